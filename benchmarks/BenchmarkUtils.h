@@ -0,0 +1,54 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace parus::benchmark
+{
+
+    /** Runs the body `repetitions` times and returns the fastest wall-clock time in milliseconds. */
+    inline double measureBestMilliseconds(const int repetitions, const std::function<void()>& body)
+    {
+        double best = 1e300;
+        for (int i = 0; i < repetitions; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    /** Keeps the compiler from optimizing away a computed value. */
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        // MSVC has no inline asm on x64: escape the address through a volatile store instead.
+        [[maybe_unused]] const void* volatile escaped = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+
+    /** A few hundred nanoseconds of ALU work, standing in for a small real task. */
+    inline uint64_t spinWork(const int iterations)
+    {
+        uint64_t value = 0x9E3779B97F4A7C15ull;
+        for (int i = 0; i < iterations; ++i)
+        {
+            value ^= value << 7;
+            value ^= value >> 9;
+        }
+        return value;
+    }
+
+}
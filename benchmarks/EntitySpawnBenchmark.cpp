@@ -0,0 +1,118 @@
+/**
+ * EntityManager bulk spawn benchmark: what finishSceneLoad() does per entity, with and without the
+ * batch API.
+ *
+ * Each run starts from an empty EntityManager and spawns entities with a transform, a mesh and, for
+ * every fourth one, a point light:
+ *  - spawn loop:            one spawn() per entity, storage grows as it goes;
+ *  - reserve + spawnMany:   reserve()/reserveComponents() first, then one spawnMany() call;
+ *  - same-name spawnMany:   every entity requests the same name, so each one gets a numeric suffix;
+ *  - destroy loop:          one destroy() per entity;
+ *  - destroyMany:           one destroyMany() call over every id.
+ *
+ * Usage: EntitySpawnBenchmark [entities]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace
+{
+    using namespace parus;
+
+    constexpr int REPETITIONS = 5;
+
+    void addComponents(EntityManager& entityManager, const EntityId id, const int i)
+    {
+        math::Transform transform;
+        transform.position = math::Vector3(static_cast<float>(i), 0.0f, 0.0f);
+        entityManager.setTransform(id, transform);
+
+        entityManager.addMeshComponent(id, MeshComponent{});
+        if (i % 4 == 0)
+        {
+            entityManager.addPointLightComponent(id, PointLightComponent{});
+        }
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    const int entityCount = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    // Distinct names, as a saved scene has; the same-name case is measured separately.
+    std::vector<std::string> names;
+    names.reserve(entityCount);
+    for (int i = 0; i < entityCount; ++i)
+    {
+        names.push_back("Entity" + std::to_string(i));
+    }
+
+    std::printf("EntityManager spawn benchmark: %d entities\n\n", entityCount);
+
+    const double loopMilliseconds = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        EntityManager entityManager;
+        for (int i = 0; i < entityCount; ++i)
+        {
+            addComponents(entityManager, entityManager.spawn(names[i]), i);
+        }
+        benchmark::doNotOptimize(entityManager.view<>().size());
+    });
+    std::printf("%-22s %10.3f ms\n", "spawn loop", loopMilliseconds);
+
+    const double batchMilliseconds = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        EntityManager entityManager;
+        entityManager.reserve(entityCount);
+        entityManager.reserveComponents<MeshComponent>(entityCount);
+        entityManager.reserveComponents<PointLightComponent>(entityCount / 4 + 1);
+
+        const std::vector<EntityId> ids = entityManager.spawnMany(names);
+        for (int i = 0; i < entityCount; ++i)
+        {
+            addComponents(entityManager, ids[i], i);
+        }
+        benchmark::doNotOptimize(entityManager.view<>().size());
+    });
+    std::printf("%-22s %10.3f ms\n", "reserve + spawnMany", batchMilliseconds);
+
+    const std::vector<std::string> sameNames(entityCount, "Crate");
+    const double sameNameMilliseconds = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        EntityManager entityManager;
+        benchmark::doNotOptimize(entityManager.spawnMany(sameNames).size());
+    });
+    std::printf("%-22s %10.3f ms\n", "same-name spawnMany", sameNameMilliseconds);
+
+    // Destroys are timed on their own; filling the scene is left out of the measurement.
+    double destroyLoopMilliseconds = 1e300;
+    double destroyManyMilliseconds = 1e300;
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+    {
+        EntityManager loopManager;
+        EntityManager batchManager;
+        const std::vector<EntityId> loopIds = loopManager.spawnMany(names);
+        const std::vector<EntityId> batchIds = batchManager.spawnMany(names);
+
+        destroyLoopMilliseconds = std::min(destroyLoopMilliseconds, benchmark::measureBestMilliseconds(1, [&]
+        {
+            for (const EntityId id : loopIds)
+            {
+                loopManager.destroy(id);
+            }
+        }));
+        destroyManyMilliseconds = std::min(destroyManyMilliseconds, benchmark::measureBestMilliseconds(1, [&]
+        {
+            batchManager.destroyMany(batchIds);
+        }));
+    }
+    std::printf("%-22s %10.3f ms\n", "destroy loop", destroyLoopMilliseconds);
+    std::printf("%-22s %10.3f ms\n", "destroyMany", destroyManyMilliseconds);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * EntityManager query benchmark: the vector-returning getters against in-place views.
+ *
+ * Fills a scene with mesh entities (every fourth one also a point light) and reports time and heap
+ * allocations per query:
+ *  - count/getMeshEntities:  getMeshEntities().size(), what scene save/load used to report;
+ *  - count/view:             view<MeshComponent>().size();
+ *  - sum/getMeshEntities:    walks the returned vector and reads every transform;
+ *  - sum/view:               the same walk through view<MeshComponent>().each();
+ *  - sum/view parallel:      view<MeshComponent>().parallelEach() on the pool;
+ *  - sum/getPointLight...:   mesh + light entities through getPointLightEntities() and a mesh lookup;
+ *  - sum/view<Light, Mesh>:  the same join through a two-component view.
+ *
+ * Usage: EntityViewBenchmark [entities] [threads]
+ */
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+
+#include "BenchmarkUtils.h"
+#include "services/threading/ThreadPool.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace
+{
+    std::atomic<size_t> allocationCount { 0 };
+}
+
+void* operator new(const size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    using namespace parus;
+
+    constexpr int REPETITIONS = 20;
+
+    void fillScene(EntityManager& entityManager, const int entityCount)
+    {
+        for (int i = 0; i < entityCount; ++i)
+        {
+            // Distinct names keep spawn() off the unique-suffix search, which isn't what is measured here.
+            const EntityId id = entityManager.spawn("Entity" + std::to_string(i));
+
+            math::Transform transform;
+            transform.position = math::Vector3(static_cast<float>(i), 0.0f, 0.0f);
+            entityManager.setTransform(id, transform);
+
+            entityManager.addMeshComponent(id, MeshComponent{});
+            if (i % 4 == 0)
+            {
+                entityManager.addPointLightComponent(id, PointLightComponent{});
+            }
+        }
+    }
+
+    void report(const char* name, const std::function<void()>& body)
+    {
+        body();
+
+        const size_t allocationsBefore = allocationCount.load();
+        body();
+        const size_t allocations = allocationCount.load() - allocationsBefore;
+
+        const double milliseconds = benchmark::measureBestMilliseconds(REPETITIONS, body);
+        std::printf("%-26s %10.3f ms %8zu allocs/query\n", name, milliseconds, allocations);
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    const int entityCount = argc > 1 ? std::stoi(argv[1]) : 100000;
+    const unsigned int threadCount = argc > 2 ? static_cast<unsigned int>(std::stoul(argv[2])) : ThreadPool::defaultThreadCount();
+
+    EntityManager entityManager;
+    fillScene(entityManager, entityCount);
+
+    ThreadPool pool;
+    pool.init(threadCount);
+
+    std::printf("EntityManager query benchmark: %d entities, %u pool threads\n\n", entityCount, threadCount);
+
+    report("count/getMeshEntities", [&]
+    {
+        benchmark::doNotOptimize(entityManager.getMeshEntities().size());
+    });
+    report("count/view", [&]
+    {
+        benchmark::doNotOptimize(entityManager.view<MeshComponent>().size());
+    });
+
+    report("sum/getMeshEntities", [&]
+    {
+        float sum = 0.0f;
+        for (const auto& [entity, meshComponent] : entityManager.getMeshEntities())
+        {
+            sum += entity->transform.position.x;
+        }
+        benchmark::doNotOptimize(sum);
+    });
+    report("sum/view", [&]
+    {
+        float sum = 0.0f;
+        entityManager.view<MeshComponent>().each([&sum](const Entity& entity, const MeshComponent&)
+        {
+            sum += entity.transform.position.x;
+        });
+        benchmark::doNotOptimize(sum);
+    });
+    report("sum/view parallel", [&]
+    {
+        std::atomic<uint64_t> sum { 0 };
+        entityManager.view<MeshComponent>().parallelEach(pool, [&sum](const Entity& entity, const MeshComponent&)
+        {
+            sum.fetch_add(static_cast<uint64_t>(entity.transform.position.x), std::memory_order_relaxed);
+        }, 4096);
+        benchmark::doNotOptimize(sum.load());
+    });
+
+    report("sum/getPointLightEntities", [&]
+    {
+        float sum = 0.0f;
+        for (const auto& [entity, pointLightComponent] : entityManager.getPointLightEntities())
+        {
+            if (entityManager.getMeshComponent(entity->id))
+            {
+                sum += entity->transform.position.x * pointLightComponent->intensity;
+            }
+        }
+        benchmark::doNotOptimize(sum);
+    });
+    report("sum/view<Light, Mesh>", [&]
+    {
+        float sum = 0.0f;
+        entityManager.view<PointLightComponent, MeshComponent>().each([&sum](const Entity& entity, const PointLightComponent& light, const MeshComponent&)
+        {
+            sum += entity.transform.position.x * light.intensity;
+        });
+        benchmark::doNotOptimize(sum);
+    });
+
+    return 0;
+}
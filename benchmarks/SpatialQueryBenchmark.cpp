@@ -0,0 +1,198 @@
+/**
+ * Spatial index benchmark: EntityManager::getSpatialIndex() queries against scanning every entity.
+ *
+ * The scene is a cube of randomly placed entities, each with a point light of radius 2, so every
+ * entity has a small box; half are static and half movable. Each query kind runs a batch of queries
+ * at random places, once through the index and once by testing every entity's world bounds:
+ *  - sphere:   entities within 10 units, as for light assignment or proximity checks;
+ *  - frustum:  a 60 degree camera frustum, as for culling;
+ *  - raycast:  the closest box along a random ray, as for picking.
+ *
+ * It also times a frame in which a tenth of the movable entities move a little, which is what
+ * keeping the index up to date costs in updateWorldTransforms().
+ *
+ * Usage: SpatialQueryBenchmark [entities]
+ */
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace
+{
+    using namespace parus;
+
+    constexpr int REPETITIONS = 5;
+    constexpr int QUERY_COUNT = 1000;
+    constexpr float WORLD_SIZE = 1000.0f;
+
+    struct Queries
+    {
+        std::vector<math::Sphere> spheres;
+        std::vector<math::Frustum> frustums;
+        std::vector<math::Ray> rays;
+    };
+
+    Queries makeQueries(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        const math::Matrix4x4 projection = math::Matrix4x4::perspective(math::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+
+        Queries queries;
+        for (int i = 0; i < QUERY_COUNT; ++i)
+        {
+            const math::Vector3 origin(position(random), position(random), position(random));
+            const math::Vector3 forward = math::Vector3(direction(random), direction(random), direction(random)).normalize();
+
+            queries.spheres.push_back({ origin, 10.0f });
+            queries.frustums.push_back(math::Frustum::fromViewProjection(math::Matrix4x4::lookAt(origin, origin + forward, { 0.0f, 1.0f, 0.0f }) * projection));
+            queries.rays.push_back({ origin, forward });
+        }
+        return queries;
+    }
+
+    void printComparison(const char* name, const double indexMilliseconds, const double scanMilliseconds)
+    {
+        std::printf("%-10s index %10.3f ms   scan %10.3f ms   speedup %6.1fx\n", name, indexMilliseconds, scanMilliseconds, scanMilliseconds / indexMilliseconds);
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    const int entityCount = argc > 1 ? std::stoi(argv[1]) : 100000;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+
+    EntityManager entityManager;
+    entityManager.reserve(entityCount);
+    std::vector<EntityId> movableIds;
+    for (int i = 0; i < entityCount; ++i)
+    {
+        const EntityId id = entityManager.spawn("Entity");
+        math::Transform transform;
+        transform.position = math::Vector3(position(random), position(random), position(random));
+        entityManager.setTransform(id, transform);
+        entityManager.addPointLightComponent(id, PointLightComponent { .radius = 2.0f });
+        if (i % 2 == 0)
+        {
+            entityManager.setMobility(id, Mobility::Movable);
+            movableIds.push_back(id);
+        }
+    }
+    entityManager.updateWorldTransforms();
+
+    // What a scan would test: every entity's world bounds, in one flat array.
+    std::vector<std::pair<EntityId, math::Aabb>> allBounds;
+    entityManager.view<>().each([&](const Entity& entity)
+    {
+        allBounds.emplace_back(entity.id, *entityManager.getSpatialIndex().getBounds(entity.id));
+    });
+
+    const Queries queries = makeQueries(random);
+    const SpatialIndex& index = entityManager.getSpatialIndex();
+
+    std::printf("Spatial query benchmark: %d entities, %d queries per kind\n\n", entityCount, QUERY_COUNT);
+
+    size_t indexHits = 0;
+    const double sphereIndex = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        indexHits = 0;
+        for (const math::Sphere& sphere : queries.spheres)
+        {
+            index.querySphere(sphere, [&indexHits](EntityId) { ++indexHits; });
+        }
+    });
+    size_t scanHits = 0;
+    const double sphereScan = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        scanHits = 0;
+        for (const math::Sphere& sphere : queries.spheres)
+        {
+            for (const auto& [id, bounds] : allBounds)
+            {
+                scanHits += sphere.intersects(bounds) ? 1 : 0;
+            }
+        }
+    });
+    printComparison("sphere", sphereIndex, sphereScan);
+    if (indexHits != scanHits)
+    {
+        std::printf("  mismatch: %zu vs %zu hits\n", indexHits, scanHits);
+    }
+
+    const double frustumIndex = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        indexHits = 0;
+        for (const math::Frustum& frustum : queries.frustums)
+        {
+            index.queryFrustum(frustum, [&indexHits](EntityId) { ++indexHits; });
+        }
+    });
+    const double frustumScan = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        scanHits = 0;
+        for (const math::Frustum& frustum : queries.frustums)
+        {
+            for (const auto& [id, bounds] : allBounds)
+            {
+                scanHits += frustum.intersects(bounds) ? 1 : 0;
+            }
+        }
+    });
+    printComparison("frustum", frustumIndex, frustumScan);
+    if (indexHits != scanHits)
+    {
+        std::printf("  mismatch: %zu vs %zu hits\n", indexHits, scanHits);
+    }
+
+    const double rayIndex = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        indexHits = 0;
+        for (const math::Ray& ray : queries.rays)
+        {
+            indexHits += index.raycast(ray, WORLD_SIZE).has_value() ? 1 : 0;
+        }
+    });
+    const double rayScan = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        scanHits = 0;
+        for (const math::Ray& ray : queries.rays)
+        {
+            std::optional<float> closest;
+            for (const auto& [id, bounds] : allBounds)
+            {
+                if (const std::optional<float> distance = ray.intersect(bounds, closest.value_or(WORLD_SIZE)))
+                {
+                    closest = distance;
+                }
+            }
+            scanHits += closest.has_value() ? 1 : 0;
+        }
+    });
+    printComparison("raycast", rayIndex, rayScan);
+    if (indexHits != scanHits)
+    {
+        std::printf("  mismatch: %zu vs %zu hits\n", indexHits, scanHits);
+    }
+
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    const double moveMilliseconds = benchmark::measureBestMilliseconds(REPETITIONS, [&]
+    {
+        for (size_t i = 0; i < movableIds.size(); i += 10)
+        {
+            math::Transform transform = entityManager.getEntity(movableIds[i])->transform;
+            transform.position = transform.position + math::Vector3(step(random), step(random), step(random));
+            entityManager.setTransform(movableIds[i], transform);
+        }
+        entityManager.updateWorldTransforms();
+    });
+    std::printf("\n%-10s %10.3f ms for %zu moved entities\n", "move", moveMilliseconds, movableIds.size() / 10);
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * Enqueue/dequeue microbenchmark for the ThreadPool's task storage.
+ *
+ * Moves empty tasks with a typical capture (a shared_ptr plus a couple of pointers) through a
+ * queue and reports throughput and heap allocations per task:
+ *  - queue/std::function: the old scheme, a heap-allocated std::function per submission;
+ *  - queue/Task slot:     a pooled TaskSlot with the callable stored inline;
+ *  - pool/enqueue:        ThreadPool::enqueue, which still allocates the handle's shared state;
+ *  - pool/post:           ThreadPool::post, the fire-and-forget path.
+ *
+ * Usage: TaskBenchmark [threads]
+ */
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "BenchmarkUtils.h"
+#include "services/threading/MpmcQueue.h"
+#include "services/threading/TaskSlotPool.h"
+#include "services/threading/ThreadPool.h"
+
+namespace
+{
+    std::atomic<size_t> allocationCount { 0 };
+}
+
+void* operator new(const size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    using namespace parus;
+
+    constexpr int TASK_COUNT = 200000;
+    constexpr int BATCH_SIZE = 1024;
+    constexpr int REPETITIONS = 5;
+
+    std::atomic<uint64_t> executed { 0 };
+
+    struct Payload
+    {
+        uint64_t value = 1;
+    };
+
+    // Same shape as the engine's usual submissions: shared state plus a few raw pointers.
+    auto makeCallable(const std::shared_ptr<Payload>& payload, std::atomic<uint64_t>* counter)
+    {
+        return [payload, counter, extra = counter]
+        {
+            counter->fetch_add(payload->value, std::memory_order_relaxed);
+            benchmark::doNotOptimize(extra);
+        };
+    }
+
+    void runStdFunctionQueue(const std::shared_ptr<Payload>& payload)
+    {
+        MpmcQueue<std::function<void()>> queue(BATCH_SIZE);
+        for (int batch = 0; batch < TASK_COUNT; batch += BATCH_SIZE)
+        {
+            for (int i = 0; i < BATCH_SIZE; ++i)
+            {
+                queue.push(new std::function<void()>(makeCallable(payload, &executed)));
+            }
+            while (std::function<void()>* task = queue.pop())
+            {
+                (*task)();
+                delete task;
+            }
+        }
+    }
+
+    void runTaskSlotQueue(TaskSlotPool& slots, const std::shared_ptr<Payload>& payload)
+    {
+        MpmcQueue<TaskSlot> queue(BATCH_SIZE);
+        for (int batch = 0; batch < TASK_COUNT; batch += BATCH_SIZE)
+        {
+            for (int i = 0; i < BATCH_SIZE; ++i)
+            {
+                TaskSlot* slot = slots.acquire();
+                slot->task.emplace(makeCallable(payload, &executed));
+                queue.push(slot);
+            }
+            while (TaskSlot* slot = queue.pop())
+            {
+                slot->task();
+                slot->task.reset();
+                slots.release(slot);
+            }
+        }
+    }
+
+    void runPoolEnqueue(ThreadPool& pool, const std::shared_ptr<Payload>& payload)
+    {
+        for (int i = 0; i < TASK_COUNT; ++i)
+        {
+            pool.enqueue(makeCallable(payload, &executed));
+        }
+        pool.waitUntilDone();
+    }
+
+    void runPoolPost(ThreadPool& pool, const std::shared_ptr<Payload>& payload)
+    {
+        for (int i = 0; i < TASK_COUNT; ++i)
+        {
+            pool.post(makeCallable(payload, &executed));
+        }
+        pool.waitUntilDone();
+    }
+
+    void report(const char* name, const std::function<void()>& body)
+    {
+        // Warm-up run fills slot pools and queues, so the measurement below is the steady state.
+        body();
+
+        const size_t allocationsBefore = allocationCount.load();
+        body();
+        const double allocationsPerTask = static_cast<double>(allocationCount.load() - allocationsBefore) / TASK_COUNT;
+
+        const double milliseconds = benchmark::measureBestMilliseconds(REPETITIONS, body);
+        const double tasksPerSecond = TASK_COUNT / (milliseconds / 1000.0);
+        std::printf("%-22s %10.2f ms %12.0f tasks/s %8.2f allocs/task\n", name, milliseconds, tasksPerSecond, allocationsPerTask);
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    const unsigned int threadCount = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : ThreadPool::defaultThreadCount();
+    const auto payload = std::make_shared<Payload>();
+
+    std::printf("Task storage benchmark: %d tasks, %u pool threads, Task inline capacity %zu bytes\n\n",
+        TASK_COUNT, threadCount, Task::INLINE_CAPACITY);
+
+    TaskSlotPool slots;
+    report("queue/std::function", [&] { runStdFunctionQueue(payload); });
+    report("queue/Task slot", [&] { runTaskSlotQueue(slots, payload); });
+
+    ThreadPool pool;
+    pool.init(threadCount);
+    report("pool/enqueue", [&] { runPoolEnqueue(pool, payload); });
+    report("pool/post", [&] { runPoolPost(pool, payload); });
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * Contention benchmark for the ThreadPool scheduler.
+ *
+ * Runs the same three workloads with 1..N worker threads and prints throughput and speedup
+ * relative to a single worker:
+ *  - external:  the main thread submits every task (injection queue, single producer);
+ *  - producers: four external threads submit concurrently (injection queue, many producers);
+ *  - nested:    a handful of root tasks fan out from inside the pool (worker deques + stealing).
+ *
+ * Usage: ThreadPoolBenchmark [maxThreads]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "services/threading/ThreadPool.h"
+
+namespace
+{
+    using namespace parus;
+
+    constexpr int TASK_COUNT = 200000;
+    constexpr int WORK_ITERATIONS = 256;
+    constexpr int PRODUCER_COUNT = 4;
+    constexpr int ROOT_TASK_COUNT = 64;
+    constexpr int REPETITIONS = 5;
+
+    void tinyTask()
+    {
+        benchmark::doNotOptimize(benchmark::spinWork(WORK_ITERATIONS));
+    }
+
+    void runExternal(ThreadPool& pool)
+    {
+        for (int i = 0; i < TASK_COUNT; ++i)
+        {
+            pool.enqueue(tinyTask);
+        }
+        pool.waitUntilDone();
+    }
+
+    void runProducers(ThreadPool& pool)
+    {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCER_COUNT; ++p)
+        {
+            producers.emplace_back([&pool]
+            {
+                for (int i = 0; i < TASK_COUNT / PRODUCER_COUNT; ++i)
+                {
+                    pool.enqueue(tinyTask);
+                }
+            });
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        pool.waitUntilDone();
+    }
+
+    void runNested(ThreadPool& pool)
+    {
+        for (int root = 0; root < ROOT_TASK_COUNT; ++root)
+        {
+            pool.enqueue([&pool]
+            {
+                for (int i = 0; i < TASK_COUNT / ROOT_TASK_COUNT; ++i)
+                {
+                    pool.enqueue(tinyTask);
+                }
+            });
+        }
+        pool.waitUntilDone();
+    }
+
+    struct Workload
+    {
+        const char* name;
+        void (*run)(ThreadPool&);
+        double singleThreadMilliseconds = 0.0;
+    };
+}
+
+int main(const int argc, char** argv)
+{
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int maxThreads = argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : hardwareThreads;
+
+    Workload workloads[] = {
+        { "external", runExternal },
+        { "producers", runProducers },
+        { "nested", runNested },
+    };
+
+    std::printf("%d tasks per run, ~%d spin iterations each, best of %d.\n\n", TASK_COUNT, WORK_ITERATIONS, REPETITIONS);
+    std::printf("%-10s %8s %12s %14s %9s\n", "workload", "threads", "time [ms]", "Mtasks/s", "speedup");
+
+    // 1, 2, 3, 4, 8, 16, ... and always the requested maximum.
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads = threads < 4 ? threads + 1 : threads * 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(std::max(1u, maxThreads));
+
+    for (const unsigned int threads : threadCounts)
+    {
+        const auto pool = std::make_unique<ThreadPool>();
+        pool->init(threads);
+
+        for (Workload& workload : workloads)
+        {
+            const double milliseconds = benchmark::measureBestMilliseconds(REPETITIONS, [&] { workload.run(*pool); });
+            if (threads == 1)
+            {
+                workload.singleThreadMilliseconds = milliseconds;
+            }
+
+            std::printf("%-10s %8u %12.2f %14.2f %8.2fx\n",
+                workload.name,
+                threads,
+                milliseconds,
+                TASK_COUNT / milliseconds / 1000.0,
+                workload.singleThreadMilliseconds / milliseconds);
+        }
+    }
+
+    return 0;
+}
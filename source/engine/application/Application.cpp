@@ -11,6 +11,7 @@
 #include "services/Services.h"
 #include "services/config/Configs.h"
 #include "services/console/Console.h"
+#include "services/threading/MainThreadQueue.h"
 #include "services/threading/ThreadPool.h"
 #include "services/world/World.h"
 #include "services/serialization/Serialization.h"
@@ -25,7 +26,7 @@ namespace parus
 
 		configs->loadAll();
 		platform->init();
-		threadPool->init();
+		threadPool->init(ThreadPoolSettings::fromConfigs(*configs));
 		world->init();
 		renderer->init();
 		graphicsLibrary->init();
@@ -33,6 +34,7 @@ namespace parus
 		processArgs(argc, argv);
 
 		isMinimized = configs->getOrDefault<bool>("Window", "isMinimized", false);
+		isPipelined = configs->getOrDefault<bool>("Engine", "pipelineSimulation", false);
 		isRunning = true;
 	}
 
@@ -66,6 +68,9 @@ namespace parus
 		threadPool = std::make_shared<ThreadPool>();
 		Services::registerService<ThreadPool>(threadPool);
 
+		mainThreadQueue = std::make_shared<MainThreadQueue>();
+		Services::registerService<MainThreadQueue>(mainThreadQueue);
+
 		console = std::make_shared<Console>();
 		Services::registerService<Console>(console);
 
@@ -101,7 +106,23 @@ namespace parus
 			FIRE_EVENT(EventType::EVENT_APPLICATION_QUIT, 0);
 		});
 
+		console->registerConsoleCommand("pipeline", [this](const std::vector<std::string>& args, CommandContext& out)
+		{
+			if (!args.empty())
+			{
+				if (args[0] != "on" && args[0] != "off")
+				{
+					out.write("Usage: pipeline [on|off]");
+					return;
+				}
+				isPipelined = args[0] == "on";
+			}
+
+			out.write(std::string("Simulation pipelining: ") + (isPipelined ? "on" : "off"));
+		});
+
 		serialization->registerConsoleCommands();
+		threadPool->registerConsoleCommands();
 	}
 	
 	void Application::processArgs(const int argc, const char* argv[])
@@ -116,6 +137,11 @@ namespace parus
 	{
 		auto lastFrameTime = std::chrono::high_resolution_clock::now();
 
+		// The first pipelined frame draws this while the world ticks for the second one.
+		world->extractRenderSnapshot(world->getRenderSnapshots().getWriteSnapshot());
+		world->getRenderSnapshots().publish();
+		world->getEntityManager()->publishSnapshot();
+
 		while (isRunning)
 		{
 			const auto currentFrameTime = std::chrono::high_resolution_clock::now();
@@ -123,19 +149,85 @@ namespace parus
 			const float deltaTime = deltaTimeDuration.count();
 			lastFrameTime = currentFrameTime;
 
-			world->tick(deltaTime);
-			platform->getMessages();
+			threadPool->beginFrame();
 
-			if (!isMinimized)
+			if (isPipelined)
 			{
-				graphicsLibrary->drawFrame();
-				renderer->drawFrame();
+				runPipelinedFrame(deltaTime);
+			}
+			else
+			{
+				runSequentialFrame(deltaTime);
 			}
 		}
 
 		renderer->deviceWaitIdle();
 	}
 
+	void Application::runSequentialFrame(const float deltaTime)
+	{
+		world->tick(deltaTime);
+		platform->getMessages();
+		mainThreadQueue->drain(static_cast<size_t>(threadPool->getSettings().mainThreadCallbacksPerFrame));
+
+		if (!isMinimized)
+		{
+			graphicsLibrary->drawFrame();
+		}
+
+		// Extracted after the UI so console edits made this frame are drawn this frame.
+		world->extractRenderSnapshot(world->getRenderSnapshots().getWriteSnapshot());
+		world->getRenderSnapshots().publish();
+		renderer->syncScene();
+
+		if (!isMinimized)
+		{
+			renderer->drawFrame();
+		}
+
+		world->getEntityManager()->dispatchObservers();
+		// Frame boundary: background jobs started from now on read this frame's world, if any job
+		// read the last one; unread epochs are skipped so the next tick doesn't clone every chunk.
+		world->getEntityManager()->publishSnapshotIfRead();
+	}
+
+	void Application::runPipelinedFrame(const float deltaTime)
+	{
+		// Everything that changes the world from the main thread (input, loaded scenes, console
+		// commands run by the UI) happens before the tick starts, so the two stages never share it.
+		platform->getMessages();
+		mainThreadQueue->drain(static_cast<size_t>(threadPool->getSettings().mainThreadCallbacksPerFrame));
+
+		if (!isMinimized)
+		{
+			graphicsLibrary->drawFrame();
+		}
+
+		// Applied while nothing else touches the world; picks up last frame's tick and this frame's edits.
+		renderer->syncScene();
+
+		TaskHandle<void> simulation = threadPool->enqueue(TaskPriority::FRAME_CRITICAL, [this, deltaTime]
+		{
+			world->tick(deltaTime);
+			world->extractRenderSnapshot(world->getRenderSnapshots().getWriteSnapshot());
+		});
+
+		// Draws the snapshot the previous frame's tick published.
+		if (!isMinimized)
+		{
+			renderer->drawFrame();
+		}
+
+		simulation.get();
+		world->getRenderSnapshots().publish();
+
+		// The tick is done, so observers see this frame's edits and the tick's changes together.
+		world->getEntityManager()->dispatchObservers();
+		// Frame boundary: background jobs started from now on read this tick's world, if any job
+		// read the last one (see EntityManager::publishSnapshotIfRead()).
+		world->getEntityManager()->publishSnapshotIfRead();
+	}
+
 	void Application::clean()
 	{
 		isRunning = false;
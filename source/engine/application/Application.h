@@ -12,6 +12,7 @@ namespace parus
 	class Input;
 	class World;
 	class ThreadPool;
+	class MainThreadQueue;
 	class Console;
 	class Serialization;
 
@@ -26,13 +27,22 @@ namespace parus
 		/** Initialize the application: register services, load config, create window, initialize Vulkan and ImGui. */
 		void init(int argc, const char* argv[]);
 
-		/** Run the main loop: process delta time, tick world, handle platform messages, render frame. */
+		/**
+		 * Run the main loop: process delta time, tick world, handle platform messages, run main-thread callbacks, render frame.
+		 * With [Engine] pipelineSimulation the next world tick runs on the ThreadPool while the current frame is recorded.
+		 */
 		void loop();
 
 		/** Perform ordered shutdown of all services and subsystems. */
 		void clean();
 
 	private:
+		/** One frame with the simulation and the renderer one after another on the main thread. */
+		void runSequentialFrame(float deltaTime);
+
+		/** One frame that ticks the world for the next frame on the ThreadPool while this one is recorded. */
+		void runPipelinedFrame(float deltaTime);
+
 		/** Register all core services (Configs, Platform, Graphics, Renderer, Events, Input, World, etc.) with the service locator. */
 		void registerServices();
 
@@ -51,6 +61,9 @@ namespace parus
 		/** Whether the window is currently minimized; used to skip frame rendering. */
 		bool isMinimized = false;
 
+		/** Whether world ticks overlap frame recording (one frame of extra input latency); toggled by the `pipeline` command. */
+		bool isPipelined = false;
+
 		/** Loads and provides access to INI config values. */
 		std::shared_ptr<Configs> configs;
 
@@ -75,6 +88,9 @@ namespace parus
 		/** Worker threads for fire-and-forget async work. */
 		std::shared_ptr<ThreadPool> threadPool;
 
+		/** Callbacks posted from worker threads, run on the main thread once per frame. */
+		std::shared_ptr<MainThreadQueue> mainThreadQueue;
+
 		/** In-engine command console; registers and dispatches debug commands. */
 		std::shared_ptr<Console> console;
 
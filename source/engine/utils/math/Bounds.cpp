@@ -0,0 +1,197 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace parus::math
+{
+
+    /*==================================
+     * Aabb implementation
+     *==================================*/
+    float Aabb::surfaceArea() const
+    {
+        if (isEmpty())
+        {
+            return 0.0f;
+        }
+
+        const Vector3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    Aabb Aabb::merge(const Aabb& other) const
+    {
+        return {
+            { std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z) },
+            { std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z) }
+        };
+    }
+
+    Aabb Aabb::expand(const float margin) const
+    {
+        const Vector3 offset(margin, margin, margin);
+        return { min - offset, max + offset };
+    }
+
+    bool Aabb::contains(const Aabb& other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+            && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    bool Aabb::intersects(const Aabb& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x
+            && min.y <= other.max.y && max.y >= other.min.y
+            && min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    Aabb Aabb::transform(const Matrix4x4& matrix) const
+    {
+        if (isEmpty())
+        {
+            return {};
+        }
+
+        // Arvo's method: each output axis is the translation plus, per input axis, the smaller and
+        // larger of the two scaled extremes.
+        const TrivialMatrix4x4 values = matrix.trivial();
+        const float inputMin[3] = { min.x, min.y, min.z };
+        const float inputMax[3] = { max.x, max.y, max.z };
+        float outputMin[3] = { values.values[3][0], values.values[3][1], values.values[3][2] };
+        float outputMax[3] = { values.values[3][0], values.values[3][1], values.values[3][2] };
+
+        for (int column = 0; column < 3; ++column)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                const float a = values.values[row][column] * inputMin[row];
+                const float b = values.values[row][column] * inputMax[row];
+                outputMin[column] += std::min(a, b);
+                outputMax[column] += std::max(a, b);
+            }
+        }
+
+        return { { outputMin[0], outputMin[1], outputMin[2] }, { outputMax[0], outputMax[1], outputMax[2] } };
+    }
+
+    /*==================================
+     * Sphere implementation
+     *==================================*/
+    bool Sphere::intersects(const Aabb& box) const
+    {
+        if (box.isEmpty())
+        {
+            return false;
+        }
+
+        const Vector3 closest(
+            std::clamp(center.x, box.min.x, box.max.x),
+            std::clamp(center.y, box.min.y, box.max.y),
+            std::clamp(center.z, box.min.z, box.max.z));
+        const Vector3 offset = center - closest;
+
+        return offset.dot(offset) <= radius * radius;
+    }
+
+    /*==================================
+     * Ray implementation
+     *==================================*/
+    std::optional<float> Ray::intersect(const Aabb& box, const float maxDistance) const
+    {
+        const float origins[3] = { origin.x, origin.y, origin.z };
+        const float directions[3] = { direction.x, direction.y, direction.z };
+        const float boxMin[3] = { box.min.x, box.min.y, box.min.z };
+        const float boxMax[3] = { box.max.x, box.max.y, box.max.z };
+
+        // Slab test: clip [0, maxDistance] against the pair of planes on each axis.
+        float entry = 0.0f;
+        float exit = maxDistance;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::fabs(directions[axis]) < static_cast<float>(MATH_EPSILON))
+            {
+                if (origins[axis] < boxMin[axis] || origins[axis] > boxMax[axis])
+                {
+                    return std::nullopt;
+                }
+                continue;
+            }
+
+            const float inverseDirection = 1.0f / directions[axis];
+            float slabEntry = (boxMin[axis] - origins[axis]) * inverseDirection;
+            float slabExit = (boxMax[axis] - origins[axis]) * inverseDirection;
+            if (slabEntry > slabExit)
+            {
+                std::swap(slabEntry, slabExit);
+            }
+
+            entry = std::max(entry, slabEntry);
+            exit = std::min(exit, slabExit);
+            if (entry > exit)
+            {
+                return std::nullopt;
+            }
+        }
+
+        return entry;
+    }
+
+    /*==================================
+     * Frustum implementation
+     *==================================*/
+    Frustum Frustum::fromViewProjection(const Matrix4x4& viewProjection)
+    {
+        // Row vectors: clip = (x, y, z, 1) * M, so each clip coordinate is a dot product with a column.
+        const TrivialMatrix4x4 values = viewProjection.trivial();
+        const auto column = [&values](const int index)
+        {
+            return std::array<float, 4> { values.values[0][index], values.values[1][index], values.values[2][index], values.values[3][index] };
+        };
+        const auto makePlane = [](const std::array<float, 4>& w, const std::array<float, 4>& axis, const float sign)
+        {
+            const Vector3 normal(w[0] + sign * axis[0], w[1] + sign * axis[1], w[2] + sign * axis[2]);
+            const float length = normal.length();
+            return Plane { normal * (1.0f / length), (w[3] + sign * axis[3]) / length };
+        };
+
+        const std::array<float, 4> x = column(0);
+        const std::array<float, 4> y = column(1);
+        const std::array<float, 4> z = column(2);
+        const std::array<float, 4> w = column(3);
+
+        return Frustum { {
+            makePlane(w, x, 1.0f),
+            makePlane(w, x, -1.0f),
+            makePlane(w, y, 1.0f),
+            makePlane(w, y, -1.0f),
+            makePlane(w, z, 1.0f),
+            makePlane(w, z, -1.0f)
+        } };
+    }
+
+    bool Frustum::intersects(const Aabb& box) const
+    {
+        if (box.isEmpty())
+        {
+            return false;
+        }
+
+        for (const Plane& plane : planes)
+        {
+            // The corner furthest along the normal; if even that is behind, the whole box is.
+            const Vector3 positiveCorner(
+                plane.normal.x >= 0.0f ? box.max.x : box.min.x,
+                plane.normal.y >= 0.0f ? box.max.y : box.min.y,
+                plane.normal.z >= 0.0f ? box.max.z : box.min.z);
+            if (plane.signedDistance(positiveCorner) < 0.0f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <optional>
+
+#include "Math.h"
+
+namespace parus::math
+{
+    /*==================================
+     * Aabb
+     *==================================*/
+    /** Axis-aligned bounding box. The default value is empty: it contains nothing and merges as a no-op. */
+    struct Aabb final
+    {
+        Vector3 min { 1e30f, 1e30f, 1e30f };
+        Vector3 max { -1e30f, -1e30f, -1e30f };
+
+        static Aabb fromPoint(const Vector3& point) { return { point, point }; }
+        static Aabb fromCenterExtents(const Vector3& center, const Vector3& extents) { return { center - extents, center + extents }; }
+
+        [[nodiscard]] bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+        [[nodiscard]] Vector3 center() const { return (min + max) * 0.5f; }
+        [[nodiscard]] Vector3 extents() const { return (max - min) * 0.5f; }
+        /** Used as the insertion cost when building trees. */
+        [[nodiscard]] float surfaceArea() const;
+
+        /** Smallest box containing both; merging with an empty box returns the other one. */
+        [[nodiscard]] Aabb merge(const Aabb& other) const;
+        /** Grown by margin on every side. */
+        [[nodiscard]] Aabb expand(float margin) const;
+
+        [[nodiscard]] bool contains(const Aabb& other) const;
+        /** Touching boxes intersect. */
+        [[nodiscard]] bool intersects(const Aabb& other) const;
+
+        /** Bounds of this box after transforming it by a (row-vector) matrix; still axis-aligned, so it may grow. */
+        [[nodiscard]] Aabb transform(const Matrix4x4& matrix) const;
+
+        bool operator==(const Aabb& other) const = default;
+    };
+
+    /*==================================
+     * Sphere
+     *==================================*/
+    struct Sphere final
+    {
+        Vector3 center;
+        float radius = 0.0f;
+
+        [[nodiscard]] bool intersects(const Aabb& box) const;
+    };
+
+    /*==================================
+     * Ray
+     *==================================*/
+    /** origin + t * direction for t >= 0. direction need not be normalized; distances are in units of its length. */
+    struct Ray final
+    {
+        Vector3 origin;
+        Vector3 direction;
+
+        /** Entry distance into the box (0 if the origin is inside), or nullopt if it is missed within maxDistance. */
+        [[nodiscard]] std::optional<float> intersect(const Aabb& box, float maxDistance) const;
+    };
+
+    /*==================================
+     * Frustum
+     *==================================*/
+    /** A plane as normal . p + distance = 0; points with a positive signed distance are in front. */
+    struct Plane final
+    {
+        Vector3 normal;
+        float distance = 0.0f;
+
+        [[nodiscard]] float signedDistance(const Vector3& point) const { return normal.dot(point) + distance; }
+    };
+
+    /** Six inward-facing planes: left, right, bottom, top, near, far. */
+    struct Frustum final
+    {
+        std::array<Plane, 6> planes;
+
+        /**
+         * Extracts the planes of a (row-vector) view-projection matrix. The near plane is taken at
+         * clip z = -w, which is exact for the engine's perspective() and conservative for [0, 1]
+         * depth projections.
+         */
+        static Frustum fromViewProjection(const Matrix4x4& viewProjection);
+
+        /** False only if the box is fully behind one plane; boxes near the corners may pass. */
+        [[nodiscard]] bool intersects(const Aabb& box) const;
+    };
+}
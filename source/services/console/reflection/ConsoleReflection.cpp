@@ -1,7 +1,9 @@
 #include "ConsoleReflection.h"
 
 #include <algorithm>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
 
 #include "services/console/CommandContext.h"
 #include "services/console/Console.h"
@@ -261,6 +263,21 @@ namespace parus
         {
             return completeAddress(input);
         });
+
+        const auto markTargetNamesStale = [this](std::span<const EntityId>) { areTargetNamesStale = true; };
+        entityObserverIds = {
+            this->entityManager->onAdd<Entity>(markTargetNamesStale),
+            this->entityManager->onRemove<Entity>(markTargetNamesStale),
+            this->entityManager->onChange<Entity>(markTargetNamesStale)
+        };
+    }
+
+    ConsoleReflection::~ConsoleReflection()
+    {
+        for (const ComponentObservers::ObserverId id : entityObserverIds)
+        {
+            entityManager->removeObserver(id);
+        }
     }
 
     std::optional<EntityId> ConsoleReflection::resolveEntityId(const std::string& targetToken) const
@@ -269,10 +286,15 @@ namespace parus
         {
             try
             {
-                const EntityId id = static_cast<EntityId>(std::stoul(targetToken.substr(1)));
-                if (entityManager->getEntity(id))
+                // "#5" names whatever lives in slot 5 (what `list` prints); a full handle with a
+                // generation in its high bits only resolves while that exact entity is alive.
+                const EntityId id = static_cast<EntityId>(std::stoull(targetToken.substr(1)));
+                const Entity* entity = getEntityGeneration(id) == 0
+                    ? entityManager->getEntityByIndex(getEntityIndex(id))
+                    : entityManager->getEntity(id);
+                if (entity)
                 {
-                    return id;
+                    return entity->id;
                 }
             }
             catch (const std::exception&)
@@ -333,18 +355,7 @@ namespace parus
 
         if (lastToken.find(SEGMENT_SEPARATOR) == std::string::npos)
         {
-            std::vector<std::string> candidates;
-            for (const Entity* entity : entityManager->getAllEntities())
-            {
-                candidates.push_back(entity->name);
-            }
-            if (camera)
-            {
-                candidates.push_back(CAMERA_TARGET_NAME);
-            }
-            std::sort(candidates.begin(), candidates.end());
-
-            const std::optional<std::string> completed = cycleWord(candidates, lastToken);
+            const std::optional<std::string> completed = cycleWord(getTargetNames(), lastToken);
             if (!completed)
             {
                 return std::nullopt;
@@ -436,7 +447,7 @@ namespace parus
         entitySchema.name = "Entity";
         entitySchema.properties.push_back(PropertyAccessor{
             "name", "string",
-            [](const void* object) { return static_cast<const Entity*>(object)->name; },
+            [](const void* object) { return std::string(static_cast<const Entity*>(object)->name); },
             [](void* object, const std::vector<std::string>& values, std::string& error)
             {
                 if (values.empty())
@@ -444,6 +455,7 @@ namespace parus
                     error = "expected a name";
                     return false;
                 }
+                // Only views values[0]; handleSet() passes it to renameEntity() while values is alive.
                 static_cast<Entity*>(object)->name = values[0];
                 return true;
             }
@@ -689,6 +701,40 @@ namespace parus
         {
             handleList(args, out);
         });
+        console->registerConsoleCommand("parent", [this](const std::vector<std::string>& args, CommandContext& out)
+        {
+            handleParent(args, out);
+        });
+        console->registerConsoleCommand("undo", [this](const std::vector<std::string>&, CommandContext& out)
+        {
+            handleUndo(out);
+        });
+        console->registerConsoleCommand("redo", [this](const std::vector<std::string>&, CommandContext& out)
+        {
+            handleRedo(out);
+        });
+    }
+
+    const std::vector<std::string>& ConsoleReflection::getTargetNames() const
+    {
+        if (!areTargetNamesStale)
+        {
+            return targetNames;
+        }
+
+        targetNames.clear();
+        entityManager->view<>().each([this](const Entity& entity)
+        {
+            targetNames.emplace_back(entity.name);
+        });
+        if (camera)
+        {
+            targetNames.push_back(CAMERA_TARGET_NAME);
+        }
+        std::sort(targetNames.begin(), targetNames.end());
+        areTargetNamesStale = false;
+
+        return targetNames;
     }
 
     void ConsoleReflection::handleGet(const std::vector<std::string>& args, CommandContext& out) const
@@ -772,7 +818,7 @@ namespace parus
         out.write(property->read(componentPointer));
     }
 
-    void ConsoleReflection::handleSet(const std::vector<std::string>& args, CommandContext& out) const
+    void ConsoleReflection::handleSet(const std::vector<std::string>& args, CommandContext& out)
     {
         if (args.size() < 2)
         {
@@ -834,13 +880,15 @@ namespace parus
                 return;
             }
 
-            entityManager->setTransform(*id, entityCopy.transform);
-            entityManager->setMobility(*id, entityCopy.mobility);
-            if (entityCopy.name != entity->name)
+            EntityIntrinsics before { std::string(entity->name), entity->mobility, entity->transform };
+            EntityIntrinsics after { std::string(entityCopy.name), entityCopy.mobility, entityCopy.transform };
+            if (applySetValue(*id, after) != ApplyResult::Applied)
             {
-                entityManager->renameEntity(*id, entityCopy.name);
+                out.write("Failed to set " + args[0] + ": name already taken");
+                return;
             }
 
+            recordSet(*id, args[0], std::move(before), std::move(after));
             out.write(args[0] + " set.");
             return;
         }
@@ -874,6 +922,7 @@ namespace parus
                 out.write("Failed to set " + args[0] + ": " + error);
                 return;
             }
+            recordSet(*id, args[0], *component, componentCopy);
             entityManager->addPointLightComponent(*id, componentCopy);
         }
         else if (componentName == "DirectionalLight")
@@ -891,6 +940,7 @@ namespace parus
                 out.write("Failed to set " + args[0] + ": " + error);
                 return;
             }
+            recordSet(*id, args[0], *component, componentCopy);
             entityManager->addDirectionalLightComponent(*id, componentCopy);
         }
         else if (componentName == "Skybox")
@@ -908,6 +958,7 @@ namespace parus
                 out.write("Failed to set " + args[0] + ": " + error);
                 return;
             }
+            recordSet(*id, args[0], *component, componentCopy);
             entityManager->addSkyboxComponent(*id, componentCopy);
         }
         else if (componentName == "Mesh")
@@ -924,13 +975,167 @@ namespace parus
         out.write(args[0] + " set.");
     }
 
+    void ConsoleReflection::recordSet(const EntityId id, const std::string& address, SetValue before, SetValue after)
+    {
+        if (undoHistory.size() == MAX_UNDO_COUNT)
+        {
+            undoHistory.erase(undoHistory.begin());
+        }
+        undoHistory.push_back({ id, address, std::move(before), std::move(after) });
+        redoHistory.clear();
+    }
+
+    ConsoleReflection::ApplyResult ConsoleReflection::applySetValue(const EntityId id, const SetValue& value) const
+    {
+        const Entity* entity = entityManager->getEntity(id);
+        if (!entity)
+        {
+            return ApplyResult::Gone;
+        }
+
+        return std::visit([this, id, entity](const auto& state)
+        {
+            using State = std::decay_t<decltype(state)>;
+            if constexpr (std::is_same_v<State, EntityIntrinsics>)
+            {
+                // Rename first: it is the only part that can fail.
+                if (entity->name != state.name && !entityManager->renameEntity(id, state.name))
+                {
+                    return ApplyResult::NameTaken;
+                }
+                entityManager->setTransform(id, state.transform);
+                entityManager->setMobility(id, state.mobility);
+                return ApplyResult::Applied;
+            }
+            else if constexpr (std::is_same_v<State, PointLightComponent>)
+            {
+                if (!entityManager->getPointLightComponent(id))
+                {
+                    return ApplyResult::Gone;
+                }
+                entityManager->addPointLightComponent(id, state);
+                return ApplyResult::Applied;
+            }
+            else if constexpr (std::is_same_v<State, DirectionalLightComponent>)
+            {
+                const Entity* directionalLightEntity = entityManager->getDirectionalLightEntity();
+                if (!directionalLightEntity || directionalLightEntity->id != id)
+                {
+                    return ApplyResult::Gone;
+                }
+                entityManager->addDirectionalLightComponent(id, state);
+                return ApplyResult::Applied;
+            }
+            else
+            {
+                const Entity* skyboxEntity = entityManager->getSkyboxEntity();
+                if (!skyboxEntity || skyboxEntity->id != id)
+                {
+                    return ApplyResult::Gone;
+                }
+                entityManager->addSkyboxComponent(id, state);
+                return ApplyResult::Applied;
+            }
+        }, value);
+    }
+
+    void ConsoleReflection::handleUndo(CommandContext& out)
+    {
+        if (undoHistory.empty())
+        {
+            out.write("Nothing to undo.");
+            return;
+        }
+
+        applyHistory(undoHistory, redoHistory, true, out);
+    }
+
+    void ConsoleReflection::handleRedo(CommandContext& out)
+    {
+        if (redoHistory.empty())
+        {
+            out.write("Nothing to redo.");
+            return;
+        }
+
+        applyHistory(redoHistory, undoHistory, false, out);
+    }
+
+    void ConsoleReflection::applyHistory(std::vector<SetRecord>& history, std::vector<SetRecord>& otherHistory, const bool isUndo, CommandContext& out)
+    {
+        SetRecord& record = history.back();
+        const SetValue& value = isUndo ? record.before : record.after;
+        const std::string verb = isUndo ? "undo" : "redo";
+
+        switch (applySetValue(record.id, value))
+        {
+        case ApplyResult::Gone:
+            out.write("Cannot " + verb + " set " + record.address + ": the entity or component is gone.");
+            history.pop_back();
+            return;
+        case ApplyResult::NameTaken:
+            // Kept, so the user can free the name and try again.
+            out.write("Cannot " + verb + " set " + record.address + ": name " + std::get<EntityIntrinsics>(value).name + " is already taken.");
+            return;
+        case ApplyResult::Applied:
+            break;
+        }
+
+        out.write((isUndo ? "Undid set " : "Redid set ") + record.address + ".");
+        otherHistory.push_back(std::move(record));
+        history.pop_back();
+    }
+
+    void ConsoleReflection::handleParent(const std::vector<std::string>& args, CommandContext& out) const
+    {
+        if (args.empty() || args.size() > 2)
+        {
+            out.write("Usage: parent <entity> [<parent entity> | none]");
+            return;
+        }
+
+        const std::optional<EntityId> id = resolveEntityId(args[0]);
+        if (!id)
+        {
+            out.write("Unknown entity: " + args[0]);
+            return;
+        }
+
+        if (args.size() == 1)
+        {
+            const Entity* parent = entityManager->getEntity(entityManager->getEntity(*id)->parent);
+            out.write(args[0] + " parent = " + std::string(parent ? parent->name : "none"));
+            return;
+        }
+
+        EntityId parentId = 0;
+        if (args[1] != "none")
+        {
+            const std::optional<EntityId> resolvedParentId = resolveEntityId(args[1]);
+            if (!resolvedParentId)
+            {
+                out.write("Unknown entity: " + args[1]);
+                return;
+            }
+            parentId = *resolvedParentId;
+        }
+
+        if (!entityManager->setParent(*id, parentId))
+        {
+            out.write("Cannot parent " + args[0] + " to " + args[1] + ": it would create a cycle.");
+            return;
+        }
+
+        out.write(args[0] + " parent set.");
+    }
+
     void ConsoleReflection::handleList(const std::vector<std::string>& args, CommandContext& out) const
     {
         if (args.empty())
         {
             for (const Entity* entity : entityManager->getAllEntities())
             {
-                out.write(entity->name + " (#" + std::to_string(entity->id) + ")");
+                out.write(std::string(entity->name) + " (#" + std::to_string(getEntityIndex(entity->id)) + ")");
             }
             return;
         }
@@ -2,9 +2,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include "services/console/reflection/PropertyRegistry.h"
+#include "services/world/entity/ComponentObservers.h"
 #include "services/world/entity/Entity.h"
 
 namespace parus
@@ -14,13 +16,19 @@ namespace parus
     class EntityManager;
     class SpectatorCamera;
 
-    /** Wires the generic get/set/list console commands onto entity and component property schemas. */
+    /**
+     * Wires the generic get/set/list console commands onto entity and component property schemas, plus
+     * `parent` for the transform hierarchy and `undo`/`redo` for entity sets.
+     */
     class ConsoleReflection final
     {
     public:
         ConsoleReflection(std::shared_ptr<Console> console, std::shared_ptr<EntityManager> entityManager, SpectatorCamera* camera = nullptr);
+        ~ConsoleReflection();
+        ConsoleReflection(const ConsoleReflection&) = delete;
+        ConsoleReflection& operator=(const ConsoleReflection&) = delete;
 
-        /** Parses a target token: "#5" -> id 5, otherwise a name lookup. Nullopt if unresolved. */
+        /** Parses a target token: "#5" -> the entity in slot 5, otherwise a name lookup. Nullopt if unresolved. */
         [[nodiscard]] std::optional<EntityId> resolveEntityId(const std::string& targetToken) const;
 
     private:
@@ -48,16 +56,76 @@ namespace parus
          * get/set/list. Returns nullopt for anything else, deferring to the static Trie.
          */
         [[nodiscard]] std::optional<std::string> completeAddress(const std::string& input) const;
+        /** Sorted entity names plus the camera target, rebuilt only after entities were spawned, destroyed or changed. */
+        [[nodiscard]] const std::vector<std::string>& getTargetNames() const;
+
+        /** Name, mobility and transform: everything `set` can change on the entity itself. */
+        struct EntityIntrinsics
+        {
+            std::string name;
+            Mobility mobility = Mobility::Static;
+            math::Transform transform;
+        };
+
+        /** What one entity `set` replaced: the entity's intrinsics or the one component it addressed. */
+        using SetValue = std::variant<EntityIntrinsics, PointLightComponent, DirectionalLightComponent, SkyboxComponent>;
+
+        struct SetRecord
+        {
+            EntityId id = 0;
+            std::string address;
+            SetValue before;
+            SetValue after;
+        };
+
+        static constexpr size_t MAX_UNDO_COUNT = 64;
+
+        /** Pushes a successful entity set onto the undo history and forgets everything that could be redone. */
+        void recordSet(EntityId id, const std::string& address, SetValue before, SetValue after);
+        enum class ApplyResult
+        {
+            Applied,
+            /** The entity was destroyed or no longer has the component. */
+            Gone,
+            /** Another entity now has the name to restore; nothing was changed. */
+            NameTaken
+        };
+
+        /**
+         * Writes value back to the entity. Never resurrects the entity or a component, and never moves
+         * the directional light or skybox to another entity.
+         */
+        [[nodiscard]] ApplyResult applySetValue(EntityId id, const SetValue& value) const;
+        /**
+         * Applies the latest record of history (its before value when undoing) and moves it to
+         * otherHistory. A record whose entity or component is gone is dropped; one blocked by a name
+         * conflict stays, so it can be retried once the name is free.
+         */
+        void applyHistory(std::vector<SetRecord>& history, std::vector<SetRecord>& otherHistory, bool isUndo, CommandContext& out);
 
         void handleGet(const std::vector<std::string>& args, CommandContext& out) const;
-        void handleSet(const std::vector<std::string>& args, CommandContext& out) const;
+        void handleSet(const std::vector<std::string>& args, CommandContext& out);
+        /** Reverts the latest entity set; camera sets are not recorded. */
+        void handleUndo(CommandContext& out);
+        void handleRedo(CommandContext& out);
         void handleList(const std::vector<std::string>& args, CommandContext& out) const;
+        /** "parent <entity>" prints the parent; "parent <entity> <parent|none>" re-parents, keeping the local transform. */
+        void handleParent(const std::vector<std::string>& args, CommandContext& out) const;
 
         std::shared_ptr<Console> console;
         std::shared_ptr<EntityManager> entityManager;
         /** Optional bridge to the world's camera, addressed via the special "camera" target name. */
         SpectatorCamera* camera = nullptr;
         PropertyRegistry registry;
+
+        mutable std::vector<std::string> targetNames;
+        mutable bool areTargetNamesStale = true;
+        /** Entity observers that mark targetNames stale; removed again on destruction. */
+        std::vector<ComponentObservers::ObserverId> entityObserverIds;
+
+        /** Oldest first, at most MAX_UNDO_COUNT. */
+        std::vector<SetRecord> undoHistory;
+        std::vector<SetRecord> redoHistory;
     };
 
 }
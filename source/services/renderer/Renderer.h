@@ -13,6 +13,8 @@ namespace parus
 		virtual void registerEvents() = 0;
 		virtual void clean() = 0;
 		virtual void drawFrame() = 0;
+		/** Applies the world's entity changes since the last call. Main thread, while the simulation isn't ticking. */
+		virtual void syncScene() = 0;
 		virtual void deviceWaitIdle() = 0;
 
 	};
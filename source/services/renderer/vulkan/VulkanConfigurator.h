@@ -36,6 +36,11 @@ namespace parus::vulkan
 		float zFar = 1500.0f;
 		float fieldOfView = 45.0f;
 
+		// Level of detail
+		float lodDistanceScale = 1.0f;
+		float shadowLodDistanceScale = 2.0f;
+		float lodHysteresis = 0.1f;
+
 		// Fog
 		float fogStart = 500.0f;
 		float fogEnd = 2500.0f;
@@ -11,10 +11,12 @@
 #pragma warning(pop)
 #endif // SAVE_CAPTURE_CUBEMAP_TEXTURES
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <set>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "builder/VkBufferBuilder.h"
 #include "builder/VkPipelineBuilder.h"
@@ -33,8 +35,10 @@
 #include "material/VulkanMaterial.h"
 #include "mesh/SkyboxMesh.h"
 #include "services/Services.h"
+#include "services/threading/Parallel.h"
 #include "services/threading/ThreadPool.h"
 #include "services/world/World.h"
+#include "services/world/entity/EntityCommandBuffer.h"
 #include "services/world/entity/Components.h"
 #include "services/world/entity/EntityManager.h"
 #include "utils/VulkanUtils.h"
@@ -42,6 +46,22 @@
 
 namespace parus::vulkan
 {
+	namespace
+	{
+		/** The chain's mesh for level, or fallback if there is no usable one. */
+		const std::shared_ptr<Mesh>& getLodMesh(const LodComponent* lodComponent, const uint32_t level, const std::shared_ptr<Mesh>& fallback)
+		{
+			if (!lodComponent || lodComponent->levels.empty())
+			{
+				return fallback;
+			}
+
+			// The chain may have been replaced by a shorter one since the level was selected.
+			const std::shared_ptr<Mesh>& mesh = lodComponent->levels[std::min<size_t>(level, lodComponent->levels.size() - 1)].mesh;
+			return mesh && mesh->meshType == MeshType::GEOMETRY ? mesh : fallback;
+		}
+	}
+
 	void VulkanRenderer::init()
 	{
 		registerEvents();
@@ -143,7 +163,7 @@ namespace parus::vulkan
 					VulkanStorage::MAX_FRAMES_IN_FLIGHT * static_cast<uint32_t>(MAX_MESHES))
 				.withAllocator([&](VulkanStorage& s, const VkDescriptorSetLayout layout)
 				{
-					for (auto& meshInstance : meshInstances)
+					for (auto& meshInstance : meshInstances.getValues())
 					{
 						if (!meshInstance.instanceDescriptorSets.empty())
 						{
@@ -173,6 +193,7 @@ namespace parus::vulkan
 							vkUpdateDescriptorSets(s.logicalDevice, 1, &write, 0, nullptr);
 						}
 					}
+					hasInstancesWithoutDescriptorSets = false;
 				}));
 
 		descriptorManager.define(DescriptorType::MATERIAL,
@@ -449,121 +470,278 @@ namespace parus::vulkan
 		vkDeviceWaitIdle(storage.logicalDevice);
 	}
 
-	void VulkanRenderer::importMesh(const std::string& meshPath, const MeshType meshType)
+	void VulkanRenderer::importMesh(const std::string& meshPath, const MeshType meshType, const CancellationToken& token)
 	{
-		Mesh newMesh = importMeshFromFile(meshPath);
-		newMesh.meshType = meshType;
-
-		std::scoped_lock lock(importModelMutex);
-		modelQueue.emplace(meshPath, std::make_shared<Mesh>(newMesh));
-	}
+		std::optional<Mesh> newMesh = importMeshFromFile(meshPath, token);
+		if (token.isCancelled())
+		{
+			LOG_INFO("Import cancelled: " + meshPath);
+			return;
+		}
+		if (!newMesh)
+		{
+			LOG_ERROR("Failed to import mesh: " + meshPath);
+			return;
+		}
+		newMesh->meshType = meshType;
 
-	void VulkanRenderer::enqueueMesh(const std::string& meshId, const std::shared_ptr<Mesh>& mesh)
-	{
-		std::scoped_lock lock(importModelMutex);
-		modelQueue.emplace(meshId, mesh);
+		const auto world = Services::get<World>();
+		const auto mesh = std::make_shared<Mesh>(std::move(*newMesh));
+		world->getStorage()->addNewMesh(meshPath, mesh);
+		// Raised before the entity can exist, so whichever frame first draws it rebuilds the scene buffers first.
+		hasNewMeshes.store(true, std::memory_order_release);
+
+		// The token also drops the entity if the scene is replaced before the next tick plays it back.
+		EntityCommandBuffer commands(token);
+		const EntityCommandBuffer::Target entity = commands.spawn(meshPath);
+		commands.addMeshComponent(entity, MeshComponent{ mesh });
+		world->getCommandQueue().submit(std::move(commands));
 	}
 
 	void VulkanRenderer::applySceneFromWorld()
 	{
-		// Flush any meshes pending in the model queue (e.g. the skybox enqueued during init)
-		// so they are in Storage before rebuildSceneBuffers reads from it.
-		flushMeshQueue();
+		// Imported meshes already registered themselves in Storage; the rebuild below covers them.
+		hasNewMeshes.store(false, std::memory_order_relaxed);
 
 		const auto world = Services::get<World>();
 		ASSERT(world, "World service must be available.");
 
 		const auto entityManager = world->getEntityManager();
+		world->updateWorldTransforms();
+
+		// Everything is rebuilt from the current state below, so pending changes are already covered.
+		entityManager->takeChanges(sceneChanges);
 
 		// Rebuild renderer mesh instance list from mesh-component entities (geometry meshes only).
+		for (MeshInstance& meshInstance : meshInstances.getValues())
+		{
+			if (!meshInstance.instanceDescriptorSets.empty())
+			{
+				freeInstanceDescriptorSets.push_back(std::move(meshInstance.instanceDescriptorSets));
+			}
+		}
 		meshInstances.clear();
-		for (const auto& [entity, meshComponent] : entityManager->getMeshEntities())
+		areMeshBatchesStale = true;
+		pointLights.clear();
+
+		lodSelector.clear();
+		selectLods(*entityManager, world->getMainCamera().getPosition());
+
+		entityManager->view<MeshComponent>().each([this, &entityManager](const Entity& entity, const MeshComponent&)
 		{
-			if (!meshComponent->mesh || meshComponent->mesh->meshType != MeshType::GEOMETRY)
+			syncMeshInstance(*entityManager, entity.id);
+		});
+
+		// Mirror lights and sky colors from the entity system.
+		entityManager->view<PointLightComponent>().each([this, &entityManager](const Entity& entity, const PointLightComponent&)
+		{
+			syncPointLight(*entityManager, entity.id);
+		});
+		syncDirectionalLightAndSky(*entityManager);
+		rebuildMeshBatches();
+
+		rebuildSceneBuffers();
+		rebuildDescriptorSets();
+	}
+
+	void VulkanRenderer::syncScene()
+	{
+		const auto world = Services::get<World>();
+		const auto entityManager = world->getEntityManager();
+		world->updateWorldTransforms();
+		entityManager->takeChanges(sceneChanges);
+
+		if (sceneChanges.wasCleared)
+		{
+			applySceneFromWorld();
+			return;
+		}
+
+		selectLods(*entityManager, world->getMainCamera().getPosition());
+		for (const EntityId id : lodSelector.getChanged())
+		{
+			syncMeshInstance(*entityManager, id);
+		}
+
+		// Each listed entity is re-read from its current state, so order and repeats don't matter.
+		for (const EntityId id : sceneChanges.destroyed)
+		{
+			removeMeshInstance(id);
+			pointLights.erase(id);
+		}
+		for (const EntityId id : sceneChanges.transformChanged)
+		{
+			syncMeshInstance(*entityManager, id);
+			syncPointLight(*entityManager, id);
+		}
+
+		bool hasSunOrSkyChanged = false;
+		const auto syncComponentChanges = [this, &entityManager, &hasSunOrSkyChanged](const std::vector<ComponentChange>& componentChanges)
+		{
+			for (const ComponentChange& change : componentChanges)
 			{
-				continue;
+				switch (change.type)
+				{
+				case ComponentType::Mesh:
+				case ComponentType::Lod:
+					syncMeshInstance(*entityManager, change.id);
+					break;
+				case ComponentType::PointLight:
+					syncPointLight(*entityManager, change.id);
+					break;
+				case ComponentType::DirectionalLight:
+				case ComponentType::Skybox:
+					hasSunOrSkyChanged = true;
+					break;
+				}
 			}
+		};
+		syncComponentChanges(sceneChanges.componentsAdded);
+		syncComponentChanges(sceneChanges.componentsRemoved);
 
-			meshInstances.push_back({
-				.mesh                   = meshComponent->mesh,
-				.transform              = entity->transform.toMatrix(),
-				.instanceDescriptorSets = {}
-			});
+		if (hasSunOrSkyChanged)
+		{
+			syncDirectionalLightAndSky(*entityManager);
 		}
+		rebuildMeshBatches();
 
-		// Mirror lights from the entity system.
-		if (const auto* directionalLightComponent = entityManager->getDirectionalLightComponent())
+		// Only instances that found no recycled descriptor sets need the pool.
+		if (hasInstancesWithoutDescriptorSets)
 		{
-			directionalLight = VulkanDirectionalLight(*directionalLightComponent);
+			rebuildDescriptorSets();
 		}
+	}
 
-		pointLights.clear();
-		for (const auto& [entity, pointLightComponent] : entityManager->getPointLightEntities())
+	void VulkanRenderer::syncMeshInstance(const EntityManager& entityManager, const EntityId id)
+	{
+		const MeshComponent* meshComponent = entityManager.getMeshComponent(id);
+		if (!meshComponent || !meshComponent->mesh || meshComponent->mesh->meshType != MeshType::GEOMETRY)
+		{
+			removeMeshInstance(id);
+			return;
+		}
+
+		MeshInstance* meshInstance = meshInstances.find(id);
+		if (!meshInstance)
+		{
+			std::vector<VkDescriptorSet> descriptorSets;
+			if (!freeInstanceDescriptorSets.empty())
+			{
+				descriptorSets = std::move(freeInstanceDescriptorSets.back());
+				freeInstanceDescriptorSets.pop_back();
+			}
+			hasInstancesWithoutDescriptorSets = hasInstancesWithoutDescriptorSets || descriptorSets.empty();
+			meshInstance = &meshInstances.insertOrAssign(id, MeshInstance{ .instanceDescriptorSets = std::move(descriptorSets) });
+		}
+
+		const LodComponent* lodComponent = entityManager.getLodComponent(id);
+		const LodSelector::Selection* selection = lodSelector.find(id);
+		const std::shared_ptr<Mesh>& mesh = getLodMesh(lodComponent, selection ? selection->level : 0, meshComponent->mesh);
+		const std::shared_ptr<Mesh>& shadowMesh = getLodMesh(lodComponent, selection ? selection->shadowLevel : 0, meshComponent->mesh);
+
+		areMeshBatchesStale = areMeshBatchesStale || meshInstance->mesh != mesh || meshInstance->shadowMesh != shadowMesh;
+		meshInstance->mesh       = mesh;
+		meshInstance->shadowMesh = shadowMesh;
+		meshInstance->transform  = *entityManager.getWorldMatrix(id);
+	}
+
+	void VulkanRenderer::syncPointLight(const EntityManager& entityManager, const EntityId id)
+	{
+		const PointLightComponent* pointLightComponent = entityManager.getPointLightComponent(id);
+		if (!pointLightComponent)
+		{
+			pointLights.erase(id);
+			return;
+		}
+
+		pointLights.insertOrAssign(id, VulkanPointLight(*pointLightComponent, entityManager.getWorldMatrix(id)->transformPoint({})));
+	}
+
+	void VulkanRenderer::syncDirectionalLightAndSky(const EntityManager& entityManager)
+	{
+		// Assigning the component part keeps the light's descriptor sets.
+		if (const auto* directionalLightComponent = entityManager.getDirectionalLightComponent())
 		{
-			pointLights.emplace_back(*pointLightComponent, entity->transform.position);
+			static_cast<DirectionalLightComponent&>(directionalLight) = *directionalLightComponent;
 		}
 
-		// Mirror sky colors from the skybox entity.
-		if (const auto* skyboxComponent = entityManager->getSkyboxComponent())
+		if (const auto* skyboxComponent = entityManager.getSkyboxComponent())
 		{
 			skyHorizonColor = skyboxComponent->horizonColor;
 			skyZenithColor  = skyboxComponent->zenithColor;
 		}
-
-		rebuildSceneBuffers();
-		rebuildDescriptorSets();
 	}
 
-	void VulkanRenderer::processLoadedMeshes()
+	void VulkanRenderer::removeMeshInstance(const EntityId id)
 	{
-		if (!flushMeshQueue())
+		MeshInstance* meshInstance = meshInstances.find(id);
+		if (!meshInstance)
 		{
 			return;
 		}
-		rebuildSceneBuffers();
-		rebuildDescriptorSets();
 
-		if (needsCubemapCapture && storage.globalBuffers.skyVertexBuffer != VK_NULL_HANDLE)
+		if (!meshInstance->instanceDescriptorSets.empty())
 		{
-			captureSkyToCubemap();
-			needsCubemapCapture = false;
+			freeInstanceDescriptorSets.push_back(std::move(meshInstance->instanceDescriptorSets));
 		}
+		meshInstances.erase(id);
+		areMeshBatchesStale = true;
 	}
 
-	bool VulkanRenderer::flushMeshQueue()
+	void VulkanRenderer::rebuildMeshBatches()
 	{
-		std::vector<std::pair<std::string, std::shared_ptr<Mesh>>> pendingMeshes;
+		if (!areMeshBatchesStale)
+		{
+			return;
+		}
 
+		const std::span<const MeshInstance> instances = meshInstances.getValues();
+		const auto groupBy = [instances](std::shared_ptr<Mesh> MeshInstance::* meshMember, std::vector<MeshBatch>& batches)
 		{
-			std::scoped_lock lock(importModelMutex);
-			if (modelQueue.empty())
+			batches.clear();
+			std::unordered_map<const Mesh*, size_t> batchIndices;
+			for (size_t instanceIndex = 0; instanceIndex < instances.size(); ++instanceIndex)
 			{
-				return false;
+				const std::shared_ptr<Mesh>& mesh = instances[instanceIndex].*meshMember;
+				const auto [batchIndex, isNewMesh] = batchIndices.try_emplace(mesh.get(), batches.size());
+				if (isNewMesh)
+				{
+					batches.push_back(MeshBatch{ .mesh = mesh, .representativeInstance = static_cast<uint32_t>(instanceIndex) });
+				}
+				++batches[batchIndex->second].instanceCount;
 			}
+		};
+		groupBy(&MeshInstance::mesh, meshBatches);
+		groupBy(&MeshInstance::shadowMesh, shadowMeshBatches);
+		areMeshBatchesStale = false;
+	}
 
-			while (!modelQueue.empty())
-			{
-				pendingMeshes.push_back(modelQueue.front());
-				modelQueue.pop();
-			}
-		}
+	void VulkanRenderer::selectLods(const EntityManager& entityManager, const math::Vector3& cameraPosition)
+	{
+		const LodSettings settings{
+			.verticalFieldOfView = math::radians(configurator.fieldOfView),
+			.distanceScale = configurator.lodDistanceScale,
+			.shadowDistanceScale = configurator.shadowLodDistanceScale,
+			.hysteresis = configurator.lodHysteresis
+		};
+		lodSelector.update(entityManager, cameraPosition, settings, *Services::get<ThreadPool>());
+	}
 
-		for (auto& [meshPath, newMesh] : pendingMeshes)
+	void VulkanRenderer::processLoadedMeshes()
+	{
+		if (!hasNewMeshes.exchange(false, std::memory_order_acquire))
 		{
-			const auto world = Services::get<World>();
-			world->getStorage()->addNewMesh(meshPath, newMesh);
-			meshInstances.push_back({
-				.mesh = newMesh,
-				.transform = parus::math::Transform{}.toMatrix(),
-				.instanceDescriptorSets = {}
-			});
-
-			const auto entityManager = world->getEntityManager();
-			const EntityId newEntityId = entityManager->spawn(meshPath);
-			entityManager->addMeshComponent(newEntityId, MeshComponent{ newMesh });
+			return;
 		}
 
-		return true;
+		rebuildSceneBuffers();
+		rebuildDescriptorSets();
+
+		if (needsCubemapCapture && storage.globalBuffers.skyVertexBuffer != VK_NULL_HANDLE)
+		{
+			captureSkyToCubemap();
+			needsCubemapCapture = false;
+		}
 	}
 
 	void VulkanRenderer::rebuildSceneBuffers()
@@ -572,18 +750,7 @@ namespace parus::vulkan
 		std::vector<math::Vertex> allVertices;
 		std::vector<uint32_t> allIndices;
 
-		for (const auto& mesh : Services::get<World>()->getStorage()->getAllMeshesByType(MeshType::GEOMETRY))
-		{
-			for (auto& meshPart : mesh->meshParts)
-			{
-				meshPart.vertexOffset = allVertices.size();
-				meshPart.indexOffset  = allIndices.size();
-				meshPart.vertexCount  = meshPart.vertices.size();
-				meshPart.indexCount   = meshPart.indices.size();
-				allVertices.insert(allVertices.end(), meshPart.vertices.begin(), meshPart.vertices.end());
-				allIndices.insert(allIndices.end(), meshPart.indices.begin(), meshPart.indices.end());
-			}
-		}
+		concatenateMeshParts(Services::get<World>()->getStorage()->getAllMeshesByType(MeshType::GEOMETRY), allVertices, allIndices);
 
 		if (!allVertices.empty()) { createVertexBuffer(allVertices); }
 		if (!allIndices.empty())  { createIndexBuffer(allIndices); }
@@ -598,24 +765,50 @@ namespace parus::vulkan
 		DEBUG_ASSERT(Services::get<World>()->getStorage()->getAllMeshesByType(MeshType::SKY).size() == 1,
 			"There must be always one and only one sky mesh.");
 
-		for (const auto& mesh : Services::get<World>()->getStorage()->getAllMeshesByType(MeshType::SKY))
+		concatenateMeshParts(Services::get<World>()->getStorage()->getAllMeshesByType(MeshType::SKY), allSkyVertices, allSkyIndices);
+
+		if (!allSkyVertices.empty()) { createSkyVertexBuffer(allSkyVertices); }
+		if (!allSkyIndices.empty())  { createSkyIndexBuffer(allSkyIndices); }
+
+		storage.globalBuffers.totalSkyVertices = allSkyVertices.size();
+		storage.globalBuffers.totalSkyIndices  = allSkyIndices.size();
+	}
+
+	void VulkanRenderer::concatenateMeshParts(
+		const std::vector<std::shared_ptr<Mesh>>& meshes,
+		std::vector<math::Vertex>& allVertices,
+		std::vector<uint32_t>& allIndices)
+	{
+		// Offsets are a prefix sum over the parts; once they are known every part copies independently.
+		std::vector<MeshPart*> meshParts;
+		size_t totalVertices = 0;
+		size_t totalIndices = 0;
+
+		for (const auto& mesh : meshes)
 		{
 			for (auto& meshPart : mesh->meshParts)
 			{
-				meshPart.vertexOffset = allSkyVertices.size();
-				meshPart.indexOffset  = allSkyIndices.size();
+				meshPart.vertexOffset = totalVertices;
+				meshPart.indexOffset  = totalIndices;
 				meshPart.vertexCount  = meshPart.vertices.size();
 				meshPart.indexCount   = meshPart.indices.size();
-				allSkyVertices.insert(allSkyVertices.end(), meshPart.vertices.begin(), meshPart.vertices.end());
-				allSkyIndices.insert(allSkyIndices.end(), meshPart.indices.begin(), meshPart.indices.end());
+				totalVertices += meshPart.vertexCount;
+				totalIndices  += meshPart.indexCount;
+				meshParts.push_back(&meshPart);
 			}
 		}
 
-		if (!allSkyVertices.empty()) { createSkyVertexBuffer(allSkyVertices); }
-		if (!allSkyIndices.empty())  { createSkyIndexBuffer(allSkyIndices); }
+		allVertices.resize(totalVertices);
+		allIndices.resize(totalIndices);
 
-		storage.globalBuffers.totalSkyVertices = allSkyVertices.size();
-		storage.globalBuffers.totalSkyIndices  = allSkyIndices.size();
+		// The frame waits on this copy; keep its chunks ahead of imports and other queued work.
+		const ScopedTaskPriority framePriority(TaskPriority::FRAME_CRITICAL);
+		parallelFor(*Services::get<ThreadPool>(), 0, meshParts.size(), [&](const size_t partIndex)
+		{
+			const MeshPart& meshPart = *meshParts[partIndex];
+			std::ranges::copy(meshPart.vertices, allVertices.begin() + static_cast<std::ptrdiff_t>(meshPart.vertexOffset));
+			std::ranges::copy(meshPart.indices, allIndices.begin() + static_cast<std::ptrdiff_t>(meshPart.indexOffset));
+		}, 1);
 	}
 
 	void VulkanRenderer::rebuildDescriptorSets()
@@ -644,7 +837,6 @@ namespace parus::vulkan
 			.color     = DEFAULT_LIGHT_COLOR,
 			.direction = DEFAULT_LIGHT_DIRECTION
 		});
-		directionalLight = VulkanDirectionalLight(*entityManager->getDirectionalLightComponent());
 
 		const EntityId lampId = entityManager->spawn("Lamp");
 		entityManager->setMobility(lampId, Mobility::Movable);
@@ -657,11 +849,6 @@ namespace parus::vulkan
 			.intensity = DEFAULT_POINT_INTENSITY
 		});
 
-		for (const auto& [entity, pointLightComponent] : entityManager->getPointLightEntities())
-		{
-			pointLights.emplace_back(*pointLightComponent, entity->transform.position);
-		}
-
 		createCubemapTexture();
 
 		const auto skyboxMesh = std::make_shared<Mesh>(SkyboxMesh::create());
@@ -674,8 +861,7 @@ namespace parus::vulkan
 			.zenithColor  = DEFAULT_SKY_ZENITH
 		});
 
-		skyHorizonColor = DEFAULT_SKY_HORIZON;
-		skyZenithColor  = DEFAULT_SKY_ZENITH;
+		syncScene();
 
 		rebuildSceneBuffers();
 		rebuildDescriptorSets();
@@ -1092,7 +1278,7 @@ namespace parus::vulkan
 			"Failed to begin recording command buffer.");
 
 		const FrameContext frame{ commandBufferToRecord, static_cast<uint32_t>(currentFrame), imageIndex };
-		const SceneData scene{ meshInstances, directionalLight, pointLights };
+		const SceneData scene{ meshInstances.getValues(), meshBatches, shadowMeshBatches, directionalLight, pointLights.getValues() };
 
 		shadowPass.record(frame, storage, scene);
 		depthPrePass.record(frame, storage, scene);
@@ -1432,16 +1618,19 @@ namespace parus::vulkan
 
 	void VulkanRenderer::updateUniformBuffer(const uint32_t currentImage)
 	{
-		const SpectatorCamera camera = Services::get<World>()->getMainCamera();
+		// Only the published snapshot is read here: with a pipelined loop the next world tick is running meanwhile.
+		const RenderSnapshot& snapshot = Services::get<World>()->getRenderSnapshots().getReadSnapshot();
+		const RenderSnapshot::Camera& camera = snapshot.camera;
+		const DirectionalLightComponent& sun = snapshot.directionalLight.value_or(directionalLight);
 
 		// Compute light-space matrix for shadow mapping
-		const math::Vector3 lightDir = directionalLight.direction.normalize();
+		const math::Vector3 lightDir = sun.direction.normalize();
 
 		const float shadowExtent = configurator.shadowExtent;
 		const float shadowNear = configurator.shadowNear;
 		const float shadowFar = configurator.shadowFar;
 
-		const math::Vector3 shadowCenter = camera.getPosition();
+		const math::Vector3 shadowCenter = camera.position;
 		const math::Vector3 lightPos = shadowCenter + lightDir * (shadowFar * 0.5f);
 
 		const math::Matrix4x4 lightView = math::Matrix4x4::lookAt(
@@ -1470,9 +1659,9 @@ namespace parus::vulkan
 		math::GlobalUbo globalUbo{};
 
 		globalUbo.view = math::Matrix4x4::lookAt(
-			camera.getPosition(),
-			camera.getPosition() + camera.getForwardVector(),
-			camera.getUpVector()).trivial();
+			camera.position,
+			camera.position + camera.forward,
+			camera.up).trivial();
 
 		globalUbo.projection = math::Matrix4x4::perspective(
 			math::radians(configurator.fieldOfView),
@@ -1480,11 +1669,11 @@ namespace parus::vulkan
 			configurator.zNear, configurator.zFar).trivial();
 
 		globalUbo.lightSpaceMatrix = snappedLightSpaceMatrix;
-		globalUbo.cameraPosition = camera.getPosition().trivial();
+		globalUbo.cameraPosition = camera.position.trivial();
 
 		globalUbo.debug = debugMode;
-		globalUbo.skyHorizonColor = skyHorizonColor.trivial();
-		globalUbo.skyZenithColor = skyZenithColor.trivial();
+		globalUbo.skyHorizonColor = (snapshot.skybox ? snapshot.skybox->horizonColor : skyHorizonColor).trivial();
+		globalUbo.skyZenithColor = (snapshot.skybox ? snapshot.skybox->zenithColor : skyZenithColor).trivial();
 		globalUbo.fogStart = configurator.fogStart;
 		globalUbo.fogEnd = configurator.fogEnd;
 
@@ -1507,24 +1696,25 @@ namespace parus::vulkan
 
 		// Directional Light UBO
 		math::DirectionalLightUbo directionalLightUbo{};
-		directionalLightUbo.color = directionalLight.color.trivial();
-		directionalLightUbo.direction = directionalLight.direction.trivial();
+		directionalLightUbo.color = sun.color.trivial();
+		directionalLightUbo.direction = sun.direction.trivial();
 
 		memcpy(storage.directionalLightUboBuffer.mapped[currentFrame], &directionalLightUbo, sizeof(directionalLightUbo));
 
 		// Point Light UBO
 		math::PointLightUbo pointLightUbo{};
-		pointLightUbo.count = static_cast<int>(std::min(pointLights.size(), static_cast<size_t>(math::MAX_POINT_LIGHTS)));
+		pointLightUbo.count = static_cast<int>(std::min(snapshot.pointLights.size(), static_cast<size_t>(math::MAX_POINT_LIGHTS)));
 		for (int i = 0; i < pointLightUbo.count; ++i)
 		{
-			pointLightUbo.lights[i].posX = pointLights[i].position.x;
-			pointLightUbo.lights[i].posY = pointLights[i].position.y;
-			pointLightUbo.lights[i].posZ = pointLights[i].position.z;
-			pointLightUbo.lights[i].radius = pointLights[i].radius;
-			pointLightUbo.lights[i].colorR = pointLights[i].color.x;
-			pointLightUbo.lights[i].colorG = pointLights[i].color.y;
-			pointLightUbo.lights[i].colorB = pointLights[i].color.z;
-			pointLightUbo.lights[i].intensity = pointLights[i].intensity;
+			const RenderSnapshot::PointLight& pointLight = snapshot.pointLights[i];
+			pointLightUbo.lights[i].posX = pointLight.position.x;
+			pointLightUbo.lights[i].posY = pointLight.position.y;
+			pointLightUbo.lights[i].posZ = pointLight.position.z;
+			pointLightUbo.lights[i].radius = pointLight.light.radius;
+			pointLightUbo.lights[i].colorR = pointLight.light.color.x;
+			pointLightUbo.lights[i].colorG = pointLight.light.color.y;
+			pointLightUbo.lights[i].colorB = pointLight.light.color.z;
+			pointLightUbo.lights[i].intensity = pointLight.light.intensity;
 		}
 
 		memcpy(storage.pointLightUboBuffer.mapped[currentFrame], &pointLightUbo, sizeof(pointLightUbo));
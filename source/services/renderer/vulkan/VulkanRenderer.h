@@ -1,9 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
-#include <mutex>
 #include <optional>
-#include <queue>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -23,8 +23,16 @@
 #include "VulkanConfigurator.h"
 #include "VulkanDescriptorManager.h"
 #include "VulkanInitializer.h"
+#include "services/world/entity/ComponentStorage.h"
+#include "services/world/entity/EntityChangeSet.h"
+#include "services/world/lod/LodSelector.h"
 
 
+namespace parus
+{
+	class EntityManager;
+}
+
 namespace parus::vulkan
 {
 
@@ -37,17 +45,23 @@ namespace parus::vulkan
 		void registerEvents() override;
 		void clean() override;
 		void drawFrame() override;
+		/** Re-syncs only the mesh instances and lights of entities in the world's change set; a cleared scene falls back to applySceneFromWorld(). */
+		void syncScene() override;
 		void deviceWaitIdle() override;
 		[[nodiscard]] const VulkanStorage& getStorage() const;
 
-		/** Reads current World state and rebuilds all renderer buffers and descriptor sets. */
+		/** Reads current World state and rebuilds all renderer buffers and descriptor sets. Discards pending entity changes. */
 		void applySceneFromWorld();
 
 		/** Destroys Vulkan handles for all scene textures (not defaults or cubemap). Call before clearing scene assets from Storage. */
 		void cleanupSceneTextures();
 
-		/** Loads an OBJ file from disk and enqueues it for upload on the next frame. */
-		void importMesh(const std::string& meshPath, const MeshType meshType = MeshType::GEOMETRY);
+		/**
+		 * Loads an OBJ file from disk (on any thread), registers the mesh in Storage and submits an entity for it
+		 * to the world's command queue; the next frame uploads it. Once the token is cancelled the entity is
+		 * dropped, whether the mesh is still loading or the entity is waiting for the next tick.
+		 */
+		void importMesh(const std::string& meshPath, const MeshType meshType = MeshType::GEOMETRY, const CancellationToken& token = {});
 
 		friend VulkanTexture2d VulkanTexture2dBuilder::buildFromFile(const std::string& filePath);
 		friend VulkanTexture2d VulkanTexture2dBuilder::buildFromSolidColor(const math::Vector3& color);
@@ -67,22 +81,59 @@ namespace parus::vulkan
 
 		int debugMode = 0;
 
-		std::vector<MeshInstance> meshInstances;
+		/** Keyed by the owning entity, so syncScene() can patch one instance in O(1). */
+		ComponentStorage<MeshInstance> meshInstances;
+		/** meshInstances grouped by mesh, in first-seen order. */
+		std::vector<MeshBatch> meshBatches;
+		/** Same, grouped by shadow mesh. */
+		std::vector<MeshBatch> shadowMeshBatches;
+		/** Set when an instance is added, removed or changes mesh; transform updates keep the batches. */
+		bool areMeshBatchesStale = false;
+		/** Set when an instance is added without recycled descriptor sets; the instance allocator clears it. */
+		bool hasInstancesWithoutDescriptorSets = false;
+		/** Which LodComponent level each entity is drawn and shadowed with. */
+		LodSelector lodSelector;
 		VulkanDirectionalLight directionalLight;
-		std::vector<VulkanPointLight> pointLights;
+		ComponentStorage<VulkanPointLight> pointLights;
+
+		/** Reused by syncScene() so taking the world's changes doesn't allocate. */
+		EntityChangeSet sceneChanges;
+		/**
+		 * Descriptor sets of removed mesh instances. Every instance's sets point at the same instance
+		 * UBO, so new instances take these before anything is allocated from the pool.
+		 */
+		std::vector<std::vector<VkDescriptorSet>> freeInstanceDescriptorSets;
+
+		/**
+		 * Adds, updates or removes the entity's mesh instance to match its current MeshComponent, selected
+		 * LOD levels and world matrix.
+		 */
+		void syncMeshInstance(const EntityManager& entityManager, EntityId id);
+		/** Same for the entity's point light. */
+		void syncPointLight(const EntityManager& entityManager, EntityId id);
+		/** Mirrors the sun and sky colours from the world. */
+		void syncDirectionalLightAndSky(const EntityManager& entityManager);
+		void removeMeshInstance(EntityId id);
+		/** Regroups meshInstances into meshBatches and shadowMeshBatches if they are stale. */
+		void rebuildMeshBatches();
+		/** Reselects LOD levels for the camera's current position; see LodSelector::getChanged(). */
+		void selectLods(const EntityManager& entityManager, const math::Vector3& cameraPosition);
 
 		void cleanupFrameResources();
 
-		std::queue<std::pair<std::string, std::shared_ptr<Mesh>>> modelQueue;
-		std::mutex importModelMutex;
+		/** Set by importMesh() from any thread; processLoadedMeshes() rebuilds scene buffers once for all new meshes. */
+		std::atomic<bool> hasNewMeshes { false };
 
 		VulkanTexture2d cubemap;
 		math::Vector3 skyHorizonColor;
 		math::Vector3 skyZenithColor;
-		void enqueueMesh(const std::string& meshId, const std::shared_ptr<Mesh>& mesh);
 		void processLoadedMeshes();
-		[[nodiscard]] bool flushMeshQueue();
 		void rebuildSceneBuffers();
+		/** Packs every part of the meshes into shared vertex/index arrays and records each part's offsets. */
+		static void concatenateMeshParts(
+			const std::vector<std::shared_ptr<Mesh>>& meshes,
+			std::vector<math::Vertex>& allVertices,
+			std::vector<uint32_t>& allIndices);
 		void rebuildDescriptorSets();
 
 		void defineDescriptors();
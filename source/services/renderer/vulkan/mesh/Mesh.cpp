@@ -6,6 +6,8 @@
 #include "engine/EngineCore.h"
 #include "engine/utils/Utils.h"
 #include "services/Services.h"
+#include "services/threading/Parallel.h"
+#include "services/threading/ThreadPool.h"
 #include "services/world/World.h"
 
 
@@ -22,47 +24,65 @@ namespace parus
 			return (arbitraryVector - normal * normal.dot(arbitraryVector)).normalize();
 		}
 
-		void calculateTangents(std::vector<math::Vertex>& vertices, const std::vector<uint32_t>& indices)
+		std::optional<math::Vector3> calculateTriangleTangent(const math::Vertex& v0, const math::Vertex& v1, const math::Vertex& v2)
 		{
-			for (size_t i = 0; i < indices.size(); i += 3)
+			// Triangle edges
+			const math::Vector3 edge1 = v1.position - v0.position;
+			const math::Vector3 edge2 = v2.position - v0.position;
+
+			// Texture coordinates subtraction
+			const math::Vector2 deltaUv1 = v1.textureCoordinates - v0.textureCoordinates;
+			const math::Vector2 deltaUv2 = v2.textureCoordinates - v0.textureCoordinates;
+
+			// Tangent calculation
+			const float determinant = deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y;
+			if (std::abs(determinant) < 1e-6f)
 			{
-				math::Vertex& v0 = vertices[indices[i]];
-				math::Vertex& v1 = vertices[indices[i + 1]];
-				math::Vertex& v2 = vertices[indices[i + 2]];
+				return std::nullopt;
+			}
 
-				// Triangle edges
-				const math::Vector3 edge1 = v1.position - v0.position;
-				const math::Vector3 edge2 = v2.position - v0.position;
+			const float f = 1.0f / determinant;
 
-				// Texture coordinates subtraction
-				const math::Vector2 deltaUv1 = v1.textureCoordinates - v0.textureCoordinates;
-				const math::Vector2 deltaUv2 = v2.textureCoordinates - v0.textureCoordinates;
+			math::Vector3 tangent;
+			tangent.x = f * (deltaUv2.y * edge1.x - deltaUv1.y * edge2.x);
+			tangent.y = f * (deltaUv2.y * edge1.y - deltaUv1.y * edge2.y);
+			tangent.z = f * (deltaUv2.y * edge1.z - deltaUv1.y * edge2.z);
+
+			return tangent.normalize();
+		}
 
-				// Tangent calculation
-				const float determinant = deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y;
-				if (std::abs(determinant) < 1e-6f)
+		void calculateTangents(ThreadPool& pool, std::vector<math::Vertex>& vertices, const std::vector<uint32_t>& indices)
+		{
+			// Triangles are independent, so their tangents are computed in parallel...
+			const size_t triangleCount = indices.size() / 3;
+			std::vector<std::optional<math::Vector3>> triangleTangents(triangleCount);
+			parallelFor(pool, 0, triangleCount, [&](const size_t triangle)
+			{
+				triangleTangents[triangle] = calculateTriangleTangent(
+					vertices[indices[3 * triangle]],
+					vertices[indices[3 * triangle + 1]],
+					vertices[indices[3 * triangle + 2]]);
+			});
+
+			// ...and assigned in triangle order, so a shared vertex keeps the tangent of the last triangle that touches it.
+			for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				if (!triangleTangents[triangle])
 				{
 					continue;
 				}
 
-				const float f = 1.0f / determinant;
-
-				math::Vector3 tangent;
-				tangent.x = f * (deltaUv2.y * edge1.x - deltaUv1.y * edge2.x);
-				tangent.y = f * (deltaUv2.y * edge1.y - deltaUv1.y * edge2.y);
-				tangent.z = f * (deltaUv2.y * edge1.z - deltaUv1.y * edge2.z);
-				tangent = tangent.normalize();
-
 				// Assign tangent to all vertices of triangle
-				v0.tangent = tangent;
-				v1.tangent = tangent;
-				v2.tangent = tangent;
+				vertices[indices[3 * triangle]].tangent     = *triangleTangents[triangle];
+				vertices[indices[3 * triangle + 1]].tangent = *triangleTangents[triangle];
+				vertices[indices[3 * triangle + 2]].tangent = *triangleTangents[triangle];
 			}
 
 			// Assign a fallback tangent to any vertex whose tangent was never set
 			// (e.g. vertices that belong only to degenerate UV triangles).
-			for (math::Vertex& vertex : vertices)
+			parallelFor(pool, 0, vertices.size(), [&](const size_t vertexIndex)
 			{
+				math::Vertex& vertex = vertices[vertexIndex];
 				const float tangentLengthSquared = vertex.tangent.x * vertex.tangent.x
 					+ vertex.tangent.y * vertex.tangent.y
 					+ vertex.tangent.z * vertex.tangent.z;
@@ -71,12 +91,54 @@ namespace parus
 				{
 					vertex.tangent = fallbackTangent(vertex.normal);
 				}
+			});
+		}
+
+		math::Vertex makeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index)
+		{
+			math::Vertex vertex{};
+
+			vertex.position = {
+				attrib.vertices[3 * index.vertex_index + 0],
+				attrib.vertices[3 * index.vertex_index + 1],
+				attrib.vertices[3 * index.vertex_index + 2]
+			};
+
+			if (index.normal_index >= 0)
+			{
+				vertex.normal = {
+					attrib.normals[3 * index.normal_index + 0],
+					attrib.normals[3 * index.normal_index + 1],
+					attrib.normals[3 * index.normal_index + 2]
+				};
+			}
+			else
+			{
+				// LOG_ERROR("Model has missing normals that require recalculation.");
+				vertex.normal = { 0.0f, 0.0f, 0.0f };
 			}
+
+			if (index.texcoord_index >= 0)
+			{
+				vertex.textureCoordinates = math::Vector2(
+					attrib.texcoords[2 * index.texcoord_index + 0],
+					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+				);
+			}
+			else
+			{
+				vertex.textureCoordinates = {0.0f, 0.0f};
+			}
+
+			// Will be calculated after loading.
+			vertex.tangent = math::Vector3();
+
+			return vertex;
 		}
 	}
 	
 
-    Mesh importMeshFromFile(const std::string& filePath)
+    std::optional<Mesh> importMeshFromFile(const std::string& filePath, const CancellationToken& token)
     {
         ASSERT(std::filesystem::exists(filePath),
 			"File " + filePath + " must exist.");
@@ -116,12 +178,23 @@ namespace parus
 		{
 			LOG_WARNING(warningMessage);
 		}
+
+		// Materials load their textures from disk, so give up before that if nobody wants the mesh.
+		if (token.isCancelled())
+		{
+			return std::nullopt;
+		}
 		
 		std::vector<std::shared_ptr<parus::Material>> modelMaterials;
     	modelMaterials.reserve(materials.size());
 
 		for (const auto& material : materials)
 		{
+			if (token.isCancelled())
+			{
+				return std::nullopt;
+			}
+
 			std::shared_ptr<parus::Material> newModelMaterial
 				= Services::get<World>()->getStorage()->getOrLoadMaterial(
 					material.name,
@@ -135,8 +208,11 @@ namespace parus
 			modelMaterials.push_back(newModelMaterial);
 		}
 
-		std::unordered_map<int, MeshPart> materialMeshes;
-		std::unordered_map<int, std::unordered_map<math::Vertex, uint32_t>> uniqueVerticesPerMaterial;
+		// Group face corners by material first (parts keep the order materials first appear in),
+		// then build every part independently.
+		std::vector<MeshPart> meshParts;
+		std::vector<std::vector<tinyobj::index_t>> cornersPerPart;
+		std::unordered_map<int, size_t> partIndexByMaterial;
 
 		ASSERT(!modelMaterials.empty(),
 			"Default material is missing for mesh " + filePath);
@@ -150,7 +226,8 @@ namespace parus
 			{
 				int materialId = shape.mesh.material_ids[faceIndex];
 
-				if (!materialMeshes.contains(materialId))
+				auto [partIterator, isNewPart] = partIndexByMaterial.try_emplace(materialId, meshParts.size());
+				if (isNewPart)
 				{
 					MeshPart newMeshPart;
 					ASSERT(modelMaterials.size() > static_cast<size_t>(materialId),
@@ -164,77 +241,84 @@ namespace parus
 					{
 						newMeshPart.material = modelMaterials[materialId];
 					}
-					materialMeshes[materialId] = newMeshPart;
+					meshParts.push_back(std::move(newMeshPart));
+					cornersPerPart.emplace_back();
 				}
 
-				MeshPart& currentMesh = materialMeshes[materialId];
-				std::unordered_map<math::Vertex, uint32_t>& uniqueVertices = uniqueVerticesPerMaterial[materialId];
+				std::vector<tinyobj::index_t>& corners = cornersPerPart[partIterator->second];
 
 				size_t faceVertices = 3;
 				for (size_t v = 0; v < faceVertices; v++)
 				{
-					tinyobj::index_t index = shape.mesh.indices[indexOffset + v];
-
-					math::Vertex vertex{};
+					corners.push_back(shape.mesh.indices[indexOffset + v]);
+				}
+				indexOffset += faceVertices;
+			}
+		}
 
-					vertex.position = {
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2]
-					};
+		ThreadPool& pool = *Services::get<ThreadPool>();
 
-					if (index.normal_index >= 0)
-					{
-						vertex.normal = {
-							(index.normal_index >= 0) ? attrib.normals[3 * index.normal_index + 0] : 0.0f,
-							(index.normal_index >= 0) ? attrib.normals[3 * index.normal_index + 1] : 0.0f,
-							(index.normal_index >= 0) ? attrib.normals[3 * index.normal_index + 2] : 0.0f
-						};
-					}
-					else
-					{
-						// LOG_ERROR("Model " + filePath + " has missing normals that require recalculation.");
-						vertex.normal = { 0.0f, 0.0f, 0.0f };
-					}
+		parallelFor(pool, 0, meshParts.size(), [&](const size_t partIndex)
+		{
+			if (token.isCancelled())
+			{
+				return;
+			}
 
-					if (index.texcoord_index >= 0)
-					{
-						vertex.textureCoordinates = math::Vector2(
-							attrib.texcoords[2 * index.texcoord_index + 0],
-							1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-						);
-					}
-					else
-					{
-						vertex.textureCoordinates = {0.0f, 0.0f};
-					}
+			MeshPart& currentMesh = meshParts[partIndex];
+			const std::vector<tinyobj::index_t>& corners = cornersPerPart[partIndex];
 
-					// Will be calculated after loading.
-					vertex.tangent = math::Vector3();
+			// Building vertices is independent per corner; deduplication needs one shared map.
+			std::vector<math::Vertex> cornerVertices(corners.size());
+			parallelTransform(pool, corners.begin(), corners.end(), cornerVertices.begin(), [&attrib](const tinyobj::index_t& index)
+			{
+				return makeVertex(attrib, index);
+			});
 
-					if (!uniqueVertices.contains(vertex))
-					{
-						uniqueVertices[vertex] = static_cast<uint32_t>(currentMesh.vertices.size());
-						currentMesh.vertices.push_back(vertex);
-					}
+			std::unordered_map<math::Vertex, uint32_t> uniqueVertices;
+			uniqueVertices.reserve(cornerVertices.size());
+			currentMesh.indices.reserve(cornerVertices.size());
 
-					currentMesh.indices.push_back(uniqueVertices[vertex]);
+			for (const math::Vertex& vertex : cornerVertices)
+			{
+				const auto [vertexIterator, isNewVertex] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(currentMesh.vertices.size()));
+				if (isNewVertex)
+				{
+					currentMesh.vertices.push_back(vertex);
 				}
-				indexOffset += faceVertices;
+
+				currentMesh.indices.push_back(vertexIterator->second);
 			}
-		}
 
-		// Convert temporary meshes to final model meshes
-		for (auto& [matId, mesh] : materialMeshes)
+			calculateTangents(pool, currentMesh.vertices, currentMesh.indices);
+			currentMesh.vertexCount = currentMesh.vertices.size();
+			currentMesh.indexCount = currentMesh.indices.size();
+		}, 1);
+
+		if (token.isCancelled())
 		{
-			calculateTangents(mesh.vertices, mesh.indices);
-			mesh.vertexCount = mesh.vertices.size();
-			mesh.indexCount = mesh.indices.size();
-			newMesh.meshParts.push_back(mesh);
+			return std::nullopt;
 		}
 
+		newMesh.meshParts = std::move(meshParts);
+		newMesh.bounds = computeMeshBounds(newMesh.meshParts);
+
     	return newMesh;
     }
 
+	math::Aabb computeMeshBounds(const std::vector<MeshPart>& meshParts)
+	{
+		math::Aabb bounds;
+		for (const MeshPart& meshPart : meshParts)
+		{
+			for (const math::Vertex& vertex : meshPart.vertices)
+			{
+				bounds = bounds.merge(math::Aabb::fromPoint(vertex.position));
+			}
+		}
+
+		return bounds;
+	}
+
 	
 }
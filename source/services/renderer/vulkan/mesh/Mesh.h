@@ -5,8 +5,10 @@
 #include <vector>
 #include <filesystem>
 
+#include "engine/utils/math/Bounds.h"
 #include "engine/utils/math/Math.h"
 #include "services/renderer/Material.h"
+#include "services/threading/CancellationToken.h"
 
 namespace parus
 {
@@ -35,8 +37,17 @@ namespace parus
         std::vector<MeshPart> meshParts;
         /** Path to the source asset file. Empty when the mesh has no backing file (e.g. procedural geometry). */
         std::optional<std::string> sourcePath;
+        /** Local-space bounds of every part's vertices, filled in by whoever builds the parts. */
+        math::Aabb bounds;
     };
 
-    Mesh importMeshFromFile(const std::string& filePath);
+    /** Bounds of the vertices of every part; empty if there are none. */
+    [[nodiscard]] math::Aabb computeMeshBounds(const std::vector<MeshPart>& meshParts);
+
+    /**
+     * Loads an OBJ file with its materials. The token is checked between the loading phases;
+     * returns nullopt once it is cancelled, dropping everything built so far.
+     */
+    std::optional<Mesh> importMeshFromFile(const std::string& filePath, const CancellationToken& token = {});
     
 }
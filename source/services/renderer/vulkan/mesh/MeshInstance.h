@@ -12,8 +12,22 @@ namespace parus
     struct MeshInstance
     {
         std::shared_ptr<Mesh> mesh;
+        /** What the shadow pass draws instead: a coarser LOD level, or mesh without an LodComponent. */
+        std::shared_ptr<Mesh> shadowMesh;
         math::Matrix4x4 transform = math::Matrix4x4::identity();
         std::vector<VkDescriptorSet> instanceDescriptorSets;
     };
+
+    /**
+     * Every instance of one mesh, drawn with a single instanced draw per mesh part. Prefab instances
+     * share their mesh, so thousands of them cost one batch.
+     */
+    struct MeshBatch
+    {
+        std::shared_ptr<Mesh> mesh;
+        /** Index of one of the batch's instances; its descriptor sets are bound for the whole batch. */
+        uint32_t representativeInstance = 0;
+        uint32_t instanceCount = 0;
+    };
         
 }
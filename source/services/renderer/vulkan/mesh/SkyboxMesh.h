@@ -51,6 +51,7 @@ public:
         Mesh mesh{};
         mesh.meshType = MeshType::SKY;
         mesh.meshParts.push_back(std::move(part));
+        mesh.bounds = { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
 
         return mesh;
     }
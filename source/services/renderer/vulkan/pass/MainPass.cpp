@@ -247,14 +247,15 @@ namespace parus::vulkan
 			1,
 			&scene.directionalLight.descriptorSets[frame.currentFrame], 0, nullptr);
 
-		for (const auto& meshInstance : scene.meshInstances)
+		for (const auto& meshBatch : scene.meshBatches)
 		{
-			if (meshInstance.mesh->meshType != MeshType::GEOMETRY)
+			if (meshBatch.mesh->meshType != MeshType::GEOMETRY)
 			{
 				continue;
 			}
 
-			// Bind the instance descriptor set.
+			// Bind the instance descriptor set; every instance's sets are alike.
+			const MeshInstance& meshInstance = scene.meshInstances[meshBatch.representativeInstance];
 			vkCmdBindDescriptorSets(
 				frame.commandBuffer,
 				VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -263,7 +264,7 @@ namespace parus::vulkan
 				1,
 				&meshInstance.instanceDescriptorSets[frame.currentFrame], 0, nullptr);
 
-			for (const auto& meshPart : meshInstance.mesh->meshParts)
+			for (const auto& meshPart : meshBatch.mesh->meshParts)
 			{
 				const auto* vulkanMaterial = dynamic_cast<const vulkan::VulkanMaterial*>(meshPart.material.get());
 				ASSERT(vulkanMaterial, "Expected vulkan::Material in Vulkan render pass.");
@@ -277,10 +278,10 @@ namespace parus::vulkan
 					1,
 					&vulkanMaterial->materialDescriptorSet, 0, nullptr);
 
-				// Draw mesh part.
+				// Draw mesh part, once per instance in the batch.
 				vkCmdDrawIndexed(frame.commandBuffer,
 					 static_cast<uint32_t>(meshPart.indexCount),
-					 1,
+					 meshBatch.instanceCount,
 					 static_cast<uint32_t>(meshPart.indexOffset),
 					 static_cast<int32_t>(meshPart.vertexOffset),
 					 0);
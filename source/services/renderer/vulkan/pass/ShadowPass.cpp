@@ -214,14 +214,15 @@ namespace parus::vulkan
 			1,
 			&storage.globalDescriptorSets[frame.currentFrame], 0, nullptr);
 
-		for (const auto& meshInstance : scene.meshInstances)
+		for (const MeshBatch& meshBatch : scene.shadowMeshBatches)
 		{
-			if (meshInstance.mesh->meshType != MeshType::GEOMETRY)
+			if (meshBatch.mesh->meshType != MeshType::GEOMETRY)
 			{
 				continue;
 			}
 
-			// Bind instance descriptor
+			// Bind instance descriptor; every instance's sets are alike.
+			const MeshInstance& meshInstance = scene.meshInstances[meshBatch.representativeInstance];
 			vkCmdBindDescriptorSets(
 				frame.commandBuffer,
 				VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -230,11 +231,11 @@ namespace parus::vulkan
 				1,
 				&meshInstance.instanceDescriptorSets[frame.currentFrame], 0, nullptr);
 
-			for (const auto& meshPart : meshInstance.mesh->meshParts)
+			for (const auto& meshPart : meshBatch.mesh->meshParts)
 			{
 				vkCmdDrawIndexed(frame.commandBuffer,
 					static_cast<uint32_t>(meshPart.indexCount),
-					1,
+					meshBatch.instanceCount,
 					static_cast<uint32_t>(meshPart.indexOffset),
 					static_cast<int32_t>(meshPart.vertexOffset),
 					0);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -23,9 +24,13 @@ namespace parus::vulkan
 
 	struct SceneData
 	{
-		const std::vector<MeshInstance>& meshInstances;
+		std::span<const MeshInstance> meshInstances;
+		/** meshInstances grouped by mesh; passes draw these instead of one instance at a time. */
+		std::span<const MeshBatch> meshBatches;
+		/** meshInstances grouped by shadow mesh, for the shadow pass. */
+		std::span<const MeshBatch> shadowMeshBatches;
 		const VulkanDirectionalLight& directionalLight;
-		const std::vector<VulkanPointLight>& pointLights;
+		std::span<const VulkanPointLight> pointLights;
 	};
 
 	class VulkanRenderPass
@@ -3,6 +3,7 @@
 #include <istream>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 #include "engine/utils/math/Math.h"
 
@@ -34,7 +35,7 @@ namespace parus::serialization
         stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
     }
 
-    inline void writeString(std::ostream& stream, const std::string& value)
+    inline void writeString(std::ostream& stream, const std::string_view value)
     {
         writeUInt32(stream, static_cast<uint32_t>(value.size()));
         stream.write(value.data(), static_cast<std::streamsize>(value.size()));
@@ -7,6 +7,8 @@ namespace parus::serialization
 {
 
     inline constexpr uint32_t FORMAT_VERSION = 3;
+    /** .pworld is versioned on its own: version 4 added prefabs, .pmesh and .ptex stayed at FORMAT_VERSION. */
+    inline constexpr uint32_t WORLD_FORMAT_VERSION = 4;
     inline constexpr std::array<char, 4> MAGIC_PWORLD = { 'P', 'W', 'L', 'D' };
     inline constexpr std::array<char, 4> MAGIC_PMESH  = { 'P', 'M', 'S', 'H' };
     inline constexpr std::array<char, 4> MAGIC_PTEX   = { 'P', 'T', 'E', 'X' };
@@ -1,7 +1,9 @@
 #include "MeshFormat.h"
 
+#include <array>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 
 #include "BinaryStream.h"
 #include "FormatHeader.h"
@@ -12,11 +14,34 @@
 #include "services/renderer/vulkan/texture/VulkanTexture2d.h"
 #include "services/world/Storage.h"
 #include "services/Services.h"
+#include "services/threading/Parallel.h"
+#include "services/threading/TaskGraph.h"
+#include "services/threading/ThreadPool.h"
 #include "services/world/World.h"
 
 namespace parus::serialization
 {
 
+    // Order in which a mesh part's texture stems are stored in the file.
+    static constexpr std::array<parus::TextureType, 5> MATERIAL_TEXTURE_TYPES = {
+        parus::TextureType::ALBEDO,
+        parus::TextureType::NORMAL,
+        parus::TextureType::METALLIC,
+        parus::TextureType::ROUGHNESS,
+        parus::TextureType::AMBIENT_OCCLUSION
+    };
+
+    /** A mesh part as read from disk, plus the results its task graph nodes fill in. */
+    struct PendingMeshPart
+    {
+        std::array<std::string, MATERIAL_TEXTURE_TYPES.size()> textureStems;
+        std::vector<math::TrivialVertex> trivialVertices;
+        std::vector<uint32_t> indices;
+
+        std::shared_ptr<parus::vulkan::VulkanMaterial> material;
+        std::vector<math::Vertex> vertices;
+    };
+
     static std::string textureStemForType(
         parus::vulkan::VulkanMaterial& material,
         const parus::TextureType textureType)
@@ -120,8 +145,14 @@ namespace parus::serialization
     std::optional<parus::Mesh> readMesh(
         const std::string& stem,
         const std::filesystem::path& meshesDir,
-        const std::filesystem::path& texturesDir)
+        const std::filesystem::path& texturesDir,
+        const CancellationToken& token)
     {
+        if (token.isCancelled())
+        {
+            return std::nullopt;
+        }
+
         const std::filesystem::path meshPath = meshesDir / (stem + ".pmesh");
 
         std::ifstream file(meshPath, std::ios::binary);
@@ -152,101 +183,177 @@ namespace parus::serialization
         const auto meshType = static_cast<MeshType>(readUInt8(file));
         const uint32_t partCount = readUInt32(file);
 
-        const auto storage = Services::get<parus::World>()->getStorage();
-
-        // Load a texture by stem — checks Storage cache first, then reads from .ptex, falls back to default on failure.
-        auto loadTextureForMaterial = [&](
-            const std::string& textureStem,
-            const parus::TextureType textureType,
-            parus::vulkan::VulkanMaterial& material)
+        // Parse the whole file first; decoding runs as a task graph once all I/O is done.
+        std::vector<PendingMeshPart> parts(partCount);
+        for (PendingMeshPart& part : parts)
         {
-            if (textureStem.empty())
+            readString(file); // Material name, reserved.
+            for (std::string& textureStem : part.textureStems)
             {
-                return;
+                textureStem = readString(file);
             }
 
-            if (storage->hasTexture(textureStem))
-            {
-                const auto cached = std::dynamic_pointer_cast<parus::vulkan::VulkanTexture2d>(
-                    storage->getTexture(textureStem));
-                if (cached)
-                {
-                    material.addOrUpdateTexture(textureType, cached);
-                }
+            const uint32_t vertexCount = readUInt32(file);
+            part.trivialVertices.resize(vertexCount);
+            readBytes(file, part.trivialVertices.data(), vertexCount * sizeof(math::TrivialVertex));
 
-                return;
-            }
+            const uint32_t indexCount = readUInt32(file);
+            part.indices.resize(indexCount);
+            readBytes(file, part.indices.data(), indexCount * sizeof(uint32_t));
 
-            const auto loaded = readTexture(textureStem, texturesDir);
-            if (loaded)
+            if (!file.good())
             {
-                storage->addNewTexture(textureStem, loaded);
-                material.addOrUpdateTexture(textureType, loaded);
-
-                return;
+                break;
             }
+        }
+
+        if (!file.good())
+        {
+            LOG_WARNING("File read error in mesh: " + meshPath.string());
+
+            return std::nullopt;
+        }
+
+        if (token.isCancelled())
+        {
+            return std::nullopt;
+        }
+
+        const auto storage = Services::get<parus::World>()->getStorage();
 
-            LOG_WARNING("Texture not found, using default: " + textureStem);
-            const auto defaultTexture = std::dynamic_pointer_cast<parus::vulkan::VulkanTexture2d>(
-                storage->getDefaultTextureOfType(textureType));
-            if (defaultTexture)
+        // Every texture referenced by the mesh is decoded once, even if several parts share it.
+        // The map is fully populated up front so nodes only ever write to their own value.
+        std::unordered_map<std::string, std::shared_ptr<parus::vulkan::VulkanTexture2d>> textures;
+        for (const PendingMeshPart& part : parts)
+        {
+            for (const std::string& textureStem : part.textureStems)
             {
-                material.addOrUpdateTexture(textureType, defaultTexture);
+                if (!textureStem.empty())
+                {
+                    textures.try_emplace(textureStem);
+                }
             }
-        };
+        }
 
-        parus::Mesh mesh{};
-        mesh.meshType   = meshType;
-        mesh.sourcePath = stem;
+        ThreadPool& pool = *Services::get<ThreadPool>();
+        TaskGraph graph;
+        std::unordered_map<std::string, TaskGraph::NodeId> textureNodes;
 
-        for (uint32_t partIndex = 0; partIndex < partCount; ++partIndex)
+        // Decode textures: Storage cache first, then the .ptex file.
+        for (auto& entry : textures)
         {
-            const std::string materialName  = readString(file);
-            const std::string albedoStem    = readString(file);
-            const std::string normalStem    = readString(file);
-            const std::string metallicStem  = readString(file);
-            const std::string roughnessStem = readString(file);
-            const std::string aoStem        = readString(file);
-
-            auto material = std::make_shared<parus::vulkan::VulkanMaterial>();
+            const std::string& textureStem = entry.first;
+            auto& texture = entry.second;
+            textureNodes[textureStem] = graph.add([&storage, &texturesDir, &token, &textureStem, &texture]
+            {
+                if (token.isCancelled())
+                {
+                    return;
+                }
 
-            loadTextureForMaterial(albedoStem,    parus::TextureType::ALBEDO,            *material);
-            loadTextureForMaterial(normalStem,    parus::TextureType::NORMAL,            *material);
-            loadTextureForMaterial(metallicStem,  parus::TextureType::METALLIC,          *material);
-            loadTextureForMaterial(roughnessStem, parus::TextureType::ROUGHNESS,         *material);
-            loadTextureForMaterial(aoStem,        parus::TextureType::AMBIENT_OCCLUSION, *material);
+                if (storage->hasTexture(textureStem))
+                {
+                    texture = std::dynamic_pointer_cast<parus::vulkan::VulkanTexture2d>(storage->getTexture(textureStem));
+                    return;
+                }
 
-            const uint32_t vertexCount = readUInt32(file);
-            std::vector<math::Vertex> vertices;
-            vertices.reserve(vertexCount);
+                texture = readTexture(textureStem, texturesDir, token);
+                if (texture)
+                {
+                    storage->addNewTexture(textureStem, texture);
+                }
+            });
+        }
 
-            for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+        std::vector<TaskGraph::NodeId> partNodes;
+        for (PendingMeshPart& part : parts)
+        {
+            // Build the material once its textures are decoded, falling back to defaults for missing ones.
+            std::vector<TaskGraph::NodeId> materialDependencies;
+            for (const std::string& textureStem : part.textureStems)
             {
-                math::TrivialVertex trivialVertex{};
-                readBytes(file, &trivialVertex, sizeof(trivialVertex));
-                vertices.push_back(math::Vertex::fromTrivial(trivialVertex));
+                if (!textureStem.empty())
+                {
+                    materialDependencies.push_back(textureNodes.at(textureStem));
+                }
             }
 
-            const uint32_t indexCount = readUInt32(file);
-            std::vector<uint32_t> indices;
-            indices.reserve(indexCount);
+            partNodes.push_back(graph.add([&storage, &textures, &token, &part]
+            {
+                if (token.isCancelled())
+                {
+                    return;
+                }
 
-            for (uint32_t indexEntry = 0; indexEntry < indexCount; ++indexEntry)
+                part.material = std::make_shared<parus::vulkan::VulkanMaterial>();
+
+                for (size_t slot = 0; slot < MATERIAL_TEXTURE_TYPES.size(); ++slot)
+                {
+                    const std::string& textureStem = part.textureStems[slot];
+                    const parus::TextureType textureType = MATERIAL_TEXTURE_TYPES[slot];
+                    if (textureStem.empty())
+                    {
+                        continue;
+                    }
+
+                    if (const auto& texture = textures.at(textureStem))
+                    {
+                        part.material->addOrUpdateTexture(textureType, texture);
+                        continue;
+                    }
+
+                    LOG_WARNING("Texture not found, using default: " + textureStem);
+                    const auto defaultTexture = std::dynamic_pointer_cast<parus::vulkan::VulkanTexture2d>(
+                        storage->getDefaultTextureOfType(textureType));
+                    if (defaultTexture)
+                    {
+                        part.material->addOrUpdateTexture(textureType, defaultTexture);
+                    }
+                }
+            }, materialDependencies));
+
+            // Vertex conversion does not depend on textures and runs alongside them.
+            partNodes.push_back(graph.add([&pool, &token, &part]
             {
-                indices.push_back(readUInt32(file));
-            }
+                if (token.isCancelled())
+                {
+                    return;
+                }
 
-            MeshPart part{};
-            part.material = std::move(material);
-            part.vertices = std::move(vertices);
-            part.indices  = std::move(indices);
-            mesh.meshParts.push_back(std::move(part));
+                part.vertices.resize(part.trivialVertices.size());
+                parallelTransform(pool, part.trivialVertices.begin(), part.trivialVertices.end(), part.vertices.begin(),
+                    [](const math::TrivialVertex& trivialVertex)
+                    {
+                        return math::Vertex::fromTrivial(trivialVertex);
+                    });
+                part.trivialVertices = {};
+            }));
         }
 
-        if (!file.good())
+        parus::Mesh mesh{};
+        mesh.meshType   = meshType;
+        mesh.sourcePath = stem;
+
+        graph.add([&parts, &mesh]
         {
-            LOG_WARNING("File read error in mesh: " + meshPath.string());
+            mesh.meshParts.reserve(parts.size());
+            for (PendingMeshPart& partData : parts)
+            {
+                MeshPart part{};
+                part.material = std::move(partData.material);
+                part.vertices = std::move(partData.vertices);
+                part.indices  = std::move(partData.indices);
+                mesh.meshParts.push_back(std::move(part));
+            }
+            mesh.bounds = computeMeshBounds(mesh.meshParts);
+        }, partNodes);
 
+        // Rethrows if any node failed; waiting from a worker keeps it executing graph nodes.
+        graph.run(pool).get();
+
+        // Whatever the graph built before the cancellation is released with `mesh` here.
+        if (token.isCancelled())
+        {
             return std::nullopt;
         }
 
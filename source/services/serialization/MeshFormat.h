@@ -4,6 +4,7 @@
 #include <string>
 
 #include "services/renderer/vulkan/mesh/Mesh.h"
+#include "services/threading/CancellationToken.h"
 
 namespace parus::serialization
 {
@@ -16,10 +17,18 @@ namespace parus::serialization
         const parus::Mesh& mesh,
         const std::filesystem::path& outputDir);
 
-    /** Reads a .pmesh file and lazily loads its textures from .ptex files. Returns nullopt on failure. */
+    /**
+     * Reads a .pmesh file and lazily loads its textures from .ptex files. Returns nullopt on failure.
+     * Texture decoding, material setup and vertex conversion run as a task graph on the ThreadPool;
+     * the call returns once the mesh is assembled.
+     *
+     * Once the token is cancelled, nodes that have not started yet do nothing and the call returns
+     * nullopt; textures already added to Storage stay there until the scene is cleared.
+     */
     std::optional<parus::Mesh> readMesh(
         const std::string& stem,
         const std::filesystem::path& meshesDir,
-        const std::filesystem::path& texturesDir);
+        const std::filesystem::path& texturesDir,
+        const CancellationToken& token = {});
 
 }
@@ -21,10 +21,25 @@ namespace parus::serialization
         float intensity = 1.0f;
     };
 
-    /** One row of the entity table: every entity's core fields, plus whichever optional components it has. */
+    /** One row of the prefab table: what every instance of the prefab starts with. */
+    struct PrefabEntry
+    {
+        std::string name;
+        parus::Mobility mobility = parus::Mobility::Static;
+
+        std::optional<EntityMeshEntry> meshComponent;
+        std::optional<EntityPointLightEntry> pointLightComponent;
+    };
+
+    /**
+     * One row of the entity table: every entity's core fields, plus whichever optional components it
+     * has. Components an instance inherits from its prefab are filled in from the prefab row on read.
+     */
     struct EntityEntry
     {
         std::string name;
+        /** Indexes SceneData::prefabs; nullopt if the entity is not a prefab instance. */
+        std::optional<uint32_t> prefabIndex;
         parus::Mobility mobility = parus::Mobility::Static;
         parus::math::Transform transform;
 
@@ -57,6 +72,7 @@ namespace parus::serialization
 
         /** Ordered list of mesh stems; EntityMeshEntry.meshIndex indexes this. */
         std::vector<std::string> meshStems;
+        std::vector<PrefabEntry> prefabs;
         std::vector<EntityEntry> entities;
     };
 
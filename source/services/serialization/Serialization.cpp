@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <ranges>
 
 #include "MeshFormat.h"
 #include "SceneData.h"
@@ -14,6 +15,8 @@
 #include "services/console/Console.h"
 #include "services/platform/Platform.h"
 #include "services/renderer/vulkan/VulkanRenderer.h"
+#include "services/threading/MainThreadQueue.h"
+#include "services/threading/TaskGroup.h"
 #include "services/threading/ThreadPool.h"
 #include "services/world/World.h"
 #include "services/world/entity/Components.h"
@@ -26,6 +29,21 @@ namespace parus
     static constexpr const char* MESHES_DIR   = "bin/assets/meshes";
     static constexpr const char* TEXTURES_DIR = "bin/assets/textures";
 
+    /** An `open` in flight: the parsed scene file plus the mesh loads it waits for. */
+    struct Serialization::SceneLoad
+    {
+        SceneLoad(ThreadPool& pool, const CancellationToken& token, std::string sceneName, serialization::SceneData sceneData)
+            : sceneName(std::move(sceneName))
+            , sceneData(std::move(sceneData))
+            , meshLoads(pool, token)
+        {
+        }
+
+        std::string sceneName;
+        serialization::SceneData sceneData;
+        TaskGroup meshLoads;
+    };
+
     static void updateWindowTitle(const std::string& sceneName)
     {
         const std::string baseTitle = Services::get<Configs>()->getOrDefault<std::string>("Window", "title", "");
@@ -38,6 +56,15 @@ namespace parus
         Services::get<Platform>()->setWindowTitle(title);
     }
 
+    Serialization::Serialization() = default;
+
+    Serialization::~Serialization()
+    {
+        // Stop a load still in flight instead of finishing it for nobody, but let a save finish its files.
+        sceneCancellation.cancel();
+        currentSave.wait();
+    }
+
     void Serialization::registerConsoleCommands()
     {
         const auto console = Services::get<Console>();
@@ -109,7 +136,15 @@ namespace parus
             auto* vulkanRenderer = dynamic_cast<parus::vulkan::VulkanRenderer*>(renderer.get());
             ASSERT(vulkanRenderer, "VulkanRenderer type is expected.");
 
-            RUN_ASYNC(vulkanRenderer->importMesh(filePath););
+            // Imports can take seconds; keep them out of the way of per-frame work. The import belongs
+            // to the current scene, so opening another one cancels it and waits for it to stop.
+            const auto serialization = Services::get<Serialization>();
+            const CancellationToken token = serialization->sceneCancellation.getToken();
+            const ScopedTaskPriority priority(TaskPriority::BACKGROUND);
+            serialization->getSceneImports().run([vulkanRenderer, filePath, token]
+            {
+                vulkanRenderer->importMesh(filePath, MeshType::GEOMETRY, token);
+            });
 
             out.write("Importing: " + filePath);
         });
@@ -117,6 +152,15 @@ namespace parus
 
     std::string Serialization::saveCurrentWorld(const std::string& sceneName)
     {
+        if (currentLoad)
+        {
+            return "Cannot save while a scene is loading: " + currentLoad->sceneName;
+        }
+        if (currentSave.isValid() && !currentSave.isReady())
+        {
+            return "Cannot save while another save is running.";
+        }
+
         const std::filesystem::path scenesDir   = SCENES_DIR;
         const std::filesystem::path meshesDir   = MESHES_DIR;
         const std::filesystem::path texturesDir = TEXTURES_DIR;
@@ -129,50 +173,73 @@ namespace parus
         const auto storage = world->getStorage();
         const auto pool    = Services::get<ThreadPool>();
 
-        for (const auto& mesh : storage->getAllMeshes())
-        {
-            if (!mesh)
-            {
-                continue;
-            }
+        // Everything the save reads is captured here, the entities as a copy-on-write snapshot, so
+        // the files are written in the background while the world keeps ticking.
+        EntitySnapshot entities = world->getEntityManager()->snapshot();
+        const SpectatorCamera camera = world->getMainCamera();
+        std::vector<std::shared_ptr<Mesh>> meshes = storage->getAllMeshes();
+        std::vector<std::shared_ptr<Texture>> textures = storage->getAllTextures();
 
-            RUN_ASYNC(serialization::writeMesh(*mesh, meshesDir););
-        }
+        const uint32_t meshCount = static_cast<uint32_t>(
+            std::count_if(meshes.begin(), meshes.end(), [](const auto& mesh)
+            {
+                return mesh && mesh->sourcePath.has_value();
+            }));
+        const uint32_t textureCount  = static_cast<uint32_t>(textures.size());
+        const uint32_t instanceCount = static_cast<uint32_t>(entities.view<MeshComponent>().size());
+        const std::string result = "Scene saved: " + sceneName
+            + "\n\tMeshes:    " + std::to_string(meshCount)
+            + "\n\tTextures:  " + std::to_string(textureCount)
+            + "\n\tInstances: " + std::to_string(instanceCount);
 
-        for (const auto& texture : storage->getAllTextures())
+        currentSave = pool->enqueue(TaskPriority::BACKGROUND,
+            [pool, sceneName, scenesDir, meshesDir, texturesDir, result,
+             entities = std::move(entities), camera, meshes = std::move(meshes), textures = std::move(textures)]
         {
-            if (!texture || !texture->sourcePath.has_value())
             {
-                continue;
-            }
+                // Wait only for our own exports; unrelated background work (e.g. `import`) keeps running.
+                TaskGroup exports(*pool);
 
-            RUN_ASYNC(serialization::writeTexture(*texture, texturesDir););
-        }
+                for (const auto& mesh : meshes)
+                {
+                    if (!mesh)
+                    {
+                        continue;
+                    }
 
-        pool->waitUntilDone();
+                    exports.run([mesh, meshesDir]
+                    {
+                        serialization::writeMesh(*mesh, meshesDir);
+                    });
+                }
 
-        const std::filesystem::path outputPath = scenesDir / (sceneName + ".pworld");
-        serialization::writeWorld(*world, sceneName, outputPath);
+                for (const auto& texture : textures)
+                {
+                    if (!texture || !texture->sourcePath.has_value())
+                    {
+                        continue;
+                    }
 
-        const auto allMeshes = storage->getAllMeshes();
-        const uint32_t meshCount = static_cast<uint32_t>(
-            std::count_if(allMeshes.begin(), allMeshes.end(), [](const auto& mesh)
-            {
-                return mesh && mesh->sourcePath.has_value();
-            }));
-        const uint32_t textureCount  = static_cast<uint32_t>(storage->getAllTextures().size());
-        const uint32_t instanceCount = static_cast<uint32_t>(world->getEntityManager()->getMeshEntities().size());
+                    exports.run([texture, texturesDir]
+                    {
+                        serialization::writeTexture(*texture, texturesDir);
+                    });
+                }
 
-        world->setCurrentSceneName(sceneName);
-        updateWindowTitle(sceneName);
+                exports.wait();
+            }
 
-        const std::string result = "Scene saved: " + sceneName
-            + "\n\tMeshes:    " + std::to_string(meshCount)
-            + "\n\tTextures:  " + std::to_string(textureCount)
-            + "\n\tInstances: " + std::to_string(instanceCount);
-        LOG_INFO(result);
+            serialization::writeWorld(entities, camera, sceneName, scenesDir / (sceneName + ".pworld"));
+            LOG_INFO(result);
+
+            Services::get<MainThreadQueue>()->post([sceneName]
+            {
+                Services::get<World>()->setCurrentSceneName(sceneName);
+                updateWindowTitle(sceneName);
+            });
+        });
 
-        return result;
+        return "Saving scene: " + sceneName;
     }
 
     std::string Serialization::importWorld(const std::string& sceneName)
@@ -194,32 +261,116 @@ namespace parus
         auto* vulkanRenderer = dynamic_cast<parus::vulkan::VulkanRenderer*>(renderer.get());
         ASSERT(vulkanRenderer, "VulkanRenderer type is expected.");
 
+        // Supersede the previous load and any import meant for the old scene. Their queued tasks are
+        // dropped and running ones return at their next check, so these waits are short; they have
+        // to finish before the assets they may have added to Storage are cleared below.
+        sceneCancellation.cancel();
+        if (currentLoad)
+        {
+            LOG_INFO("Scene load cancelled: " + currentLoad->sceneName);
+            currentLoad->meshLoads.wait();
+            currentLoad.reset();
+        }
+        if (sceneImports)
+        {
+            sceneImports->wait();
+            sceneImports.reset();
+        }
+        sceneCancellation = CancellationSource();
+        const CancellationToken token = sceneCancellation.getToken();
+
+        // A save in flight still exports the old scene's meshes and textures.
+        currentSave.wait();
+
         world->getEntityManager()->clearSceneEntities();
         vulkanRenderer->deviceWaitIdle();
         vulkanRenderer->cleanupSceneTextures();
         storage->clearSceneAssets();
 
-        for (const std::string& meshStem : sceneData->meshStems)
+        currentLoad = std::make_unique<SceneLoad>(*pool, token, sceneName, std::move(*sceneData));
+
+        for (const std::string& meshStem : currentLoad->sceneData.meshStems)
         {
-            RUN_ASYNC(
-                std::optional<Mesh> loadedMesh = serialization::readMesh(meshStem, MESHES_DIR, TEXTURES_DIR);
+            currentLoad->meshLoads.run([storage, meshStem, token]
+            {
+                std::optional<Mesh> loadedMesh = serialization::readMesh(meshStem, MESHES_DIR, TEXTURES_DIR, token);
                 if (loadedMesh)
                 {
                     storage->addNewMesh(meshStem, std::make_shared<Mesh>(std::move(*loadedMesh)));
                 }
-            );
+            });
+        }
+
+        watchSceneLoad(token);
+
+        return "Loading scene: " + sceneName + " (" + std::to_string(currentLoad->sceneData.meshStems.size()) + " meshes)";
+    }
+
+    TaskGroup& Serialization::getSceneImports()
+    {
+        if (!sceneImports)
+        {
+            sceneImports = std::make_unique<TaskGroup>(*Services::get<ThreadPool>(), sceneCancellation.getToken());
         }
+        return *sceneImports;
+    }
+
+    void Serialization::watchSceneLoad(const CancellationToken& token)
+    {
+        Services::get<MainThreadQueue>()->post([this, token]
+        {
+            // A newer importWorld() has taken over; it already waited for this load.
+            if (token.isCancelled())
+            {
+                return;
+            }
 
-        pool->waitUntilDone();
+            if (!currentLoad->meshLoads.isDone())
+            {
+                watchSceneLoad(token);
+                return;
+            }
+
+            finishSceneLoad();
+        });
+    }
+
+    void Serialization::finishSceneLoad()
+    {
+        const std::unique_ptr<SceneLoad> load = std::move(currentLoad);
+        const std::string& sceneName = load->sceneName;
+        const serialization::SceneData& sceneData = load->sceneData;
 
-        world->setCameraTransform(sceneData->cameraPosition, sceneData->cameraYaw, sceneData->cameraPitch);
+        const auto world   = Services::get<World>();
+        const auto storage = world->getStorage();
+
+        const auto renderer  = Services::get<Renderer>();
+        auto* vulkanRenderer = dynamic_cast<parus::vulkan::VulkanRenderer*>(renderer.get());
+        ASSERT(vulkanRenderer, "VulkanRenderer type is expected.");
+
+        world->setCameraTransform(sceneData.cameraPosition, sceneData.cameraYaw, sceneData.cameraPitch);
 
         const auto entityManager = world->getEntityManager();
 
+        // Sized up front (scene entities plus sun and sky) so the spawns below never rehash or regrow storage.
+        size_t meshEntryCount = 0;
+        size_t pointLightEntryCount = 0;
+        size_t prefabEntryCount = 0;
+        for (const serialization::EntityEntry& entry : sceneData.entities)
+        {
+            meshEntryCount += entry.meshComponent.has_value() ? 1 : 0;
+            pointLightEntryCount += entry.pointLightComponent.has_value() ? 1 : 0;
+            prefabEntryCount += entry.prefabIndex.has_value() ? 1 : 0;
+        }
+        entityManager->reserve(entityManager->view<>().size() + sceneData.entities.size() + 2);
+        entityManager->reserveComponents<MeshComponent>(meshEntryCount);
+        entityManager->reserveComponents<PointLightComponent>(pointLightEntryCount);
+        entityManager->reserveComponents<PrefabComponent>(prefabEntryCount);
+
         const EntityId sunId = entityManager->spawn("Sun");
         entityManager->addDirectionalLightComponent(sunId, DirectionalLightComponent{
-            .color     = sceneData->directionalLight.color,
-            .direction = sceneData->directionalLight.direction
+            .color     = sceneData.directionalLight.color,
+            .direction = sceneData.directionalLight.direction
         });
 
         // The built-in sky mesh has no sourcePath, so its stem is always empty; it survives
@@ -231,46 +382,87 @@ namespace parus
             const EntityId skyId = entityManager->spawn("Skybox");
             entityManager->addSkyboxComponent(skyId, SkyboxComponent{
                 .mesh         = skyMeshes.front(),
-                .horizonColor = sceneData->skybox.horizonColor,
-                .zenithColor  = sceneData->skybox.zenithColor
+                .horizonColor = sceneData.skybox.horizonColor,
+                .zenithColor  = sceneData.skybox.zenithColor
             });
         }
 
-        for (const serialization::EntityEntry& entry : sceneData->entities)
+        // Resolved once per mesh stem rather than per entity, so scenes of repeated meshes look each up once.
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        meshes.reserve(sceneData.meshStems.size());
+        for (const std::string& meshStem : sceneData.meshStems)
+        {
+            meshes.push_back(storage->getMeshByPath(meshStem));
+        }
+
+        const auto toMeshComponent = [&sceneData, &meshes](const serialization::EntityMeshEntry& meshEntry) -> std::optional<MeshComponent>
+        {
+            if (meshEntry.meshIndex >= meshes.size())
+            {
+                LOG_WARNING("Skipping mesh component with out-of-range mesh index: " + std::to_string(meshEntry.meshIndex));
+                return std::nullopt;
+            }
+            if (!meshes[meshEntry.meshIndex])
+            {
+                // The load itself was logged by the group when it failed.
+                LOG_WARNING("Skipping mesh component - mesh not loaded: " + sceneData.meshStems[meshEntry.meshIndex]);
+                return std::nullopt;
+            }
+
+            return MeshComponent{ meshes[meshEntry.meshIndex] };
+        };
+
+        const auto toPointLightComponent = [](const serialization::EntityPointLightEntry& pointLightEntry)
         {
-            const EntityId entityId = entityManager->spawn(entry.name);
+            return PointLightComponent{
+                .color     = pointLightEntry.color,
+                .radius    = pointLightEntry.radius,
+                .intensity = pointLightEntry.intensity
+            };
+        };
+
+        std::vector<std::shared_ptr<const Prefab>> prefabs;
+        prefabs.reserve(sceneData.prefabs.size());
+        for (const serialization::PrefabEntry& prefabEntry : sceneData.prefabs)
+        {
+            auto prefab = std::make_shared<Prefab>();
+            prefab->name     = prefabEntry.name;
+            prefab->mobility = prefabEntry.mobility;
+            if (prefabEntry.meshComponent)
+            {
+                prefab->mesh = toMeshComponent(*prefabEntry.meshComponent);
+            }
+            if (prefabEntry.pointLightComponent)
+            {
+                prefab->pointLight = toPointLightComponent(*prefabEntry.pointLightComponent);
+            }
+            prefabs.push_back(std::move(prefab));
+        }
+
+        const std::vector<EntityId> entityIds = entityManager->spawnMany(sceneData.entities | std::views::transform(&serialization::EntityEntry::name));
+        for (size_t i = 0; i < sceneData.entities.size(); ++i)
+        {
+            const serialization::EntityEntry& entry = sceneData.entities[i];
+            const EntityId entityId = entityIds[i];
             entityManager->setMobility(entityId, entry.mobility);
             entityManager->setTransform(entityId, entry.transform);
 
             if (entry.meshComponent)
             {
-                if (entry.meshComponent->meshIndex >= sceneData->meshStems.size())
+                if (std::optional<MeshComponent> meshComponent = toMeshComponent(*entry.meshComponent))
                 {
-                    LOG_WARNING("Skipping mesh component with out-of-range mesh index: " + std::to_string(entry.meshComponent->meshIndex));
-                }
-                else
-                {
-                    const std::string& meshStem = sceneData->meshStems[entry.meshComponent->meshIndex];
-                    const std::shared_ptr<Mesh> mesh = storage->getMeshByPath(meshStem);
-
-                    if (mesh)
-                    {
-                        entityManager->addMeshComponent(entityId, MeshComponent{ mesh });
-                    }
-                    else
-                    {
-                        LOG_WARNING("Skipping mesh component - mesh not loaded: " + meshStem);
-                    }
+                    entityManager->addMeshComponent(entityId, std::move(*meshComponent));
                 }
             }
 
             if (entry.pointLightComponent)
             {
-                entityManager->addPointLightComponent(entityId, PointLightComponent{
-                    .color     = entry.pointLightComponent->color,
-                    .radius    = entry.pointLightComponent->radius,
-                    .intensity = entry.pointLightComponent->intensity
-                });
+                entityManager->addPointLightComponent(entityId, toPointLightComponent(*entry.pointLightComponent));
+            }
+
+            if (entry.prefabIndex)
+            {
+                entityManager->addPrefabComponent(entityId, PrefabComponent{ prefabs[*entry.prefabIndex] });
             }
         }
 
@@ -279,22 +471,20 @@ namespace parus
         world->setCurrentSceneName(sceneName);
         updateWindowTitle(sceneName);
 
-        const uint32_t loadedMeshCount     = static_cast<uint32_t>(sceneData->meshStems.size());
-        const uint32_t loadedInstanceCount = static_cast<uint32_t>(entityManager->getMeshEntities().size());
-        const uint32_t pointLightCount     = static_cast<uint32_t>(entityManager->getPointLightEntities().size());
+        const uint32_t loadedMeshCount     = static_cast<uint32_t>(sceneData.meshStems.size());
+        const uint32_t loadedInstanceCount = static_cast<uint32_t>(entityManager->view<MeshComponent>().size());
+        const uint32_t pointLightCount     = static_cast<uint32_t>(entityManager->view<PointLightComponent>().size());
 
-        const math::Vector3& camPos = sceneData->cameraPosition;
+        const math::Vector3& camPos = sceneData.cameraPosition;
 
         const std::string result = "Scene loaded: " + sceneName
             + "\n\tMeshes:       " + std::to_string(loadedMeshCount)
             + "\n\tInstances:    " + std::to_string(loadedInstanceCount)
             + "\n\tPoint lights: " + std::to_string(pointLightCount)
             + "\n\tCamera pos:   " + std::to_string(camPos.x) + ", " + std::to_string(camPos.y) + ", " + std::to_string(camPos.z)
-            + "\n\tCamera yaw:   " + std::to_string(sceneData->cameraYaw)
-            + "\n\tCamera pitch: " + std::to_string(sceneData->cameraPitch);
+            + "\n\tCamera yaw:   " + std::to_string(sceneData.cameraYaw)
+            + "\n\tCamera pitch: " + std::to_string(sceneData.cameraPitch);
         LOG_INFO(result);
-
-        return result;
     }
 
 }
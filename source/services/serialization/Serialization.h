@@ -1,22 +1,54 @@
 #pragma once
+#include <memory>
 #include <string>
 
 #include "services/Service.h"
+#include "services/threading/CancellationToken.h"
+#include "services/threading/TaskHandle.h"
 
 namespace parus
 {
+    class TaskGroup;
 
     class Serialization final : public Service
     {
     public:
+        Serialization();
+        ~Serialization();
+
         /** Registers the save and open console commands. */
         void registerConsoleCommands();
 
-        /** Saves all current world meshes, textures, and scene state to binary format. */
+        /**
+         * Saves all current world meshes, textures, and scene state to binary format. Snapshots the
+         * world and returns right away; the files are written on the ThreadPool and the result is
+         * logged when they are done.
+         */
         std::string saveCurrentWorld(const std::string& sceneName);
 
-        /** Loads a previously saved scene by name, replacing the current world state. */
+        /**
+         * Starts loading a previously saved scene by name, replacing the current world state. Meshes
+         * load on the ThreadPool and the scene is spawned on the main thread once they are done.
+         * Opening another scene first cancels this load and every `import` started for the old scene.
+         */
         std::string importWorld(const std::string& sceneName);
+
+    private:
+        struct SceneLoad;
+
+        /** Re-posts itself to the MainThreadQueue every frame until the current load's meshes are done. */
+        void watchSceneLoad(const CancellationToken& token);
+        void finishSceneLoad();
+        /** The group `import` runs in; created on first use for the current scene. */
+        TaskGroup& getSceneImports();
+
+        /** Cancelled (and replaced) by every importWorld(). Main thread only. */
+        CancellationSource sceneCancellation;
+        std::unique_ptr<SceneLoad> currentLoad;
+        /** `import`s started for the current scene; importWorld() waits for them before clearing it. */
+        std::unique_ptr<TaskGroup> sceneImports;
+        /** The last save started; only one runs at a time. */
+        TaskHandle<void> currentSave;
     };
 
-}
\ No newline at end of file
+}
@@ -84,8 +84,14 @@ namespace parus::serialization
 
     std::shared_ptr<parus::vulkan::VulkanTexture2d> readTexture(
         const std::string& stem,
-        const std::filesystem::path& texturesDir)
+        const std::filesystem::path& texturesDir,
+        const CancellationToken& token)
     {
+        if (token.isCancelled())
+        {
+            return nullptr;
+        }
+
         const std::filesystem::path texturePath = texturesDir / (stem + ".ptex");
 
         std::ifstream file(texturePath, std::ios::binary);
@@ -133,6 +139,12 @@ namespace parus::serialization
             return nullptr;
         }
 
+        // The upload is the expensive part; a superseded load skips it and frees the pixels here.
+        if (token.isCancelled())
+        {
+            return nullptr;
+        }
+
         parus::vulkan::VulkanTexture2d gpuTexture = parus::vulkan::VulkanTexture2dBuilder(stem)
             .buildFromPixels(pixels.data(), static_cast<int>(width), static_cast<int>(height), static_cast<int>(channels));
 
@@ -5,6 +5,7 @@
 
 #include "services/renderer/Texture.h"
 #include "services/renderer/vulkan/texture/VulkanTexture2d.h"
+#include "services/threading/CancellationToken.h"
 
 namespace parus::serialization
 {
@@ -18,9 +19,13 @@ namespace parus::serialization
         const parus::Texture& texture,
         const std::filesystem::path& outputDir);
 
-    /** Loads a texture from a .ptex binary file. Returns nullptr on failure. */
+    /**
+     * Loads a texture from a .ptex binary file. Returns nullptr on failure, or when the token is
+     * cancelled before the pixels are uploaded to the GPU.
+     */
     std::shared_ptr<parus::vulkan::VulkanTexture2d> readTexture(
         const std::string& stem,
-        const std::filesystem::path& texturesDir);
+        const std::filesystem::path& texturesDir,
+        const CancellationToken& token = {});
 
 }
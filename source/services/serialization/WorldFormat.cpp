@@ -14,43 +14,107 @@
 
 namespace parus::serialization
 {
+    namespace
+    {
+        /** Marks an entity row without a prefab. */
+        constexpr uint32_t NO_PREFAB = 0xFFFFFFFF;
+
+        /** Oldest .pworld readWorld() accepts. It has no prefab table and no prefab index per row. */
+        constexpr uint32_t OLDEST_WORLD_FORMAT_VERSION = 3;
+        constexpr uint32_t FIRST_PREFAB_WORLD_FORMAT_VERSION = 4;
+
+        /** How an entity row stores one optional component. Version 3's 0/1 flags read as Absent/Stored. */
+        enum class ComponentState : uint8_t
+        {
+            Absent,
+            /** The row carries the component's fields: no prefab, or the instance overrides it. */
+            Stored,
+            /** Same as the prefab's; the reader copies it from the prefab row. */
+            Inherited
+        };
+
+        bool isGeometry(const MeshComponent* meshComponent)
+        {
+            return meshComponent && meshComponent->mesh && meshComponent->mesh->meshType == MeshType::GEOMETRY;
+        }
+
+        void writePointLight(std::ostream& stream, const PointLightComponent& pointLight)
+        {
+            writeVector3(stream, pointLight.color);
+            writeFloat(stream, pointLight.radius);
+            writeFloat(stream, pointLight.intensity);
+        }
+
+        EntityPointLightEntry readPointLight(std::istream& stream)
+        {
+            EntityPointLightEntry pointLightEntry{};
+            pointLightEntry.color     = readVector3(stream);
+            pointLightEntry.radius    = readFloat(stream);
+            pointLightEntry.intensity = readFloat(stream);
+
+            return pointLightEntry;
+        }
+    }
 
     void writeWorld(
         const parus::World& world,
         const std::string& sceneName,
         const std::filesystem::path& outputPath)
     {
-        const auto camera = world.getMainCamera();
-        const auto entityManager = world.getEntityManager();
-        const auto allEntities = entityManager->getAllEntities();
+        writeWorld(world.getEntityManager()->snapshot(), world.getMainCamera(), sceneName, outputPath);
+    }
+
+    void writeWorld(
+        const parus::EntitySnapshot& entities,
+        const parus::SpectatorCamera& camera,
+        const std::string& sceneName,
+        const std::filesystem::path& outputPath)
+    {
+        std::vector<const Entity*> allEntities;
+        entities.view<>().each([&allEntities](const Entity& entity)
+        {
+            allEntities.push_back(&entity);
+        });
 
         // Build deduplicated mesh stem table (GEOMETRY only; sky is written separately below).
         std::vector<std::string> meshStems;
         std::unordered_map<Mesh*, uint32_t> meshIndexMap;
 
-        for (const auto* entity : allEntities)
+        const auto addMeshStem = [&meshStems, &meshIndexMap](const MeshComponent* meshComponent)
         {
-            const auto* meshComponent = entityManager->getMeshComponent(entity->id);
-            if (!meshComponent || !meshComponent->mesh || meshComponent->mesh->meshType != MeshType::GEOMETRY)
+            if (!isGeometry(meshComponent) || meshIndexMap.contains(meshComponent->mesh.get()))
             {
-                continue;
+                return;
             }
 
-            auto* meshPtr = meshComponent->mesh.get();
+            const std::string stem = std::filesystem::path(*meshComponent->mesh->sourcePath).stem().string();
+            meshIndexMap[meshComponent->mesh.get()] = static_cast<uint32_t>(meshStems.size());
+            meshStems.push_back(stem);
+        };
+
+        // Build the prefab table from the prefabs that still have instances, in first-seen order.
+        std::vector<const Prefab*> prefabs;
+        std::unordered_map<const Prefab*, uint32_t> prefabIndexMap;
 
-            if (meshIndexMap.contains(meshPtr))
+        for (const auto* entity : allEntities)
+        {
+            addMeshStem(entities.getMeshComponent(entity->id));
+
+            const auto* prefabComponent = entities.getPrefabComponent(entity->id);
+            if (!prefabComponent || !prefabComponent->prefab || prefabIndexMap.contains(prefabComponent->prefab.get()))
             {
                 continue;
             }
 
-            const std::string stem = std::filesystem::path(*meshComponent->mesh->sourcePath).stem().string();
-            meshIndexMap[meshPtr] = static_cast<uint32_t>(meshStems.size());
-            meshStems.push_back(stem);
+            const Prefab* prefab = prefabComponent->prefab.get();
+            prefabIndexMap[prefab] = static_cast<uint32_t>(prefabs.size());
+            prefabs.push_back(prefab);
+            addMeshStem(prefab->mesh ? &*prefab->mesh : nullptr);
         }
 
         // Determine sky mesh stem from the skybox entity.
         std::string skyMeshStem;
-        if (const auto* skyboxComponent = entityManager->getSkyboxComponent();
+        if (const auto* skyboxComponent = entities.getSkyboxComponent();
             skyboxComponent && skyboxComponent->mesh && skyboxComponent->mesh->sourcePath.has_value())
         {
             skyMeshStem = std::filesystem::path(*skyboxComponent->mesh->sourcePath).stem().string();
@@ -64,14 +128,14 @@ namespace parus::serialization
         writeFloat(payload, camera.getPitch());
 
         // sky_section
-        const auto* skyboxComponent = entityManager->getSkyboxComponent();
+        const auto* skyboxComponent = entities.getSkyboxComponent();
         writeString(payload, skyMeshStem);
         writeVector3(payload, skyboxComponent ? skyboxComponent->horizonColor : math::Vector3());
         writeVector3(payload, skyboxComponent ? skyboxComponent->zenithColor : math::Vector3());
         writeUInt32(payload, 0); // skybox_settings_size: reserved
 
         // directional_light_section
-        const auto* directionalLightComponent = entityManager->getDirectionalLightComponent();
+        const auto* directionalLightComponent = entities.getDirectionalLightComponent();
         writeVector3(payload, directionalLightComponent ? directionalLightComponent->color : math::Vector3());
         writeVector3(payload, directionalLightComponent ? directionalLightComponent->direction : math::Vector3());
 
@@ -82,12 +146,33 @@ namespace parus::serialization
             writeString(payload, stem);
         }
 
+        // prefab_table_section
+        writeUInt32(payload, static_cast<uint32_t>(prefabs.size()));
+        for (const Prefab* prefab : prefabs)
+        {
+            writeString(payload, prefab->name);
+            writeUInt8(payload, static_cast<uint8_t>(prefab->mobility));
+
+            const bool hasMesh = isGeometry(prefab->mesh ? &*prefab->mesh : nullptr);
+            writeUInt8(payload, hasMesh ? 1 : 0);
+            if (hasMesh)
+            {
+                writeUInt32(payload, meshIndexMap.at(prefab->mesh->mesh.get()));
+            }
+
+            writeUInt8(payload, prefab->pointLight ? 1 : 0);
+            if (prefab->pointLight)
+            {
+                writePointLight(payload, *prefab->pointLight);
+            }
+        }
+
         // entity_table_section (excludes the directional-light entity and the skybox entity - those are
         // written directly in their own sections above, not as generic rows)
         std::vector<const Entity*> exportedEntities;
         for (const auto* entity : allEntities)
         {
-            if (entityManager->getDirectionalLightEntity() == entity || entityManager->getSkyboxEntity() == entity)
+            if (entities.getDirectionalLightEntity() == entity || entities.getSkyboxEntity() == entity)
             {
                 continue;
             }
@@ -98,27 +183,39 @@ namespace parus::serialization
         writeUInt32(payload, static_cast<uint32_t>(exportedEntities.size()));
         for (const auto* entity : exportedEntities)
         {
+            const auto* prefabComponent = entities.getPrefabComponent(entity->id);
+            const Prefab* prefab = prefabComponent ? prefabComponent->prefab.get() : nullptr;
+
             writeString(payload, entity->name);
+            writeUInt32(payload, prefab ? prefabIndexMap.at(prefab) : NO_PREFAB);
             writeUInt8(payload, static_cast<uint8_t>(entity->mobility));
             writeVector3(payload, entity->transform.position);
             writeVector3(payload, entity->transform.rotationEuler);
             writeVector3(payload, entity->transform.scale);
 
-            const auto* meshComponent = entityManager->getMeshComponent(entity->id);
-            const bool hasMesh = meshComponent && meshComponent->mesh && meshComponent->mesh->meshType == MeshType::GEOMETRY;
-            writeUInt8(payload, hasMesh ? 1 : 0);
-            if (hasMesh)
+            // An instance's component is only written out when it overrides the prefab's.
+            const auto* meshComponent = entities.getMeshComponent(entity->id);
+            ComponentState meshState = isGeometry(meshComponent) ? ComponentState::Stored : ComponentState::Absent;
+            if (meshState == ComponentState::Stored && prefab && prefab->mesh == *meshComponent)
+            {
+                meshState = ComponentState::Inherited;
+            }
+            writeUInt8(payload, static_cast<uint8_t>(meshState));
+            if (meshState == ComponentState::Stored)
             {
                 writeUInt32(payload, meshIndexMap.at(meshComponent->mesh.get()));
             }
 
-            const auto* pointLightComponent = entityManager->getPointLightComponent(entity->id);
-            writeUInt8(payload, pointLightComponent ? 1 : 0);
-            if (pointLightComponent)
+            const auto* pointLightComponent = entities.getPointLightComponent(entity->id);
+            ComponentState pointLightState = pointLightComponent ? ComponentState::Stored : ComponentState::Absent;
+            if (pointLightComponent && prefab && prefab->pointLight == *pointLightComponent)
+            {
+                pointLightState = ComponentState::Inherited;
+            }
+            writeUInt8(payload, static_cast<uint8_t>(pointLightState));
+            if (pointLightState == ComponentState::Stored)
             {
-                writeVector3(payload, pointLightComponent->color);
-                writeFloat(payload, pointLightComponent->radius);
-                writeFloat(payload, pointLightComponent->intensity);
+                writePointLight(payload, *pointLightComponent);
             }
         }
 
@@ -134,6 +231,7 @@ namespace parus::serialization
 
         FormatHeader header;
         header.magic       = MAGIC_PWORLD;
+        header.version     = WORLD_FORMAT_VERSION;
         header.payloadSize = payloadBytes.size();
 
         writeHeader(file, header);
@@ -173,12 +271,13 @@ namespace parus::serialization
             return std::nullopt;
         }
 
-        if (header.version != FORMAT_VERSION)
+        if (header.version < OLDEST_WORLD_FORMAT_VERSION || header.version > WORLD_FORMAT_VERSION)
         {
             LOG_ERROR("Unsupported version in world file: " + worldPath.string());
 
             return std::nullopt;
         }
+        const bool hasPrefabs = header.version >= FIRST_PREFAB_WORLD_FORMAT_VERSION;
 
         SceneData sceneData{};
 
@@ -206,6 +305,31 @@ namespace parus::serialization
             sceneData.meshStems.push_back(readString(file));
         }
 
+        // prefab_table_section
+        const uint32_t prefabCount = hasPrefabs ? readUInt32(file) : 0;
+        sceneData.prefabs.reserve(prefabCount);
+
+        for (uint32_t prefabIndex = 0; prefabIndex < prefabCount; ++prefabIndex)
+        {
+            PrefabEntry prefabEntry{};
+            prefabEntry.name     = readString(file);
+            prefabEntry.mobility = static_cast<parus::Mobility>(readUInt8(file));
+
+            const bool hasMesh = readUInt8(file) != 0;
+            if (hasMesh)
+            {
+                prefabEntry.meshComponent = EntityMeshEntry{ readUInt32(file) };
+            }
+
+            const bool hasPointLight = readUInt8(file) != 0;
+            if (hasPointLight)
+            {
+                prefabEntry.pointLightComponent = readPointLight(file);
+            }
+
+            sceneData.prefabs.push_back(prefabEntry);
+        }
+
         // entity_table_section
         const uint32_t entityCount = readUInt32(file);
         sceneData.entities.reserve(entityCount);
@@ -214,27 +338,45 @@ namespace parus::serialization
         {
             EntityEntry entry{};
             entry.name      = readString(file);
+
+            const uint32_t prefabIndex = hasPrefabs ? readUInt32(file) : NO_PREFAB;
+            const PrefabEntry* prefabEntry = nullptr;
+            if (prefabIndex != NO_PREFAB)
+            {
+                if (prefabIndex >= sceneData.prefabs.size())
+                {
+                    LOG_ERROR("Out-of-range prefab index in world file: " + worldPath.string());
+
+                    return std::nullopt;
+                }
+
+                entry.prefabIndex = prefabIndex;
+                prefabEntry = &sceneData.prefabs[prefabIndex];
+            }
+
             entry.mobility  = static_cast<parus::Mobility>(readUInt8(file));
             entry.transform.position      = readVector3(file);
             entry.transform.rotationEuler = readVector3(file);
             entry.transform.scale         = readVector3(file);
 
-            const bool hasMesh = readUInt8(file) != 0;
-            if (hasMesh)
+            const auto meshState = static_cast<ComponentState>(readUInt8(file));
+            if (meshState == ComponentState::Stored)
+            {
+                entry.meshComponent = EntityMeshEntry{ readUInt32(file) };
+            }
+            else if (meshState == ComponentState::Inherited && prefabEntry)
             {
-                EntityMeshEntry meshEntry{};
-                meshEntry.meshIndex = readUInt32(file);
-                entry.meshComponent = meshEntry;
+                entry.meshComponent = prefabEntry->meshComponent;
             }
 
-            const bool hasPointLight = readUInt8(file) != 0;
-            if (hasPointLight)
+            const auto pointLightState = static_cast<ComponentState>(readUInt8(file));
+            if (pointLightState == ComponentState::Stored)
+            {
+                entry.pointLightComponent = readPointLight(file);
+            }
+            else if (pointLightState == ComponentState::Inherited && prefabEntry)
             {
-                EntityPointLightEntry pointLightEntry{};
-                pointLightEntry.color     = readVector3(file);
-                pointLightEntry.radius    = readFloat(file);
-                pointLightEntry.intensity = readFloat(file);
-                entry.pointLightComponent = pointLightEntry;
+                entry.pointLightComponent = prefabEntry->pointLightComponent;
             }
 
             sceneData.entities.push_back(entry);
@@ -5,6 +5,8 @@
 
 #include "SceneData.h"
 #include "services/world/World.h"
+#include "services/world/camera/SpectatorCamera.h"
+#include "services/world/entity/EntitySnapshot.h"
 
 namespace parus::serialization
 {
@@ -19,6 +21,16 @@ namespace parus::serialization
         const std::string& sceneName,
         const std::filesystem::path& outputPath);
 
+    /**
+     * Same, from a snapshot of the entities and a copy of the camera. Reads nothing else from the
+     * world, so it may run on any thread while the world keeps changing.
+     */
+    void writeWorld(
+        const parus::EntitySnapshot& entities,
+        const parus::SpectatorCamera& camera,
+        const std::string& sceneName,
+        const std::filesystem::path& outputPath);
+
     /** Reads a .pworld file into a SceneData POD. Returns nullopt on failure. */
     std::optional<SceneData> readWorld(
         const std::string& sceneName,
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+namespace parus
+{
+
+    /**
+     * Read side of a cooperative cancellation flag. Long jobs (scene loads, imports) poll
+     * isCancelled() between steps and stop early, dropping whatever they built so far.
+     *
+     * Tokens are cheap to copy and safe to read from any thread. A default-constructed token is
+     * never cancelled, so it is the "cannot be cancelled" argument for APIs that take one.
+     */
+    class CancellationToken final
+    {
+    public:
+        CancellationToken() = default;
+
+        [[nodiscard]] bool isCancelled() const
+        {
+            return cancelled && cancelled->load(std::memory_order_acquire);
+        }
+
+    private:
+        friend class CancellationSource;
+
+        explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> cancelled)
+            : cancelled(std::move(cancelled))
+        {
+        }
+
+        std::shared_ptr<const std::atomic<bool>> cancelled;
+    };
+
+    /** Owner side: hands out tokens and cancels all of them at once. Cancelling cannot be undone. */
+    class CancellationSource final
+    {
+    public:
+        CancellationSource()
+            : cancelled(std::make_shared<std::atomic<bool>>(false))
+        {
+        }
+
+        void cancel()
+        {
+            cancelled->store(true, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool isCancelled() const
+        {
+            return cancelled->load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] CancellationToken getToken() const
+        {
+            return CancellationToken(cancelled);
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+}
@@ -0,0 +1,270 @@
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include "engine/EngineCore.h"
+
+#if WITH_WINDOWS_PLATFORM
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#elif WITH_LINUX_PLATFORM
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace parus
+{
+    namespace
+    {
+        std::string readFirstLine(const std::filesystem::path& path)
+        {
+            std::ifstream file(path);
+            std::string line;
+            std::getline(file, line);
+            return line;
+        }
+
+        bool isCpuDirectoryName(const std::string& name)
+        {
+            return name.size() > 3 && name.starts_with("cpu")
+                && std::all_of(name.begin() + 3, name.end(), [](const char c) { return c >= '0' && c <= '9'; });
+        }
+
+        CpuTopology oneCorePerHardwareThread()
+        {
+            CpuTopology topology;
+            const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int cpu = 0; cpu < hardwareThreads; ++cpu)
+            {
+                topology.physicalCores.push_back({ cpu });
+            }
+            return topology;
+        }
+
+#if WITH_WINDOWS_PLATFORM
+        CpuTopology fromWindows()
+        {
+            DWORD length = 0;
+            GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+
+            std::vector<char> buffer(length);
+            if (length == 0
+                || !GetLogicalProcessorInformationEx(RelationProcessorCore,
+                    reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &length))
+            {
+                return {};
+            }
+
+            // Affinity masks only address one processor group, so cores of other groups are left out.
+            CpuTopology topology;
+            for (DWORD offset = 0; offset < length;)
+            {
+                const auto* entry = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+                offset += entry->Size;
+
+                const GROUP_AFFINITY& affinity = entry->Processor.GroupMask[0];
+                if (affinity.Group != 0)
+                {
+                    continue;
+                }
+
+                std::vector<unsigned int> core;
+                for (unsigned int cpu = 0; cpu < sizeof(KAFFINITY) * 8; ++cpu)
+                {
+                    if (affinity.Mask & (static_cast<KAFFINITY>(1) << cpu))
+                    {
+                        core.push_back(cpu);
+                    }
+                }
+
+                if (!core.empty())
+                {
+                    topology.physicalCores.push_back(std::move(core));
+                }
+            }
+
+            std::ranges::sort(topology.physicalCores);
+            return topology;
+        }
+#endif
+    }
+
+    size_t CpuTopology::getLogicalCpuCount() const
+    {
+        size_t count = 0;
+        for (const auto& core : physicalCores)
+        {
+            count += core.size();
+        }
+        return count;
+    }
+
+    unsigned int CpuTopology::getDefaultWorkerCount(const bool countSmtThreads) const
+    {
+        const size_t available = countSmtThreads ? getLogicalCpuCount() : getPhysicalCoreCount();
+        return available > 1 ? static_cast<unsigned int>(available - 1) : 1;
+    }
+
+    std::vector<unsigned int> CpuTopology::getWorkerCpuOrder() const
+    {
+        std::vector<unsigned int> order;
+        if (physicalCores.size() <= 1)
+        {
+            for (const auto& core : physicalCores)
+            {
+                order.insert(order.end(), core.begin(), core.end());
+            }
+            return order;
+        }
+
+        size_t maxSiblings = 0;
+        for (const auto& core : physicalCores)
+        {
+            maxSiblings = std::max(maxSiblings, core.size());
+        }
+
+        for (size_t sibling = 0; sibling < maxSiblings; ++sibling)
+        {
+            for (size_t core = 1; core < physicalCores.size(); ++core)
+            {
+                if (sibling < physicalCores[core].size())
+                {
+                    order.push_back(physicalCores[core][sibling]);
+                }
+            }
+        }
+        return order;
+    }
+
+    CpuTopology CpuTopology::detect()
+    {
+        CpuTopology topology;
+#if WITH_WINDOWS_PLATFORM
+        topology = fromWindows();
+#elif WITH_LINUX_PLATFORM
+        topology = fromSysfs("/sys/devices/system/cpu");
+#endif
+
+        if (topology.physicalCores.empty())
+        {
+            return oneCorePerHardwareThread();
+        }
+        return topology;
+    }
+
+    CpuTopology CpuTopology::fromSysfs(const std::filesystem::path& cpuDirectory)
+    {
+        std::error_code error;
+        std::set<std::vector<unsigned int>> cores;
+
+        for (const auto& entry : std::filesystem::directory_iterator(cpuDirectory, error))
+        {
+            if (!entry.is_directory(error) || !isCpuDirectoryName(entry.path().filename().string()))
+            {
+                continue;
+            }
+
+            // cpu0 usually has no "online" file; the others contain "0" while offline.
+            if (readFirstLine(entry.path() / "online") == "0")
+            {
+                continue;
+            }
+
+            // Newer kernels call it core_cpus_list; thread_siblings_list is the older name for the same list.
+            std::vector<unsigned int> siblings = parseCpuList(readFirstLine(entry.path() / "topology" / "core_cpus_list"));
+            if (siblings.empty())
+            {
+                siblings = parseCpuList(readFirstLine(entry.path() / "topology" / "thread_siblings_list"));
+            }
+
+            if (!siblings.empty())
+            {
+                cores.insert(std::move(siblings));
+            }
+        }
+
+        // Sibling lists are disjoint and sorted, so the set is already ordered by each core's first CPU.
+        CpuTopology topology;
+        topology.physicalCores.assign(cores.begin(), cores.end());
+        return topology;
+    }
+
+    std::vector<unsigned int> CpuTopology::parseCpuList(const std::string_view list)
+    {
+        std::vector<unsigned int> cpus;
+
+        size_t position = 0;
+        while (position < list.size())
+        {
+            size_t end = list.find(',', position);
+            if (end == std::string_view::npos)
+            {
+                end = list.size();
+            }
+            const std::string_view range = list.substr(position, end - position);
+            position = end + 1;
+
+            const size_t dash = range.find('-');
+            const std::string_view firstText = range.substr(0, dash);
+            const std::string_view lastText = dash == std::string_view::npos ? firstText : range.substr(dash + 1);
+
+            unsigned int first = 0;
+            unsigned int last = 0;
+            if (std::from_chars(firstText.data(), firstText.data() + firstText.size(), first).ec != std::errc()
+                || std::from_chars(lastText.data(), lastText.data() + lastText.size(), last).ec != std::errc()
+                || last < first)
+            {
+                continue;
+            }
+
+            for (unsigned int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+
+        std::ranges::sort(cpus);
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    void setCurrentThreadName(const std::string& name)
+    {
+#if WITH_WINDOWS_PLATFORM
+        const std::wstring wideName(name.begin(), name.end());
+        SetThreadDescription(GetCurrentThread(), wideName.c_str());
+#elif WITH_LINUX_PLATFORM
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    bool pinCurrentThreadToCpu(const unsigned int cpu)
+    {
+#if WITH_WINDOWS_PLATFORM
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+        {
+            return false;
+        }
+        return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif WITH_LINUX_PLATFORM
+        if (cpu >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+}
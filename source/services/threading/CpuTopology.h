@@ -0,0 +1,53 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace parus
+{
+
+    /**
+     * Logical CPUs grouped by the physical core they belong to. SMT siblings (hyper-threads) share
+     * one core's execution units, so two busy workers on the same core get far less than twice the
+     * throughput and make each other's timings noisy.
+     */
+    struct CpuTopology
+    {
+        /** One entry per physical core, ordered by its lowest logical CPU; each lists the core's logical CPUs in ascending order. */
+        std::vector<std::vector<unsigned int>> physicalCores;
+
+        [[nodiscard]] size_t getPhysicalCoreCount() const { return physicalCores.size(); }
+        [[nodiscard]] size_t getLogicalCpuCount() const;
+        [[nodiscard]] bool hasSmt() const { return getLogicalCpuCount() > getPhysicalCoreCount(); }
+
+        /**
+         * Worker count that leaves one core to the main thread: one worker per remaining physical
+         * core, or per remaining logical CPU if countSmtThreads is set. Never less than one.
+         */
+        [[nodiscard]] unsigned int getDefaultWorkerCount(bool countSmtThreads) const;
+
+        /**
+         * Logical CPUs to pin workers to, worker i taking entry i modulo the size. The first core is
+         * left to the main thread; the other cores get one worker each before any SMT sibling gets
+         * one. On a single-core machine every CPU is listed.
+         */
+        [[nodiscard]] std::vector<unsigned int> getWorkerCpuOrder() const;
+
+        /** Topology of this machine; one core per hardware thread if the OS does not report it. */
+        static CpuTopology detect();
+
+        /** Reads a Linux sysfs CPU directory (normally /sys/devices/system/cpu). Empty if nothing could be read. */
+        static CpuTopology fromSysfs(const std::filesystem::path& cpuDirectory);
+
+        /** Parses a kernel CPU list such as "0-3,8,10-11". Malformed entries are skipped. */
+        static std::vector<unsigned int> parseCpuList(std::string_view list);
+    };
+
+    /** Names the calling thread for debuggers and profilers. Linux keeps the first 15 characters. */
+    void setCurrentThreadName(const std::string& name);
+
+    /** Restricts the calling thread to one logical CPU. Returns false if the OS refused. */
+    bool pinCurrentThreadToCpu(unsigned int cpu);
+
+}
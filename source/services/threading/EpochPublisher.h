@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace parus
+{
+
+    /**
+     * Hands immutable values from one writer to any number of reader threads without locking.
+     *
+     * Every publish() starts a new epoch whose value becomes what acquire() returns. A reader pins
+     * the current slot with an atomic counter only long enough to copy its shared_ptr, then checks
+     * the epoch is still current and retries if a publish raced it; it never waits for the writer.
+     * The writer only overwrites slots that are neither current nor pinned, so it waits at most for
+     * a reader's pointer copy, and a value stays alive as long as any reader holds it.
+     *
+     * publish() must not be called from two threads at once. Epoch 0 is a default-constructed T.
+     */
+    template <typename T>
+    class EpochPublisher final
+    {
+    public:
+        EpochPublisher()
+        {
+            slots[0].value = std::make_shared<const T>();
+        }
+
+        EpochPublisher(const EpochPublisher&) = delete;
+        EpochPublisher& operator=(const EpochPublisher&) = delete;
+
+        /** Makes value current and returns its epoch. Releases the older values no reader is pinning. */
+        uint64_t publish(std::shared_ptr<const T> value)
+        {
+            const uint64_t previous = state.load(std::memory_order_relaxed);
+            const size_t previousSlot = previous % SLOT_COUNT;
+
+            size_t slot = (previousSlot + 1) % SLOT_COUNT;
+            while (slot == previousSlot || slots[slot].pins.load() != 0)
+            {
+                // Only readers racing a publish still pin an old slot, and only for a pointer copy.
+                slot = (slot + 1) % SLOT_COUNT;
+                if (slot == previousSlot)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            const uint64_t epoch = previous / SLOT_COUNT + 1;
+            slots[slot].value = std::move(value);
+            state.store(epoch * SLOT_COUNT + slot);
+
+            // A reader that pins one of these from now on sees the new state and leaves it alone.
+            for (size_t oldSlot = 0; oldSlot < SLOT_COUNT; ++oldSlot)
+            {
+                if (oldSlot != slot && slots[oldSlot].pins.load() == 0)
+                {
+                    slots[oldSlot].value.reset();
+                }
+            }
+            return epoch;
+        }
+
+        /** The current value. Any thread; never blocks. */
+        [[nodiscard]] std::shared_ptr<const T> acquire() const
+        {
+            while (true)
+            {
+                const uint64_t current = state.load();
+                const Slot& slot = slots[current % SLOT_COUNT];
+                slot.pins.fetch_add(1);
+
+                // Still current after pinning, so the writer can't be touching the slot.
+                std::shared_ptr<const T> value;
+                const bool isCurrent = state.load() == current;
+                if (isCurrent)
+                {
+                    value = slot.value;
+                }
+                slot.pins.fetch_sub(1, std::memory_order_release);
+
+                if (isCurrent)
+                {
+                    return value;
+                }
+            }
+        }
+
+        /** The epoch acquire() currently returns the value of. */
+        [[nodiscard]] uint64_t getEpoch() const { return state.load(std::memory_order_acquire) / SLOT_COUNT; }
+
+    private:
+        /** One current, one for the next publish, one a late reader may still pin. */
+        static constexpr size_t SLOT_COUNT = 3;
+
+        struct Slot
+        {
+            alignas(64) mutable std::atomic<uint32_t> pins { 0 };
+            std::shared_ptr<const T> value;
+        };
+
+        std::array<Slot, SLOT_COUNT> slots;
+        /** epoch * SLOT_COUNT + the slot holding its value, so a reused slot never looks current to a stale reader. */
+        alignas(64) std::atomic<uint64_t> state { 0 };
+    };
+
+}
@@ -0,0 +1,75 @@
+#include "MainThreadQueue.h"
+
+#include <exception>
+
+#include "services/threading/TaskHandle.h"
+
+namespace parus
+{
+    MainThreadQueue::~MainThreadQueue()
+    {
+        // Callbacks left at shutdown are dropped; their targets are being torn down too.
+        takeIncoming();
+        while (readyHead)
+        {
+            delete std::exchange(readyHead, readyHead->next);
+        }
+    }
+
+    void MainThreadQueue::push(Node* node)
+    {
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+        incoming.push(node);
+    }
+
+    void MainThreadQueue::takeIncoming()
+    {
+        const MpscStack<Node>::List taken = incoming.takeAll();
+        if (!taken.head)
+        {
+            return;
+        }
+
+        // Append behind what is already waiting.
+        if (readyTail)
+        {
+            readyTail->next = taken.head;
+        }
+        else
+        {
+            readyHead = taken.head;
+        }
+        readyTail = taken.tail;
+    }
+
+    size_t MainThreadQueue::drain(const size_t maxCallbacks)
+    {
+        takeIncoming();
+
+        size_t ran = 0;
+        while (readyHead && (maxCallbacks == 0 || ran < maxCallbacks))
+        {
+            Node* node = readyHead;
+            readyHead = node->next;
+            if (!readyHead)
+            {
+                readyTail = nullptr;
+            }
+
+            try
+            {
+                node->task();
+            }
+            catch (...)
+            {
+                detail::reportTaskException(std::current_exception());
+            }
+
+            delete node;
+            pendingCount.fetch_sub(1, std::memory_order_relaxed);
+            ++ran;
+        }
+
+        return ran;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "services/Service.h"
+#include "services/threading/MpscStack.h"
+#include "services/threading/Task.h"
+
+namespace parus
+{
+
+    /**
+     * "Run on the main thread" queue: any thread posts callbacks (mesh ready, texture uploaded,
+     * scene loaded), the main loop runs them once per frame with drain().
+     *
+     * Producers push onto an MpscStack; the consumer takes the whole stack and appends it to a
+     * private FIFO list, so draining takes no lock and never waits for a producer. Callbacks run
+     * in submission order.
+     */
+    class MainThreadQueue final : public Service
+    {
+    public:
+        MainThreadQueue() = default;
+        ~MainThreadQueue();
+        MainThreadQueue(const MainThreadQueue&) = delete;
+        MainThreadQueue& operator=(const MainThreadQueue&) = delete;
+
+        /** Thread-safe. The callback runs on whichever thread calls drain(). */
+        template <typename Function>
+        void post(Function&& function)
+        {
+            push(new Node { Task(std::forward<Function>(function)), nullptr });
+        }
+
+        /**
+         * Runs up to maxCallbacks callbacks (0 = no limit) and returns how many ran. Callbacks posted
+         * while draining wait for the next call, so a callback that re-posts itself cannot stall a
+         * frame. Only one thread may drain.
+         */
+        size_t drain(size_t maxCallbacks = 0);
+
+        /** Callbacks posted but not run yet. Approximate while producers are active. */
+        [[nodiscard]] size_t getPendingCount() const { return pendingCount.load(std::memory_order_relaxed); }
+
+    private:
+        struct Node
+        {
+            Task task;
+            Node* next;
+        };
+
+        void push(Node* node);
+        void takeIncoming();
+
+        MpscStack<Node> incoming;
+        std::atomic<size_t> pendingCount { 0 };
+
+        // Consumer side only.
+        alignas(64) Node* readyHead = nullptr;
+        Node* readyTail = nullptr;
+    };
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace parus
+{
+
+    /**
+     * Bounded lock-free multi-producer/multi-consumer ring of pointers (Vyukov's algorithm).
+     * Each cell carries a sequence number that tells producers and consumers whose turn it is,
+     * so neither side ever takes a lock. Used as the pool's injection queue for tasks submitted
+     * from threads that do not own a work-stealing deque.
+     */
+    template <typename T>
+    class MpmcQueue final
+    {
+    public:
+        explicit MpmcQueue(const size_t capacityPowerOfTwo = 65536)
+            : mask(capacityPowerOfTwo - 1)
+            , cells(std::make_unique<Cell[]>(capacityPowerOfTwo))
+        {
+            for (size_t i = 0; i < capacityPowerOfTwo; ++i)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        /** Returns false if the queue is full. */
+        bool push(T* item)
+        {
+            size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = cells[position & mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                if (difference == 0)
+                {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.item = item;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Returns nullptr if the queue is empty. */
+        T* pop()
+        {
+            size_t position = dequeuePosition.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = cells[position & mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+                if (difference == 0)
+                {
+                    if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        T* item = cell.item;
+                        cell.sequence.store(position + mask + 1, std::memory_order_release);
+                        return item;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return nullptr;
+                }
+                else
+                {
+                    position = dequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Approximate; only meaningful as a hint or for statistics. */
+        [[nodiscard]] size_t sizeApprox() const
+        {
+            const size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+            const size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T* item = nullptr;
+        };
+
+        const size_t mask;
+        std::unique_ptr<Cell[]> cells;
+
+        alignas(64) std::atomic<size_t> enqueuePosition { 0 };
+        alignas(64) std::atomic<size_t> dequeuePosition { 0 };
+    };
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+
+namespace parus
+{
+
+    /**
+     * Lock-free multi-producer/single-consumer stack of intrusive nodes linked through Node::next.
+     * Producers push with a single CAS; the consumer takes everything at once with one exchange and
+     * gets it back oldest first, so neither side ever waits for the other. Nodes are owned by the
+     * caller. Backs MainThreadQueue and EntityCommandQueue.
+     */
+    template <typename Node>
+    class MpscStack final
+    {
+    public:
+        /** A list linked through Node::next, oldest first; both ends are nullptr when it is empty. */
+        struct List
+        {
+            Node* head = nullptr;
+            Node* tail = nullptr;
+        };
+
+        MpscStack() = default;
+        MpscStack(const MpscStack&) = delete;
+        MpscStack& operator=(const MpscStack&) = delete;
+
+        /** Thread-safe. */
+        void push(Node* node)
+        {
+            Node* head = top.load(std::memory_order_relaxed);
+            do
+            {
+                node->next = head;
+            }
+            while (!top.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        /** Takes every node pushed so far. Only one thread may take at a time. */
+        [[nodiscard]] List takeAll()
+        {
+            Node* stack = top.exchange(nullptr, std::memory_order_acquire);
+
+            // The stack is newest first, so its top becomes the tail.
+            List list { .head = nullptr, .tail = stack };
+            while (stack)
+            {
+                Node* next = stack->next;
+                stack->next = list.head;
+                list.head = stack;
+                stack = next;
+            }
+
+            return list;
+        }
+
+    private:
+        alignas(64) std::atomic<Node*> top { nullptr };
+    };
+
+}
@@ -0,0 +1,119 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+#include "services/threading/ThreadPool.h"
+
+namespace parus::detail
+{
+    namespace
+    {
+        // Chunks per participating thread; a little oversubscription evens out uneven chunks.
+        constexpr size_t CHUNKS_PER_THREAD = 4;
+
+        /** Shared by the caller and helper tasks; helpers may outlive the call, so they hold it by shared_ptr. */
+        struct ChunkRun
+        {
+            ChunkPlan plan;
+            size_t begin = 0;
+            size_t end = 0;
+            ChunkFunction function = nullptr;
+            void* context = nullptr;
+
+            std::atomic<size_t> nextChunk { 0 };
+            std::atomic<size_t> finishedChunks { 0 };
+            std::atomic<bool> hasFailed { false };
+            std::exception_ptr exception;
+        };
+
+        void claimChunks(ChunkRun& run)
+        {
+            // Once every chunk is claimed the caller may return at any moment, so `function` and
+            // `context` are only touched for a successfully claimed chunk.
+            size_t chunkIndex;
+            while ((chunkIndex = run.nextChunk.fetch_add(1, std::memory_order_relaxed)) < run.plan.chunkCount)
+            {
+                if (!run.hasFailed.load(std::memory_order_relaxed))
+                {
+                    const size_t chunkBegin = run.begin + chunkIndex * run.plan.chunkSize;
+                    const size_t chunkEnd = std::min(run.end, chunkBegin + run.plan.chunkSize);
+                    try
+                    {
+                        run.function(run.context, chunkIndex, chunkBegin, chunkEnd);
+                    }
+                    catch (...)
+                    {
+                        bool expected = false;
+                        if (run.hasFailed.compare_exchange_strong(expected, true))
+                        {
+                            run.exception = std::current_exception();
+                        }
+                    }
+                }
+
+                // The caller sleeps until the last chunk is done, so only that one has to wake it.
+                if (run.finishedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == run.plan.chunkCount)
+                {
+                    run.finishedChunks.notify_all();
+                }
+            }
+        }
+    }
+
+    ChunkPlan planChunks(const ThreadPool& pool, const size_t count, const size_t grainSize)
+    {
+        const size_t participants = static_cast<size_t>(pool.getThreadCount()) + 1;
+        const size_t targetChunkCount = participants * CHUNKS_PER_THREAD;
+
+        ChunkPlan plan;
+        plan.chunkSize = std::max<size_t>({ 1, grainSize, (count + targetChunkCount - 1) / targetChunkCount });
+        plan.chunkCount = (count + plan.chunkSize - 1) / plan.chunkSize;
+
+        if (pool.getThreadCount() == 0)
+        {
+            // No workers to share with: one chunk, run inline.
+            plan.chunkSize = count;
+            plan.chunkCount = count > 0 ? 1 : 0;
+        }
+
+        return plan;
+    }
+
+    void runChunks(ThreadPool& pool, const ChunkPlan& plan, const size_t begin, const size_t end, const ChunkFunction function, void* context)
+    {
+        const auto run = std::make_shared<ChunkRun>();
+        run->plan = plan;
+        run->begin = begin;
+        run->end = end;
+        run->function = function;
+        run->context = context;
+
+        const size_t helperCount = std::min<size_t>(plan.chunkCount - 1, pool.getThreadCount());
+        for (size_t i = 0; i < helperCount; ++i)
+        {
+            pool.post([run]
+            {
+                claimChunks(*run);
+            });
+        }
+
+        claimChunks(*run);
+
+        // Every chunk is claimed, but the ones still running on helpers can be long (grain 1 over
+        // a few heavy items), so sleep instead of spinning. Picking up unrelated tasks here could
+        // stall the caller behind someone else's work, so it doesn't help out either.
+        size_t finished;
+        while ((finished = run->finishedChunks.load(std::memory_order_acquire)) < plan.chunkCount)
+        {
+            run->finishedChunks.wait(finished, std::memory_order_acquire);
+        }
+
+        if (run->exception)
+        {
+            std::rethrow_exception(run->exception);
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace parus
+{
+    class ThreadPool;
+
+    /**
+     * Minimum number of elements per chunk when the caller gives no grain size. Ranges that fit in
+     * a single chunk run inline on the calling thread without touching the pool.
+     */
+    inline constexpr size_t DEFAULT_GRAIN_SIZE = 256;
+
+    namespace detail
+    {
+        struct ChunkPlan
+        {
+            size_t chunkSize = 0;
+            size_t chunkCount = 0;
+        };
+
+        /** Splits `count` elements into chunks of at least `grainSize`, aiming for a few chunks per thread. */
+        ChunkPlan planChunks(const ThreadPool& pool, size_t count, size_t grainSize);
+
+        using ChunkFunction = void (*)(void* context, size_t chunkIndex, size_t chunkBegin, size_t chunkEnd);
+
+        /**
+         * Runs every chunk of the plan over [begin, end). The calling thread claims chunks alongside
+         * the workers and returns once all of them are done; the first exception is rethrown.
+         */
+        void runChunks(ThreadPool& pool, const ChunkPlan& plan, size_t begin, size_t end, ChunkFunction function, void* context);
+
+        template <typename Body>
+        void runChunks(ThreadPool& pool, const ChunkPlan& plan, const size_t begin, const size_t end, Body& body)
+        {
+            runChunks(pool, plan, begin, end, [](void* context, const size_t chunkIndex, const size_t chunkBegin, const size_t chunkEnd)
+            {
+                (*static_cast<Body*>(context))(chunkIndex, chunkBegin, chunkEnd);
+            }, &body);
+        }
+    }
+
+    /** Calls body(chunkBegin, chunkEnd) for disjoint sub-ranges covering [begin, end), in parallel. */
+    template <typename Body>
+    void parallelForRange(ThreadPool& pool, const size_t begin, const size_t end, Body&& body, const size_t grainSize = DEFAULT_GRAIN_SIZE)
+    {
+        if (begin >= end)
+        {
+            return;
+        }
+
+        const detail::ChunkPlan plan = detail::planChunks(pool, end - begin, grainSize);
+        if (plan.chunkCount <= 1)
+        {
+            body(begin, end);
+            return;
+        }
+
+        auto chunkBody = [&body](size_t, const size_t chunkBegin, const size_t chunkEnd)
+        {
+            body(chunkBegin, chunkEnd);
+        };
+        detail::runChunks(pool, plan, begin, end, chunkBody);
+    }
+
+    /** Calls body(i) for every i in [begin, end), in parallel. */
+    template <typename Body>
+    void parallelFor(ThreadPool& pool, const size_t begin, const size_t end, Body&& body, const size_t grainSize = DEFAULT_GRAIN_SIZE)
+    {
+        parallelForRange(pool, begin, end, [&body](const size_t chunkBegin, const size_t chunkEnd)
+        {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i)
+            {
+                body(i);
+            }
+        }, grainSize);
+    }
+
+    /**
+     * Folds map(i) for every i in [begin, end) with `reduce`, starting each chunk from `identity`.
+     * Chunk results are combined in index order, so the result is deterministic for a given pool size.
+     */
+    template <typename T, typename Map, typename Reduce>
+    T parallelReduce(ThreadPool& pool, const size_t begin, const size_t end, T identity, Map&& map, Reduce&& reduce, const size_t grainSize = DEFAULT_GRAIN_SIZE)
+    {
+        if (begin >= end)
+        {
+            return identity;
+        }
+
+        auto reduceRange = [&](const size_t chunkBegin, const size_t chunkEnd)
+        {
+            T accumulator = identity;
+            for (size_t i = chunkBegin; i < chunkEnd; ++i)
+            {
+                accumulator = reduce(std::move(accumulator), map(i));
+            }
+            return accumulator;
+        };
+
+        const detail::ChunkPlan plan = detail::planChunks(pool, end - begin, grainSize);
+        if (plan.chunkCount <= 1)
+        {
+            return reduceRange(begin, end);
+        }
+
+        std::vector<T> partials(plan.chunkCount, identity);
+        auto chunkBody = [&](const size_t chunkIndex, const size_t chunkBegin, const size_t chunkEnd)
+        {
+            partials[chunkIndex] = reduceRange(chunkBegin, chunkEnd);
+        };
+        detail::runChunks(pool, plan, begin, end, chunkBody);
+
+        T result = std::move(identity);
+        for (T& partial : partials)
+        {
+            result = reduce(std::move(result), std::move(partial));
+        }
+        return result;
+    }
+
+    /** Writes op(*it) for every element of [first, last) to the range starting at `output`, in parallel. */
+    template <std::random_access_iterator InputIterator, std::random_access_iterator OutputIterator, typename Operation>
+    OutputIterator parallelTransform(ThreadPool& pool, InputIterator first, InputIterator last, OutputIterator output, Operation&& operation, const size_t grainSize = DEFAULT_GRAIN_SIZE)
+    {
+        const auto count = static_cast<size_t>(std::distance(first, last));
+        parallelForRange(pool, 0, count, [&](const size_t chunkBegin, const size_t chunkEnd)
+        {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i)
+            {
+                output[i] = operation(first[i]);
+            }
+        }, grainSize);
+
+        return output + count;
+    }
+
+}
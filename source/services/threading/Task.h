@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace parus
+{
+
+    /**
+     * Move-only, type-erased `void()` callable with inline storage. Callables up to
+     * INLINE_CAPACITY bytes (a few shared_ptrs, strings and paths, which covers the captures the
+     * engine submits) live inside the Task; larger or over-aligned ones fall back to one heap
+     * allocation. Unlike std::function it accepts move-only callables and never copies.
+     */
+    class Task final
+    {
+    public:
+        static constexpr size_t INLINE_CAPACITY = 112;
+
+        /** True if a callable of type Function is stored without a heap allocation. */
+        template <typename Function>
+        static constexpr bool storesInline =
+            sizeof(Function) <= INLINE_CAPACITY
+            && alignof(Function) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Function>;
+
+        Task() = default;
+
+        template <typename Function>
+            requires (!std::is_same_v<std::decay_t<Function>, Task> && std::is_invocable_v<std::decay_t<Function>&>)
+        Task(Function&& function) // NOLINT(google-explicit-constructor): tasks are built from lambdas implicitly.
+        {
+            emplace(std::forward<Function>(function));
+        }
+
+        Task(Task&& other) noexcept
+        {
+            moveFrom(other);
+        }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task()
+        {
+            reset();
+        }
+
+        template <typename Function>
+        void emplace(Function&& function)
+        {
+            using Callable = std::decay_t<Function>;
+
+            reset();
+            if constexpr (storesInline<Callable>)
+            {
+                new (storage) Callable(std::forward<Function>(function));
+                operations = &inlineOperations<Callable>;
+            }
+            else
+            {
+                *reinterpret_cast<Callable**>(storage) = new Callable(std::forward<Function>(function));
+                operations = &heapOperations<Callable>;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (operations)
+            {
+                operations->destroy(storage);
+                operations = nullptr;
+            }
+        }
+
+        void operator()()
+        {
+            operations->invoke(storage);
+        }
+
+        explicit operator bool() const { return operations != nullptr; }
+
+    private:
+        struct Operations
+        {
+            void (*invoke)(void* storage);
+            void (*relocate)(void* from, void* to) noexcept;
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename Callable>
+        static constexpr Operations inlineOperations = {
+            [](void* storage) { (*std::launder(static_cast<Callable*>(storage)))(); },
+            [](void* from, void* to) noexcept
+            {
+                Callable* source = std::launder(static_cast<Callable*>(from));
+                new (to) Callable(std::move(*source));
+                source->~Callable();
+            },
+            [](void* storage) noexcept { std::launder(static_cast<Callable*>(storage))->~Callable(); }
+        };
+
+        template <typename Callable>
+        static constexpr Operations heapOperations = {
+            [](void* storage) { (**static_cast<Callable**>(storage))(); },
+            [](void* from, void* to) noexcept { *static_cast<Callable**>(to) = *static_cast<Callable**>(from); },
+            [](void* storage) noexcept { delete *static_cast<Callable**>(storage); }
+        };
+
+        void moveFrom(Task& other) noexcept
+        {
+            if (other.operations)
+            {
+                other.operations->relocate(other.storage, storage);
+                operations = std::exchange(other.operations, nullptr);
+            }
+        }
+
+        alignas(std::max_align_t) std::byte storage[INLINE_CAPACITY];
+        const Operations* operations = nullptr;
+    };
+
+}
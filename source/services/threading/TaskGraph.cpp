@@ -0,0 +1,192 @@
+#include "TaskGraph.h"
+
+#include <atomic>
+
+#include "engine/EngineCore.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    namespace
+    {
+        struct NodeRuntime
+        {
+            std::function<void()> work;
+            std::vector<TaskGraph::NodeId> successors;
+            std::atomic<uint32_t> remainingDependencies { 0 };
+        };
+
+        /** Everything a running graph needs; shared by all of its in-flight node tasks. */
+        struct GraphExecution
+        {
+            GraphExecution(ThreadPool* pool, const size_t nodeCount)
+                : pool(pool)
+                , nodes(nodeCount)
+                , remainingNodes(nodeCount)
+                , completion(std::make_shared<TaskState<void>>(pool, getCurrentTaskPriority()))
+            {
+            }
+
+            ThreadPool* pool;
+            std::vector<NodeRuntime> nodes;
+            std::atomic<size_t> remainingNodes;
+            std::atomic<bool> hasFailed { false };
+            std::exception_ptr firstException;
+            std::shared_ptr<TaskState<void>> completion;
+        };
+
+        void scheduleNode(const std::shared_ptr<GraphExecution>& execution, TaskGraph::NodeId nodeId);
+
+        void runNode(const std::shared_ptr<GraphExecution>& execution, const TaskGraph::NodeId nodeId)
+        {
+            NodeRuntime& node = execution->nodes[nodeId];
+
+            if (!execution->hasFailed.load(std::memory_order_acquire))
+            {
+                try
+                {
+                    node.work();
+                }
+                catch (...)
+                {
+                    bool expected = false;
+                    if (execution->hasFailed.compare_exchange_strong(expected, true))
+                    {
+                        execution->firstException = std::current_exception();
+                        detail::reportTaskException(execution->firstException);
+                    }
+                }
+            }
+
+            // Release the captured state as soon as the node is done, not when the graph is.
+            node.work = nullptr;
+
+            for (const TaskGraph::NodeId successor : node.successors)
+            {
+                if (execution->nodes[successor].remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    scheduleNode(execution, successor);
+                }
+            }
+
+            if (execution->remainingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                execution->completion->exception = execution->firstException;
+                execution->completion->finish();
+            }
+        }
+
+        void scheduleNode(const std::shared_ptr<GraphExecution>& execution, const TaskGraph::NodeId nodeId)
+        {
+            execution->pool->post([execution, nodeId]
+            {
+                runNode(execution, nodeId);
+            });
+        }
+
+        bool hasCycle(const std::vector<NodeRuntime>& nodes)
+        {
+            // Kahn's algorithm: the graph is acyclic iff every node can be visited in topological order.
+            std::vector<uint32_t> inDegree(nodes.size());
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                inDegree[i] = nodes[i].remainingDependencies.load(std::memory_order_relaxed);
+            }
+
+            std::vector<TaskGraph::NodeId> ready;
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (inDegree[i] == 0)
+                {
+                    ready.push_back(i);
+                }
+            }
+
+            size_t visited = 0;
+            while (!ready.empty())
+            {
+                const TaskGraph::NodeId nodeId = ready.back();
+                ready.pop_back();
+                ++visited;
+
+                for (const TaskGraph::NodeId successor : nodes[nodeId].successors)
+                {
+                    if (--inDegree[successor] == 0)
+                    {
+                        ready.push_back(successor);
+                    }
+                }
+            }
+
+            return visited != nodes.size();
+        }
+    }
+
+    TaskGraph::NodeId TaskGraph::add(std::function<void()> work, const std::initializer_list<NodeId> dependencies)
+    {
+        return add(std::move(work), std::vector<NodeId>(dependencies));
+    }
+
+    TaskGraph::NodeId TaskGraph::add(std::function<void()> work, const std::vector<NodeId>& dependencies)
+    {
+        const NodeId nodeId = nodes.size();
+        nodes.push_back(Node{ .work = std::move(work) });
+
+        for (const NodeId dependency : dependencies)
+        {
+            precede(dependency, nodeId);
+        }
+
+        return nodeId;
+    }
+
+    void TaskGraph::precede(const NodeId before, const NodeId after)
+    {
+        ASSERT(before < nodes.size() && after < nodes.size(), "Task graph dependency refers to an unknown node.");
+        ASSERT(before != after, "A task graph node cannot depend on itself.");
+
+        nodes[before].successors.push_back(after);
+        ++nodes[after].dependencyCount;
+    }
+
+    TaskHandle<void> TaskGraph::run(ThreadPool& pool)
+    {
+        const auto execution = std::make_shared<GraphExecution>(&pool, nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            NodeRuntime& runtime = execution->nodes[i];
+            runtime.work = std::move(nodes[i].work);
+            runtime.successors = std::move(nodes[i].successors);
+            runtime.remainingDependencies.store(nodes[i].dependencyCount, std::memory_order_relaxed);
+        }
+        nodes.clear();
+
+        ASSERT(!hasCycle(execution->nodes), "Task graph contains a dependency cycle.");
+
+        TaskHandle<void> handle(execution->completion);
+
+        if (execution->nodes.empty())
+        {
+            execution->completion->finish();
+            return handle;
+        }
+
+        // Collect roots first: once the first root is posted, counters start changing under us.
+        std::vector<NodeId> roots;
+        for (NodeId i = 0; i < execution->nodes.size(); ++i)
+        {
+            if (execution->nodes[i].remainingDependencies.load(std::memory_order_relaxed) == 0)
+            {
+                roots.push_back(i);
+            }
+        }
+
+        for (const NodeId root : roots)
+        {
+            scheduleNode(execution, root);
+        }
+
+        return handle;
+    }
+
+}
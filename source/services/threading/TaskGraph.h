@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "services/threading/TaskHandle.h"
+
+namespace parus
+{
+    class ThreadPool;
+
+    /**
+     * Builder for a DAG of tasks. Nodes declare the nodes they depend on; run() submits every node
+     * whose dependencies are done and schedules the rest as their last dependency finishes, so no
+     * global barrier is involved. Nodes exchange data through state captured by their lambdas.
+     *
+     * If a node throws, nodes that have not started yet are skipped and the handle returned by
+     * run() rethrows the first exception.
+     */
+    class TaskGraph final
+    {
+    public:
+        using NodeId = size_t;
+
+        NodeId add(std::function<void()> work, std::initializer_list<NodeId> dependencies = {});
+        NodeId add(std::function<void()> work, const std::vector<NodeId>& dependencies);
+
+        /** Makes `after` wait for `before`. */
+        void precede(NodeId before, NodeId after);
+
+        [[nodiscard]] size_t size() const { return nodes.size(); }
+        [[nodiscard]] bool empty() const { return nodes.empty(); }
+
+        /** Submits the graph and leaves this builder empty. The handle completes when every node has run. */
+        TaskHandle<void> run(ThreadPool& pool);
+
+    private:
+        struct Node
+        {
+            std::function<void()> work;
+            std::vector<NodeId> successors {};
+            uint32_t dependencyCount = 0;
+        };
+
+        std::vector<Node> nodes;
+    };
+
+}
@@ -0,0 +1,95 @@
+#include "TaskGroup.h"
+
+#include "engine/EngineCore.h"
+
+namespace parus
+{
+    TaskGroup::TaskGroup(ThreadPool& pool, CancellationToken token)
+        : pool(&pool)
+        , state(std::make_shared<State>(pool.getSlotPool()))
+    {
+        state->token = std::move(token);
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        wait();
+    }
+
+    void TaskGroup::wait()
+    {
+        while (true)
+        {
+            const uint32_t pending = state->pending.load(std::memory_order_acquire);
+            if (pending == 0)
+            {
+                return;
+            }
+
+            if (state->runOne())
+            {
+                continue;
+            }
+
+            // Everything left is running on other threads. Sleep until one of those tasks
+            // finishes, then look again: it may have added more work to the group.
+            state->waiters.fetch_add(1);
+            state->pending.wait(pending, std::memory_order_acquire);
+            state->waiters.fetch_sub(1);
+        }
+    }
+
+    bool TaskGroup::isDone() const
+    {
+        return state->pending.load(std::memory_order_acquire) == 0;
+    }
+
+    std::exception_ptr TaskGroup::getFirstException() const
+    {
+        std::scoped_lock lock(state->exceptionMutex);
+        return state->firstException;
+    }
+
+    bool TaskGroup::State::runOne()
+    {
+        TaskSlot* slot = queue.pop();
+        if (!slot)
+        {
+            return false;
+        }
+
+        // A cancelled group still counts its dropped tasks down, so wait() returns right away.
+        if (!token.isCancelled())
+        {
+            try
+            {
+                slot->task();
+            }
+            catch (...)
+            {
+                detail::reportTaskException(std::current_exception());
+
+                std::scoped_lock lock(exceptionMutex);
+                if (!firstException)
+                {
+                    firstException = std::current_exception();
+                }
+            }
+        }
+
+        slot->task.reset();
+        slotPool->release(slot);
+        finishOne();
+        return true;
+    }
+
+    void TaskGroup::State::finishOne()
+    {
+        // Waiters sleep on the counter itself, so wake them on every completion, not only the last.
+        // Both sides use seq_cst so either the waiter sees the new count or we see the waiter.
+        if (pending.fetch_sub(1) == 1 || waiters.load() > 0)
+        {
+            pending.notify_all();
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "services/threading/CancellationToken.h"
+#include "services/threading/TaskSlotPool.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+
+    /**
+     * A set of tasks that can be waited on as a whole, without waiting for the rest of the pool.
+     *
+     * run() submits a task into the group, wait() returns once every task submitted so far has
+     * finished. Instead of sleeping, the waiting thread executes the group's tasks that no worker
+     * has picked up yet, so a main thread waiting on a scene load works on the load itself. It never
+     * picks up unrelated tasks, which could be long or wait on the main thread; that holds for
+     * workers too, so a save waiting for its exports doesn't end up running someone's import.
+     *
+     * The tasks wait in pooled TaskSlots on a lock-free stack, and run() posts one pool task per
+     * group task that runs whichever is next, so neither side locks or allocates once warmed up.
+     *
+     * Failures are logged like enqueue() failures; the first one is kept for getFirstException().
+     * Once the group's token is cancelled, tasks that have not started yet are dropped; running
+     * ones are expected to poll the same token and return early.
+     * The destructor waits, so a group never outlives the work it tracks.
+     */
+    class TaskGroup final
+    {
+    public:
+        explicit TaskGroup(ThreadPool& pool, CancellationToken token = {});
+        ~TaskGroup();
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template <typename Function>
+        void run(Function&& function);
+
+        void wait();
+
+        [[nodiscard]] bool isDone() const;
+        [[nodiscard]] const CancellationToken& getToken() const { return state->token; }
+        [[nodiscard]] std::exception_ptr getFirstException() const;
+
+    private:
+        // Shared with the pool tasks, so the last one can still signal after wait() returned and
+        // the group went away.
+        struct State
+        {
+            alignas(64) std::atomic<uint32_t> pending { 0 };
+            std::atomic<uint32_t> waiters { 0 };
+
+            CancellationToken token;
+
+            TaskSlotPool* slotPool;
+            // Tasks not started yet. Every pool task and every waiter takes whichever one is next,
+            // so a task runs exactly once no matter who gets to it first.
+            TaskSlotStack queue;
+
+            // Guards firstException; only task failures and getFirstException() take it.
+            mutable std::mutex exceptionMutex;
+            std::exception_ptr firstException;
+
+            explicit State(TaskSlotPool& slotPool) : slotPool(&slotPool), queue(slotPool) {}
+
+            bool runOne();
+            void finishOne();
+        };
+
+        ThreadPool* pool;
+        std::shared_ptr<State> state;
+    };
+
+    template <typename Function>
+    void TaskGroup::run(Function&& function)
+    {
+        TaskSlot* slot = state->slotPool->acquire();
+        slot->task.emplace(std::forward<Function>(function));
+        state->pending.fetch_add(1, std::memory_order_relaxed);
+        state->queue.push(slot);
+
+        pool->post([state = state] { state->runOne(); });
+    }
+
+}
@@ -0,0 +1,79 @@
+#include "TaskHandle.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "engine/EngineCore.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    void TaskStateBase::addContinuation(std::function<void()> continuation)
+    {
+        {
+            std::scoped_lock lock(continuationMutex);
+            if (!ready.load(std::memory_order_relaxed))
+            {
+                continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+
+        continuation();
+    }
+
+    void TaskStateBase::finish()
+    {
+        std::vector<std::function<void()>> pendingContinuations;
+        {
+            std::scoped_lock lock(continuationMutex);
+            ready.store(true, std::memory_order_release);
+            pendingContinuations.swap(continuations);
+        }
+        ready.notify_all();
+
+        for (auto& continuation : pendingContinuations)
+        {
+            continuation();
+        }
+    }
+
+    void TaskStateBase::wait() const
+    {
+        // A worker that blocks could be the only one able to run what it waits for. The awaited task's
+        // own lane is always allowed, so that stays true; anything less urgent than both is left alone.
+        if (pool && pool->isWorkerThread())
+        {
+            const TaskPriority lowestPriority = std::max(getCurrentTaskPriority(), priority);
+            while (!isReady())
+            {
+                if (!pool->tryRunPendingTask(lowestPriority))
+                {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+
+        ready.wait(false, std::memory_order_acquire);
+    }
+
+    namespace detail
+    {
+        void reportTaskException(const std::exception_ptr& exception)
+        {
+            try
+            {
+                std::rethrow_exception(exception);
+            }
+            catch (const std::exception& error)
+            {
+                LOG_ERROR(std::string("Task failed: ") + error.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("Task failed with an unknown exception.");
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "services/threading/TaskPriority.h"
+
+namespace parus
+{
+    class ThreadPool;
+
+    /**
+     * Shared completion state behind a TaskHandle. The producing task stores its result (or
+     * exception) and calls finish(); continuations registered before that run from finish(),
+     * continuations registered after it run immediately.
+     */
+    class TaskStateBase
+    {
+    public:
+        TaskStateBase(ThreadPool* pool, const TaskPriority priority) : pool(pool), priority(priority) {}
+        virtual ~TaskStateBase() = default;
+
+        [[nodiscard]] bool isReady() const { return ready.load(std::memory_order_acquire); }
+        [[nodiscard]] ThreadPool* getPool() const { return pool; }
+        /** Lane the producing task was submitted in. */
+        [[nodiscard]] TaskPriority getPriority() const { return priority; }
+
+        void addContinuation(std::function<void()> continuation);
+        void finish();
+
+        /**
+         * Blocks until finish() was called. Worker threads keep executing other tasks meanwhile, but
+         * only from lanes at least as urgent as both their own task and the awaited one, so a
+         * frame-critical wait never picks up a background import.
+         */
+        void wait() const;
+
+        std::exception_ptr exception;
+
+    private:
+        ThreadPool* pool;
+        TaskPriority priority;
+        std::atomic<bool> ready { false };
+        std::mutex continuationMutex;
+        std::vector<std::function<void()>> continuations;
+    };
+
+    template <typename T>
+    class TaskState final : public TaskStateBase
+    {
+    public:
+        using TaskStateBase::TaskStateBase;
+        std::optional<T> value;
+    };
+
+    template <>
+    class TaskState<void> final : public TaskStateBase
+    {
+    public:
+        using TaskStateBase::TaskStateBase;
+    };
+
+    namespace detail
+    {
+        /** Logs a task failure; the exception itself stays in the handle for get() to rethrow. */
+        void reportTaskException(const std::exception_ptr& exception);
+
+        /** Runs the function, stores its result or exception into the state and completes it. */
+        template <typename T, typename Function>
+        void fulfil(TaskState<T>& state, Function& function)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    function();
+                }
+                else
+                {
+                    state.value.emplace(function());
+                }
+            }
+            catch (...)
+            {
+                state.exception = std::current_exception();
+                reportTaskException(state.exception);
+            }
+
+            state.finish();
+        }
+    }
+
+    /**
+     * Typed handle to the result of a task submitted to the ThreadPool. Cheap to copy; all copies
+     * refer to the same task. Waiting only blocks on this task, not on the whole pool.
+     */
+    template <typename T>
+    class TaskHandle final
+    {
+    public:
+        using ValueType = T;
+
+        TaskHandle() = default;
+        explicit TaskHandle(std::shared_ptr<TaskState<T>> state) : state(std::move(state)) {}
+
+        [[nodiscard]] bool isValid() const { return state != nullptr; }
+        [[nodiscard]] bool isReady() const { return state && state->isReady(); }
+
+        void wait() const
+        {
+            if (state)
+            {
+                state->wait();
+            }
+        }
+
+        /** Waits for the task and returns its result; rethrows the exception the task failed with. */
+        std::add_lvalue_reference_t<const T> get() const
+        {
+            wait();
+            if (state->exception)
+            {
+                std::rethrow_exception(state->exception);
+            }
+
+            if constexpr (!std::is_void_v<T>)
+            {
+                return *state->value;
+            }
+        }
+
+        /**
+         * Schedules `continuation` on the pool once this task has finished. It receives the result
+         * (by const reference) unless T is void. If this task failed, the continuation is skipped
+         * and the returned handle carries the same exception.
+         */
+        template <typename Function>
+        auto then(Function&& continuation) const;
+
+    private:
+        std::shared_ptr<TaskState<T>> state;
+    };
+
+}
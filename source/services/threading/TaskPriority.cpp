@@ -0,0 +1,25 @@
+#include "TaskPriority.h"
+
+namespace parus
+{
+    namespace
+    {
+        thread_local TaskPriority currentPriority = TaskPriority::NORMAL;
+    }
+
+    TaskPriority getCurrentTaskPriority()
+    {
+        return currentPriority;
+    }
+
+    ScopedTaskPriority::ScopedTaskPriority(const TaskPriority priority)
+        : previous(currentPriority)
+    {
+        currentPriority = priority;
+    }
+
+    ScopedTaskPriority::~ScopedTaskPriority()
+    {
+        currentPriority = previous;
+    }
+}
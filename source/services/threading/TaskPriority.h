@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace parus
+{
+
+    /** Scheduling lane of a task; lower values run first. */
+    enum class TaskPriority : uint8_t
+    {
+        /** Work the current frame waits on (render preparation, per-frame updates). */
+        FRAME_CRITICAL,
+        /** Default lane. */
+        NORMAL,
+        /** Streaming and imports; may be capped per frame. */
+        BACKGROUND
+    };
+
+    inline constexpr size_t TASK_PRIORITY_COUNT = 3;
+
+    constexpr std::string_view toString(const TaskPriority priority)
+    {
+        switch (priority)
+        {
+        case TaskPriority::FRAME_CRITICAL: return "frame-critical";
+        case TaskPriority::NORMAL:         return "normal";
+        case TaskPriority::BACKGROUND:     return "background";
+        }
+        return "unknown";
+    }
+
+    /**
+     * Priority used by submissions that do not name one: the lane of the task running on this
+     * thread, so work spawned by an import stays in the background lane. NORMAL outside tasks.
+     */
+    TaskPriority getCurrentTaskPriority();
+
+    /** Sets the current thread's default submission priority until the scope ends. */
+    class ScopedTaskPriority final
+    {
+    public:
+        explicit ScopedTaskPriority(TaskPriority priority);
+        ~ScopedTaskPriority();
+        ScopedTaskPriority(const ScopedTaskPriority&) = delete;
+        ScopedTaskPriority& operator=(const ScopedTaskPriority&) = delete;
+
+    private:
+        TaskPriority previous;
+    };
+
+}
@@ -0,0 +1,93 @@
+#include "TaskSlotPool.h"
+
+#include "engine/EngineCore.h"
+
+namespace parus
+{
+    TaskSlotPool::~TaskSlotPool()
+    {
+        for (auto& chunk : chunks)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    void TaskSlotStack::push(TaskSlot* slot)
+    {
+        uint64_t current = head.load(std::memory_order_relaxed);
+        do
+        {
+            slot->next.store(headIndex(current), std::memory_order_relaxed);
+        }
+        while (!head.compare_exchange_weak(current, packHead(slot->index, headTag(current) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    TaskSlot* TaskSlotStack::pop()
+    {
+        uint64_t current = head.load(std::memory_order_acquire);
+        while (headIndex(current) != EMPTY)
+        {
+            TaskSlot* slot = pool->slotAt(headIndex(current));
+            // May be stale if another thread pops and re-pushes this slot meanwhile; the tag makes the CAS fail then.
+            const uint32_t next = slot->next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(current, packHead(next, headTag(current) + 1), std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return slot;
+            }
+        }
+
+        return nullptr;
+    }
+
+    TaskSlot* TaskSlotPool::acquire()
+    {
+        if (TaskSlot* slot = freeSlots.pop())
+        {
+            return slot;
+        }
+
+        return grow();
+    }
+
+    void TaskSlotPool::release(TaskSlot* slot)
+    {
+        DEBUG_ASSERT(!slot->task, "Task slot must be emptied before it is released.");
+        freeSlots.push(slot);
+    }
+
+    TaskSlot* TaskSlotPool::slotAt(const uint32_t index) const
+    {
+        return &chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+    }
+
+    TaskSlot* TaskSlotPool::grow()
+    {
+        std::scoped_lock lock(growMutex);
+
+        // Another thread may have grown the pool while we waited for the lock.
+        if (TaskSlot* slot = freeSlots.pop())
+        {
+            return slot;
+        }
+
+        const uint32_t firstIndex = capacity.load(std::memory_order_relaxed);
+        const uint32_t chunkIndex = firstIndex >> CHUNK_SHIFT;
+        ASSERT(chunkIndex < MAX_CHUNKS, "Task slot pool exhausted: too many tasks in flight.");
+
+        auto* chunk = new TaskSlot[CHUNK_SIZE];
+        for (uint32_t i = 0; i < CHUNK_SIZE; ++i)
+        {
+            chunk[i].index = firstIndex + i;
+        }
+        chunks[chunkIndex].store(chunk, std::memory_order_release);
+        capacity.store(firstIndex + CHUNK_SIZE, std::memory_order_relaxed);
+
+        // Keep the first slot for the caller, hand the rest to the free list.
+        for (uint32_t i = CHUNK_SIZE - 1; i > 0; --i)
+        {
+            freeSlots.push(&chunk[i]);
+        }
+
+        return &chunk[0];
+    }
+}
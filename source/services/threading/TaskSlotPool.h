@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "services/threading/Task.h"
+#include "services/threading/TaskPriority.h"
+
+namespace parus
+{
+
+    /** A pooled Task plus its bookkeeping; queues pass these around by pointer. */
+    struct TaskSlot
+    {
+        Task task;
+        TaskPriority priority = TaskPriority::NORMAL;
+        uint32_t index = 0;
+        /** Index of the next slot in whichever TaskSlotStack holds this one. */
+        std::atomic<uint32_t> next { 0 };
+    };
+
+    class TaskSlotPool;
+
+    /**
+     * Lock-free LIFO of TaskSlots from one TaskSlotPool (a Treiber stack). Slots are linked by index
+     * through TaskSlot::next and the head carries a tag that changes on every update to rule out
+     * ABA. A popper may read the link of a slot another thread just took, which is harmless because
+     * pool slots are never freed while the pool lives.
+     */
+    class TaskSlotStack final
+    {
+    public:
+        explicit TaskSlotStack(const TaskSlotPool& pool) : pool(&pool) {}
+        TaskSlotStack(const TaskSlotStack&) = delete;
+        TaskSlotStack& operator=(const TaskSlotStack&) = delete;
+
+        void push(TaskSlot* slot);
+        /** Returns nullptr if the stack is empty. */
+        [[nodiscard]] TaskSlot* pop();
+
+    private:
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        static uint64_t packHead(const uint32_t index, const uint32_t tag) { return (static_cast<uint64_t>(tag) << 32) | index; }
+        static uint32_t headIndex(const uint64_t head) { return static_cast<uint32_t>(head); }
+        static uint32_t headTag(const uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+        const TaskSlotPool* pool;
+        alignas(64) std::atomic<uint64_t> head { packHead(EMPTY, 0) };
+    };
+
+    /**
+     * Recycles TaskSlots so that submitting a task does not allocate once the pool has warmed up.
+     * Free slots form a TaskSlotStack. Slots are allocated in chunks whose addresses never change,
+     * and are only freed with the pool.
+     */
+    class TaskSlotPool final
+    {
+    public:
+        TaskSlotPool() = default;
+        ~TaskSlotPool();
+        TaskSlotPool(const TaskSlotPool&) = delete;
+        TaskSlotPool& operator=(const TaskSlotPool&) = delete;
+
+        [[nodiscard]] TaskSlot* acquire();
+
+        /** The slot's task must already be empty. */
+        void release(TaskSlot* slot);
+
+        /** Number of slots allocated so far (free or in use). */
+        [[nodiscard]] uint32_t getCapacity() const { return capacity.load(std::memory_order_relaxed); }
+
+        /** The slot whose TaskSlot::index is index; it must have been allocated already. */
+        [[nodiscard]] TaskSlot* slotAt(uint32_t index) const;
+
+    private:
+        static constexpr uint32_t CHUNK_SHIFT = 10;
+        static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_SHIFT;
+        static constexpr uint32_t MAX_CHUNKS = 4096;
+
+        TaskSlot* grow();
+
+        std::array<std::atomic<TaskSlot*>, MAX_CHUNKS> chunks {};
+        std::atomic<uint32_t> capacity { 0 };
+        std::mutex growMutex;
+
+        TaskSlotStack freeSlots { *this };
+    };
+
+}
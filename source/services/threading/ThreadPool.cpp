@@ -1,93 +1,481 @@
 #include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
 #include "engine/EngineCore.h"
+#include "services/Services.h"
+#include "services/console/Console.h"
+#include "services/threading/CpuTopology.h"
 
 namespace parus
 {
-    ThreadPool::~ThreadPool()
+    namespace
     {
+        // Spin rounds an idle worker spends looking for work before it goes to sleep.
+        constexpr int IDLE_SPIN_COUNT = 64;
+
+        constexpr size_t BACKGROUND_LANE = static_cast<size_t>(TaskPriority::BACKGROUND);
+
+        thread_local const ThreadPool* currentPool = nullptr;
+        thread_local unsigned int currentWorkerIndex = 0;
+        thread_local uint32_t stealSeed = 0;
+        thread_local uint32_t pickCount = 0;
+
+        uint32_t nextRandom()
         {
-            std::lock_guard lock(queueMutex);
-            isPendingStop = true;
+            // xorshift32; only used to spread thieves across victims.
+            uint32_t value = stealSeed;
+            if (value == 0)
+            {
+                // Non-worker threads that help out seed lazily from their id.
+                value = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+            }
+            value ^= value << 13;
+            value ^= value >> 17;
+            value ^= value << 5;
+            stealSeed = value;
+            return value;
+        }
+
+        int64_t nowNanoseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
         }
+    }
 
-        conditionVariable.notify_all();
+    ThreadPool::~ThreadPool()
+    {
+        isPendingStop.store(true);
+        workSignal.fetch_add(1);
+        workSignal.notify_all();
+        wakeStallWatcher();
 
         for (auto& worker : workers)
         {
             worker.join();
         }
+
+        // Only reachable if tasks were enqueued into a pool that was never initialized.
+        for (auto& injectionQueue : injectionQueues)
+        {
+            while (TaskSlot* slot = injectionQueue.pop())
+            {
+                slot->task.reset();
+                slotPool.release(slot);
+            }
+        }
     }
 
-    void ThreadPool::workerJob()
+    void ThreadPool::workerJob(const unsigned int workerIndex)
     {
+        currentPool = this;
+        currentWorkerIndex = workerIndex;
+        stealSeed = 0x9E3779B9u * (workerIndex + 1);
+
+        setCurrentThreadName("Parus Worker " + std::to_string(workerIndex));
+        if (!workerCpus.empty())
+        {
+            const unsigned int cpu = workerCpus[workerIndex % workerCpus.size()];
+            if (!pinCurrentThreadToCpu(cpu))
+            {
+                LOG_WARNING("Failed to pin worker " + std::to_string(workerIndex) + " to CPU " + std::to_string(cpu) + ".");
+            }
+        }
+
         while (true)
         {
-            std::function<void()> newTask;
-            
+            TaskSlot* task = nullptr;
+            for (int spin = 0; spin < IDLE_SPIN_COUNT && !task; ++spin)
             {
-                std::unique_lock lock(queueMutex);
-                conditionVariable.wait(lock, [&]()
+                task = findTask();
+                if (!task)
                 {
-                   return isPendingStop || !tasks.empty(); 
-                });
+                    std::this_thread::yield();
+                }
+            }
+
+            if (task)
+            {
+                execute(task);
+                continue;
+            }
+
+            // Read the signal before the final check, so a submission that lands in between
+            // changes it and the wait below returns immediately instead of missing the wakeup.
+            const uint32_t observedSignal = workSignal.load();
+            if ((task = findTask()))
+            {
+                execute(task);
+                continue;
+            }
+
+            // Exit condition.
+            if (isPendingStop.load())
+            {
+                return;
+            }
 
-                // Exit condition.
-                if (isPendingStop && tasks.empty())
+            // Background work held back by the frame cap: beginFrame() wakes everyone parked below.
+            // One worker waits with a timeout instead, so the cap still lifts if frames stall.
+            if (isBackgroundThrottled() && getQueueDepth(TaskPriority::BACKGROUND) > 0 && !isWatchingStall.exchange(true))
+            {
+                waitForFrameOrStall(observedSignal);
+                isWatchingStall.store(false);
+                continue;
+            }
+
+            sleepingWorkers.fetch_add(1);
+            workSignal.wait(observedSignal);
+            sleepingWorkers.fetch_sub(1);
+        }
+    }
+
+    TaskSlot* ThreadPool::findTask(const size_t laneCount)
+    {
+        const bool isWorker = isWorkerThread();
+
+        // Highest lane first, but periodically lowest first so a busy lane cannot starve the rest.
+        const bool isStarvationPick = ++pickCount % static_cast<uint32_t>(settings.starvationInterval) == 0;
+        for (size_t i = 0; i < laneCount; ++i)
+        {
+            const size_t lane = isStarvationPick ? laneCount - 1 - i : i;
+            if (lane != BACKGROUND_LANE)
+            {
+                if (TaskSlot* task = findTaskInLane(lane, isWorker))
                 {
-                    return;
+                    return task;
                 }
+                continue;
+            }
 
-                newTask = std::move(tasks.front());
-                tasks.pop();
-                ++activeTasks;
+            bool isFromBudget = false;
+            if (!tryClaimBackgroundTask(isFromBudget))
+            {
+                continue;
             }
 
-            newTask();
+            if (TaskSlot* task = findTaskInLane(lane, isWorker))
+            {
+                return task;
+            }
 
+            if (isFromBudget)
             {
-                std::scoped_lock completionLock(queueMutex);
-                --activeTasks;
+                backgroundBudget.fetch_add(1);
             }
-            completionVariable.notify_all();
         }
+
+        return nullptr;
+    }
+
+    TaskSlot* ThreadPool::findTaskInLane(const size_t lane, const bool isWorker)
+    {
+        if (isWorker)
+        {
+            if (TaskSlot* task = localQueues[currentWorkerIndex]->lanes[lane].pop())
+            {
+                return task;
+            }
+        }
+
+        if (TaskSlot* task = injectionQueues[lane].pop())
+        {
+            return task;
+        }
+
+        const auto queueCount = static_cast<unsigned int>(localQueues.size());
+        if (queueCount == 0)
+        {
+            return nullptr;
+        }
+
+        const unsigned int firstVictim = nextRandom() % queueCount;
+        for (unsigned int i = 0; i < queueCount; ++i)
+        {
+            const unsigned int victim = (firstVictim + i) % queueCount;
+            if (isWorker && victim == currentWorkerIndex)
+            {
+                continue;
+            }
+
+            if (TaskSlot* task = localQueues[victim]->lanes[lane].steal())
+            {
+                return task;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void ThreadPool::execute(TaskSlot* slot)
+    {
+        {
+            // Work the task submits inherits its lane.
+            const ScopedTaskPriority priority(slot->priority);
+            slot->task();
+        }
+        slot->task.reset();
+        slotPool.release(slot);
+
+        if (pendingTasks.fetch_sub(1) == 1)
+        {
+            pendingTasks.notify_all();
+        }
+    }
+
+    void ThreadPool::wakeOneWorker()
+    {
+        workSignal.fetch_add(1);
+        if (sleepingWorkers.load() > 0)
+        {
+            workSignal.notify_one();
+        }
+        else
+        {
+            // The stall watcher may be the only idle worker left.
+            wakeStallWatcher();
+        }
+    }
+
+    void ThreadPool::waitForFrameOrStall(const uint32_t observedSignal)
+    {
+        const int64_t stallNanoseconds = frameStartNanoseconds.load(std::memory_order_relaxed)
+            + static_cast<int64_t>(settings.stalledFrameMilliseconds) * 1'000'000;
+        const auto deadline = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(stallNanoseconds));
+
+        bool isSignalled = false;
+        {
+            std::unique_lock lock(stallMutex);
+            isSignalled = stallCondition.wait_until(lock, deadline, [&] { return workSignal.load() != observedSignal; });
+        }
+
+        if (!isSignalled)
+        {
+            // The frame stalled and lifted the cap: let the parked workers help with the backlog.
+            workSignal.fetch_add(1);
+            workSignal.notify_all();
+        }
+    }
+
+    void ThreadPool::wakeStallWatcher()
+    {
+        // Every caller changes workSignal first: either the watcher's predicate sees that change,
+        // or the watcher is already registered here and the notify reaches it.
+        if (isWatchingStall.load())
+        {
+            std::scoped_lock lock(stallMutex);
+            stallCondition.notify_all();
+        }
+    }
+
+    bool ThreadPool::tryClaimBackgroundTask(bool& isFromBudget)
+    {
+        isFromBudget = false;
+        // Shutting down drains every lane, capped or not.
+        if (!isBackgroundThrottled() || isPendingStop.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+
+        int budget = backgroundBudget.load(std::memory_order_relaxed);
+        while (budget > 0)
+        {
+            if (backgroundBudget.compare_exchange_weak(budget, budget - 1, std::memory_order_relaxed))
+            {
+                isFromBudget = true;
+                return true;
+            }
+        }
+
+        return isFrameStalled();
+    }
+
+    bool ThreadPool::isBackgroundThrottled() const
+    {
+        // No frames yet (tools, tests, loading before the main loop) means no cap.
+        return settings.backgroundTasksPerFrame > 0 && frameStartNanoseconds.load(std::memory_order_relaxed) != 0;
+    }
+
+    bool ThreadPool::isFrameStalled() const
+    {
+        const int64_t frameLength = nowNanoseconds() - frameStartNanoseconds.load(std::memory_order_relaxed);
+        return frameLength > static_cast<int64_t>(settings.stalledFrameMilliseconds) * 1'000'000;
     }
 
     unsigned int ThreadPool::defaultThreadCount()
     {
-        const unsigned int cores = std::thread::hardware_concurrency();
-        return cores > 1 ? cores - 1 : 1;
+        return CpuTopology::detect().getDefaultWorkerCount(false);
     }
 
     void ThreadPool::init(const unsigned int numberOfThreads)
     {
-        LOG_INFO("Initializing Thread Pool with " + std::to_string(numberOfThreads) + " threads.");
+        ThreadPoolSettings newSettings;
+        newSettings.threadCount = numberOfThreads;
+        init(newSettings);
+    }
+
+    void ThreadPool::init(const ThreadPoolSettings& newSettings)
+    {
+        ASSERT(workers.empty(), "Thread Pool is already initialized.");
+        ASSERT(newSettings.starvationInterval > 0, "Thread Pool starvation interval must be positive.");
+
+        settings = newSettings;
+
+        const CpuTopology topology = CpuTopology::detect();
+        if (settings.threadCount == 0)
+        {
+            settings.threadCount = topology.getDefaultWorkerCount(settings.countSmtThreads);
+        }
+        const unsigned int numberOfThreads = settings.threadCount;
+
+        LOG_INFO("Initializing Thread Pool with " + std::to_string(numberOfThreads) + " threads ("
+            + std::to_string(topology.getPhysicalCoreCount()) + " physical cores, "
+            + std::to_string(topology.getLogicalCpuCount()) + " logical CPUs).");
+
+        if (settings.pinMainThread && !pinCurrentThreadToCpu(topology.physicalCores.front().front()))
+        {
+            LOG_WARNING("Failed to pin the main thread.");
+        }
+
+        // Read by the workers as they start, so it must be filled in before the first one is created.
+        if (settings.pinWorkers)
+        {
+            workerCpus = topology.getWorkerCpuOrder();
+        }
+
+        // Every deque must exist before the first worker starts stealing.
         for (unsigned int i = 0; i < numberOfThreads; ++i)
         {
-            workers.emplace_back(&ThreadPool::workerJob, this);
+            localQueues.emplace_back(std::make_unique<WorkerQueues>());
+        }
+
+        for (unsigned int i = 0; i < numberOfThreads; ++i)
+        {
+            workers.emplace_back(&ThreadPool::workerJob, this, i);
+        }
+    }
+
+    void ThreadPool::submit(TaskSlot* slot)
+    {
+        pendingTasks.fetch_add(1);
+
+        const auto lane = static_cast<size_t>(slot->priority);
+        if (isWorkerThread() && localQueues[currentWorkerIndex]->lanes[lane].push(slot))
+        {
+            wakeOneWorker();
+            return;
+        }
+
+        while (!injectionQueues[lane].push(slot))
+        {
+            if (isWorkerThread())
+            {
+                // Both our deque and the injection queue are full: make progress ourselves rather
+                // than wait for a queue slot that only the workers (including us) can free.
+                execute(slot);
+                return;
+            }
+            std::this_thread::yield();
         }
+
+        wakeOneWorker();
     }
 
-    void ThreadPool::enqueue(std::function<void()> task)
+    void ThreadPool::beginFrame()
     {
+        frameStartNanoseconds.store(nowNanoseconds(), std::memory_order_relaxed);
+        if (settings.backgroundTasksPerFrame <= 0)
+        {
+            return;
+        }
+
+        backgroundBudget.store(settings.backgroundTasksPerFrame, std::memory_order_relaxed);
+        if (getQueueDepth(TaskPriority::BACKGROUND) > 0)
         {
-            std::scoped_lock lock(queueMutex);
-            tasks.emplace(std::move(task));
+            workSignal.fetch_add(1);
+            workSignal.notify_all();
+            wakeStallWatcher();
         }
-        conditionVariable.notify_all();
     }
 
     void ThreadPool::waitUntilDone()
     {
-        std::unique_lock lock(queueMutex);
-        completionVariable.wait(lock, [&]()
+        uint32_t pending = pendingTasks.load();
+        while (pending != 0)
         {
-            return tasks.empty() && activeTasks == 0;
-        });
+            pendingTasks.wait(pending);
+            pending = pendingTasks.load();
+        }
+    }
+
+    bool ThreadPool::tryRunPendingTask(const TaskPriority lowestPriority)
+    {
+        if (TaskSlot* task = findTask(static_cast<size_t>(lowestPriority) + 1))
+        {
+            execute(task);
+            return true;
+        }
+
+        return false;
     }
 
     bool ThreadPool::isBusy() const
     {
-        std::scoped_lock lock(queueMutex);
-        return !tasks.empty() || activeTasks > 0;
+        return pendingTasks.load() != 0;
+    }
+
+    bool ThreadPool::isWorkerThread() const
+    {
+        return currentPool == this;
+    }
+
+    size_t ThreadPool::getQueueDepth(const TaskPriority priority) const
+    {
+        const auto lane = static_cast<size_t>(priority);
+
+        size_t depth = injectionQueues[lane].sizeApprox();
+        for (const auto& queues : localQueues)
+        {
+            depth += static_cast<size_t>(std::max<int64_t>(0, queues->lanes[lane].sizeApprox()));
+        }
+        return depth;
+    }
+
+    int ThreadPool::getBackgroundBudget() const
+    {
+        return isBackgroundThrottled() ? backgroundBudget.load(std::memory_order_relaxed) : -1;
+    }
+
+    void ThreadPool::registerConsoleCommands()
+    {
+        Services::get<Console>()->registerConsoleCommand("threads", [this](const std::vector<std::string>& /*args*/, CommandContext& out)
+        {
+            out.write("Threads: " + std::to_string(getThreadCount()) + ", running or queued tasks: " + std::to_string(pendingTasks.load()));
+
+            for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+            {
+                const auto priority = static_cast<TaskPriority>(lane);
+                out.write("\t" + std::string(toString(priority)) + ": " + std::to_string(getQueueDepth(priority)) + " queued");
+            }
+
+            if (!workerCpus.empty())
+            {
+                std::string pinning;
+                for (unsigned int worker = 0; worker < getThreadCount(); ++worker)
+                {
+                    pinning += (worker > 0 ? ", " : "") + std::to_string(workerCpus[worker % workerCpus.size()]);
+                }
+                out.write("\tworkers pinned to CPUs: " + pinning);
+            }
+
+            if (settings.backgroundTasksPerFrame > 0)
+            {
+                const int budget = getBackgroundBudget();
+                out.write("\tbackground budget: " + (budget < 0 ? std::string("not capped yet") : std::to_string(budget))
+                    + " of " + std::to_string(settings.backgroundTasksPerFrame) + " per frame");
+            }
+        });
     }
-}
\ No newline at end of file
+}
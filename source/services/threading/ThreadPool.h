@@ -1,15 +1,45 @@
 #pragma once
-#include <functional>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
 #include "services/Service.h"
+#include "services/threading/CancellationToken.h"
+#include "services/threading/MpmcQueue.h"
+#include "services/threading/Task.h"
+#include "services/threading/TaskHandle.h"
+#include "services/threading/TaskPriority.h"
+#include "services/threading/TaskSlotPool.h"
+#include "services/threading/ThreadPoolSettings.h"
+#include "services/threading/WorkStealingQueue.h"
 
 namespace parus
 {
-    
+
+    /**
+     * Work-stealing job scheduler.
+     *
+     * Every worker owns a lock-free deque: tasks enqueued from a worker go to its own deque and are
+     * popped LIFO, idle workers steal FIFO from the others. Tasks enqueued from any other thread
+     * (main thread, renderer) go through a lock-free MPMC injection queue. Idle workers sleep on an
+     * atomic wait and each submission wakes at most one of them.
+     *
+     * enqueue() returns a TaskHandle to wait on that one task or chain continuations onto it;
+     * TaskGraph builds larger dependency graphs. post() is the fire-and-forget path: the callable
+     * is stored inline in a pooled Task, so it does not allocate once the pool has warmed up.
+     *
+     * Every task runs in one of three priority lanes (see TaskPriority), each with its own deques
+     * and injection queue. Threads look in the frame-critical lane first, except on every
+     * starvationInterval-th pick, when they start from the background lane. Background tasks can be
+     * capped per frame; beginFrame() refills that budget and wakes the workers parked on it.
+     *
+     * Workers are named "Parus Worker <index>" for debuggers and profilers. By default there is one
+     * per physical core but the main thread's; ThreadPoolSettings can pin them to cores.
+     */
     class ThreadPool final : public Service
     {
     public:
@@ -20,26 +50,197 @@ namespace parus
         ThreadPool& operator=(const ThreadPool&) = delete;
         ThreadPool& operator=(const ThreadPool&&) = delete;
 
+        /** One worker per physical core, minus one for the main thread. */
         static unsigned int defaultThreadCount();
 
         void init(unsigned int numberOfThreads = defaultThreadCount());
-        void enqueue(std::function<void()> task);
+        void init(const ThreadPoolSettings& newSettings);
+
+        /** Submits a task and returns a handle to its result. */
+        template <typename Function>
+        auto enqueue(TaskPriority priority, Function&& function) -> TaskHandle<std::invoke_result_t<std::decay_t<Function>&>>;
+
+        /** Submits with the current task's priority (see getCurrentTaskPriority()). */
+        template <typename Function>
+        auto enqueue(Function&& function)
+        {
+            return enqueue(getCurrentTaskPriority(), std::forward<Function>(function));
+        }
+
+        /** Fire-and-forget submission: no handle, an escaping exception terminates the program. */
+        template <typename Function>
+        void post(const TaskPriority priority, Function&& function)
+        {
+            TaskSlot* slot = slotPool.acquire();
+            slot->task.emplace(std::forward<Function>(function));
+            slot->priority = priority;
+            submit(slot);
+        }
+
+        template <typename Function>
+        void post(Function&& function)
+        {
+            post(getCurrentTaskPriority(), std::forward<Function>(function));
+        }
+
+        /** Like post(), but the task is dropped if the token is cancelled before a thread starts it. */
+        template <typename Function>
+        void post(const TaskPriority priority, CancellationToken token, Function&& function)
+        {
+            post(priority, [token = std::move(token), function = std::forward<Function>(function)]() mutable
+            {
+                if (!token.isCancelled())
+                {
+                    function();
+                }
+            });
+        }
+
+        /** Called by the main loop at the start of every frame: refills the background budget. */
+        void beginFrame();
+
+        /** Waits for every task in the pool, including ones other systems submitted. Prefer a TaskHandle. */
         void waitUntilDone();
 
+        /**
+         * Runs one queued task on the calling thread, if there is one in a lane no less urgent than
+         * lowestPriority. Used by waits that help instead of blocking.
+         */
+        bool tryRunPendingTask(TaskPriority lowestPriority = TaskPriority::BACKGROUND);
+
         [[nodiscard]] bool isBusy() const;
-        
+        [[nodiscard]] unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+        /** True if the calling thread is one of this pool's workers. */
+        [[nodiscard]] bool isWorkerThread() const;
+
+        /** Tasks waiting in a lane, across all queues. Approximate while workers are running. */
+        [[nodiscard]] size_t getQueueDepth(TaskPriority priority) const;
+
+        /** Background tasks that may still start this frame; negative if the lane is not capped. */
+        [[nodiscard]] int getBackgroundBudget() const;
+
+        [[nodiscard]] const ThreadPoolSettings& getSettings() const { return settings; }
+
+        /** Where post() takes its TaskSlots from; TaskGroup keeps its unstarted tasks in slots from here too. */
+        [[nodiscard]] TaskSlotPool& getSlotPool() { return slotPool; }
+
+        /** Registers the `threads` console command, which prints the per-lane queue depth. */
+        void registerConsoleCommands();
+
     private:
-        void workerJob();
-        
+        struct WorkerQueues
+        {
+            std::array<WorkStealingQueue<TaskSlot>, TASK_PRIORITY_COUNT> lanes;
+        };
+
+        void workerJob(unsigned int workerIndex);
+        void submit(TaskSlot* slot);
+        TaskSlot* findTask(size_t laneCount = TASK_PRIORITY_COUNT);
+        TaskSlot* findTaskInLane(size_t lane, bool isWorker);
+        void execute(TaskSlot* slot);
+        void wakeOneWorker();
+        void waitForFrameOrStall(uint32_t observedSignal);
+        void wakeStallWatcher();
+
+        bool tryClaimBackgroundTask(bool& isFromBudget);
+        bool isBackgroundThrottled() const;
+        bool isFrameStalled() const;
+
+        ThreadPoolSettings settings;
         std::vector<std::thread> workers;
-        std::queue<std::function<void()>> tasks;
-        mutable std::mutex queueMutex;
-        std::condition_variable conditionVariable;
-        std::condition_variable completionVariable;
-        unsigned int activeTasks = 0;
-        bool isPendingStop = false;
+        // Logical CPU per worker (index modulo size) when settings.pinWorkers is set, empty otherwise.
+        std::vector<unsigned int> workerCpus;
+        std::vector<std::unique_ptr<WorkerQueues>> localQueues;
+        std::array<MpmcQueue<TaskSlot>, TASK_PRIORITY_COUNT> injectionQueues;
+        TaskSlotPool slotPool;
+
+        // Bumped on every submission; sleeping workers wait for it to change.
+        alignas(64) std::atomic<uint32_t> workSignal { 0 };
+        alignas(64) std::atomic<uint32_t> sleepingWorkers { 0 };
+        // Submitted but not yet finished; waitUntilDone() waits for it to reach zero.
+        alignas(64) std::atomic<uint32_t> pendingTasks { 0 };
+        std::atomic<bool> isPendingStop { false };
+
+        // Background tasks left this frame, and when the frame began (0 until the first beginFrame()).
+        alignas(64) std::atomic<int> backgroundBudget { 0 };
+        std::atomic<int64_t> frameStartNanoseconds { 0 };
+
+        // The one idle worker that sleeps until the frame stalls instead of until the next signal.
+        std::atomic<bool> isWatchingStall { false };
+        std::mutex stallMutex;
+        std::condition_variable stallCondition;
     };
 
-#define RUN_ASYNC(function) Services::get<ThreadPool>()->enqueue([=]{function})
-    
+    template <typename Function>
+    auto ThreadPool::enqueue(const TaskPriority priority, Function&& function) -> TaskHandle<std::invoke_result_t<std::decay_t<Function>&>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<Function>&>;
+
+        auto state = std::make_shared<TaskState<Result>>(this, priority);
+        post(priority, [state, function = std::forward<Function>(function)]() mutable
+        {
+            detail::fulfil(*state, function);
+        });
+
+        return TaskHandle<Result>(std::move(state));
+    }
+
+    namespace detail
+    {
+        template <typename Function, typename T>
+        struct ContinuationResult
+        {
+            using Type = std::invoke_result_t<Function&, const T&>;
+        };
+
+        template <typename Function>
+        struct ContinuationResult<Function, void>
+        {
+            using Type = std::invoke_result_t<Function&>;
+        };
+    }
+
+    template <typename T>
+    template <typename Function>
+    auto TaskHandle<T>::then(Function&& continuation) const
+    {
+        using Result = typename detail::ContinuationResult<std::decay_t<Function>, T>::Type;
+
+        ThreadPool* pool = state->getPool();
+        // Continuations run in the lane of whoever chained them, not of whoever finished first.
+        const TaskPriority priority = getCurrentTaskPriority();
+        auto nextState = std::make_shared<TaskState<Result>>(pool, priority);
+
+        state->addContinuation([pool, priority, previous = state, nextState, function = std::forward<Function>(continuation)]() mutable
+        {
+            pool->post(priority, [previous, nextState, function = std::move(function)]() mutable
+            {
+                if (previous->exception)
+                {
+                    nextState->exception = previous->exception;
+                    nextState->finish();
+                    return;
+                }
+
+                auto invoke = [&]() -> Result
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        return function();
+                    }
+                    else
+                    {
+                        return function(*previous->value);
+                    }
+                };
+                detail::fulfil(*nextState, invoke);
+            });
+        });
+
+        return TaskHandle<Result>(std::move(nextState));
+    }
+
+#define RUN_ASYNC(function) Services::get<ThreadPool>()->post([=]{function})
+
 }
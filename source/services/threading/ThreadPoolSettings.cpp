@@ -0,0 +1,25 @@
+#include "ThreadPoolSettings.h"
+
+#include <algorithm>
+
+#include "services/config/Configs.h"
+
+namespace parus
+{
+    ThreadPoolSettings ThreadPoolSettings::fromConfigs(Configs& configs)
+    {
+        constexpr auto GROUP = "Threading";
+        const ThreadPoolSettings defaults;
+
+        ThreadPoolSettings settings;
+        settings.threadCount = static_cast<unsigned int>(std::max(0, configs.getOrDefault<int>(GROUP, "threadCount", 0)));
+        settings.countSmtThreads = configs.getOrDefault<bool>(GROUP, "countSmtThreads", defaults.countSmtThreads);
+        settings.pinWorkers = configs.getOrDefault<bool>(GROUP, "pinWorkers", defaults.pinWorkers);
+        settings.pinMainThread = configs.getOrDefault<bool>(GROUP, "pinMainThread", defaults.pinMainThread);
+        settings.backgroundTasksPerFrame = std::max(0, configs.getOrDefault<int>(GROUP, "backgroundTasksPerFrame", defaults.backgroundTasksPerFrame));
+        settings.starvationInterval = std::max(1, configs.getOrDefault<int>(GROUP, "starvationInterval", defaults.starvationInterval));
+        settings.stalledFrameMilliseconds = std::max(1, configs.getOrDefault<int>(GROUP, "stalledFrameMilliseconds", defaults.stalledFrameMilliseconds));
+        settings.mainThreadCallbacksPerFrame = std::max(0, configs.getOrDefault<int>(GROUP, "mainThreadCallbacksPerFrame", defaults.mainThreadCallbacksPerFrame));
+        return settings;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace parus
+{
+    class Configs;
+
+    /** ThreadPool tuning, read from the [Threading] section of config/engine.ini. */
+    struct ThreadPoolSettings
+    {
+        /** Worker count; 0 sizes the pool from the CPU topology (see CpuTopology::getDefaultWorkerCount()). */
+        unsigned int threadCount = 0;
+
+        /** With threadCount = 0: one worker per logical CPU instead of per physical core. */
+        bool countSmtThreads = false;
+
+        /** Pins every worker to one logical CPU, keeping them off the main thread's core (see CpuTopology::getWorkerCpuOrder()). */
+        bool pinWorkers = false;
+
+        /** Pins the thread that calls ThreadPool::init() (the main thread) to the first core. */
+        bool pinMainThread = false;
+
+        /** Background tasks started per frame (see ThreadPool::beginFrame()); 0 means unlimited. */
+        int backgroundTasksPerFrame = 0;
+
+        /** Every n-th task a thread picks is looked up lowest lane first, so busy lanes cannot starve the others. */
+        int starvationInterval = 32;
+
+        /** The background cap is ignored once a frame runs this long, so a blocked main thread cannot stall it forever. */
+        int stalledFrameMilliseconds = 250;
+
+        /** MainThreadQueue callbacks the main loop runs per frame; 0 means all of them. */
+        int mainThreadCallbacksPerFrame = 64;
+
+        /** Reads the [Threading] section; missing or invalid keys keep their defaults. */
+        static ThreadPoolSettings fromConfigs(Configs& configs);
+    };
+}
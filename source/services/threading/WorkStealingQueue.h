@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace parus
+{
+
+    /**
+     * Bounded Chase-Lev deque of pointers. The owning worker pushes and pops at the bottom (LIFO,
+     * cache-warm); any other thread steals from the top (FIFO). Only push/pop may be called by the
+     * owner, steal may be called by anyone. Lock-free; based on Le et al., "Correct and Efficient
+     * Work-Stealing for Weak Memory Models" (PPoPP 2013).
+     */
+    template <typename T>
+    class WorkStealingQueue final
+    {
+    public:
+        explicit WorkStealingQueue(const int64_t capacityPowerOfTwo = 4096)
+            : capacity(capacityPowerOfTwo)
+            , mask(capacityPowerOfTwo - 1)
+            , buffer(std::make_unique<std::atomic<T*>[]>(static_cast<size_t>(capacityPowerOfTwo)))
+        {
+        }
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+        /** Owner only. Returns false if the deque is full; the caller must place the item elsewhere. */
+        bool push(T* item)
+        {
+            const int64_t currentBottom = bottom.load(std::memory_order_relaxed);
+            const int64_t currentTop = top.load(std::memory_order_acquire);
+            if (currentBottom - currentTop >= capacity)
+            {
+                return false;
+            }
+
+            buffer[currentBottom & mask].store(item, std::memory_order_relaxed);
+            bottom.store(currentBottom + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /** Owner only. Returns nullptr if the deque is empty or the last item was stolen concurrently. */
+        T* pop()
+        {
+            const int64_t newBottom = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(newBottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t currentTop = top.load(std::memory_order_relaxed);
+
+            if (currentTop > newBottom)
+            {
+                bottom.store(newBottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = buffer[newBottom & mask].load(std::memory_order_relaxed);
+            if (currentTop == newBottom)
+            {
+                // Last item: race against thieves for it.
+                if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                bottom.store(newBottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        /** Any thread. Returns nullptr if the deque is empty or another thief won the race. */
+        T* steal()
+        {
+            int64_t currentTop = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t currentBottom = bottom.load(std::memory_order_acquire);
+
+            if (currentTop >= currentBottom)
+            {
+                return nullptr;
+            }
+
+            T* item = buffer[currentTop & mask].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+
+            return item;
+        }
+
+        /** Approximate; only meaningful as a hint or for statistics. */
+        [[nodiscard]] int64_t sizeApprox() const
+        {
+            const int64_t size = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+            return size > 0 ? size : 0;
+        }
+
+    private:
+        const int64_t capacity;
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T*>[]> buffer;
+
+        // Thieves hammer top while the owner hammers bottom; keep them on separate cache lines.
+        alignas(64) std::atomic<int64_t> top { 0 };
+        alignas(64) std::atomic<int64_t> bottom { 0 };
+    };
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "engine/utils/math/Math.h"
+#include "services/world/entity/Components.h"
+
+namespace parus
+{
+
+    /**
+     * What the renderer needs from the world for one frame: camera, lights and sky.
+     * World::extractRenderSnapshot() copies it out at the end of a tick, so the renderer never reads
+     * EntityManager or SpectatorCamera while the next tick is changing them. Mesh instances are not
+     * part of it: VulkanRenderer::syncScene() patches them from the change set on the main thread
+     * before the next tick starts, which costs O(changes) rather than a copy of every mesh per frame.
+     */
+    struct RenderSnapshot
+    {
+        struct Camera
+        {
+            math::Vector3 position;
+            math::Vector3 forward = math::Vector3(0.0f, 0.0f, -1.0f);
+            math::Vector3 up = math::Vector3(0.0f, 1.0f, 0.0f);
+        };
+
+        struct PointLight
+        {
+            PointLightComponent light;
+            math::Vector3 position;
+        };
+
+        /** World ticks since startup; tells apart snapshots that look the same. */
+        uint64_t tick = 0;
+
+        Camera camera;
+        std::optional<DirectionalLightComponent> directionalLight;
+        std::vector<PointLight> pointLights;
+        std::optional<SkyboxComponent> skybox;
+    };
+
+    /**
+     * Two RenderSnapshots: the simulation fills one while the renderer reads the other. Both slots
+     * keep their vectors between frames, so refilling them does not reallocate once the scene
+     * stops growing.
+     *
+     * Not synchronized itself: publish() must run while neither stage is touching a snapshot, which
+     * the main loop guarantees by calling it after the simulation task has finished and the frame
+     * has been recorded.
+     */
+    class RenderSnapshotBuffer final
+    {
+    public:
+        /** The slot the simulation writes the next frame into. */
+        [[nodiscard]] RenderSnapshot& getWriteSnapshot() { return snapshots[1 - readIndex]; }
+
+        /** The last published snapshot; the renderer draws from it. */
+        [[nodiscard]] const RenderSnapshot& getReadSnapshot() const { return snapshots[readIndex]; }
+
+        /** Makes the written snapshot the one the renderer reads. */
+        void publish() { readIndex = 1 - readIndex; }
+
+    private:
+        std::array<RenderSnapshot, 2> snapshots;
+        size_t readIndex = 0;
+    };
+
+}
@@ -2,6 +2,7 @@
 
 #include "services/Services.h"
 #include "services/console/Console.h"
+#include "services/threading/ThreadPool.h"
 
 namespace parus
 {
@@ -13,6 +14,38 @@ namespace parus
     void World::tick(const float deltaTime)
     {
         mainCamera.updateTransform(deltaTime);
+        systems.update(*entityManager, commandQueue, *Services::get<ThreadPool>(), deltaTime);
+        commandQueue.playback(*entityManager);
+        ++tickCount;
+    }
+
+    void World::updateWorldTransforms()
+    {
+        entityManager->updateWorldTransforms(*Services::get<ThreadPool>());
+    }
+
+    void World::extractRenderSnapshot(RenderSnapshot& snapshot)
+    {
+        updateWorldTransforms();
+
+        snapshot.tick = tickCount;
+        snapshot.camera = {
+            .position = mainCamera.getPosition(),
+            .forward  = mainCamera.getForwardVector(),
+            .up       = mainCamera.getUpVector()
+        };
+
+        snapshot.pointLights.clear();
+        entityManager->view<PointLightComponent>().each([this, &snapshot](const Entity& entity, const PointLightComponent& pointLightComponent)
+        {
+            snapshot.pointLights.push_back({ pointLightComponent, entityManager->getWorldMatrix(entity.id)->transformPoint({}) });
+        });
+
+        const DirectionalLightComponent* directionalLight = entityManager->getDirectionalLightComponent();
+        snapshot.directionalLight = directionalLight ? std::optional(*directionalLight) : std::nullopt;
+
+        const SkyboxComponent* skybox = entityManager->getSkyboxComponent();
+        snapshot.skybox = skybox ? std::optional(*skybox) : std::nullopt;
     }
 
     void World::setCameraTransform(const math::Vector3& position, float yaw, float pitch)
@@ -3,11 +3,14 @@
 #include <string>
 #include <string_view>
 
+#include "RenderSnapshot.h"
 #include "Storage.h"
 #include "camera/SpectatorCamera.h"
+#include "entity/EntityCommandQueue.h"
 #include "entity/EntityManager.h"
 #include "services/Service.h"
 #include "services/console/reflection/ConsoleReflection.h"
+#include "system/SystemScheduler.h"
 
 namespace parus
 {
@@ -17,8 +20,22 @@ namespace parus
     {
     public:
         void init();
+        /**
+         * Moves the camera, runs every registered system on the ThreadPool, then plays back the
+         * entity command buffers submitted since the last tick.
+         */
         void tick(const float deltaTime);
 
+        /** Brings the entities' cached world matrices up to date, spreading large batches over the ThreadPool. */
+        void updateWorldTransforms();
+
+        /** Copies what the renderer draws (camera, lights, sky) into the snapshot, reusing its storage. Updates world transforms first. */
+        void extractRenderSnapshot(RenderSnapshot& snapshot);
+
+        /** The snapshots handed from the simulation to the renderer; see Application::loop(). */
+        [[nodiscard]] RenderSnapshotBuffer& getRenderSnapshots() { return renderSnapshots; }
+        [[nodiscard]] const RenderSnapshotBuffer& getRenderSnapshots() const { return renderSnapshots; }
+
         [[nodiscard]] SpectatorCamera getMainCamera() const { return mainCamera; }
 
         /** Sets the camera position, yaw and pitch, then recalculates direction vectors. */
@@ -26,6 +43,10 @@ namespace parus
 
         [[nodiscard]] std::shared_ptr<Storage> getStorage() const { return storage; }
         [[nodiscard]] std::shared_ptr<EntityManager> getEntityManager() const { return entityManager; }
+        /** Register simulation systems here; tick() runs them. */
+        [[nodiscard]] SystemScheduler& getSystems() { return systems; }
+        /** Any thread may submit entity changes here; they are applied at the end of the next tick(). */
+        [[nodiscard]] EntityCommandQueue& getCommandQueue() { return commandQueue; }
 
         [[nodiscard]] std::string_view getCurrentSceneName() const { return currentSceneName; }
         void setCurrentSceneName(const std::string& name) { currentSceneName = name; }
@@ -34,7 +55,11 @@ namespace parus
         SpectatorCamera mainCamera;
         std::shared_ptr<Storage> storage = std::make_shared<Storage>();
         std::shared_ptr<EntityManager> entityManager = std::make_shared<EntityManager>();
+        SystemScheduler systems;
+        EntityCommandQueue commandQueue;
         std::string currentSceneName;
+        uint64_t tickCount = 0;
+        RenderSnapshotBuffer renderSnapshots;
 
         /** Binds the generic get/set/list console commands to entities, components and the camera. */
         std::unique_ptr<ConsoleReflection> consoleReflection;
@@ -0,0 +1,247 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+namespace parus
+{
+
+    /**
+     * Copy-on-write sparse set: the same layout and O(1) operations as ComponentStorage, but the
+     * dense arrays are split into fixed-size chunks and both chunks and index pages are shared.
+     *
+     * Copying a ChunkedStorage is O(chunks + pages): the copy shares everything, and whichever side
+     * writes next clones just the chunk or page it writes to. That is what makes
+     * EntityManager::snapshot() cheap. Reads never copy, so only findMutable(), getMutableValue()
+     * and the other non-const functions may allocate; detach() does all the cloning up front when
+     * many values are about to change.
+     *
+     * A copy may be read on another thread while the original keeps changing: shared chunks are
+     * never written, and a chunk is only written in place once no copy refers to it any more.
+     * Dense order and the pointer/reference lifetime rules are as for ComponentStorage.
+     */
+    template <typename T>
+    class ChunkedStorage final
+    {
+    public:
+        static constexpr size_t CHUNK_SIZE = 256;
+
+        [[nodiscard]] const T* find(const EntityId id) const
+        {
+            const uint32_t slot = slotOf(id);
+            return slot == NO_SLOT ? nullptr : &getValue(slot);
+        }
+
+        /** Like find(), but clones the value's chunk first if a copy still shares it. */
+        [[nodiscard]] T* findMutable(const EntityId id)
+        {
+            const uint32_t slot = slotOf(id);
+            return slot == NO_SLOT ? nullptr : &getMutableValue(slot);
+        }
+
+        [[nodiscard]] bool contains(const EntityId id) const { return slotOf(id) != NO_SLOT; }
+
+        /**
+         * Adds the value, or replaces the one already stored for the id's index (an older generation's
+         * value included). Returns the stored value.
+         */
+        T& insertOrAssign(const EntityId id, T value)
+        {
+            uint32_t& slot = mutableSlotReference(id);
+            if (slot == NO_SLOT)
+            {
+                slot = static_cast<uint32_t>(count);
+                ++count;
+            }
+
+            Chunk& chunk = mutableChunk(slot);
+            chunk.ids[slot % CHUNK_SIZE] = id;
+            chunk.values[slot % CHUNK_SIZE] = std::move(value);
+            return chunk.values[slot % CHUNK_SIZE];
+        }
+
+        /** Returns false if the id had no value. */
+        bool erase(const EntityId id)
+        {
+            const uint32_t slot = slotOf(id);
+            if (slot == NO_SLOT)
+            {
+                return false;
+            }
+
+            // The vacated slot is reset, so a removed value's resources are released now.
+            const uint32_t lastSlot = static_cast<uint32_t>(count - 1);
+            Chunk& lastChunk = mutableChunk(lastSlot);
+            const EntityId lastId = lastChunk.ids[lastSlot % CHUNK_SIZE];
+            T lastValue = std::exchange(lastChunk.values[lastSlot % CHUNK_SIZE], T {});
+            if (slot != lastSlot)
+            {
+                Chunk& chunk = mutableChunk(slot);
+                chunk.ids[slot % CHUNK_SIZE] = lastId;
+                chunk.values[slot % CHUNK_SIZE] = std::move(lastValue);
+                mutableSlotReference(lastId) = slot;
+            }
+
+            --count;
+            mutableSlotReference(id) = NO_SLOT;
+            return true;
+        }
+
+        /** Removes every value. Keeps the pages and chunks no copy shares, for the next scene. */
+        void clear()
+        {
+            for (size_t slot = 0; slot < count; ++slot)
+            {
+                mutableSlotReference(getId(slot)) = NO_SLOT;
+            }
+
+            for (size_t chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex)
+            {
+                std::shared_ptr<Chunk>& chunk = chunks[chunkIndex];
+                if (!chunk || chunk.use_count() != 1)
+                {
+                    chunk.reset();
+                    continue;
+                }
+
+                const size_t usedCount = std::min(CHUNK_SIZE, count - std::min(count, chunkIndex * CHUNK_SIZE));
+                std::fill_n(chunk->values.begin(), usedCount, T {});
+            }
+            count = 0;
+        }
+
+        /** Allocates the chunks for capacity values now, so insertions up to that many don't. */
+        void reserve(const size_t capacity)
+        {
+            const size_t chunkCount = (capacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            if (chunkCount > chunks.size())
+            {
+                chunks.resize(chunkCount);
+            }
+            for (std::shared_ptr<Chunk>& chunk : chunks)
+            {
+                if (!chunk)
+                {
+                    chunk = std::make_shared<Chunk>();
+                }
+            }
+        }
+
+        /**
+         * Clones every chunk a copy still shares. Afterwards getMutableValue() and findMutable() do
+         * not allocate until the next copy, so they may be called concurrently for different values.
+         */
+        void detach()
+        {
+            for (size_t chunkIndex = 0; chunkIndex * CHUNK_SIZE < count; ++chunkIndex)
+            {
+                makeUnique(chunks[chunkIndex]);
+            }
+        }
+
+        [[nodiscard]] size_t size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+
+        /** Dense order, slot in [0, size()); getId(slot) owns getValue(slot). */
+        [[nodiscard]] EntityId getId(const size_t slot) const { return chunks[slot / CHUNK_SIZE]->ids[slot % CHUNK_SIZE]; }
+        [[nodiscard]] const T& getValue(const size_t slot) const { return chunks[slot / CHUNK_SIZE]->values[slot % CHUNK_SIZE]; }
+        [[nodiscard]] T& getMutableValue(const size_t slot) { return mutableChunk(slot).values[slot % CHUNK_SIZE]; }
+
+    private:
+        static constexpr size_t PAGE_SIZE = 1024;
+        static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+        using Page = std::array<uint32_t, PAGE_SIZE>;
+
+        struct Chunk
+        {
+            std::array<EntityId, CHUNK_SIZE> ids {};
+            std::array<T, CHUNK_SIZE> values {};
+        };
+
+        /** Clones shared unless this is the only owner. */
+        template <typename Shared>
+        static void makeUnique(std::shared_ptr<Shared>& shared)
+        {
+            if (shared.use_count() != 1)
+            {
+                shared = std::make_shared<Shared>(std::as_const(*shared));
+                return;
+            }
+
+            // Pairs with the release in the last copy's destructor, so its reads finish before our writes.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+
+        /** NO_SLOT unless the exact id, generation included, is stored. */
+        [[nodiscard]] uint32_t slotOf(const EntityId id) const
+        {
+            const uint32_t index = getEntityIndex(id);
+            const size_t pageIndex = index / PAGE_SIZE;
+            if (pageIndex >= pages.size() || !pages[pageIndex])
+            {
+                return NO_SLOT;
+            }
+
+            const uint32_t slot = (*pages[pageIndex])[index % PAGE_SIZE];
+            return slot != NO_SLOT && getId(slot) == id ? slot : NO_SLOT;
+        }
+
+        /** The table entry for the id's index, whatever generation it holds. Creates or clones the page as needed. */
+        uint32_t& mutableSlotReference(const EntityId id)
+        {
+            const uint32_t index = getEntityIndex(id);
+            const size_t pageIndex = index / PAGE_SIZE;
+            if (pageIndex >= pages.size())
+            {
+                pages.resize(pageIndex + 1);
+            }
+
+            std::shared_ptr<Page>& page = pages[pageIndex];
+            if (!page)
+            {
+                page = std::make_shared<Page>();
+                page->fill(NO_SLOT);
+            }
+            else
+            {
+                makeUnique(page);
+            }
+            return (*page)[index % PAGE_SIZE];
+        }
+
+        /** The chunk holding slot, allocated or cloned so it can be written. */
+        Chunk& mutableChunk(const size_t slot)
+        {
+            const size_t chunkIndex = slot / CHUNK_SIZE;
+            if (chunkIndex >= chunks.size())
+            {
+                chunks.resize(chunkIndex + 1);
+            }
+
+            std::shared_ptr<Chunk>& chunk = chunks[chunkIndex];
+            if (!chunk)
+            {
+                chunk = std::make_shared<Chunk>();
+            }
+            else
+            {
+                makeUnique(chunk);
+            }
+            return *chunk;
+        }
+
+        std::vector<std::shared_ptr<Page>> pages;
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        size_t count = 0;
+    };
+
+}
@@ -0,0 +1,95 @@
+#include "ComponentObservers.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "engine/EngineCore.h"
+
+namespace parus
+{
+    ComponentObservers::ObserverId ComponentObservers::add(const size_t channel, ObserverFunction function)
+    {
+        const ObserverId id = nextObserverId++;
+        ++channels[channel].observerCount;
+
+        std::vector<Observer>& target = isDispatching ? addedObservers : observers;
+        target.push_back({ id, channel, std::move(function) });
+        return id;
+    }
+
+    bool ComponentObservers::remove(const ObserverId id)
+    {
+        const auto matches = [id](const Observer& observer) { return observer.id == id && !observer.isRemoved; };
+
+        if (const auto added = std::ranges::find_if(addedObservers, matches); added != addedObservers.end())
+        {
+            --channels[added->channel].observerCount;
+            addedObservers.erase(added);
+            return true;
+        }
+
+        const auto observer = std::ranges::find_if(observers, matches);
+        if (observer == observers.end())
+        {
+            return false;
+        }
+
+        --channels[observer->channel].observerCount;
+        if (isDispatching)
+        {
+            observer->isRemoved = true;
+        }
+        else
+        {
+            observers.erase(observer);
+        }
+        return true;
+    }
+
+    void ComponentObservers::beginConcurrentRecording()
+    {
+        DEBUG_ASSERT(!threadEvents.isActive(), "Concurrent recording is already running.");
+        threadEvents.begin();
+    }
+
+    void ComponentObservers::endConcurrentRecording()
+    {
+        DEBUG_ASSERT(threadEvents.isActive(), "Concurrent recording is not running.");
+        threadEvents.end([this](const ThreadEvent& event)
+        {
+            channels[event.channel].pending.push_back(event.id);
+        });
+    }
+
+    void ComponentObservers::dispatch()
+    {
+        if (isDispatching)
+        {
+            return;
+        }
+        isDispatching = true;
+
+        for (Channel& channel : channels)
+        {
+            channel.dispatching.clear();
+            std::swap(channel.pending, channel.dispatching);
+        }
+
+        // Observers added meanwhile go to addedObservers, so this vector keeps its size and storage.
+        for (const Observer& observer : observers)
+        {
+            const std::vector<EntityId>& ids = channels[observer.channel].dispatching;
+            if (!observer.isRemoved && !ids.empty())
+            {
+                observer.function(ids);
+            }
+        }
+
+        std::erase_if(observers, [](const Observer& observer) { return observer.isRemoved; });
+        observers.insert(observers.end(), std::make_move_iterator(addedObservers.begin()), std::make_move_iterator(addedObservers.end()));
+        addedObservers.clear();
+        isDispatching = false;
+    }
+
+}
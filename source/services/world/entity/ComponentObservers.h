@@ -0,0 +1,191 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "ChunkedStorage.h"
+#include "Components.h"
+#include "Entity.h"
+#include "services/threading/PerThreadBuffers.h"
+
+namespace parus
+{
+
+    enum class ComponentEvent : uint8_t
+    {
+        Added,
+        Removed,
+        /** Replaced, or changed in place and reported through EntityManager::markChanged(). */
+        Changed
+    };
+
+    /**
+     * Lifecycle observers for EntityManager's pools, batched until dispatch().
+     *
+     * A pool is Entity itself, math::Transform or one of the component types. Each (pool, event)
+     * pair is a channel; record() appends the id to its channel only while someone observes it, so
+     * an unobserved event costs one branch. dispatch() then calls every observer once with all ids
+     * its channel collected since the last dispatch.
+     *
+     * Like EntityChangeSet, a batch is in the order things happened and may repeat an id or name an
+     * entity that has been destroyed since, so observers should look each id up again rather than
+     * replay events.
+     *
+     * record() is not thread-safe on its own. Between beginConcurrentRecording() and
+     * endConcurrentRecording(), several threads may record at once: each appends to a buffer of its
+     * own, and the buffers are merged into the channels at the end. Events from different threads
+     * are then grouped by thread rather than interleaved.
+     */
+    class ComponentObservers final
+    {
+    public:
+        using ObserverId = uint32_t;
+        using ObserverFunction = std::function<void(std::span<const EntityId> ids)>;
+
+        /** Only events recorded after this call reach the observer. */
+        template <typename T>
+        ObserverId add(const ComponentEvent event, ObserverFunction function)
+        {
+            return add(getChannel<T>(event), std::move(function));
+        }
+
+        /** Safe to call from an observer, including on itself. Returns false for unknown ids. */
+        bool remove(ObserverId id);
+
+        template <typename T>
+        void record(const ComponentEvent event, const EntityId id)
+        {
+            const size_t channelIndex = getChannel<T>(event);
+            if (channels[channelIndex].observerCount != 0)
+            {
+                append(channelIndex, id);
+            }
+        }
+
+        /** Records the event for every id in storage. */
+        template <typename T>
+        void recordAll(const ComponentEvent event, const ChunkedStorage<T>& storage)
+        {
+            const size_t channelIndex = getChannel<T>(event);
+            if (channels[channelIndex].observerCount != 0)
+            {
+                for (size_t slot = 0; slot < storage.size(); ++slot)
+                {
+                    append(channelIndex, storage.getId(slot));
+                }
+            }
+        }
+
+        /**
+         * Lets record() be called from several threads until endConcurrentRecording(). Observers
+         * must not be added or removed meanwhile. Called from the owning thread.
+         */
+        void beginConcurrentRecording();
+        /** Merges what every thread recorded since beginConcurrentRecording(), once they are all done. */
+        void endConcurrentRecording();
+
+        /**
+         * Calls the observers of every channel that recorded something, in registration order.
+         * Events that observers cause meanwhile wait for the next dispatch; a nested call is ignored.
+         */
+        void dispatch();
+
+    private:
+        static constexpr size_t POOL_COUNT = 8;
+        static constexpr size_t EVENT_COUNT = 3;
+
+        struct Channel
+        {
+            std::vector<EntityId> pending;
+            /** What the running dispatch() hands out; swapped with pending so neither reallocates. */
+            std::vector<EntityId> dispatching;
+            uint32_t observerCount = 0;
+        };
+
+        struct ThreadEvent
+        {
+            uint32_t channel = 0;
+            EntityId id = 0;
+        };
+
+        struct Observer
+        {
+            ObserverId id = 0;
+            size_t channel = 0;
+            ObserverFunction function;
+            /** Removed during dispatch(); erased once it's done, as the function may be running. */
+            bool isRemoved = false;
+        };
+
+        template <typename T>
+        [[nodiscard]] static constexpr size_t getChannel(const ComponentEvent event)
+        {
+            return getPool<T>() * EVENT_COUNT + static_cast<size_t>(event);
+        }
+
+        template <typename T>
+        [[nodiscard]] static constexpr size_t getPool()
+        {
+            if constexpr (std::is_same_v<T, Entity>)
+            {
+                return 0;
+            }
+            else if constexpr (std::is_same_v<T, math::Transform>)
+            {
+                return 1;
+            }
+            else if constexpr (std::is_same_v<T, MeshComponent>)
+            {
+                return 2;
+            }
+            else if constexpr (std::is_same_v<T, PointLightComponent>)
+            {
+                return 3;
+            }
+            else if constexpr (std::is_same_v<T, DirectionalLightComponent>)
+            {
+                return 4;
+            }
+            else if constexpr (std::is_same_v<T, SkyboxComponent>)
+            {
+                return 5;
+            }
+            else if constexpr (std::is_same_v<T, PrefabComponent>)
+            {
+                return 6;
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, LodComponent>, "EntityManager has no observable pool for this type.");
+                return 7;
+            }
+        }
+
+        ObserverId add(size_t channel, ObserverFunction function);
+
+        void append(const size_t channel, const EntityId id)
+        {
+            if (threadEvents.isActive())
+            {
+                threadEvents.push({ static_cast<uint32_t>(channel), id });
+                return;
+            }
+            channels[channel].pending.push_back(id);
+        }
+
+        std::array<Channel, POOL_COUNT * EVENT_COUNT> channels;
+        std::vector<Observer> observers;
+        /** Added during dispatch(); appended afterwards so observers doesn't reallocate under a running function. */
+        std::vector<Observer> addedObservers;
+        ObserverId nextObserverId = 1;
+        bool isDispatching = false;
+
+        /** Events recorded between beginConcurrentRecording() and endConcurrentRecording(). */
+        PerThreadBuffers<ThreadEvent> threadEvents;
+    };
+
+}
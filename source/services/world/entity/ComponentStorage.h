@@ -0,0 +1,155 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+namespace parus
+{
+
+    /**
+     * Sparse set: values of one type packed into a dense array, plus a paged entity index -> slot
+     * table.
+     *
+     * Lookup, insertion and removal are O(1) array accesses; removal moves the last value into the
+     * freed slot. Iterating getIds()/getValues() is a linear sweep over contiguous memory, in no
+     * particular order. The table is indexed by getEntityIndex(), which EntityManager recycles, so it
+     * stays as small as the peak entity count. A lookup only matches the exact id that was stored, so
+     * a stale handle to a reused index finds nothing.
+     *
+     * Insertion and removal may move values: pointers and spans are valid until the next change.
+     */
+    template <typename T>
+    class ComponentStorage final
+    {
+    public:
+        [[nodiscard]] T* find(const EntityId id)
+        {
+            const uint32_t slot = slotOf(id);
+            return slot == NO_SLOT ? nullptr : &values[slot];
+        }
+
+        [[nodiscard]] const T* find(const EntityId id) const
+        {
+            const uint32_t slot = slotOf(id);
+            return slot == NO_SLOT ? nullptr : &values[slot];
+        }
+
+        [[nodiscard]] bool contains(const EntityId id) const { return slotOf(id) != NO_SLOT; }
+
+        /**
+         * Adds the value, or replaces the one already stored for the id's index (an older generation's
+         * value included). Returns the stored value.
+         */
+        T& insertOrAssign(const EntityId id, T value)
+        {
+            uint32_t& slot = slotReference(id);
+            if (slot != NO_SLOT)
+            {
+                ids[slot] = id;
+                values[slot] = std::move(value);
+                return values[slot];
+            }
+
+            slot = static_cast<uint32_t>(ids.size());
+            ids.push_back(id);
+            values.push_back(std::move(value));
+            return values.back();
+        }
+
+        /** Returns false if the id had no value. */
+        bool erase(const EntityId id)
+        {
+            const uint32_t slot = slotOf(id);
+            if (slot == NO_SLOT)
+            {
+                return false;
+            }
+
+            const uint32_t lastSlot = static_cast<uint32_t>(ids.size() - 1);
+            if (slot != lastSlot)
+            {
+                ids[slot] = ids[lastSlot];
+                values[slot] = std::move(values[lastSlot]);
+                slotReference(ids[slot]) = slot;
+            }
+
+            ids.pop_back();
+            values.pop_back();
+            slotReference(id) = NO_SLOT;
+            return true;
+        }
+
+        /** Removes every value; keeps the allocated pages and capacity for the next scene. */
+        void clear()
+        {
+            for (const EntityId id : ids)
+            {
+                slotReference(id) = NO_SLOT;
+            }
+            ids.clear();
+            values.clear();
+        }
+
+        void reserve(const size_t capacity)
+        {
+            ids.reserve(capacity);
+            values.reserve(capacity);
+        }
+
+        [[nodiscard]] size_t size() const { return ids.size(); }
+        [[nodiscard]] bool empty() const { return ids.empty(); }
+
+        /** Ids in dense order; getIds()[i] owns getValues()[i]. */
+        [[nodiscard]] std::span<const EntityId> getIds() const { return ids; }
+        [[nodiscard]] std::span<T> getValues() { return values; }
+        [[nodiscard]] std::span<const T> getValues() const { return values; }
+
+    private:
+        static constexpr size_t PAGE_SIZE = 1024;
+        static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+        using Page = std::array<uint32_t, PAGE_SIZE>;
+
+        /** NO_SLOT unless the exact id, generation included, is stored. */
+        [[nodiscard]] uint32_t slotOf(const EntityId id) const
+        {
+            const uint32_t index = getEntityIndex(id);
+            const size_t pageIndex = index / PAGE_SIZE;
+            if (pageIndex >= pages.size() || !pages[pageIndex])
+            {
+                return NO_SLOT;
+            }
+
+            const uint32_t slot = (*pages[pageIndex])[index % PAGE_SIZE];
+            return slot != NO_SLOT && ids[slot] == id ? slot : NO_SLOT;
+        }
+
+        /** The table entry for the id's index, whatever generation it holds. Creates the page on first use. */
+        uint32_t& slotReference(const EntityId id)
+        {
+            const uint32_t index = getEntityIndex(id);
+            const size_t pageIndex = index / PAGE_SIZE;
+            if (pageIndex >= pages.size())
+            {
+                pages.resize(pageIndex + 1);
+            }
+            if (!pages[pageIndex])
+            {
+                pages[pageIndex] = std::make_unique<Page>();
+                pages[pageIndex]->fill(NO_SLOT);
+            }
+            return (*pages[pageIndex])[index % PAGE_SIZE];
+        }
+
+        std::vector<std::unique_ptr<Page>> pages;
+        std::vector<EntityId> ids;
+        std::vector<T> values;
+    };
+
+}
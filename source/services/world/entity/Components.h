@@ -1,6 +1,9 @@
 #pragma once
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "engine/utils/math/Math.h"
 #include "services/renderer/vulkan/mesh/Mesh.h"
@@ -19,6 +22,29 @@ namespace parus
     struct MeshComponent final
     {
         std::shared_ptr<Mesh> mesh;
+
+        bool operator==(const MeshComponent&) const = default;
+    };
+
+    /** One mesh in an LodComponent's chain. Like any drawn mesh, it must be registered in Storage. */
+    struct LodLevel final
+    {
+        std::shared_ptr<Mesh> mesh;
+        /**
+         * Smallest on-screen size this level is drawn at: the entity's bounding sphere diameter as a
+         * fraction of the screen height. Ignored for the last level, which covers any smaller size.
+         */
+        float minScreenSize = 0.0f;
+    };
+
+    /**
+     * Swaps an entity's mesh for cheaper ones as it shrinks on screen; see LodSelector. The
+     * MeshComponent stays the full-detail mesh, which bounds, saving and picking keep using.
+     */
+    struct LodComponent final
+    {
+        /** Most detailed first, with decreasing minScreenSize. */
+        std::vector<LodLevel> levels;
     };
 
     /**
@@ -28,11 +54,13 @@ namespace parus
     struct PointLightComponent
     {
         /** Light emission color (RGB). */
-        math::Vector3 color;
+        math::Vector3 color {};
         /** Radius of light influence. */
         float radius = 50.0f;
         /** Light intensity multiplier. */
         float intensity = 1.0f;
+
+        bool operator==(const PointLightComponent&) const = default;
     };
 
     /**
@@ -55,4 +83,28 @@ namespace parus
         math::Vector3 zenithColor;
     };
 
+    /**
+     * A template for many copies of one object: the mobility and components each instance starts
+     * with. Shared by every instance and never changed, so it is kept and saved once no matter how
+     * many instances there are; see EntityManager::instantiate().
+     */
+    struct Prefab final
+    {
+        std::string name;
+        Mobility mobility = Mobility::Static;
+        std::optional<MeshComponent> mesh;
+        std::optional<PointLightComponent> pointLight;
+    };
+
+    /**
+     * Links an instance to its prefab. The instance still holds its own component rows, so views
+     * and the renderer treat it like any entity; a row that differs from the prefab's, or a
+     * component the prefab lacks, is a per-instance override, and only overrides are saved per
+     * instance.
+     */
+    struct PrefabComponent final
+    {
+        std::shared_ptr<const Prefab> prefab;
+    };
+
 }
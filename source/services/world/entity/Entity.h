@@ -1,6 +1,6 @@
 #pragma once
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 #include "engine/utils/math/Math.h"
 #include "services/world/entity/Components.h"
@@ -8,15 +8,40 @@
 namespace parus
 {
 
-    using EntityId = uint32_t;
+    /**
+     * Generational entity handle: the low 32 bits index a slot in EntityManager, the high 32 bits
+     * count how many times that slot has been reused. Destroying an entity bumps its slot's
+     * generation, so stale handles stop resolving instead of aliasing whatever was spawned next.
+     * Slot 0 is never used, so 0 is never a valid id.
+     */
+    using EntityId = uint64_t;
+
+    [[nodiscard]] constexpr EntityId makeEntityId(const uint32_t index, const uint32_t generation)
+    {
+        return (static_cast<EntityId>(generation) << 32) | index;
+    }
+
+    [[nodiscard]] constexpr uint32_t getEntityIndex(const EntityId id)
+    {
+        return static_cast<uint32_t>(id);
+    }
+
+    [[nodiscard]] constexpr uint32_t getEntityGeneration(const EntityId id)
+    {
+        return static_cast<uint32_t>(id >> 32);
+    }
 
     /** A named object in the world: a transform plus whatever optional components EntityManager has attached to its id. */
     struct Entity final
     {
         EntityId id = 0;
-        std::string name;
+        /** Interned by EntityManager; change it through EntityManager::renameEntity(). */
+        std::string_view name;
         Mobility mobility = Mobility::Static;
+        /** Relative to the parent's world transform, or to the world when there is no parent. */
         math::Transform transform;
+        /** 0 for root entities. Changed through EntityManager::setParent(). */
+        EntityId parent = 0;
     };
 
 }
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+
+namespace parus
+{
+
+    enum class ComponentType : uint8_t
+    {
+        Mesh,
+        PointLight,
+        DirectionalLight,
+        Skybox,
+        Lod
+    };
+
+    struct ComponentChange final
+    {
+        EntityId id = 0;
+        ComponentType type = ComponentType::Mesh;
+    };
+
+    /**
+     * What happened to entities since EntityManager::takeChanges() was last called.
+     *
+     * Lists are in the order things happened and may repeat an id or name an entity that has been
+     * destroyed since, so consumers should treat every listed id as "look this entity up again"
+     * rather than replaying the lists.
+     */
+    struct EntityChangeSet final
+    {
+        std::vector<EntityId> spawned;
+        std::vector<EntityId> destroyed;
+        /** World matrix recomputed by updateWorldTransforms(), descendants of moved parents included. */
+        std::vector<EntityId> transformChanged;
+        /** Added, replaced, or changed in place and reported through EntityManager::markChanged(). */
+        std::vector<ComponentChange> componentsAdded;
+        std::vector<ComponentChange> componentsRemoved;
+        /** clearSceneEntities() ran: every earlier entity is gone, so consumers should resync from scratch. */
+        bool wasCleared = false;
+
+        [[nodiscard]] bool empty() const
+        {
+            return spawned.empty() && destroyed.empty() && transformChanged.empty()
+                && componentsAdded.empty() && componentsRemoved.empty() && !wasCleared;
+        }
+
+        /** Keeps the vectors' capacity. */
+        void clear()
+        {
+            spawned.clear();
+            destroyed.clear();
+            transformChanged.clear();
+            componentsAdded.clear();
+            componentsRemoved.clear();
+            wasCleared = false;
+        }
+    };
+
+}
@@ -0,0 +1,228 @@
+#include "EntityCommandBuffer.h"
+
+#include <atomic>
+#include <utility>
+
+#include "EntityManager.h"
+#include "engine/Asserts.h"
+
+namespace parus
+{
+
+    namespace
+    {
+        uint32_t makeBufferId()
+        {
+            static std::atomic<uint32_t> nextBufferId { 1 };
+            return nextBufferId.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    EntityCommandBuffer::EntityCommandBuffer(CancellationToken token)
+        : token(std::move(token))
+        , bufferId(makeBufferId())
+    {
+    }
+
+    EntityCommandBuffer::EntityCommandBuffer(EntityCommandBuffer&& other) noexcept
+        : token(other.token)
+        , bufferId(std::exchange(other.bufferId, makeBufferId()))
+        , commands(std::move(other.commands))
+        , nameArena(std::move(other.nameArena))
+        , nameEnds(std::move(other.nameEnds))
+        , transforms(std::move(other.transforms))
+        , parents(std::move(other.parents))
+        , meshComponents(std::move(other.meshComponents))
+        , pointLightComponents(std::move(other.pointLightComponents))
+        , spawnedIds(std::move(other.spawnedIds))
+    {
+        // Moved-from containers are only "valid but unspecified"; make them empty for reuse.
+        other.clear();
+        other.spawnedIds.clear();
+    }
+
+    EntityCommandBuffer& EntityCommandBuffer::operator=(EntityCommandBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            token = other.token;
+            bufferId = std::exchange(other.bufferId, makeBufferId());
+            commands = std::move(other.commands);
+            nameArena = std::move(other.nameArena);
+            nameEnds = std::move(other.nameEnds);
+            transforms = std::move(other.transforms);
+            parents = std::move(other.parents);
+            meshComponents = std::move(other.meshComponents);
+            pointLightComponents = std::move(other.pointLightComponents);
+            spawnedIds = std::move(other.spawnedIds);
+
+            other.clear();
+            other.spawnedIds.clear();
+        }
+        return *this;
+    }
+
+    EntityCommandBuffer::Target EntityCommandBuffer::spawn(const std::string_view requestedName)
+    {
+        Target target(0);
+        target.spawnIndex = static_cast<uint32_t>(nameEnds.size());
+        target.bufferId = bufferId;
+
+        nameArena.append(requestedName);
+        nameEnds.push_back(static_cast<uint32_t>(nameArena.size()));
+        record(CommandType::Spawn, target, target.spawnIndex);
+
+        return target;
+    }
+
+    void EntityCommandBuffer::destroy(const Target target)
+    {
+        record(CommandType::Destroy, target);
+    }
+
+    void EntityCommandBuffer::setTransform(const Target target, const math::Transform& transform)
+    {
+        record(CommandType::SetTransform, target, transforms.size());
+        transforms.push_back(transform);
+    }
+
+    void EntityCommandBuffer::setMobility(const Target target, const Mobility mobility)
+    {
+        record(CommandType::SetMobility, target, static_cast<size_t>(mobility));
+    }
+
+    void EntityCommandBuffer::setParent(const Target target, const Target parent)
+    {
+        assertOwned(parent);
+        record(CommandType::SetParent, target, parents.size());
+        parents.push_back(parent);
+    }
+
+    void EntityCommandBuffer::addMeshComponent(const Target target, MeshComponent component)
+    {
+        record(CommandType::AddMeshComponent, target, meshComponents.size());
+        meshComponents.push_back(std::move(component));
+    }
+
+    void EntityCommandBuffer::removeMeshComponent(const Target target)
+    {
+        record(CommandType::RemoveMeshComponent, target);
+    }
+
+    void EntityCommandBuffer::addPointLightComponent(const Target target, const PointLightComponent component)
+    {
+        record(CommandType::AddPointLightComponent, target, pointLightComponents.size());
+        pointLightComponents.push_back(component);
+    }
+
+    void EntityCommandBuffer::removePointLightComponent(const Target target)
+    {
+        record(CommandType::RemovePointLightComponent, target);
+    }
+
+    void EntityCommandBuffer::clear()
+    {
+        bufferId = makeBufferId();
+        commands.clear();
+        nameArena.clear();
+        nameEnds.clear();
+        transforms.clear();
+        parents.clear();
+        meshComponents.clear();
+        pointLightComponents.clear();
+    }
+
+    std::span<const EntityId> EntityCommandBuffer::playback(EntityManager& entityManager)
+    {
+        spawnedIds.clear();
+        if (token.isCancelled())
+        {
+            clear();
+            return {};
+        }
+
+        // One reservation for the whole batch instead of regrowing storage spawn by spawn.
+        if (!nameEnds.empty())
+        {
+            entityManager.reserve(entityManager.view<>().size() + nameEnds.size());
+            spawnedIds.reserve(nameEnds.size());
+        }
+        if (!meshComponents.empty())
+        {
+            entityManager.reserveComponents<MeshComponent>(entityManager.view<MeshComponent>().size() + meshComponents.size());
+        }
+        if (!pointLightComponents.empty())
+        {
+            entityManager.reserveComponents<PointLightComponent>(entityManager.view<PointLightComponent>().size() + pointLightComponents.size());
+        }
+
+        for (const Command& command : commands)
+        {
+            if (command.type == CommandType::Spawn)
+            {
+                const uint32_t nameBegin = command.payload == 0 ? 0 : nameEnds[command.payload - 1];
+                const std::string_view name = std::string_view(nameArena).substr(nameBegin, nameEnds[command.payload] - nameBegin);
+                spawnedIds.push_back(entityManager.spawn(name));
+                continue;
+            }
+
+            const EntityId id = resolve(command.target);
+            switch (command.type)
+            {
+            case CommandType::Destroy:
+                entityManager.destroy(id);
+                break;
+            case CommandType::SetTransform:
+                entityManager.setTransform(id, transforms[command.payload]);
+                break;
+            case CommandType::SetMobility:
+                entityManager.setMobility(id, static_cast<Mobility>(command.payload));
+                break;
+            case CommandType::SetParent:
+                entityManager.setParent(id, resolve(parents[command.payload]));
+                break;
+            case CommandType::AddMeshComponent:
+                entityManager.addMeshComponent(id, std::move(meshComponents[command.payload]));
+                break;
+            case CommandType::RemoveMeshComponent:
+                entityManager.removeMeshComponent(id);
+                break;
+            case CommandType::AddPointLightComponent:
+                entityManager.addPointLightComponent(id, pointLightComponents[command.payload]);
+                break;
+            case CommandType::RemovePointLightComponent:
+                entityManager.removePointLightComponent(id);
+                break;
+            case CommandType::Spawn:
+                break;
+            }
+        }
+
+        clear();
+        return spawnedIds;
+    }
+
+    void EntityCommandBuffer::record(const CommandType type, const Target target, const size_t payload)
+    {
+        assertOwned(target);
+        commands.push_back({ target, type, static_cast<uint32_t>(payload) });
+    }
+
+    EntityId EntityCommandBuffer::resolve(const Target& target) const
+    {
+        if (target.spawnIndex == Target::NOT_SPAWNED)
+        {
+            return target.id;
+        }
+
+        // assertOwned() let only this recording's spawns in, and each plays back before any command on it.
+        return spawnedIds[target.spawnIndex];
+    }
+
+    void EntityCommandBuffer::assertOwned(const Target& target) const
+    {
+        ASSERT(target.spawnIndex == Target::NOT_SPAWNED || target.bufferId == bufferId,
+            "Entity command targets an entity spawned by another command buffer or before clear().");
+    }
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Components.h"
+#include "Entity.h"
+#include "services/threading/CancellationToken.h"
+
+namespace parus
+{
+    class EntityManager;
+
+    /**
+     * Structural entity changes (spawn, destroy, add/remove components, set transforms) recorded
+     * now and applied to an EntityManager later, in recording order, by playback().
+     *
+     * A buffer belongs to the thread that records into it: recording touches nothing shared, so
+     * jobs and systems can prepare entities while the EntityManager is in use elsewhere, then hand
+     * the buffer to an EntityCommandQueue for the next sync point. Entities spawned by the buffer
+     * can be targeted by later commands in the same buffer through the Target spawn() returns;
+     * recording a command on another buffer's spawn, or on one from before clear(), asserts.
+     *
+     * Commands go into one flat array with their payloads in typed side arrays, so recording
+     * allocates only when those grow, and a cleared buffer keeps its capacity.
+     */
+    class EntityCommandBuffer final
+    {
+    public:
+        /** An entity a command applies to: one that exists, or one spawned earlier by the same buffer. */
+        struct Target final
+        {
+            static constexpr uint32_t NOT_SPAWNED = std::numeric_limits<uint32_t>::max();
+
+            Target(const EntityId id) : id(id) {}
+
+            EntityId id = 0;
+            /** Index among the buffer's spawns; NOT_SPAWNED when id names an existing entity. */
+            uint32_t spawnIndex = NOT_SPAWNED;
+            /** Recording id of the buffer that spawned it. */
+            uint32_t bufferId = 0;
+        };
+
+        /** If the token is cancelled by playback time, playback() applies nothing. */
+        explicit EntityCommandBuffer(CancellationToken token = {});
+
+        /**
+         * The moved-from buffer is left empty, keeps its token, and gets a new recording id, so it
+         * can be reused right away and rejects the Targets its earlier spawns returned.
+         */
+        EntityCommandBuffer(EntityCommandBuffer&& other) noexcept;
+        EntityCommandBuffer& operator=(EntityCommandBuffer&& other) noexcept;
+        EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+        EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+        ~EntityCommandBuffer() = default;
+
+        Target spawn(std::string_view requestedName);
+        void destroy(Target target);
+        void setTransform(Target target, const math::Transform& transform);
+        void setMobility(Target target, Mobility mobility);
+        /** parent may be 0 to detach. */
+        void setParent(Target target, Target parent);
+
+        void addMeshComponent(Target target, MeshComponent component);
+        void removeMeshComponent(Target target);
+        void addPointLightComponent(Target target, PointLightComponent component);
+        void removePointLightComponent(Target target);
+
+        [[nodiscard]] size_t size() const { return commands.size(); }
+        [[nodiscard]] bool empty() const { return commands.empty(); }
+        [[nodiscard]] const CancellationToken& getToken() const { return token; }
+
+        /** Drops every recorded command; keeps the capacity. */
+        void clear();
+
+        /**
+         * Applies every command through the EntityManager's usual functions, as if called directly in
+         * recording order, after reserving room for the spawns and added components. Commands on
+         * entities that no longer exist silently no-op, like the functions they stand for. Leaves
+         * the buffer empty and returns the ids of the spawned entities in spawn order, valid until
+         * the buffer is next played back.
+         */
+        std::span<const EntityId> playback(EntityManager& entityManager);
+
+    private:
+        enum class CommandType : uint8_t
+        {
+            Spawn,
+            Destroy,
+            SetTransform,
+            SetMobility,
+            SetParent,
+            AddMeshComponent,
+            RemoveMeshComponent,
+            AddPointLightComponent,
+            RemovePointLightComponent
+        };
+
+        struct Command
+        {
+            Target target;
+            CommandType type = CommandType::Spawn;
+            /** Index into the side array for the command's type; the Mobility value for SetMobility. */
+            uint32_t payload = 0;
+        };
+
+        void record(CommandType type, Target target, size_t payload = 0);
+        void assertOwned(const Target& target) const;
+        [[nodiscard]] EntityId resolve(const Target& target) const;
+
+        CancellationToken token;
+        /** Unique per buffer and renewed by clear(), so stale and foreign spawn targets are caught. */
+        uint32_t bufferId;
+        std::vector<Command> commands;
+
+        /** Spawned names back to back; spawn i's name ends at nameEnds[i]. */
+        std::string nameArena;
+        std::vector<uint32_t> nameEnds;
+        std::vector<math::Transform> transforms;
+        std::vector<Target> parents;
+        std::vector<MeshComponent> meshComponents;
+        std::vector<PointLightComponent> pointLightComponents;
+
+        /** Filled by playback(): the id each spawn got. */
+        std::vector<EntityId> spawnedIds;
+    };
+
+}
@@ -0,0 +1,45 @@
+#include "EntityCommandQueue.h"
+
+#include <utility>
+
+namespace parus
+{
+
+    EntityCommandQueue::~EntityCommandQueue()
+    {
+        // Buffers left at shutdown are dropped along with the world they were meant for.
+        Node* node = submitted.takeAll().head;
+        while (node)
+        {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    void EntityCommandQueue::submit(EntityCommandBuffer&& buffer)
+    {
+        if (buffer.empty())
+        {
+            return;
+        }
+
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+        submitted.push(new Node { std::move(buffer), nullptr });
+    }
+
+    size_t EntityCommandQueue::playback(EntityManager& entityManager)
+    {
+        size_t commandCount = 0;
+        Node* node = submitted.takeAll().head;
+        while (node)
+        {
+            commandCount += node->buffer.size();
+            node->buffer.playback(entityManager);
+
+            delete std::exchange(node, node->next);
+            pendingCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return commandCount;
+    }
+
+}
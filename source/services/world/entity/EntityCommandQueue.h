@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+#include "EntityCommandBuffer.h"
+#include "services/threading/MpscStack.h"
+
+namespace parus
+{
+    class EntityManager;
+
+    /**
+     * Hands EntityCommandBuffers from any thread to the thread that owns the EntityManager, which
+     * plays them all back in one pass at its sync point (World::tick()).
+     *
+     * Like MainThreadQueue, producers push onto an MpscStack and playback() takes the whole stack
+     * at once, so neither side ever waits for the other. Buffers are played back in submission
+     * order; each buffer's commands in recording order.
+     */
+    class EntityCommandQueue final
+    {
+    public:
+        EntityCommandQueue() = default;
+        ~EntityCommandQueue();
+        EntityCommandQueue(const EntityCommandQueue&) = delete;
+        EntityCommandQueue& operator=(const EntityCommandQueue&) = delete;
+
+        /** Thread-safe. Empty buffers are dropped. */
+        void submit(EntityCommandBuffer&& buffer);
+
+        /**
+         * Plays back every buffer submitted so far and returns how many commands that was. Buffers
+         * submitted meanwhile wait for the next call. Only one thread may play back at a time.
+         */
+        size_t playback(EntityManager& entityManager);
+
+        /** Buffers submitted but not played back yet. Approximate while producers are active. */
+        [[nodiscard]] size_t getPendingCount() const { return pendingCount.load(std::memory_order_relaxed); }
+
+    private:
+        struct Node
+        {
+            EntityCommandBuffer buffer;
+            Node* next;
+        };
+
+        MpscStack<Node> submitted;
+        std::atomic<size_t> pendingCount { 0 };
+    };
+
+}
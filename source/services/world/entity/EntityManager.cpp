@@ -1,61 +1,187 @@
 #include "EntityManager.h"
 
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include "services/threading/Parallel.h"
+
 namespace parus
 {
 
-    EntityId EntityManager::spawn(const std::string& requestedName)
+    EntityId EntityManager::spawn(const std::string_view requestedName)
     {
-        const EntityId id = nextId;
-        ++nextId;
+        uint32_t index = 0;
+        if (!freeIndices.empty())
+        {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(generations.size());
+            generations.push_back(0);
+        }
+        const EntityId id = makeEntityId(index, generations[index]);
 
         Entity entity;
         entity.id = id;
-        entity.name = makeUniqueName(requestedName);
+        const NameId nameId = makeUniqueName(requestedName);
+        entity.name = names.get(nameId);
+        nameOwners[nameId] = id;
 
-        nameToId.insert_or_assign(entity.name, id);
-        entities.insert_or_assign(id, entity);
+        entities.insertOrAssign(id, std::move(entity));
+        markWorldDirty(id, transformNodes.insertOrAssign(id, TransformNode {}));
+        changes.spawned.push_back(id);
+        observers.record<Entity>(ComponentEvent::Added, id);
 
         return id;
     }
 
     bool EntityManager::destroy(EntityId id)
     {
-        const auto entityIterator = entities.find(id);
-        if (entityIterator == entities.end())
+        const Entity* entity = entities.find(id);
+        if (!entity)
         {
             return false;
         }
 
-        nameToId.erase(entityIterator->second.name);
-        entities.erase(entityIterator);
-        meshComponents.erase(id);
-        pointLightComponents.erase(id);
-        directionalLightComponents.erase(id);
-        skyboxComponents.erase(id);
+        // Children become roots that keep their local transform.
+        setParent(id, 0);
+        const std::vector<EntityId> children = transformNodes.find(id)->children;
+        for (const EntityId childId : children)
+        {
+            setParent(childId, 0);
+        }
+
+        releaseName(entity->name);
+        spatialIndex.remove(id);
+        transformNodes.erase(id);
+        entities.erase(id);
+        if (meshComponents.erase(id))
+        {
+            observers.record<MeshComponent>(ComponentEvent::Removed, id);
+        }
+        if (pointLightComponents.erase(id))
+        {
+            observers.record<PointLightComponent>(ComponentEvent::Removed, id);
+        }
+        if (directionalLightComponents.erase(id))
+        {
+            observers.record<DirectionalLightComponent>(ComponentEvent::Removed, id);
+        }
+        if (skyboxComponents.erase(id))
+        {
+            observers.record<SkyboxComponent>(ComponentEvent::Removed, id);
+        }
+        if (prefabComponents.erase(id))
+        {
+            observers.record<PrefabComponent>(ComponentEvent::Removed, id);
+        }
+        if (lodComponents.erase(id))
+        {
+            observers.record<LodComponent>(ComponentEvent::Removed, id);
+        }
+        releaseIndex(getEntityIndex(id));
+        changes.destroyed.push_back(id);
+        observers.record<Entity>(ComponentEvent::Removed, id);
 
         return true;
     }
 
+    EntityId EntityManager::instantiate(std::shared_ptr<const Prefab> prefab, const math::Transform& transform)
+    {
+        const EntityId id = spawn(prefab->name);
+        setMobility(id, prefab->mobility);
+        setTransform(id, transform);
+        if (prefab->mesh)
+        {
+            addMeshComponent(id, *prefab->mesh);
+        }
+        if (prefab->pointLight)
+        {
+            addPointLightComponent(id, *prefab->pointLight);
+        }
+        addPrefabComponent(id, PrefabComponent{ std::move(prefab) });
+
+        return id;
+    }
+
+    std::vector<EntityId> EntityManager::instantiateMany(const std::shared_ptr<const Prefab>& prefab, const std::span<const math::Transform> transforms)
+    {
+        reserve(entities.size() + transforms.size());
+        prefabComponents.reserve(prefabComponents.size() + transforms.size());
+        if (prefab->mesh)
+        {
+            meshComponents.reserve(meshComponents.size() + transforms.size());
+        }
+        if (prefab->pointLight)
+        {
+            pointLightComponents.reserve(pointLightComponents.size() + transforms.size());
+        }
+
+        std::vector<EntityId> ids;
+        ids.reserve(transforms.size());
+        for (const math::Transform& transform : transforms)
+        {
+            ids.push_back(instantiate(prefab, transform));
+        }
+        return ids;
+    }
+
+    size_t EntityManager::destroyMany(const std::span<const EntityId> ids)
+    {
+        changes.destroyed.reserve(changes.destroyed.size() + ids.size());
+
+        size_t destroyedCount = 0;
+        for (const EntityId id : ids)
+        {
+            if (destroy(id))
+            {
+                ++destroyedCount;
+            }
+        }
+        return destroyedCount;
+    }
+
+    void EntityManager::reserve(const size_t entityCount)
+    {
+        // Index 0 is reserved.
+        generations.reserve(entityCount + 1);
+        entities.reserve(entityCount);
+        transformNodes.reserve(entityCount);
+        names.reserve(entityCount);
+        nameOwners.reserve(entityCount);
+        nextSuffixes.reserve(entityCount);
+        dirtyTransforms.reserve(entityCount);
+        spatialIndex.reserve(entityCount);
+        changes.spawned.reserve(entityCount);
+    }
+
     const Entity* EntityManager::getEntity(EntityId id) const
     {
-        const auto entityIterator = entities.find(id);
-        if (entityIterator == entities.end())
+        return entities.find(id);
+    }
+
+    const Entity* EntityManager::getEntityByName(const std::string_view name) const
+    {
+        const std::optional<NameId> nameId = names.find(name);
+        if (!nameId)
         {
             return nullptr;
         }
 
-        return &entityIterator->second;
+        return getEntity(nameOwners[*nameId]);
     }
 
-    const Entity* EntityManager::getEntityByName(const std::string& name) const
+    const Entity* EntityManager::getEntityByIndex(uint32_t index) const
     {
-        const auto nameIterator = nameToId.find(name);
-        if (nameIterator == nameToId.end())
+        if (index == 0 || index >= generations.size())
         {
             return nullptr;
         }
 
-        return getEntity(nameIterator->second);
+        return getEntity(makeEntityId(index, generations[index]));
     }
 
     std::vector<const Entity*> EntityManager::getAllEntities() const
@@ -63,106 +189,324 @@ namespace parus
         std::vector<const Entity*> allEntities;
         allEntities.reserve(entities.size());
 
-        for (const auto& [id, entity] : entities)
+        view<>().each([&allEntities](const Entity& entity)
         {
             allEntities.push_back(&entity);
-        }
+        });
 
         return allEntities;
     }
 
+    EntitySnapshot EntityManager::snapshot() const
+    {
+        EntitySnapshot snapshot;
+        snapshot.entities = entities;
+        snapshot.meshComponents = meshComponents;
+        snapshot.pointLightComponents = pointLightComponents;
+        snapshot.directionalLightComponents = directionalLightComponents;
+        snapshot.skyboxComponents = skyboxComponents;
+        snapshot.prefabComponents = prefabComponents;
+        snapshot.lodComponents = lodComponents;
+        snapshot.nameChunks = names.shareChunks();
+        return snapshot;
+    }
+
+    void EntityManager::publishSnapshot()
+    {
+        isPublishedSnapshotWanted.store(false, std::memory_order_relaxed);
+
+        auto published = std::make_shared<EntitySnapshot>(snapshot());
+        published->epoch = publishedSnapshots.getEpoch() + 1;
+        publishedSnapshots.publish(std::move(published));
+    }
+
+    bool EntityManager::publishSnapshotIfRead()
+    {
+        if (!isPublishedSnapshotWanted.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        publishSnapshot();
+        return true;
+    }
+
+    std::shared_ptr<const EntitySnapshot> EntityManager::getPublishedSnapshot() const
+    {
+        isPublishedSnapshotWanted.store(true, std::memory_order_relaxed);
+        return publishedSnapshots.acquire();
+    }
+
     void EntityManager::clearSceneEntities()
     {
+        // Unlike the change set, observers get no "cleared" flag, so they hear about every removal.
+        observers.recordAll(ComponentEvent::Removed, meshComponents);
+        observers.recordAll(ComponentEvent::Removed, pointLightComponents);
+        observers.recordAll(ComponentEvent::Removed, directionalLightComponents);
+        observers.recordAll(ComponentEvent::Removed, skyboxComponents);
+        observers.recordAll(ComponentEvent::Removed, prefabComponents);
+        observers.recordAll(ComponentEvent::Removed, lodComponents);
+        observers.recordAll(ComponentEvent::Removed, entities);
+
+        for (size_t slot = 0; slot < entities.size(); ++slot)
+        {
+            releaseIndex(getEntityIndex(entities.getId(slot)));
+        }
+
         entities.clear();
-        nameToId.clear();
+        transformNodes.clear();
+        dirtyTransforms.clear();
+        dirtyBounds.clear();
+        spatialIndex.clear();
+        changes.clear();
+        changes.wasCleared = true;
+        names.clear();
+        nameOwners.clear();
+        nextSuffixes.clear();
         meshComponents.clear();
         pointLightComponents.clear();
         directionalLightComponents.clear();
         skyboxComponents.clear();
+        prefabComponents.clear();
+        lodComponents.clear();
+
+        // An older epoch would keep the old scene's chunks, meshes included, until the next read.
+        publishSnapshot();
     }
 
     void EntityManager::setTransform(EntityId id, const math::Transform& transform)
     {
-        const auto entityIterator = entities.find(id);
-        if (entityIterator == entities.end())
+        if (Entity* entity = entities.findMutable(id))
         {
-            return;
-        }
+            entity->transform = transform;
 
-        entityIterator->second.transform = transform;
+            TransformNode* node = transformNodes.find(id);
+            node->isLocalDirty = true;
+            markWorldDirty(id, *node);
+        }
     }
 
     void EntityManager::setMobility(EntityId id, Mobility mobility)
     {
-        const auto entityIterator = entities.find(id);
-        if (entityIterator == entities.end())
+        const Entity* entity = entities.find(id);
+        if (entity && entity->mobility != mobility)
         {
-            return;
+            entities.findMutable(id)->mobility = mobility;
+            markBoundsDirty(id);
+            observers.record<Entity>(ComponentEvent::Changed, id);
         }
-
-        entityIterator->second.mobility = mobility;
     }
 
-    bool EntityManager::renameEntity(EntityId id, const std::string& newName)
+    bool EntityManager::renameEntity(EntityId id, const std::string_view newName)
     {
-        const auto entityIterator = entities.find(id);
-        if (entityIterator == entities.end())
+        const Entity* entity = entities.find(id);
+        if (!entity)
         {
             return false;
         }
 
-        if (nameToId.contains(newName) && nameToId.at(newName) != id)
+        if (const std::optional<NameId> nameId = names.find(newName); nameId && nameOwners[*nameId] != 0)
+        {
+            return nameOwners[*nameId] == id;
+        }
+
+        const NameId nameId = internName(newName);
+        releaseName(entity->name);
+        entities.findMutable(id)->name = names.get(nameId);
+        nameOwners[nameId] = id;
+        observers.record<Entity>(ComponentEvent::Changed, id);
+
+        return true;
+    }
+
+    bool EntityManager::setParent(EntityId id, EntityId parentId)
+    {
+        const Entity* entity = entities.find(id);
+        if (!entity || (parentId != 0 && !entities.contains(parentId)))
         {
             return false;
         }
 
-        nameToId.erase(entityIterator->second.name);
-        entityIterator->second.name = newName;
-        nameToId.insert_or_assign(newName, id);
+        for (EntityId ancestorId = parentId; ancestorId != 0; ancestorId = entities.find(ancestorId)->parent)
+        {
+            if (ancestorId == id)
+            {
+                return false;
+            }
+        }
+
+        if (entity->parent == parentId)
+        {
+            return true;
+        }
+
+        if (entity->parent != 0)
+        {
+            std::vector<EntityId>& siblings = transformNodes.find(entity->parent)->children;
+            siblings.erase(std::ranges::find(siblings, id));
+        }
+
+        entities.findMutable(id)->parent = parentId;
+        uint32_t depth = 0;
+        if (parentId != 0)
+        {
+            TransformNode* parentNode = transformNodes.find(parentId);
+            parentNode->children.push_back(id);
+            depth = parentNode->depth + 1;
+        }
+
+        updateSubtreeDepth(id, depth);
+        markWorldDirty(id, *transformNodes.find(id));
+        observers.record<Entity>(ComponentEvent::Changed, id);
 
         return true;
     }
 
-    void EntityManager::addMeshComponent(EntityId id, MeshComponent component)
+    std::span<const EntityId> EntityManager::getChildren(EntityId id) const
     {
-        meshComponents.insert_or_assign(id, std::move(component));
+        const TransformNode* node = transformNodes.find(id);
+        if (!node)
+        {
+            return {};
+        }
+
+        return node->children;
     }
 
-    const MeshComponent* EntityManager::getMeshComponent(EntityId id) const
+    const math::Matrix4x4* EntityManager::getWorldMatrix(EntityId id) const
     {
-        const auto componentIterator = meshComponents.find(id);
-        if (componentIterator == meshComponents.end())
+        const TransformNode* node = transformNodes.find(id);
+        if (!node)
         {
             return nullptr;
         }
 
-        return &componentIterator->second;
+        return &node->worldMatrix;
     }
 
-    void EntityManager::removeMeshComponent(EntityId id)
+    void EntityManager::updateWorldTransforms()
     {
-        meshComponents.erase(id);
+        updateWorldTransforms(nullptr);
     }
 
-    void EntityManager::addPointLightComponent(EntityId id, PointLightComponent component)
+    void EntityManager::updateWorldTransforms(ThreadPool& pool)
     {
-        pointLightComponents.insert_or_assign(id, component);
+        updateWorldTransforms(&pool);
     }
 
-    const PointLightComponent* EntityManager::getPointLightComponent(EntityId id) const
+    void EntityManager::updateWorldTransforms(ThreadPool* pool)
     {
-        const auto componentIterator = pointLightComponents.find(id);
-        if (componentIterator == pointLightComponents.end())
+        if (dirtyTransforms.empty() && dirtyBounds.empty())
         {
-            return nullptr;
+            return;
+        }
+
+        const size_t levelCount = collectDirtySubtrees();
+
+        // Each level only reads the level above it, which is finished by then.
+        for (size_t depth = 0; depth < levelCount; ++depth)
+        {
+            const std::vector<EntityId>& batch = depthBatches[depth];
+            if (pool)
+            {
+                parallelFor(*pool, 0, batch.size(), [this, &batch](const size_t i)
+                {
+                    updateTransformNode(batch[i]);
+                });
+            }
+            else
+            {
+                for (const EntityId id : batch)
+                {
+                    updateTransformNode(id);
+                }
+            }
+        }
+
+        // The bounds were computed alongside the matrices; the trees themselves are updated serially.
+        for (size_t depth = 0; depth < levelCount; ++depth)
+        {
+            for (const EntityId id : depthBatches[depth])
+            {
+                spatialIndex.update(id, transformNodes.find(id)->worldBounds, entities.find(id)->mobility);
+            }
+        }
+        for (const EntityId id : dirtyBounds)
+        {
+            TransformNode* node = transformNodes.find(id);
+            if (!node)
+            {
+                continue;
+            }
+            node->isBoundsQueued = false;
+            node->worldBounds = computeWorldBounds(id, *node);
+            spatialIndex.update(id, node->worldBounds, entities.find(id)->mobility);
+        }
+        dirtyBounds.clear();
+
+        spatialIndex.commit();
+    }
+
+    void EntityManager::takeChanges(EntityChangeSet& out)
+    {
+        out.clear();
+        std::swap(out, changes);
+    }
+
+    void EntityManager::addMeshComponent(EntityId id, MeshComponent component)
+    {
+        if (!entities.contains(id))
+        {
+            return;
+        }
+
+        recordComponentAdd<MeshComponent>(id);
+        meshComponents.insertOrAssign(id, std::move(component));
+        markBoundsDirty(id);
+        changes.componentsAdded.push_back({ id, ComponentType::Mesh });
+    }
+
+    const MeshComponent* EntityManager::getMeshComponent(EntityId id) const
+    {
+        return meshComponents.find(id);
+    }
+
+    void EntityManager::removeMeshComponent(EntityId id)
+    {
+        if (meshComponents.erase(id))
+        {
+            markBoundsDirty(id);
+            changes.componentsRemoved.push_back({ id, ComponentType::Mesh });
+            observers.record<MeshComponent>(ComponentEvent::Removed, id);
+        }
+    }
+
+    void EntityManager::addPointLightComponent(EntityId id, PointLightComponent component)
+    {
+        if (!entities.contains(id))
+        {
+            return;
         }
 
-        return &componentIterator->second;
+        recordComponentAdd<PointLightComponent>(id);
+        pointLightComponents.insertOrAssign(id, component);
+        markBoundsDirty(id);
+        changes.componentsAdded.push_back({ id, ComponentType::PointLight });
+    }
+
+    const PointLightComponent* EntityManager::getPointLightComponent(EntityId id) const
+    {
+        return pointLightComponents.find(id);
     }
 
     void EntityManager::removePointLightComponent(EntityId id)
     {
-        pointLightComponents.erase(id);
+        if (pointLightComponents.erase(id))
+        {
+            markBoundsDirty(id);
+            changes.componentsRemoved.push_back({ id, ComponentType::PointLight });
+            observers.record<PointLightComponent>(ComponentEvent::Removed, id);
+        }
     }
 
     std::vector<std::pair<const Entity*, const MeshComponent*>> EntityManager::getMeshEntities() const
@@ -170,13 +514,10 @@ namespace parus
         std::vector<std::pair<const Entity*, const MeshComponent*>> result;
         result.reserve(meshComponents.size());
 
-        for (const auto& [id, component] : meshComponents)
+        view<MeshComponent>().each([&result](const Entity& entity, const MeshComponent& component)
         {
-            if (const Entity* entity = getEntity(id))
-            {
-                result.emplace_back(entity, &component);
-            }
-        }
+            result.emplace_back(&entity, &component);
+        });
 
         return result;
     }
@@ -186,21 +527,81 @@ namespace parus
         std::vector<std::pair<const Entity*, const PointLightComponent*>> result;
         result.reserve(pointLightComponents.size());
 
-        for (const auto& [id, component] : pointLightComponents)
+        view<PointLightComponent>().each([&result](const Entity& entity, const PointLightComponent& component)
         {
-            if (const Entity* entity = getEntity(id))
-            {
-                result.emplace_back(entity, &component);
-            }
-        }
+            result.emplace_back(&entity, &component);
+        });
 
         return result;
     }
 
+    void EntityManager::addPrefabComponent(EntityId id, PrefabComponent component)
+    {
+        if (!entities.contains(id))
+        {
+            return;
+        }
+
+        recordComponentAdd<PrefabComponent>(id);
+        prefabComponents.insertOrAssign(id, std::move(component));
+    }
+
+    const PrefabComponent* EntityManager::getPrefabComponent(EntityId id) const
+    {
+        return prefabComponents.find(id);
+    }
+
+    void EntityManager::removePrefabComponent(EntityId id)
+    {
+        if (prefabComponents.erase(id))
+        {
+            observers.record<PrefabComponent>(ComponentEvent::Removed, id);
+        }
+    }
+
+    void EntityManager::addLodComponent(EntityId id, LodComponent component)
+    {
+        if (!entities.contains(id))
+        {
+            return;
+        }
+
+        recordComponentAdd<LodComponent>(id);
+        lodComponents.insertOrAssign(id, std::move(component));
+        changes.componentsAdded.push_back({ id, ComponentType::Lod });
+    }
+
+    const LodComponent* EntityManager::getLodComponent(EntityId id) const
+    {
+        return lodComponents.find(id);
+    }
+
+    void EntityManager::removeLodComponent(EntityId id)
+    {
+        if (lodComponents.erase(id))
+        {
+            changes.componentsRemoved.push_back({ id, ComponentType::Lod });
+            observers.record<LodComponent>(ComponentEvent::Removed, id);
+        }
+    }
+
     void EntityManager::addDirectionalLightComponent(EntityId id, DirectionalLightComponent component)
     {
+        if (!entities.contains(id))
+        {
+            return;
+        }
+
+        if (const Entity* previousHolder = getDirectionalLightEntity(); previousHolder && previousHolder->id != id)
+        {
+            changes.componentsRemoved.push_back({ previousHolder->id, ComponentType::DirectionalLight });
+            observers.record<DirectionalLightComponent>(ComponentEvent::Removed, previousHolder->id);
+        }
+
+        recordComponentAdd<DirectionalLightComponent>(id);
         directionalLightComponents.clear();
-        directionalLightComponents.insert_or_assign(id, component);
+        directionalLightComponents.insertOrAssign(id, component);
+        changes.componentsAdded.push_back({ id, ComponentType::DirectionalLight });
     }
 
     const Entity* EntityManager::getDirectionalLightEntity() const
@@ -210,7 +611,7 @@ namespace parus
             return nullptr;
         }
 
-        return getEntity(directionalLightComponents.begin()->first);
+        return getEntity(directionalLightComponents.getId(0));
     }
 
     const DirectionalLightComponent* EntityManager::getDirectionalLightComponent() const
@@ -220,13 +621,26 @@ namespace parus
             return nullptr;
         }
 
-        return &directionalLightComponents.begin()->second;
+        return &directionalLightComponents.getValue(0);
     }
 
     void EntityManager::addSkyboxComponent(EntityId id, SkyboxComponent component)
     {
+        if (!entities.contains(id))
+        {
+            return;
+        }
+
+        if (const Entity* previousHolder = getSkyboxEntity(); previousHolder && previousHolder->id != id)
+        {
+            changes.componentsRemoved.push_back({ previousHolder->id, ComponentType::Skybox });
+            observers.record<SkyboxComponent>(ComponentEvent::Removed, previousHolder->id);
+        }
+
+        recordComponentAdd<SkyboxComponent>(id);
         skyboxComponents.clear();
-        skyboxComponents.insert_or_assign(id, std::move(component));
+        skyboxComponents.insertOrAssign(id, std::move(component));
+        changes.componentsAdded.push_back({ id, ComponentType::Skybox });
     }
 
     const Entity* EntityManager::getSkyboxEntity() const
@@ -236,7 +650,7 @@ namespace parus
             return nullptr;
         }
 
-        return getEntity(skyboxComponents.begin()->first);
+        return getEntity(skyboxComponents.getId(0));
     }
 
     const SkyboxComponent* EntityManager::getSkyboxComponent() const
@@ -246,26 +660,249 @@ namespace parus
             return nullptr;
         }
 
-        return &skyboxComponents.begin()->second;
+        return &skyboxComponents.getValue(0);
+    }
+
+    void EntityManager::markWorldDirty(EntityId id, TransformNode& node)
+    {
+        if (!node.isQueued)
+        {
+            node.isQueued = true;
+            dirtyTransforms.push_back(id);
+        }
+    }
+
+    void EntityManager::markBoundsDirty(EntityId id)
+    {
+        TransformNode* node = transformNodes.find(id);
+        if (!node->isBoundsQueued)
+        {
+            node->isBoundsQueued = true;
+            dirtyBounds.push_back(id);
+        }
+    }
+
+    void EntityManager::beginConcurrentMarks()
+    {
+        observers.beginConcurrentRecording();
+        concurrentChanges.begin();
+    }
+
+    void EntityManager::endConcurrentMarks()
+    {
+        observers.endConcurrentRecording();
+        concurrentChanges.end([this](const ComponentChange change) { applyInPlaceChange(change); });
+    }
+
+    void EntityManager::recordInPlaceChange(const ComponentChange change)
+    {
+        if (concurrentChanges.isActive())
+        {
+            concurrentChanges.push(change);
+            return;
+        }
+        applyInPlaceChange(change);
+    }
+
+    void EntityManager::applyInPlaceChange(const ComponentChange change)
+    {
+        changes.componentsAdded.push_back(change);
+        // A buffered mark is applied after its system ran; the entity can't be gone, as destroys are deferred then.
+        if (change.type == ComponentType::Mesh || change.type == ComponentType::PointLight)
+        {
+            markBoundsDirty(change.id);
+        }
+    }
+
+    math::Aabb EntityManager::computeWorldBounds(EntityId id, const TransformNode& node) const
+    {
+        const math::Vector3 position = node.worldMatrix.transformPoint({});
+
+        math::Aabb bounds = math::Aabb::fromPoint(position);
+        if (const MeshComponent* meshComponent = meshComponents.find(id); meshComponent && meshComponent->mesh && !meshComponent->mesh->bounds.isEmpty())
+        {
+            bounds = meshComponent->mesh->bounds.transform(node.worldMatrix);
+        }
+        if (const PointLightComponent* pointLightComponent = pointLightComponents.find(id))
+        {
+            const float radius = pointLightComponent->radius;
+            bounds = bounds.merge(math::Aabb::fromCenterExtents(position, { radius, radius, radius }));
+        }
+
+        return bounds;
+    }
+
+    void EntityManager::updateSubtreeDepth(EntityId id, uint32_t depth)
+    {
+        traversalStack.clear();
+        transformNodes.find(id)->depth = depth;
+        traversalStack.push_back(id);
+
+        while (!traversalStack.empty())
+        {
+            const TransformNode* node = transformNodes.find(traversalStack.back());
+            traversalStack.pop_back();
+
+            for (const EntityId childId : node->children)
+            {
+                transformNodes.find(childId)->depth = node->depth + 1;
+                traversalStack.push_back(childId);
+            }
+        }
+    }
+
+    size_t EntityManager::collectDirtySubtrees()
+    {
+        for (std::vector<EntityId>& batch : depthBatches)
+        {
+            batch.clear();
+        }
+
+        size_t levelCount = 0;
+        for (const EntityId dirtyId : dirtyTransforms)
+        {
+            TransformNode* dirtyNode = transformNodes.find(dirtyId);
+            if (!dirtyNode)
+            {
+                continue;
+            }
+            dirtyNode->isQueued = false;
+
+            // A scheduled entity has its whole subtree scheduled too, so the walk stops there.
+            traversalStack.clear();
+            traversalStack.push_back(dirtyId);
+            while (!traversalStack.empty())
+            {
+                const EntityId id = traversalStack.back();
+                traversalStack.pop_back();
+
+                TransformNode* node = transformNodes.find(id);
+                if (node->isScheduled)
+                {
+                    continue;
+                }
+                node->isScheduled = true;
+
+                if (node->depth >= depthBatches.size())
+                {
+                    depthBatches.resize(node->depth + 1);
+                }
+                depthBatches[node->depth].push_back(id);
+                changes.transformChanged.push_back(id);
+                observers.record<math::Transform>(ComponentEvent::Changed, id);
+                levelCount = std::max<size_t>(levelCount, node->depth + 1);
+
+                traversalStack.insert(traversalStack.end(), node->children.begin(), node->children.end());
+            }
+        }
+
+        dirtyTransforms.clear();
+        return levelCount;
+    }
+
+    void EntityManager::updateTransformNode(EntityId id)
+    {
+        const Entity* entity = entities.find(id);
+        TransformNode* node = transformNodes.find(id);
+
+        if (node->isLocalDirty)
+        {
+            node->localMatrix = entity->transform.toMatrix();
+            node->isLocalDirty = false;
+        }
+
+        // Row vectors: the local transform applies first, then the parent's.
+        node->worldMatrix = entity->parent != 0
+            ? node->localMatrix * transformNodes.find(entity->parent)->worldMatrix
+            : node->localMatrix;
+        node->worldBounds = computeWorldBounds(id, *node);
+        node->isScheduled = false;
+    }
+
+    void EntityManager::releaseIndex(uint32_t index)
+    {
+        // A slot whose generation would wrap is retired, so an old id can never match again.
+        if (generations[index] == std::numeric_limits<uint32_t>::max())
+        {
+            return;
+        }
+
+        ++generations[index];
+        freeIndices.push_back(index);
     }
 
-    std::string EntityManager::makeUniqueName(const std::string& requestedName) const
+    NameId EntityManager::internName(const std::string_view name)
     {
-        if (!nameToId.contains(requestedName))
+        const NameId nameId = names.intern(name);
+        if (nameId >= nameOwners.size())
         {
-            return requestedName;
+            nameOwners.resize(nameId + 1, 0);
+            nextSuffixes.resize(nameId + 1, 1);
         }
+        return nameId;
+    }
 
-        uint32_t suffix = 1;
-        std::string candidateName = requestedName + std::to_string(suffix);
+    NameId EntityManager::makeUniqueName(const std::string_view requestedName)
+    {
+        const NameId baseId = internName(requestedName);
+        if (nameOwners[baseId] == 0)
+        {
+            return baseId;
+        }
 
-        while (nameToId.contains(candidateName))
+        // Suffixes below the counter are known to be taken, so each suffix is probed at most once
+        // between releases of names with this base.
+        candidateName.assign(requestedName);
+        const size_t baseLength = candidateName.size();
+        uint32_t suffix = nextSuffixes[baseId];
+        while (true)
         {
+            char digits[std::numeric_limits<uint32_t>::digits10 + 1];
+            char* digitsEnd = std::to_chars(std::begin(digits), std::end(digits), suffix).ptr;
+            candidateName.resize(baseLength);
+            candidateName.append(digits, static_cast<size_t>(digitsEnd - digits));
+
+            const std::optional<NameId> candidateId = names.find(candidateName);
+            if (!candidateId || nameOwners[*candidateId] == 0)
+            {
+                break;
+            }
             ++suffix;
-            candidateName = requestedName + std::to_string(suffix);
         }
 
-        return candidateName;
+        nextSuffixes[baseId] = suffix + 1;
+        return internName(candidateName);
+    }
+
+    void EntityManager::releaseName(const std::string_view name)
+    {
+        nameOwners[*names.find(name)] = 0;
+
+        // "Crate12" may have been made from base "Crate" (suffix 12) or "Crate1" (suffix 2): wherever
+        // a base with that spelling exists, let its counter find this suffix again.
+        for (size_t digitCount = 1; digitCount <= name.size(); ++digitCount)
+        {
+            const size_t suffixBegin = name.size() - digitCount;
+            if (name[suffixBegin] < '0' || name[suffixBegin] > '9')
+            {
+                break;
+            }
+            if (name[suffixBegin] == '0')
+            {
+                continue;
+            }
+
+            uint32_t suffix = 0;
+            if (std::from_chars(name.data() + suffixBegin, name.data() + name.size(), suffix).ec != std::errc())
+            {
+                break;
+            }
+
+            if (const std::optional<NameId> baseId = names.find(name.substr(0, suffixBegin)))
+            {
+                nextSuffixes[*baseId] = std::min(nextSuffixes[*baseId], suffix);
+            }
+        }
     }
 
 }
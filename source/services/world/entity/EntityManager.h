@@ -1,39 +1,310 @@
 #pragma once
+#include <atomic>
+#include <memory>
+#include <ranges>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "ChunkedStorage.h"
+#include "ComponentObservers.h"
+#include "ComponentStorage.h"
 #include "Components.h"
 #include "Entity.h"
+#include "EntityChangeSet.h"
+#include "EntitySnapshot.h"
+#include "EntityView.h"
+#include "NameTable.h"
+#include "services/threading/EpochPublisher.h"
+#include "services/threading/PerThreadBuffers.h"
+#include "services/world/spatial/SpatialIndex.h"
 
 namespace parus
 {
 
-    /** Owns every Entity in the current scene plus its optional components, keyed by EntityId. */
+    /**
+     * Owns every Entity in the current scene plus its optional components, keyed by EntityId.
+     *
+     * Entities and each component type live in their own ChunkedStorage, so every lookup is an
+     * array access and iterating a component type walks its dense chunks in order. Returned pointers
+     * are valid until the next spawn, destroy or component add/remove. The chunks are copy-on-write,
+     * which lets snapshot() hand out a consistent copy of the whole scene in O(chunks).
+     * publishSnapshot() makes such a copy the current epoch, which other threads read through
+     * getPublishedSnapshot() without locking while the owning thread keeps writing.
+     *
+     * Destroyed entities' indices go on a free list and are handed out again with a new generation,
+     * keeping the index range dense; stale ids simply stop resolving.
+     *
+     * Entities form a transform hierarchy. Each one caches its local and world matrix; setTransform()
+     * and setParent() only mark the entity dirty, and updateWorldTransforms() recomputes the changed
+     * subtrees one depth level at a time, so an unchanged scene costs nothing per frame.
+     *
+     * Every spawn, destroy, component add/remove, markChanged() and recomputed world matrix is also
+     * recorded in a change set, so consumers such as the renderer can sync only what changed; see
+     * takeChanges(). Any number of subsystems can also observe one pool's adds, removes or changes,
+     * delivered in batches by dispatchObservers(); see onAdd().
+     *
+     * updateWorldTransforms() also refreshes a SpatialIndex over every entity's world bounds (its
+     * mesh's bounds, grown to cover its point light's radius, or just its position), for culling,
+     * picking and proximity queries; see getSpatialIndex().
+     *
+     * instantiate() spawns copies of a shared Prefab; each keeps a PrefabComponent pointing back to
+     * it, so saving can store the prefab once and only each instance's overrides.
+     *
+     * Entity names are interned in a NameTable: Entity::name views the table's arena, and name
+     * lookups and uniqueness checks go through dense NameIds rather than per-entity strings.
+     */
     class EntityManager final
     {
     public:
         /** Spawns a new entity; auto-suffixes requestedName if it's already taken. Returns the new entity's id. */
-        EntityId spawn(const std::string& requestedName);
+        EntityId spawn(std::string_view requestedName);
 
         /** Removes the entity with the given id. Returns false if no such entity exists. */
         bool destroy(EntityId id);
 
+        /**
+         * Spawns one entity per name, like spawn(), after reserving room for all of them. Returns the
+         * new ids in the order of requestedNames.
+         */
+        template <std::ranges::input_range Names>
+        std::vector<EntityId> spawnMany(Names&& requestedNames)
+        {
+            std::vector<EntityId> ids;
+            if constexpr (std::ranges::sized_range<Names>)
+            {
+                const size_t count = std::ranges::size(requestedNames);
+                reserve(entities.size() + count);
+                ids.reserve(count);
+            }
+
+            for (const std::string_view requestedName : requestedNames)
+            {
+                ids.push_back(spawn(requestedName));
+            }
+            return ids;
+        }
+
+        /**
+         * Spawns an instance of prefab at transform: named after the prefab (auto-suffixed), with its
+         * mobility, a copy of each of its components and a PrefabComponent linking back to it.
+         */
+        EntityId instantiate(std::shared_ptr<const Prefab> prefab, const math::Transform& transform);
+
+        /** instantiate() once per transform, after reserving room for all of them. Returns the ids in order. */
+        std::vector<EntityId> instantiateMany(const std::shared_ptr<const Prefab>& prefab, std::span<const math::Transform> transforms);
+
+        /** Destroys every listed entity that exists. Returns how many were destroyed. */
+        size_t destroyMany(std::span<const EntityId> ids);
+
+        /**
+         * Pre-sizes the per-entity storage (ids, names, transforms, recorded spawns) for entityCount
+         * live entities, so spawning up to that many does not reallocate or rehash.
+         */
+        void reserve(size_t entityCount);
+
+        /** Pre-sizes one component type's storage, e.g. reserveComponents<MeshComponent>(meshCount). */
+        template <typename Component>
+        void reserveComponents(const size_t count)
+        {
+            getStorage<Component>().reserve(count);
+        }
+
         const Entity* getEntity(EntityId id) const;
-        const Entity* getEntityByName(const std::string& name) const;
+        const Entity* getEntityByName(std::string_view name) const;
+        /** The live entity in slot getEntityIndex(id), whatever its generation. Returns nullptr if the slot is free. */
+        const Entity* getEntityByIndex(uint32_t index) const;
         std::vector<const Entity*> getAllEntities() const;
 
+        /**
+         * Read-only copy of every entity and component, safe to read on any thread while this manager
+         * keeps changing. Shares storage chunks instead of copying them; a chunk is cloned only when
+         * it is next written. Call from the owning thread while nothing is writing.
+         */
+        [[nodiscard]] EntitySnapshot snapshot() const;
+
+        /**
+         * Takes a snapshot() and makes it the next epoch getPublishedSnapshot() returns. Like
+         * snapshot(), it needs nothing else to be writing. The main loop calls this once before its
+         * first frame, and clearSceneEntities() calls it so that no epoch keeps an unloaded scene alive.
+         */
+        void publishSnapshot();
+
+        /**
+         * publishSnapshot() at a frame boundary, skipped (returning false) while nobody has called
+         * getPublishedSnapshot() since the last epoch: a published epoch keeps every chunk shared,
+         * and the next write to each clones it.
+         */
+        bool publishSnapshotIfRead();
+
+        /**
+         * The last published epoch; empty, with epoch 0, before the first publishSnapshot(). Any thread
+         * may call this at any time without locking, which makes it the way for ThreadPool jobs to
+         * read the world while ticks keep changing it. After frames nobody read, the epoch may be
+         * older than the last frame boundary; the call makes the next publishSnapshotIfRead() publish
+         * a new one. A held snapshot stays valid, but keeps its chunks shared, so the next write to
+         * each clones it.
+         */
+        [[nodiscard]] std::shared_ptr<const EntitySnapshot> getPublishedSnapshot() const;
+
+        /**
+         * Clones the chunks of T's storage (Entity's for transforms, names and the like) that a
+         * snapshot still shares. Writes after this don't allocate, and so don't swap chunks under
+         * other threads reading the same storage. SystemScheduler does this before systems run.
+         */
+        template <typename T>
+        void detach()
+        {
+            if constexpr (std::is_same_v<T, Entity>)
+            {
+                entities.detach();
+            }
+            else
+            {
+                getStorage<T>().detach();
+            }
+        }
+
         /** Removes every entity and component. Used when loading a new scene. */
         void clearSceneEntities();
 
-        /** Silently no-ops if no such entity exists. */
+        /** Silently no-ops if no such entity exists. Takes effect on the next updateWorldTransforms(). */
         void setTransform(EntityId id, const math::Transform& transform);
         /** Silently no-ops if no such entity exists. */
         void setMobility(EntityId id, Mobility mobility);
         /** Renames an entity; fails (returns false) if newName is already taken by a different entity. */
-        bool renameEntity(EntityId id, const std::string& newName);
+        bool renameEntity(EntityId id, std::string_view newName);
+
+        /**
+         * Attaches the entity to parentId, or detaches it when parentId is 0. The local transform is
+         * kept, so the entity now moves with its parent. Fails if either entity doesn't exist or
+         * the parent is the entity itself or one of its descendants.
+         */
+        bool setParent(EntityId id, EntityId parentId);
+        /** Direct children in attach order. Empty if the entity has none or doesn't exist. */
+        std::span<const EntityId> getChildren(EntityId id) const;
+
+        /** Local-to-world matrix as of the last updateWorldTransforms(). Returns nullptr if no such entity exists. */
+        const math::Matrix4x4* getWorldMatrix(EntityId id) const;
+
+        /**
+         * Recomputes the cached matrices of every entity whose transform or parent changed since the
+         * last call, and of all their descendants. Parents are finished before their children.
+         */
+        void updateWorldTransforms();
+        /** Same, but each depth level of the changed subtrees is split across the pool. */
+        void updateWorldTransforms(ThreadPool& pool);
+        [[nodiscard]] bool hasDirtyTransforms() const { return !dirtyTransforms.empty(); }
+
+        /**
+         * World bounds of every entity as of the last updateWorldTransforms(); static entities go in
+         * a tree rebuilt only when one of them changes, movable ones are refitted incrementally.
+         */
+        [[nodiscard]] const SpatialIndex& getSpatialIndex() const { return spatialIndex; }
+
+        /** Changes recorded since the last takeChanges(). */
+        [[nodiscard]] const EntityChangeSet& getChanges() const { return changes; }
+        /**
+         * Moves the recorded changes into out and starts a new, empty set. Swaps storage with out, so
+         * a consumer that keeps its EntityChangeSet around does not reallocate.
+         */
+        void takeChanges(EntityChangeSet& out);
+
+        using ObserverId = ComponentObservers::ObserverId;
+        using ObserverFunction = ComponentObservers::ObserverFunction;
+
+        /**
+         * Calls function from dispatchObservers() with every entity whose T was added since the last
+         * dispatch. T is a component type, or Entity for spawns. Only events after registration count.
+         */
+        template <typename T>
+        ObserverId onAdd(ObserverFunction function)
+        {
+            return observers.add<T>(ComponentEvent::Added, std::move(function));
+        }
 
+        /** Like onAdd(), for removals; destroying an entity removes each of its components, then the Entity. */
+        template <typename T>
+        ObserverId onRemove(ObserverFunction function)
+        {
+            return observers.add<T>(ComponentEvent::Removed, std::move(function));
+        }
+
+        /**
+         * Like onAdd(), for components replaced through their add function or reported by
+         * markChanged(); for Entity, renames, re-parents and mobility changes; for math::Transform,
+         * world matrices recomputed by updateWorldTransforms().
+         */
+        template <typename T>
+        ObserverId onChange(ObserverFunction function)
+        {
+            return observers.add<T>(ComponentEvent::Changed, std::move(function));
+        }
+
+        /** Safe to call from an observer. Returns false for unknown ids. */
+        bool removeObserver(const ObserverId id) { return observers.remove(id); }
+
+        /**
+         * Reports a component changed in place, e.g. through mutableView(), to its onChange()
+         * observers and, like a replacing add, to the change set and the entity's spatial bounds.
+         * No-ops if the entity has no such component. Only safe to call from several threads at
+         * once between beginConcurrentMarks() and endConcurrentMarks().
+         */
+        template <typename Component>
+        void markChanged(const EntityId id)
+        {
+            if (getStorage<Component>().contains(id))
+            {
+                observers.record<Component>(ComponentEvent::Changed, id);
+                if constexpr (!std::is_same_v<Component, PrefabComponent>)
+                {
+                    recordInPlaceChange({ id, getComponentType<Component>() });
+                }
+            }
+        }
+
+        /**
+         * Lets threads call markChanged() concurrently, e.g. from parallel chunks of one view, until
+         * endConcurrentMarks() merges what they recorded. SystemScheduler::update() brackets the
+         * systems with these; observers must not be added or removed in between.
+         */
+        void beginConcurrentMarks();
+        void endConcurrentMarks();
+
+        /**
+         * Hands every observer the events its pool collected since the last call. Call once per frame
+         * from the thread that owns the EntityManager, while nothing else uses it.
+         */
+        void dispatchObservers() { observers.dispatch(); }
+
+        /**
+         * Every entity that has all of Components, e.g. view<MeshComponent>() or view<>() for all
+         * entities. Iterates the storages in place without allocating; see EntityView.
+         */
+        template <typename... Components>
+        [[nodiscard]] EntityView<const Components...> view() const
+        {
+            return EntityView<const Components...>(entities, getStorage<Components>()...);
+        }
+
+        /**
+         * Like view(), but components not listed as const can be changed in place, e.g.
+         * mutableView<const MeshComponent, PointLightComponent>(). Adding or removing components is
+         * still done through the add/remove functions; in-place changes reach the change set and
+         * observers only through markChanged(). Clones the writable
+         * components' chunks still shared with a snapshot up front.
+         */
+        template <typename... Components>
+        [[nodiscard]] EntityView<Components...> mutableView()
+        {
+            (detachIfMutable<Components>(), ...);
+            return EntityView<Components...>(entities, getStorage<std::remove_const_t<Components>>()...);
+        }
+
+        /** Silently no-ops if no such entity exists, like the other add*Component functions. */
         void addMeshComponent(EntityId id, MeshComponent component);
         /** Returns nullptr if the entity has no MeshComponent. */
         const MeshComponent* getMeshComponent(EntityId id) const;
@@ -44,11 +315,24 @@ namespace parus
         const PointLightComponent* getPointLightComponent(EntityId id) const;
         void removePointLightComponent(EntityId id);
 
-        /** Every entity that has a MeshComponent, paired with it. */
+        /** Every entity that has a MeshComponent, paired with it. Allocates; prefer view<MeshComponent>(). */
         std::vector<std::pair<const Entity*, const MeshComponent*>> getMeshEntities() const;
-        /** Every entity that has a PointLightComponent, paired with it. */
+        /** Every entity that has a PointLightComponent, paired with it. Allocates; prefer view<PointLightComponent>(). */
         std::vector<std::pair<const Entity*, const PointLightComponent*>> getPointLightEntities() const;
 
+        /** Links the entity to a prefab without touching its components; instantiate() does both. */
+        void addPrefabComponent(EntityId id, PrefabComponent component);
+        /** Returns nullptr if the entity is not a prefab instance. */
+        const PrefabComponent* getPrefabComponent(EntityId id) const;
+        /** Unlinks the entity from its prefab; it keeps its components, which now all count as its own. */
+        void removePrefabComponent(EntityId id);
+
+        /** Replaces any previous chain. Silently no-ops if no such entity exists. */
+        void addLodComponent(EntityId id, LodComponent component);
+        /** Returns nullptr if the entity has no LodComponent. */
+        const LodComponent* getLodComponent(EntityId id) const;
+        void removeLodComponent(EntityId id);
+
         /** Attaches the sun to this entity. Only one entity is expected to hold this component at a time. */
         void addDirectionalLightComponent(EntityId id, DirectionalLightComponent component);
         /** Returns nullptr if no directional light is set. */
@@ -64,16 +348,167 @@ namespace parus
         const SkyboxComponent* getSkyboxComponent() const;
 
     private:
-        EntityId nextId = 1;
-        std::unordered_map<EntityId, Entity> entities;
-        std::unordered_map<std::string, EntityId> nameToId;
-        std::unordered_map<EntityId, MeshComponent> meshComponents;
-        std::unordered_map<EntityId, PointLightComponent> pointLightComponents;
-        std::unordered_map<EntityId, DirectionalLightComponent> directionalLightComponents;
-        std::unordered_map<EntityId, SkyboxComponent> skyboxComponents;
-
-        /** Returns requestedName unchanged if free, otherwise appends the lowest free numeric suffix. */
-        std::string makeUniqueName(const std::string& requestedName) const;
+        /** Per-entity hierarchy links and matrix cache; kept out of Entity so views over entities stay compact. */
+        struct TransformNode
+        {
+            std::vector<EntityId> children;
+            math::Matrix4x4 localMatrix = math::Matrix4x4::identity();
+            math::Matrix4x4 worldMatrix = math::Matrix4x4::identity();
+            /** What the spatial index holds for the entity, refreshed with worldMatrix. */
+            math::Aabb worldBounds;
+            /** Number of ancestors; roots are at depth 0. */
+            uint32_t depth = 0;
+            bool isLocalDirty = true;
+            /** Already in dirtyTransforms. */
+            bool isQueued = false;
+            /** Already in depthBatches during the current update. */
+            bool isScheduled = false;
+            /** Already in dirtyBounds. */
+            bool isBoundsQueued = false;
+        };
+
+        /** Current generation of every index; index 0 is reserved so that 0 is never a valid id. */
+        std::vector<uint32_t> generations { 0 };
+        /** Indices of destroyed entities, reused last-in first-out. */
+        std::vector<uint32_t> freeIndices;
+        ChunkedStorage<Entity> entities;
+        NameTable names;
+        /** Entity holding each interned name, or 0 if the name is free. Indexed by NameId. */
+        std::vector<EntityId> nameOwners;
+        /**
+         * Per base name, the lowest numeric suffix that might still be free: every lower one is taken.
+         * Indexed by the base name's NameId. Keeps repeated spawns of one name linear overall.
+         */
+        std::vector<uint32_t> nextSuffixes;
+        /** Scratch for makeUniqueName(), kept between calls. */
+        std::string candidateName;
+        ChunkedStorage<MeshComponent> meshComponents;
+        ChunkedStorage<PointLightComponent> pointLightComponents;
+        ChunkedStorage<DirectionalLightComponent> directionalLightComponents;
+        ChunkedStorage<SkyboxComponent> skyboxComponents;
+        ChunkedStorage<PrefabComponent> prefabComponents;
+        ChunkedStorage<LodComponent> lodComponents;
+
+        ComponentStorage<TransformNode> transformNodes;
+        /** Entities whose own world matrix is stale; their descendants are found when updating. */
+        std::vector<EntityId> dirtyTransforms;
+        /** Scratch for updateWorldTransforms(), kept between calls: changed entities grouped by depth. */
+        std::vector<std::vector<EntityId>> depthBatches;
+        std::vector<EntityId> traversalStack;
+
+        SpatialIndex spatialIndex;
+        /** Entities whose bounds changed without a transform change, e.g. a mesh or mobility change. */
+        std::vector<EntityId> dirtyBounds;
+
+        EntityChangeSet changes;
+        EpochPublisher<EntitySnapshot> publishedSnapshots;
+        /** Set by getPublishedSnapshot(), cleared by the next publish. */
+        mutable std::atomic<bool> isPublishedSnapshotWanted { false };
+        ComponentObservers observers;
+        /** markChanged() calls between beginConcurrentMarks() and endConcurrentMarks(), applied at the end. */
+        PerThreadBuffers<ComponentChange> concurrentChanges;
+
+        template <typename T>
+        [[nodiscard]] const ChunkedStorage<T>& getStorage() const
+        {
+            if constexpr (std::is_same_v<T, MeshComponent>)
+            {
+                return meshComponents;
+            }
+            else if constexpr (std::is_same_v<T, PointLightComponent>)
+            {
+                return pointLightComponents;
+            }
+            else if constexpr (std::is_same_v<T, DirectionalLightComponent>)
+            {
+                return directionalLightComponents;
+            }
+            else if constexpr (std::is_same_v<T, SkyboxComponent>)
+            {
+                return skyboxComponents;
+            }
+            else if constexpr (std::is_same_v<T, PrefabComponent>)
+            {
+                return prefabComponents;
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, LodComponent>, "EntityManager has no storage for this component type.");
+                return lodComponents;
+            }
+        }
+
+        template <typename T>
+        [[nodiscard]] ChunkedStorage<T>& getStorage()
+        {
+            return const_cast<ChunkedStorage<T>&>(std::as_const(*this).getStorage<T>());
+        }
+
+        template <typename Component>
+        void detachIfMutable()
+        {
+            if constexpr (!std::is_const_v<Component>)
+            {
+                detach<Component>();
+            }
+        }
+
+        void markWorldDirty(EntityId id, TransformNode& node);
+        /** Gives the entity a new depth and renumbers its descendants below it. */
+        void updateSubtreeDepth(EntityId id, uint32_t depth);
+        /** Fills depthBatches with every dirty entity and its descendants. Returns the number of levels used. */
+        size_t collectDirtySubtrees();
+        /** Recomputes one entity's matrices; its parent must already be up to date. */
+        void updateTransformNode(EntityId id);
+        void markBoundsDirty(EntityId id);
+        /** Adds a markChanged() to the change set and dirties the bounds it feeds, or buffers it while marks run concurrently. */
+        void recordInPlaceChange(ComponentChange change);
+        void applyInPlaceChange(ComponentChange change);
+        template <typename Component>
+        [[nodiscard]] static constexpr ComponentType getComponentType()
+        {
+            if constexpr (std::is_same_v<Component, MeshComponent>)
+            {
+                return ComponentType::Mesh;
+            }
+            else if constexpr (std::is_same_v<Component, PointLightComponent>)
+            {
+                return ComponentType::PointLight;
+            }
+            else if constexpr (std::is_same_v<Component, DirectionalLightComponent>)
+            {
+                return ComponentType::DirectionalLight;
+            }
+            else if constexpr (std::is_same_v<Component, SkyboxComponent>)
+            {
+                return ComponentType::Skybox;
+            }
+            else
+            {
+                static_assert(std::is_same_v<Component, LodComponent>, "This component type is not tracked by the change set.");
+                return ComponentType::Lod;
+            }
+        }
+        /** Records Added, or Changed if the entity already had one; call before storing the component. */
+        template <typename Component>
+        void recordComponentAdd(const EntityId id)
+        {
+            observers.record<Component>(getStorage<Component>().contains(id) ? ComponentEvent::Changed : ComponentEvent::Added, id);
+        }
+        /** From the entity's cached world matrix and its mesh and point light components. */
+        [[nodiscard]] math::Aabb computeWorldBounds(EntityId id, const TransformNode& node) const;
+        /** Shared by both updateWorldTransforms() overloads; pool may be null. */
+        void updateWorldTransforms(ThreadPool* pool);
+
+        /** Bumps the generation of a destroyed entity's index and makes the index available to spawn() again. */
+        void releaseIndex(uint32_t index);
+
+        /** Interns name and grows the NameId-indexed tables to cover it. */
+        NameId internName(std::string_view name);
+        /** Returns requestedName unchanged if free, otherwise appends the lowest free numeric suffix. Interns the result. */
+        NameId makeUniqueName(std::string_view requestedName);
+        /** Marks an entity's name free again and lets the suffix counters it could belong to reuse it. */
+        void releaseName(std::string_view name);
     };
 
 }
@@ -0,0 +1,61 @@
+#include "EntitySnapshot.h"
+
+namespace parus
+{
+
+    const Entity* EntitySnapshot::getEntity(EntityId id) const
+    {
+        return entities.find(id);
+    }
+
+    const MeshComponent* EntitySnapshot::getMeshComponent(EntityId id) const
+    {
+        return meshComponents.find(id);
+    }
+
+    const PointLightComponent* EntitySnapshot::getPointLightComponent(EntityId id) const
+    {
+        return pointLightComponents.find(id);
+    }
+
+    const DirectionalLightComponent* EntitySnapshot::getDirectionalLightComponent(EntityId id) const
+    {
+        return directionalLightComponents.find(id);
+    }
+
+    const SkyboxComponent* EntitySnapshot::getSkyboxComponent(EntityId id) const
+    {
+        return skyboxComponents.find(id);
+    }
+
+    const PrefabComponent* EntitySnapshot::getPrefabComponent(EntityId id) const
+    {
+        return prefabComponents.find(id);
+    }
+
+    const LodComponent* EntitySnapshot::getLodComponent(EntityId id) const
+    {
+        return lodComponents.find(id);
+    }
+
+    const Entity* EntitySnapshot::getDirectionalLightEntity() const
+    {
+        return directionalLightComponents.empty() ? nullptr : getEntity(directionalLightComponents.getId(0));
+    }
+
+    const DirectionalLightComponent* EntitySnapshot::getDirectionalLightComponent() const
+    {
+        return directionalLightComponents.empty() ? nullptr : &directionalLightComponents.getValue(0);
+    }
+
+    const Entity* EntitySnapshot::getSkyboxEntity() const
+    {
+        return skyboxComponents.empty() ? nullptr : getEntity(skyboxComponents.getId(0));
+    }
+
+    const SkyboxComponent* EntitySnapshot::getSkyboxComponent() const
+    {
+        return skyboxComponents.empty() ? nullptr : &skyboxComponents.getValue(0);
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "ChunkedStorage.h"
+#include "Components.h"
+#include "Entity.h"
+#include "EntityView.h"
+
+namespace parus
+{
+
+    /**
+     * Read-only copy of every entity and component as EntityManager::snapshot() found them.
+     *
+     * Taking one is O(chunks), not O(entities): it shares the manager's storage chunks, and the
+     * manager clones a chunk only when it next writes to it. A snapshot never changes, so any
+     * thread may read it while the world keeps running, and Entity::name stays valid because the
+     * snapshot keeps the name arena alive too. World matrices, the hierarchy's child lists and the
+     * spatial index are not part of it; Entity::transform and Entity::parent are.
+     */
+    class EntitySnapshot final
+    {
+    public:
+        /** Same as EntityManager::view(). */
+        template <typename... Components>
+        [[nodiscard]] EntityView<const Components...> view() const
+        {
+            return EntityView<const Components...>(entities, getStorage<Components>()...);
+        }
+
+        [[nodiscard]] const Entity* getEntity(EntityId id) const;
+        [[nodiscard]] const MeshComponent* getMeshComponent(EntityId id) const;
+        [[nodiscard]] const PointLightComponent* getPointLightComponent(EntityId id) const;
+        [[nodiscard]] const DirectionalLightComponent* getDirectionalLightComponent(EntityId id) const;
+        [[nodiscard]] const SkyboxComponent* getSkyboxComponent(EntityId id) const;
+        [[nodiscard]] const PrefabComponent* getPrefabComponent(EntityId id) const;
+        [[nodiscard]] const LodComponent* getLodComponent(EntityId id) const;
+
+        /** Which EntityManager::publishSnapshot() made this; 0 for one taken directly with snapshot(). */
+        [[nodiscard]] uint64_t getEpoch() const { return epoch; }
+
+        /** Returns nullptr if no directional light was set. */
+        [[nodiscard]] const Entity* getDirectionalLightEntity() const;
+        [[nodiscard]] const DirectionalLightComponent* getDirectionalLightComponent() const;
+        /** Returns nullptr if no skybox was set. */
+        [[nodiscard]] const Entity* getSkyboxEntity() const;
+        [[nodiscard]] const SkyboxComponent* getSkyboxComponent() const;
+
+    private:
+        friend class EntityManager;
+
+        ChunkedStorage<Entity> entities;
+        ChunkedStorage<MeshComponent> meshComponents;
+        ChunkedStorage<PointLightComponent> pointLightComponents;
+        ChunkedStorage<DirectionalLightComponent> directionalLightComponents;
+        ChunkedStorage<SkyboxComponent> skyboxComponents;
+        ChunkedStorage<PrefabComponent> prefabComponents;
+        ChunkedStorage<LodComponent> lodComponents;
+        /** The NameTable chunks Entity::name points into. */
+        std::vector<std::shared_ptr<const char[]>> nameChunks;
+        uint64_t epoch = 0;
+
+        template <typename T>
+        [[nodiscard]] const ChunkedStorage<T>& getStorage() const
+        {
+            if constexpr (std::is_same_v<T, MeshComponent>)
+            {
+                return meshComponents;
+            }
+            else if constexpr (std::is_same_v<T, PointLightComponent>)
+            {
+                return pointLightComponents;
+            }
+            else if constexpr (std::is_same_v<T, DirectionalLightComponent>)
+            {
+                return directionalLightComponents;
+            }
+            else if constexpr (std::is_same_v<T, SkyboxComponent>)
+            {
+                return skyboxComponents;
+            }
+            else if constexpr (std::is_same_v<T, PrefabComponent>)
+            {
+                return prefabComponents;
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, LodComponent>, "EntitySnapshot has no storage for this component type.");
+                return lodComponents;
+            }
+        }
+    };
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ChunkedStorage.h"
+#include "Entity.h"
+#include "services/threading/Parallel.h"
+
+namespace parus
+{
+
+    /**
+     * Non-owning, non-allocating query over every entity that has all of Components, returned by
+     * EntityManager::view() and EntityManager::mutableView(). With no components it visits every entity.
+     * Components listed as const are passed by const reference, the others can be changed in place.
+     *
+     * Iteration walks the first component's dense array and looks the others up by id, so list the
+     * rarest component first. Visit order is the storage's dense order, the same order
+     * getMeshEntities()/getPointLightEntities() return. The view reads the storages it was made from:
+     * it must not outlive the EntityManager (or EntitySnapshot), and entities must not be spawned,
+     * destroyed or have components added/removed while it iterates.
+     */
+    template <typename... Components>
+    class EntityView final
+    {
+    public:
+        /** Const components read a const storage. */
+        template <typename Component>
+        using Storage = std::conditional_t<std::is_const_v<Component>,
+            const ChunkedStorage<std::remove_const_t<Component>>, ChunkedStorage<Component>>;
+
+        /** Non-const storages must have been detach()ed, so parallelEach() never clones a chunk. */
+        explicit EntityView(const ChunkedStorage<Entity>& entities, Storage<Components>&... storages)
+            : entities(entities)
+            , storages(&storages...)
+        {
+        }
+
+        /** O(1) for zero or one component; otherwise counts matches with one pass over the first component. */
+        [[nodiscard]] size_t size() const
+        {
+            if constexpr (sizeof...(Components) <= 1)
+            {
+                return getDrivingSize();
+            }
+            else
+            {
+                size_t count = 0;
+                each([&count](const Entity&, Components&...) { ++count; });
+                return count;
+            }
+        }
+
+        [[nodiscard]] bool empty() const { return size() == 0; }
+
+        /** Calls function(const Entity&, Components&...) for every matching entity. */
+        template <typename Function>
+        void each(Function&& function) const
+        {
+            eachInRange(0, getDrivingSize(), function);
+        }
+
+        /**
+         * Like each(), but splits the dense array into chunks run on the pool. The function is called
+         * concurrently from several threads and must only write to per-entity or thread-safe state,
+         * such as the visited entity's own non-const components.
+         */
+        template <typename Function>
+        void parallelEach(ThreadPool& pool, Function&& function, const size_t grainSize = DEFAULT_GRAIN_SIZE) const
+        {
+            parallelForRange(pool, 0, getDrivingSize(), [this, &function](const size_t chunkBegin, const size_t chunkEnd)
+            {
+                eachInRange(chunkBegin, chunkEnd, function);
+            }, grainSize);
+        }
+
+    private:
+        [[nodiscard]] size_t getDrivingSize() const
+        {
+            if constexpr (sizeof...(Components) == 0)
+            {
+                return entities.size();
+            }
+            else
+            {
+                return std::get<0>(storages)->size();
+            }
+        }
+
+        [[nodiscard]] EntityId getDrivingId(const size_t slot) const
+        {
+            if constexpr (sizeof...(Components) == 0)
+            {
+                return entities.getId(slot);
+            }
+            else
+            {
+                return std::get<0>(storages)->getId(slot);
+            }
+        }
+
+        template <typename Function>
+        void eachInRange(const size_t begin, const size_t end, Function& function) const
+        {
+            for (size_t slot = begin; slot < end; ++slot)
+            {
+                visit(slot, function, std::index_sequence_for<Components...>());
+            }
+        }
+
+        template <typename Function, size_t... Indices>
+        void visit(const size_t slot, Function& function, std::index_sequence<Indices...>) const
+        {
+            const EntityId id = getDrivingId(slot);
+            const Entity* entity = sizeof...(Components) == 0 ? &entities.getValue(slot) : entities.find(id);
+            const std::tuple<Components*...> components { getComponent<Indices>(slot, id)... };
+
+            if (!entity || ((std::get<Indices>(components) == nullptr) || ...))
+            {
+                return;
+            }
+
+            function(*entity, *std::get<Indices>(components)...);
+        }
+
+        /** The driving component is read by slot; the others need an id lookup. */
+        template <size_t Index>
+        [[nodiscard]] auto* getComponent(const size_t slot, const EntityId id) const
+        {
+            using Component = std::tuple_element_t<Index, std::tuple<Components...>>;
+            if constexpr (Index == 0 && std::is_const_v<Component>)
+            {
+                return &std::get<0>(storages)->getValue(slot);
+            }
+            else if constexpr (Index == 0)
+            {
+                return &std::get<0>(storages)->getMutableValue(slot);
+            }
+            else if constexpr (std::is_const_v<Component>)
+            {
+                return std::get<Index>(storages)->find(id);
+            }
+            else
+            {
+                return std::get<Index>(storages)->findMutable(id);
+            }
+        }
+
+        const ChunkedStorage<Entity>& entities;
+        std::tuple<Storage<Components>*...> storages;
+    };
+
+}
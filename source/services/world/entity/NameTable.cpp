@@ -0,0 +1,91 @@
+#include "NameTable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace parus
+{
+
+    NameId NameTable::intern(const std::string_view name)
+    {
+        if (const auto nameIterator = ids.find(name); nameIterator != ids.end())
+        {
+            return nameIterator->second;
+        }
+
+        const NameId id = static_cast<NameId>(names.size());
+        const std::string_view storedName = store(name);
+        names.push_back(storedName);
+        ids.emplace(storedName, id);
+        return id;
+    }
+
+    std::optional<NameId> NameTable::find(const std::string_view name) const
+    {
+        const auto nameIterator = ids.find(name);
+        if (nameIterator == ids.end())
+        {
+            return std::nullopt;
+        }
+
+        return nameIterator->second;
+    }
+
+    void NameTable::clear()
+    {
+        names.clear();
+        ids.clear();
+        currentChunk = 0;
+        currentChunkUsed = 0;
+
+        // A snapshot may still read a shared chunk, so only the others are overwritten by new names.
+        std::erase_if(chunks, [](const Chunk& chunk) { return chunk.data.use_count() != 1; });
+        // Snapshots released the kept ones on other threads; their reads finish before our writes.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    std::vector<std::shared_ptr<const char[]>> NameTable::shareChunks() const
+    {
+        std::vector<std::shared_ptr<const char[]>> sharedChunks;
+        sharedChunks.reserve(chunks.size());
+        for (const Chunk& chunk : chunks)
+        {
+            sharedChunks.push_back(chunk.data);
+        }
+        return sharedChunks;
+    }
+
+    void NameTable::reserve(const size_t nameCount)
+    {
+        names.reserve(nameCount);
+        ids.reserve(nameCount);
+    }
+
+    std::string_view NameTable::store(const std::string_view text)
+    {
+        if (text.empty())
+        {
+            return {};
+        }
+
+        // Move on to the first chunk, reused or new, with room for the whole string.
+        while (currentChunk < chunks.size() && chunks[currentChunk].capacity - currentChunkUsed < text.size())
+        {
+            ++currentChunk;
+            currentChunkUsed = 0;
+        }
+        if (currentChunk == chunks.size())
+        {
+            const size_t capacity = std::max(CHUNK_SIZE, text.size());
+            chunks.push_back(Chunk{ std::make_shared<char[]>(capacity), capacity });
+            currentChunkUsed = 0;
+        }
+
+        char* destination = chunks[currentChunk].data.get() + currentChunkUsed;
+        std::memcpy(destination, text.data(), text.size());
+        currentChunkUsed += text.size();
+        return { destination, text.size() };
+    }
+
+}
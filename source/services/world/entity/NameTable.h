@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parus
+{
+
+    /** Index of a string interned in a NameTable. */
+    using NameId = uint32_t;
+
+    /**
+     * Interned strings backed by an arena of fixed-size character chunks.
+     *
+     * Each distinct string is copied once; afterwards it is addressed by a dense NameId or by the
+     * string_view get() returns. Views stay valid until clear(), since chunks never move or shrink.
+     * Strings are never removed individually, so the table grows with the number of distinct names
+     * seen, not with the number of lookups.
+     *
+     * Chunks are reference-counted: shareChunks() lets a snapshot keep the views it copied valid
+     * past clear(), which then leaves the shared chunks to their holders instead of reusing them.
+     */
+    class NameTable final
+    {
+    public:
+        /** Returns the id of name, copying it into the arena the first time it is seen. */
+        NameId intern(std::string_view name);
+
+        /** Returns std::nullopt if name was never interned. Does not allocate. */
+        [[nodiscard]] std::optional<NameId> find(std::string_view name) const;
+
+        /** The interned text of id; valid until clear(). */
+        [[nodiscard]] std::string_view get(const NameId id) const { return names[id]; }
+
+        [[nodiscard]] size_t size() const { return names.size(); }
+
+        /**
+         * Forgets every name but keeps the arena chunks for reuse. Invalidates all ids, and the views
+         * into chunks nobody shares.
+         */
+        void clear();
+
+        /** Shared ownership of every chunk, keeping the views into them valid even after clear(). */
+        [[nodiscard]] std::vector<std::shared_ptr<const char[]>> shareChunks() const;
+
+        void reserve(size_t nameCount);
+
+    private:
+        static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+        struct Chunk
+        {
+            std::shared_ptr<char[]> data;
+            size_t capacity = 0;
+        };
+
+        /** Copies text into the arena and returns the stable copy. */
+        std::string_view store(std::string_view text);
+
+        std::vector<Chunk> chunks;
+        /** Chunk currently being filled and how much of it is used. */
+        size_t currentChunk = 0;
+        size_t currentChunkUsed = 0;
+
+        std::vector<std::string_view> names;
+        /** Keys are views into the arena, so lookups by any string_view need no temporary string. */
+        std::unordered_map<std::string_view, NameId> ids;
+    };
+
+}
@@ -0,0 +1,138 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "services/threading/Parallel.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace parus
+{
+
+    namespace
+    {
+        /** Bounding sphere diameter over the frustum height at that distance; infinite once the camera is inside the sphere. */
+        float computeScreenSize(const float radius, const float distance, const float tanHalfFieldOfView)
+        {
+            if (distance <= radius)
+            {
+                return std::numeric_limits<float>::infinity();
+            }
+
+            return radius / (distance * tanHalfFieldOfView);
+        }
+    }
+
+    void LodSelector::update(const EntityManager& entityManager, const math::Vector3& cameraPosition, const LodSettings& settings, ThreadPool& pool)
+    {
+        changed.clear();
+
+        // Backwards, as erase() moves the last entry into the freed slot.
+        const std::span<const EntityId> ids = entries.getIds();
+        for (size_t slot = ids.size(); slot-- > 0;)
+        {
+            if (!entityManager.getLodComponent(ids[slot]))
+            {
+                entries.erase(ids[slot]);
+            }
+        }
+
+        entityManager.view<LodComponent>().each([this](const Entity& entity, const LodComponent&)
+        {
+            if (!entries.contains(entity.id))
+            {
+                entries.insertOrAssign(entity.id, Entry {});
+            }
+        });
+
+        changedFlags.assign(entries.size(), 0);
+        const std::span<const EntityId> entryIds = entries.getIds();
+        const std::span<Entry> entryValues = entries.getValues();
+        const float tanHalfFieldOfView = std::tan(settings.verticalFieldOfView * 0.5f);
+
+        parallelForRange(pool, 0, entryValues.size(), [&](const size_t chunkBegin, const size_t chunkEnd)
+        {
+            for (size_t slot = chunkBegin; slot < chunkEnd; ++slot)
+            {
+                const math::Aabb* bounds = entityManager.getSpatialIndex().getBounds(entryIds[slot]);
+                if (!bounds)
+                {
+                    continue;
+                }
+
+                const std::span<const LodLevel> levels = entityManager.getLodComponent(entryIds[slot])->levels;
+                const float radius = bounds->extents().length();
+                const float distance = (bounds->center() - cameraPosition).length();
+
+                Entry& entry = entryValues[slot];
+                const std::optional<uint32_t> level = entry.isSelected ? std::optional(entry.selection.level) : std::nullopt;
+                const std::optional<uint32_t> shadowLevel = entry.isSelected ? std::optional(entry.selection.shadowLevel) : std::nullopt;
+                const Selection selection {
+                    selectLevel(levels, computeScreenSize(radius, distance * settings.distanceScale, tanHalfFieldOfView), level, settings.hysteresis),
+                    selectLevel(levels, computeScreenSize(radius, distance * settings.shadowDistanceScale, tanHalfFieldOfView), shadowLevel, settings.hysteresis)
+                };
+
+                if (!entry.isSelected || selection != entry.selection)
+                {
+                    entry.selection = selection;
+                    entry.isSelected = true;
+                    changedFlags[slot] = 1;
+                }
+            }
+        });
+
+        for (size_t slot = 0; slot < changedFlags.size(); ++slot)
+        {
+            if (changedFlags[slot])
+            {
+                changed.push_back(entryIds[slot]);
+            }
+        }
+    }
+
+    const LodSelector::Selection* LodSelector::find(const EntityId id) const
+    {
+        const Entry* entry = entries.find(id);
+        return entry ? &entry->selection : nullptr;
+    }
+
+    void LodSelector::clear()
+    {
+        entries.clear();
+        changedFlags.clear();
+        changed.clear();
+    }
+
+    uint32_t LodSelector::selectLevel(const std::span<const LodLevel> levels, const float screenSize, const std::optional<uint32_t> current, const float hysteresis)
+    {
+        if (levels.empty())
+        {
+            return 0;
+        }
+
+        const uint32_t lastLevel = static_cast<uint32_t>(levels.size() - 1);
+        if (!current)
+        {
+            uint32_t level = 0;
+            while (level < lastLevel && screenSize < levels[level].minScreenSize)
+            {
+                ++level;
+            }
+            return level;
+        }
+
+        // The chain may have been replaced by a shorter one since.
+        uint32_t level = std::min(*current, lastLevel);
+        while (level < lastLevel && screenSize < levels[level].minScreenSize * (1.0f - hysteresis))
+        {
+            ++level;
+        }
+        while (level > 0 && screenSize >= levels[level - 1].minScreenSize * (1.0f + hysteresis))
+        {
+            --level;
+        }
+        return level;
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "engine/utils/math/Math.h"
+#include "services/world/entity/ComponentStorage.h"
+#include "services/world/entity/Components.h"
+#include "services/world/entity/Entity.h"
+
+namespace parus
+{
+    class EntityManager;
+    class ThreadPool;
+
+    struct LodSettings final
+    {
+        /** Of the camera the levels are picked for, in radians. */
+        float verticalFieldOfView = 0.785398f;
+        /** Multiplies camera distances: above 1 switches to coarser levels sooner. */
+        float distanceScale = 1.0f;
+        /** Same for the shadow level, which can usually be coarser than the one drawn on screen. */
+        float shadowDistanceScale = 2.0f;
+        /**
+         * Dead band around each threshold, as a fraction of it. An entity switches to a coarser level
+         * only once it is this much below the threshold and back only once it is this much above, so
+         * one hovering near a threshold doesn't flicker between levels.
+         */
+        float hysteresis = 0.1f;
+    };
+
+    /**
+     * Picks the LodComponent level every entity is drawn at, and the one it casts shadows with.
+     *
+     * update() estimates each entity's on-screen size from its spatial index bounds and the camera
+     * distance, then picks a level per LodLevel::minScreenSize, starting from the entity's previous
+     * level so the hysteresis band applies. The per-entity work is split across the ThreadPool;
+     * adding and dropping entities happens before that on the calling thread. getChanged() then
+     * lists the entities whose selection moved, so the renderer only touches those.
+     */
+    class LodSelector final
+    {
+    public:
+        struct Selection final
+        {
+            uint32_t level = 0;
+            uint32_t shadowLevel = 0;
+
+            bool operator==(const Selection& other) const = default;
+        };
+
+        /**
+         * Reselects every entity that has an LodComponent and forgets the ones that lost it.
+         * Reads entityManager from several threads, so nothing may change it meanwhile.
+         */
+        void update(const EntityManager& entityManager, const math::Vector3& cameraPosition, const LodSettings& settings, ThreadPool& pool);
+
+        /** Returns nullptr if the entity had no LodComponent at the last update(). */
+        [[nodiscard]] const Selection* find(EntityId id) const;
+
+        /** Entities selected for the first time or whose selection changed during the last update(). */
+        [[nodiscard]] std::span<const EntityId> getChanged() const { return changed; }
+
+        /** Forgets every selection, e.g. when the scene is replaced. */
+        void clear();
+
+        /**
+         * The level for an entity covering screenSize of the screen height: the first one whose
+         * minScreenSize it reaches, or with a current level, that level moved no further than the
+         * hysteresis band requires. Returns 0 for an empty chain.
+         */
+        [[nodiscard]] static uint32_t selectLevel(std::span<const LodLevel> levels, float screenSize, std::optional<uint32_t> current, float hysteresis);
+
+    private:
+        struct Entry
+        {
+            Selection selection;
+            /** False until the first update() that found bounds for the entity. */
+            bool isSelected = false;
+        };
+
+        ComponentStorage<Entry> entries;
+        /** Per entry, set by the parallel pass; bytes rather than vector<bool> so threads don't share words. */
+        std::vector<uint8_t> changedFlags;
+        std::vector<EntityId> changed;
+    };
+
+}
@@ -0,0 +1,311 @@
+#include "AabbTree.h"
+
+#include <algorithm>
+
+namespace parus
+{
+
+    AabbTree::NodeIndex AabbTree::insert(const EntityId id, const math::Aabb& bounds)
+    {
+        const NodeIndex leaf = allocateNode();
+        nodes[leaf].bounds = bounds.expand(margin);
+        nodes[leaf].id = id;
+        nodes[leaf].height = 0;
+
+        insertLeaf(leaf);
+        ++leafCount;
+        return leaf;
+    }
+
+    void AabbTree::remove(const NodeIndex leaf)
+    {
+        removeLeaf(leaf);
+        freeNode(leaf);
+        --leafCount;
+    }
+
+    bool AabbTree::update(const NodeIndex leaf, const math::Aabb& bounds)
+    {
+        if (nodes[leaf].bounds.contains(bounds))
+        {
+            return false;
+        }
+
+        removeLeaf(leaf);
+        nodes[leaf].bounds = bounds.expand(margin);
+        insertLeaf(leaf);
+        return true;
+    }
+
+    void AabbTree::build(const std::span<const std::pair<EntityId, math::Aabb>> items)
+    {
+        clear();
+        if (items.empty())
+        {
+            return;
+        }
+
+        // Leaves and internal nodes: 2n - 1 in total.
+        nodes.reserve(items.size() * 2);
+        buildLeaves.clear();
+        for (const auto& [id, bounds] : items)
+        {
+            const NodeIndex leaf = allocateNode();
+            nodes[leaf].bounds = bounds.expand(margin);
+            nodes[leaf].id = id;
+            nodes[leaf].height = 0;
+            buildLeaves.push_back(leaf);
+        }
+
+        leafCount = items.size();
+        root = buildSubtree(buildLeaves);
+        nodes[root].parent = NULL_NODE;
+    }
+
+    void AabbTree::clear()
+    {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+        leafCount = 0;
+    }
+
+    AabbTree::NodeIndex AabbTree::allocateNode()
+    {
+        if (freeList == NULL_NODE)
+        {
+            nodes.emplace_back();
+            return static_cast<NodeIndex>(nodes.size() - 1);
+        }
+
+        const NodeIndex index = freeList;
+        freeList = nodes[index].parent;
+        nodes[index] = Node {};
+        return index;
+    }
+
+    void AabbTree::freeNode(const NodeIndex index)
+    {
+        nodes[index].parent = freeList;
+        nodes[index].height = -1;
+        freeList = index;
+    }
+
+    void AabbTree::insertLeaf(const NodeIndex leaf)
+    {
+        if (root == NULL_NODE)
+        {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // Walk down choosing the child whose box grows least (surface area heuristic), and stop
+        // where pairing with the current node is cheaper than descending.
+        const math::Aabb leafBounds = nodes[leaf].bounds;
+        NodeIndex index = root;
+        while (!nodes[index].isLeaf())
+        {
+            const Node& node = nodes[index];
+            const float area = node.bounds.surfaceArea();
+            const float combinedArea = node.bounds.merge(leafBounds).surfaceArea();
+
+            const float pairCost = 2.0f * combinedArea;
+            // Every ancestor below here grows by at least this much.
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            const auto descendCost = [this, &leafBounds, inheritanceCost](const NodeIndex child)
+            {
+                const Node& childNode = nodes[child];
+                const float mergedArea = childNode.bounds.merge(leafBounds).surfaceArea();
+                return (childNode.isLeaf() ? mergedArea : mergedArea - childNode.bounds.surfaceArea()) + inheritanceCost;
+            };
+            const float leftCost = descendCost(node.left);
+            const float rightCost = descendCost(node.right);
+
+            if (pairCost < leftCost && pairCost < rightCost)
+            {
+                break;
+            }
+            index = leftCost < rightCost ? node.left : node.right;
+        }
+
+        const NodeIndex sibling = index;
+        const NodeIndex oldParent = nodes[sibling].parent;
+        const NodeIndex newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].bounds = nodes[sibling].bounds.merge(leafBounds);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].left = sibling;
+        nodes[newParent].right = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent == NULL_NODE)
+        {
+            root = newParent;
+        }
+        else if (nodes[oldParent].left == sibling)
+        {
+            nodes[oldParent].left = newParent;
+        }
+        else
+        {
+            nodes[oldParent].right = newParent;
+        }
+
+        refitAncestors(newParent);
+    }
+
+    void AabbTree::removeLeaf(const NodeIndex leaf)
+    {
+        if (leaf == root)
+        {
+            root = NULL_NODE;
+            return;
+        }
+
+        const NodeIndex parent = nodes[leaf].parent;
+        const NodeIndex grandParent = nodes[parent].parent;
+        const NodeIndex sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        freeNode(parent);
+        if (grandParent == NULL_NODE)
+        {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            return;
+        }
+
+        if (nodes[grandParent].left == parent)
+        {
+            nodes[grandParent].left = sibling;
+        }
+        else
+        {
+            nodes[grandParent].right = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+
+        refitAncestors(grandParent);
+    }
+
+    void AabbTree::refitAncestors(NodeIndex index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+
+            Node& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+            node.bounds = nodes[node.left].bounds.merge(nodes[node.right].bounds);
+
+            index = node.parent;
+        }
+    }
+
+    AabbTree::NodeIndex AabbTree::balance(const NodeIndex indexA)
+    {
+        if (nodes[indexA].isLeaf() || nodes[indexA].height < 2)
+        {
+            return indexA;
+        }
+
+        const NodeIndex indexB = nodes[indexA].left;
+        const NodeIndex indexC = nodes[indexA].right;
+        const int32_t heightDifference = nodes[indexC].height - nodes[indexB].height;
+        if (heightDifference >= -1 && heightDifference <= 1)
+        {
+            return indexA;
+        }
+
+        // The taller child P takes A's place; A keeps its other child and the shorter grandchild
+        // from P, and P keeps the taller grandchild.
+        const bool isRightTaller = heightDifference > 1;
+        const NodeIndex indexP = isRightTaller ? indexC : indexB;
+        const NodeIndex indexShortSide = isRightTaller ? indexB : indexC;
+        Node& nodeA = nodes[indexA];
+        Node& nodeP = nodes[indexP];
+
+        const NodeIndex indexF = nodeP.left;
+        const NodeIndex indexG = nodeP.right;
+        const bool isLeftGrandchildTaller = nodes[indexF].height > nodes[indexG].height;
+        const NodeIndex indexTall = isLeftGrandchildTaller ? indexF : indexG;
+        const NodeIndex indexShort = isLeftGrandchildTaller ? indexG : indexF;
+
+        nodeP.parent = nodeA.parent;
+        nodeA.parent = indexP;
+        if (nodeP.parent == NULL_NODE)
+        {
+            root = indexP;
+        }
+        else if (nodes[nodeP.parent].left == indexA)
+        {
+            nodes[nodeP.parent].left = indexP;
+        }
+        else
+        {
+            nodes[nodeP.parent].right = indexP;
+        }
+
+        nodeP.left = indexA;
+        nodeP.right = indexTall;
+        if (isRightTaller)
+        {
+            nodeA.right = indexShort;
+        }
+        else
+        {
+            nodeA.left = indexShort;
+        }
+        nodes[indexShort].parent = indexA;
+
+        nodeA.bounds = nodes[indexShortSide].bounds.merge(nodes[indexShort].bounds);
+        nodeA.height = 1 + std::max(nodes[indexShortSide].height, nodes[indexShort].height);
+        nodeP.bounds = nodeA.bounds.merge(nodes[indexTall].bounds);
+        nodeP.height = 1 + std::max(nodeA.height, nodes[indexTall].height);
+
+        return indexP;
+    }
+
+    AabbTree::NodeIndex AabbTree::buildSubtree(const std::span<NodeIndex> leaves)
+    {
+        if (leaves.size() == 1)
+        {
+            return leaves[0];
+        }
+
+        math::Aabb centerBounds;
+        for (const NodeIndex leaf : leaves)
+        {
+            centerBounds = centerBounds.merge(math::Aabb::fromPoint(nodes[leaf].bounds.center()));
+        }
+
+        const math::Vector3 size = centerBounds.max - centerBounds.min;
+        const int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+        const auto axisCenter = [this, axis](const NodeIndex leaf)
+        {
+            const math::Aabb& bounds = nodes[leaf].bounds;
+            return axis == 0 ? bounds.min.x + bounds.max.x : (axis == 1 ? bounds.min.y + bounds.max.y : bounds.min.z + bounds.max.z);
+        };
+
+        const size_t middle = leaves.size() / 2;
+        std::nth_element(leaves.begin(), leaves.begin() + static_cast<std::ptrdiff_t>(middle), leaves.end(),
+            [&axisCenter](const NodeIndex a, const NodeIndex b) { return axisCenter(a) < axisCenter(b); });
+
+        const NodeIndex left = buildSubtree(leaves.first(middle));
+        const NodeIndex right = buildSubtree(leaves.subspan(middle));
+
+        const NodeIndex parent = allocateNode();
+        Node& node = nodes[parent];
+        node.left = left;
+        node.right = right;
+        node.bounds = nodes[left].bounds.merge(nodes[right].bounds);
+        node.height = 1 + std::max(nodes[left].height, nodes[right].height);
+        nodes[left].parent = parent;
+        nodes[right].parent = parent;
+
+        return parent;
+    }
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/Asserts.h"
+#include "engine/utils/math/Bounds.h"
+#include "services/world/entity/Entity.h"
+
+namespace parus
+{
+
+    /**
+     * Bounding volume hierarchy over entity boxes.
+     *
+     * Used two ways by SpatialIndex:
+     *  - incrementally: insert()/update()/remove() keep the tree balanced with AVL-style rotations,
+     *    and each leaf stores its box grown by a margin, so an entity that moves a little stays in
+     *    its leaf and costs nothing;
+     *  - in bulk: build() replaces the contents with a top-down tree split at the median of the
+     *    longest axis, which is tighter than the incremental one but has to be rebuilt to change.
+     *
+     * Leaves are addressed by the NodeIndex insert() returns; it stays valid until remove(), clear()
+     * or build(). Not thread-safe; queries may run concurrently with each other only.
+     */
+    class AabbTree final
+    {
+    public:
+        using NodeIndex = int32_t;
+        static constexpr NodeIndex NULL_NODE = -1;
+
+        explicit AabbTree(float margin = 0.0f) : margin(margin) {}
+
+        /** Adds a leaf for id. Returns its index. */
+        NodeIndex insert(EntityId id, const math::Aabb& bounds);
+        void remove(NodeIndex leaf);
+        /**
+         * Moves the leaf to new bounds. Returns false without touching the tree while the bounds
+         * still fit in the leaf's margin-grown box.
+         */
+        bool update(NodeIndex leaf, const math::Aabb& bounds);
+
+        /** Replaces everything with a freshly built tree over items. */
+        void build(std::span<const std::pair<EntityId, math::Aabb>> items);
+        void clear();
+
+        [[nodiscard]] size_t size() const { return leafCount; }
+        /** Longest root-to-leaf path; 0 for an empty tree or a single leaf. */
+        [[nodiscard]] int32_t getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+        /**
+         * Visits every leaf whose box passes overlaps(const math::Aabb&), pruning subtrees whose box
+         * fails it. visit(EntityId) is called per leaf; for incrementally built trees the test sees
+         * the margin-grown box, so callers wanting exact results recheck the entity's own bounds.
+         */
+        template <typename Overlaps, typename Visit>
+        void query(Overlaps&& overlaps, Visit&& visit) const
+        {
+            if (root == NULL_NODE)
+            {
+                return;
+            }
+
+            std::array<NodeIndex, MAX_QUERY_STACK> stack;
+            size_t stackSize = 0;
+            stack[stackSize++] = root;
+
+            while (stackSize > 0)
+            {
+                const Node& node = nodes[stack[--stackSize]];
+                if (!overlaps(node.bounds))
+                {
+                    continue;
+                }
+
+                if (node.isLeaf())
+                {
+                    visit(node.id);
+                    continue;
+                }
+
+                ASSERT(stackSize + 2 <= MAX_QUERY_STACK, "AabbTree query stack overflow.");
+                stack[stackSize++] = node.right;
+                stack[stackSize++] = node.left;
+            }
+        }
+
+    private:
+        /** Balanced trees stay far below this: a million leaves is about 30 levels. */
+        static constexpr size_t MAX_QUERY_STACK = 256;
+
+        struct Node
+        {
+            math::Aabb bounds;
+            /** Parent while in the tree, next free node while on the free list. */
+            NodeIndex parent = NULL_NODE;
+            NodeIndex left = NULL_NODE;
+            NodeIndex right = NULL_NODE;
+            /** 0 for leaves, -1 for free nodes. */
+            int32_t height = 0;
+            EntityId id = 0;
+
+            [[nodiscard]] bool isLeaf() const { return left == NULL_NODE; }
+        };
+
+        NodeIndex allocateNode();
+        void freeNode(NodeIndex index);
+
+        void insertLeaf(NodeIndex leaf);
+        void removeLeaf(NodeIndex leaf);
+        /** Recomputes bounds and heights from index up to the root, rotating where unbalanced. */
+        void refitAncestors(NodeIndex index);
+        /** Rotates the subtree at index if its children's heights differ by more than one. Returns its new root. */
+        NodeIndex balance(NodeIndex index);
+        /** Builds a subtree over the given leaves, reordering them. Returns its root. */
+        NodeIndex buildSubtree(std::span<NodeIndex> leaves);
+
+        float margin = 0.0f;
+        std::vector<Node> nodes;
+        NodeIndex root = NULL_NODE;
+        NodeIndex freeList = NULL_NODE;
+        size_t leafCount = 0;
+        /** Scratch for build(). */
+        std::vector<NodeIndex> buildLeaves;
+    };
+
+}
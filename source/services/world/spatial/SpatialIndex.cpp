@@ -0,0 +1,124 @@
+#include "SpatialIndex.h"
+
+namespace parus
+{
+
+    void SpatialIndex::update(const EntityId id, const math::Aabb& bounds, const Mobility mobility)
+    {
+        Entry* entry = entries.find(id);
+        if (entry && entry->mobility != mobility)
+        {
+            // Switching trees: start over as a new entry.
+            remove(id);
+            entry = nullptr;
+        }
+
+        if (!entry)
+        {
+            Entry& newEntry = entries.insertOrAssign(id, Entry { bounds, mobility, AabbTree::NULL_NODE });
+            if (mobility == Mobility::Movable)
+            {
+                newEntry.leaf = movableTree.insert(id, bounds);
+            }
+            else
+            {
+                isStaticTreeDirty = true;
+            }
+            return;
+        }
+
+        if (entry->bounds == bounds)
+        {
+            return;
+        }
+
+        entry->bounds = bounds;
+        if (entry->leaf != AabbTree::NULL_NODE)
+        {
+            movableTree.update(entry->leaf, bounds);
+        }
+        else
+        {
+            isStaticTreeDirty = true;
+        }
+    }
+
+    bool SpatialIndex::remove(const EntityId id)
+    {
+        const Entry* entry = entries.find(id);
+        if (!entry)
+        {
+            return false;
+        }
+
+        if (entry->leaf != AabbTree::NULL_NODE)
+        {
+            movableTree.remove(entry->leaf);
+        }
+        else
+        {
+            isStaticTreeDirty = true;
+        }
+
+        entries.erase(id);
+        return true;
+    }
+
+    void SpatialIndex::clear()
+    {
+        entries.clear();
+        staticTree.clear();
+        movableTree.clear();
+        isStaticTreeDirty = false;
+    }
+
+    void SpatialIndex::reserve(const size_t entityCount)
+    {
+        entries.reserve(entityCount);
+    }
+
+    void SpatialIndex::commit()
+    {
+        if (!isStaticTreeDirty)
+        {
+            return;
+        }
+        isStaticTreeDirty = false;
+
+        staticItems.clear();
+        const auto ids = entries.getIds();
+        const auto values = entries.getValues();
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (values[i].leaf == AabbTree::NULL_NODE)
+            {
+                staticItems.emplace_back(ids[i], values[i].bounds);
+            }
+        }
+
+        staticTree.build(staticItems);
+    }
+
+    const math::Aabb* SpatialIndex::getBounds(const EntityId id) const
+    {
+        const Entry* entry = entries.find(id);
+        return entry ? &entry->bounds : nullptr;
+    }
+
+    std::optional<RayHit> SpatialIndex::raycast(const math::Ray& ray, const float maxDistance) const
+    {
+        // Each hit shortens the ray, so later subtrees farther than the best hit are skipped.
+        std::optional<RayHit> closestHit;
+        float closestDistance = maxDistance;
+        query([&ray, &closestDistance](const math::Aabb& box) { return ray.intersect(box, closestDistance).has_value(); },
+            [this, &ray, &closestHit, &closestDistance](const EntityId id)
+            {
+                const float distance = *ray.intersect(entries.find(id)->bounds, closestDistance);
+                closestHit = RayHit { id, distance };
+                closestDistance = distance;
+            });
+
+        return closestHit;
+    }
+
+}
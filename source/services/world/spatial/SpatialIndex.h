@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "AabbTree.h"
+#include "engine/utils/math/Bounds.h"
+#include "services/world/entity/ComponentStorage.h"
+#include "services/world/entity/Components.h"
+#include "services/world/entity/Entity.h"
+
+namespace parus
+{
+
+    /** Closest entity box hit by SpatialIndex::raycast(). */
+    struct RayHit final
+    {
+        EntityId id = 0;
+        /** Along the ray, in units of its direction's length; 0 if the origin is inside the box. */
+        float distance = 0.0f;
+    };
+
+    /**
+     * World-space boxes of entities, organized so "what is near / inside / along this" queries cost
+     * about O(log n + results) instead of a scan over every entity.
+     *
+     * Movable entities live in an incrementally updated AabbTree whose leaves carry a margin, so
+     * small moves don't restructure it. Static entities live in a second tree built in one pass by
+     * commit(), which only rebuilds it when a static entry was added, moved or removed since the
+     * last commit; scenes load as static, so they are built once. Until then, static entities that
+     * were added or moved are missing from query results, and removed ones are already gone.
+     *
+     * EntityManager owns one and keeps it in step with world transforms and components; every
+     * query reports each matching entity once, in no particular order.
+     */
+    class SpatialIndex final
+    {
+    public:
+        /** How far a movable entity's box may drift before its tree leaf is reinserted. */
+        static constexpr float MOVABLE_MARGIN = 1.0f;
+
+        /** Adds the entity or changes its bounds or mobility. */
+        void update(EntityId id, const math::Aabb& bounds, Mobility mobility);
+        /** Returns false if the entity wasn't indexed. */
+        bool remove(EntityId id);
+        void clear();
+        void reserve(size_t entityCount);
+
+        /** Rebuilds the static tree if static entries changed since the last commit. */
+        void commit();
+
+        [[nodiscard]] size_t size() const { return entries.size(); }
+        /** Returns nullptr if the entity isn't indexed. */
+        [[nodiscard]] const math::Aabb* getBounds(EntityId id) const;
+
+        /** Calls visit(EntityId) for every entity whose box intersects bounds. */
+        template <typename Visit>
+        void queryAabb(const math::Aabb& bounds, Visit&& visit) const
+        {
+            query([&bounds](const math::Aabb& box) { return box.intersects(bounds); }, visit);
+        }
+
+        /** Calls visit(EntityId) for every entity whose box intersects the sphere. */
+        template <typename Visit>
+        void querySphere(const math::Sphere& sphere, Visit&& visit) const
+        {
+            query([&sphere](const math::Aabb& box) { return sphere.intersects(box); }, visit);
+        }
+
+        /** Calls visit(EntityId) for every entity whose box is at least partly inside the frustum. */
+        template <typename Visit>
+        void queryFrustum(const math::Frustum& frustum, Visit&& visit) const
+        {
+            query([&frustum](const math::Aabb& box) { return frustum.intersects(box); }, visit);
+        }
+
+        /** Calls visit(EntityId, float distance) for every entity whose box the ray enters within maxDistance. */
+        template <typename Visit>
+        void queryRay(const math::Ray& ray, const float maxDistance, Visit&& visit) const
+        {
+            const auto hits = [&ray, maxDistance](const math::Aabb& box) { return ray.intersect(box, maxDistance).has_value(); };
+            query(hits, [this, &ray, maxDistance, &visit](const EntityId id)
+            {
+                visit(id, *ray.intersect(entries.find(id)->bounds, maxDistance));
+            });
+        }
+
+        /** The entity box the ray enters first within maxDistance; boxes only, so callers refine against geometry. */
+        [[nodiscard]] std::optional<RayHit> raycast(const math::Ray& ray, float maxDistance) const;
+
+    private:
+        struct Entry
+        {
+            math::Aabb bounds;
+            Mobility mobility = Mobility::Static;
+            /** Leaf in movableTree; NULL_NODE for static entries. */
+            AabbTree::NodeIndex leaf = AabbTree::NULL_NODE;
+        };
+
+        /**
+         * Walks both trees with the box test and rechecks each candidate against its entry: movable
+         * leaves are grown by the margin, and an uncommitted static tree may still hold entities
+         * that were removed or became movable since.
+         */
+        template <typename Overlaps, typename Visit>
+        void query(const Overlaps& overlaps, Visit&& visit) const
+        {
+            const auto visitIfCurrent = [this, &overlaps, &visit](const EntityId id, const bool isStaticLeaf)
+            {
+                const Entry* entry = entries.find(id);
+                if (entry && (entry->leaf == AabbTree::NULL_NODE) == isStaticLeaf && overlaps(entry->bounds))
+                {
+                    visit(id);
+                }
+            };
+
+            staticTree.query(overlaps, [&visitIfCurrent](const EntityId id) { visitIfCurrent(id, true); });
+            movableTree.query(overlaps, [&visitIfCurrent](const EntityId id) { visitIfCurrent(id, false); });
+        }
+
+        ComponentStorage<Entry> entries;
+        AabbTree staticTree;
+        AabbTree movableTree { MOVABLE_MARGIN };
+        bool isStaticTreeDirty = false;
+        /** Scratch for commit(). */
+        std::vector<std::pair<EntityId, math::Aabb>> staticItems;
+    };
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "engine/utils/math/Math.h"
+#include "services/world/entity/Components.h"
+
+namespace parus
+{
+
+    /** One bit per kind of entity data a system can touch; see componentMask(). */
+    using ComponentMask = uint32_t;
+
+    /**
+     * The bit for one kind of entity data. math::Transform stands for the entities' transforms,
+     * changed through EntityManager::setTransform(); the others are the component types.
+     */
+    template <typename Component>
+    [[nodiscard]] constexpr ComponentMask componentMask()
+    {
+        using T = std::remove_const_t<Component>;
+        if constexpr (std::is_same_v<T, math::Transform>)
+        {
+            return 1u << 0;
+        }
+        else if constexpr (std::is_same_v<T, MeshComponent>)
+        {
+            return 1u << 1;
+        }
+        else if constexpr (std::is_same_v<T, PointLightComponent>)
+        {
+            return 1u << 2;
+        }
+        else if constexpr (std::is_same_v<T, DirectionalLightComponent>)
+        {
+            return 1u << 3;
+        }
+        else if constexpr (std::is_same_v<T, SkyboxComponent>)
+        {
+            return 1u << 4;
+        }
+        else if constexpr (std::is_same_v<T, PrefabComponent>)
+        {
+            return 1u << 5;
+        }
+        else
+        {
+            static_assert(std::is_same_v<T, LodComponent>, "No access bit for this component type.");
+            return 1u << 6;
+        }
+    }
+
+    /**
+     * What a system reads and writes, declared when it is registered with the SystemScheduler, e.g.
+     * SystemAccess().read<MeshComponent>().write<math::Transform>().
+     */
+    struct SystemAccess final
+    {
+        ComponentMask reads = 0;
+        ComponentMask writes = 0;
+
+        template <typename... Components>
+        SystemAccess& read()
+        {
+            reads |= (componentMask<Components>() | ... | 0u);
+            return *this;
+        }
+
+        template <typename... Components>
+        SystemAccess& write()
+        {
+            writes |= (componentMask<Components>() | ... | 0u);
+            return *this;
+        }
+
+        /** Const components are read, the others written; matches EntityManager::mutableView<Components...>(). */
+        template <typename... Components>
+        [[nodiscard]] static SystemAccess fromView()
+        {
+            SystemAccess access;
+            access.reads = ((std::is_const_v<Components> ? componentMask<Components>() : 0u) | ... | 0u);
+            access.writes = ((std::is_const_v<Components> ? 0u : componentMask<Components>()) | ... | 0u);
+            return access;
+        }
+
+        /** Two systems can't run at the same time if either writes something the other touches. */
+        [[nodiscard]] bool conflictsWith(const SystemAccess& other) const
+        {
+            return (writes & (other.reads | other.writes)) != 0 || (reads & other.writes) != 0;
+        }
+    };
+
+}
@@ -0,0 +1,115 @@
+#include "SystemScheduler.h"
+
+#include "services/threading/TaskGraph.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    namespace
+    {
+        /** Brackets the systems with begin/endConcurrentMarks(), also when update() rethrows. */
+        class ScopedConcurrentMarks final
+        {
+        public:
+            explicit ScopedConcurrentMarks(EntityManager& entityManager) : entityManager(entityManager)
+            {
+                entityManager.beginConcurrentMarks();
+            }
+            ~ScopedConcurrentMarks() { entityManager.endConcurrentMarks(); }
+            ScopedConcurrentMarks(const ScopedConcurrentMarks&) = delete;
+            ScopedConcurrentMarks& operator=(const ScopedConcurrentMarks&) = delete;
+
+        private:
+            EntityManager& entityManager;
+        };
+    }
+
+    SystemScheduler::SystemId SystemScheduler::add(const SystemAccess access, SystemFunction function)
+    {
+        const SystemId id = systems.size();
+
+        // Walking back from the latest system, an earlier conflict that is already an ancestor of a
+        // chosen dependency is ordered anyway and needs no edge of its own.
+        std::vector<bool> isOrdered(id, false);
+        std::vector<SystemId> dependencies;
+        for (SystemId other = id; other-- > 0;)
+        {
+            if (isOrdered[other] || !access.conflictsWith(systems[other].access))
+            {
+                continue;
+            }
+
+            dependencies.push_back(other);
+            std::vector<SystemId> stack { other };
+            while (!stack.empty())
+            {
+                const SystemId ancestor = stack.back();
+                stack.pop_back();
+                if (!isOrdered[ancestor])
+                {
+                    isOrdered[ancestor] = true;
+                    stack.insert(stack.end(), systems[ancestor].dependencies.begin(), systems[ancestor].dependencies.end());
+                }
+            }
+        }
+
+        systems.push_back({ access, std::move(function), std::move(dependencies) });
+        writes |= access.writes;
+        return id;
+    }
+
+    void SystemScheduler::update(EntityManager& entityManager, EntityCommandQueue& commands, ThreadPool& pool, const float deltaTime)
+    {
+        // Systems write in place while others read, so chunks a snapshot still shares are cloned now
+        // rather than swapped out from under a concurrent reader.
+        if (writes & componentMask<math::Transform>())
+        {
+            entityManager.detach<Entity>();
+        }
+        if (writes & componentMask<MeshComponent>())
+        {
+            entityManager.detach<MeshComponent>();
+        }
+        if (writes & componentMask<PointLightComponent>())
+        {
+            entityManager.detach<PointLightComponent>();
+        }
+        if (writes & componentMask<DirectionalLightComponent>())
+        {
+            entityManager.detach<DirectionalLightComponent>();
+        }
+        if (writes & componentMask<SkyboxComponent>())
+        {
+            entityManager.detach<SkyboxComponent>();
+        }
+        if (writes & componentMask<PrefabComponent>())
+        {
+            entityManager.detach<PrefabComponent>();
+        }
+        if (writes & componentMask<LodComponent>())
+        {
+            entityManager.detach<LodComponent>();
+        }
+
+        // Systems, and the chunks of an addForEach() system, may call markChanged() concurrently.
+        const ScopedConcurrentMarks concurrentMarks(entityManager);
+
+        const SystemContext context { entityManager, commands, pool, deltaTime };
+        if (systems.size() <= 1)
+        {
+            for (const System& system : systems)
+            {
+                system.function(context);
+            }
+            return;
+        }
+
+        TaskGraph graph;
+        for (const System& system : systems)
+        {
+            graph.add([&system, &context] { system.function(context); }, system.dependencies);
+        }
+        graph.run(pool).get();
+    }
+
+}
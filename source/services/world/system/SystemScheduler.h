@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "SystemAccess.h"
+#include "services/threading/Parallel.h"
+#include "services/world/entity/EntityCommandQueue.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace parus
+{
+    class ThreadPool;
+
+    /** What a system gets each time it runs. */
+    struct SystemContext final
+    {
+        EntityManager& entityManager;
+        /** Where structural changes go; see SystemScheduler. */
+        EntityCommandQueue& commands;
+        ThreadPool& pool;
+        float deltaTime = 0.0f;
+    };
+
+    /**
+     * Runs the world's systems once per tick, as many at a time as their declared access allows.
+     *
+     * Every system declares the entity data it reads and writes. Two systems conflict when either
+     * writes something the other touches; a system then runs after every earlier-registered system
+     * it conflicts with, and concurrently with the rest. update() turns that into a TaskGraph on
+     * the pool, so registration order is the order of conflicting systems and nothing else.
+     *
+     * Systems may change data they declared in place (components through mutableView(), transforms
+     * through setTransform()) and report it with markChanged(), which is safe from parallel chunks
+     * while update() runs. They must not spawn, destroy, or add or remove components directly:
+     * those change storages other systems may be iterating. They record such changes in an
+     * EntityCommandBuffer and submit it to context.commands instead, which the owner plays back
+     * once every system is done. The scheduler trusts the declarations; a system touching something
+     * it didn't declare is a data race.
+     */
+    class SystemScheduler final
+    {
+    public:
+        using SystemId = size_t;
+        using SystemFunction = std::function<void(const SystemContext&)>;
+
+        /** Registers a system that runs as one task. */
+        SystemId add(SystemAccess access, SystemFunction function);
+
+        /**
+         * Registers a system that calls function(context, const Entity&, Components&...) for every
+         * entity in mutableView<Components...>(); const components are read, the others written.
+         * Views larger than grainSize are split into chunks run in parallel, so the function must
+         * only change the visited entity's own components; it may markChanged() them. Transforms
+         * can't be written this way, as setTransform() isn't safe to call concurrently.
+         */
+        template <typename... Components, typename Function>
+        SystemId addForEach(Function&& function, const size_t grainSize = DEFAULT_GRAIN_SIZE)
+        {
+            return add(SystemAccess::fromView<Components...>(),
+                [function = std::forward<Function>(function), grainSize](const SystemContext& context)
+                {
+                    context.entityManager.mutableView<Components...>().parallelEach(context.pool,
+                        [&function, &context](const Entity& entity, Components&... components)
+                        {
+                            function(context, entity, components...);
+                        }, grainSize);
+                });
+        }
+
+        [[nodiscard]] size_t size() const { return systems.size(); }
+        [[nodiscard]] bool empty() const { return systems.empty(); }
+        void clear()
+        {
+            systems.clear();
+            writes = 0;
+        }
+
+        /**
+         * Runs every system once and returns when all are done. Rethrows the first exception a
+         * system threw; systems that had not started by then are skipped.
+         */
+        void update(EntityManager& entityManager, EntityCommandQueue& commands, ThreadPool& pool, float deltaTime);
+
+    private:
+        struct System
+        {
+            SystemAccess access;
+            SystemFunction function;
+            /** Earlier systems this one conflicts with, minus those already implied through another. */
+            std::vector<SystemId> dependencies;
+        };
+
+        std::vector<System> systems;
+        /** Everything any system writes. */
+        ComponentMask writes = 0;
+    };
+
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "services/threading/CancellationToken.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    TEST(CancellationToken, DefaultTokenIsNeverCancelled)
+    {
+        const CancellationToken token;
+        EXPECT_FALSE(token.isCancelled());
+    }
+
+    TEST(CancellationToken, CancelReachesEveryTokenOfTheSource)
+    {
+        CancellationSource cancellation;
+        const CancellationToken first = cancellation.getToken();
+        const CancellationToken copy = first;
+
+        EXPECT_FALSE(first.isCancelled());
+        cancellation.cancel();
+
+        EXPECT_TRUE(cancellation.isCancelled());
+        EXPECT_TRUE(first.isCancelled());
+        EXPECT_TRUE(copy.isCancelled());
+        EXPECT_TRUE(cancellation.getToken().isCancelled());
+    }
+
+    TEST(CancellationToken, ReplacedSourceStartsFresh)
+    {
+        CancellationSource cancellation;
+        const CancellationToken oldToken = cancellation.getToken();
+        cancellation.cancel();
+        cancellation = CancellationSource();
+
+        EXPECT_TRUE(oldToken.isCancelled());
+        EXPECT_FALSE(cancellation.getToken().isCancelled());
+    }
+
+    TEST(CancellationToken, PostedTaskIsDroppedOnceCancelled)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        // Keeps the only worker busy so both tasks are still queued when the token is cancelled.
+        std::atomic<bool> started { false };
+        std::atomic<bool> release { false };
+        pool.post([&] { started = true; started.notify_all(); release.wait(false); });
+        started.wait(false);
+
+        CancellationSource cancellation;
+        std::atomic<int> cancelledRuns { 0 };
+        std::atomic<int> otherRuns { 0 };
+        pool.post(TaskPriority::NORMAL, cancellation.getToken(), [&cancelledRuns] { cancelledRuns.fetch_add(1); });
+        pool.post(TaskPriority::NORMAL, CancellationToken(), [&otherRuns] { otherRuns.fetch_add(1); });
+        cancellation.cancel();
+
+        release = true;
+        release.notify_all();
+        pool.waitUntilDone();
+
+        EXPECT_EQ(cancelledRuns.load(), 0);
+        EXPECT_EQ(otherRuns.load(), 1);
+    }
+}
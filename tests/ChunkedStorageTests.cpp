@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "services/world/entity/ChunkedStorage.h"
+
+namespace parus
+{
+    TEST(ChunkedStorage, FindsValuesAcrossChunks)
+    {
+        ChunkedStorage<int> storage;
+        for (EntityId id = 1; id <= 1000; ++id)
+        {
+            storage.insertOrAssign(id, static_cast<int>(id) * 10);
+        }
+
+        ASSERT_EQ(storage.size(), 1000u);
+        EXPECT_EQ(*storage.find(1), 10);
+        EXPECT_EQ(*storage.find(1000), 10000);
+        EXPECT_EQ(storage.find(1001), nullptr);
+        for (size_t slot = 0; slot < storage.size(); ++slot)
+        {
+            EXPECT_EQ(storage.getValue(slot), static_cast<int>(storage.getId(slot)) * 10);
+        }
+    }
+
+    TEST(ChunkedStorage, EraseMovesTheLastValueIntoTheHole)
+    {
+        ChunkedStorage<std::string> storage;
+        storage.insertOrAssign(1, "one");
+        storage.insertOrAssign(2, "two");
+        storage.insertOrAssign(3, "three");
+
+        EXPECT_TRUE(storage.erase(1));
+        EXPECT_FALSE(storage.erase(1));
+        EXPECT_FALSE(storage.contains(1));
+        ASSERT_EQ(storage.size(), 2u);
+        EXPECT_EQ(*storage.find(2), "two");
+        EXPECT_EQ(*storage.find(3), "three");
+    }
+
+    TEST(ChunkedStorage, FindRejectsOlderGenerations)
+    {
+        ChunkedStorage<int> storage;
+        storage.insertOrAssign(makeEntityId(4, 1), 1);
+
+        EXPECT_EQ(storage.find(makeEntityId(4, 0)), nullptr);
+        EXPECT_EQ(*storage.find(makeEntityId(4, 1)), 1);
+    }
+
+    TEST(ChunkedStorage, CopySharesChunksUntilOneSideWrites)
+    {
+        ChunkedStorage<int> storage;
+        for (EntityId id = 1; id <= 2 * ChunkedStorage<int>::CHUNK_SIZE; ++id)
+        {
+            storage.insertOrAssign(id, 0);
+        }
+
+        const ChunkedStorage<int> copy = storage;
+        EXPECT_EQ(&copy.getValue(0), &storage.getValue(0));
+
+        *storage.findMutable(1) = 5;
+        storage.insertOrAssign(10'000, 7);
+
+        // Only the written chunk was cloned; the copy still sees the values it was taken with.
+        EXPECT_NE(&copy.getValue(0), &storage.getValue(0));
+        EXPECT_EQ(&copy.getValue(ChunkedStorage<int>::CHUNK_SIZE), &storage.getValue(ChunkedStorage<int>::CHUNK_SIZE));
+        EXPECT_EQ(*copy.find(1), 0);
+        EXPECT_EQ(*storage.find(1), 5);
+        EXPECT_FALSE(copy.contains(10'000));
+        EXPECT_EQ(copy.size(), 2 * ChunkedStorage<int>::CHUNK_SIZE);
+    }
+
+    TEST(ChunkedStorage, ClearLeavesCopiesIntact)
+    {
+        ChunkedStorage<std::string> storage;
+        storage.insertOrAssign(1, "one");
+        storage.insertOrAssign(2, "two");
+
+        const ChunkedStorage<std::string> copy = storage;
+        storage.clear();
+        storage.insertOrAssign(1, "uno");
+
+        EXPECT_EQ(*copy.find(1), "one");
+        EXPECT_EQ(*copy.find(2), "two");
+        EXPECT_EQ(*storage.find(1), "uno");
+        EXPECT_FALSE(storage.contains(2));
+    }
+
+    TEST(ChunkedStorage, DetachClonesEverySharedChunk)
+    {
+        ChunkedStorage<int> storage;
+        storage.insertOrAssign(1, 1);
+
+        const ChunkedStorage<int> copy = storage;
+        storage.detach();
+
+        EXPECT_NE(&copy.getValue(0), &storage.getValue(0));
+        const int* before = &storage.getValue(0);
+        *storage.findMutable(1) = 2;
+        EXPECT_EQ(&storage.getValue(0), before);
+        EXPECT_EQ(*copy.find(1), 1);
+    }
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "services/world/entity/ComponentStorage.h"
+
+namespace parus
+{
+    TEST(ComponentStorage, FindsInsertedValues)
+    {
+        ComponentStorage<std::string> storage;
+        storage.insertOrAssign(3, "three");
+        storage.insertOrAssign(7, "seven");
+
+        ASSERT_NE(storage.find(3), nullptr);
+        EXPECT_EQ(*storage.find(3), "three");
+        EXPECT_EQ(*storage.find(7), "seven");
+        EXPECT_EQ(storage.find(4), nullptr);
+        EXPECT_EQ(storage.find(1'000'000), nullptr);
+        EXPECT_EQ(storage.size(), 2u);
+    }
+
+    TEST(ComponentStorage, InsertOrAssignReplacesExistingValue)
+    {
+        ComponentStorage<int> storage;
+        storage.insertOrAssign(5, 1);
+        storage.insertOrAssign(5, 2);
+
+        EXPECT_EQ(storage.size(), 1u);
+        EXPECT_EQ(*storage.find(5), 2);
+    }
+
+    TEST(ComponentStorage, EraseMovesTheLastValueIntoTheHole)
+    {
+        ComponentStorage<int> storage;
+        storage.insertOrAssign(1, 10);
+        storage.insertOrAssign(2, 20);
+        storage.insertOrAssign(3, 30);
+
+        EXPECT_TRUE(storage.erase(1));
+        EXPECT_FALSE(storage.erase(1));
+        EXPECT_FALSE(storage.contains(1));
+
+        // Values stay packed and every remaining id still finds its own value.
+        ASSERT_EQ(storage.size(), 2u);
+        EXPECT_EQ(*storage.find(2), 20);
+        EXPECT_EQ(*storage.find(3), 30);
+        for (size_t i = 0; i < storage.size(); ++i)
+        {
+            EXPECT_EQ(storage.getValues()[i], static_cast<int>(storage.getIds()[i]) * 10);
+        }
+    }
+
+    TEST(ComponentStorage, ClearForgetsEveryIdButCanBeReused)
+    {
+        ComponentStorage<int> storage;
+        for (EntityId id = 0; id < 3000; id += 3)
+        {
+            storage.insertOrAssign(id, static_cast<int>(id));
+        }
+
+        storage.clear();
+        EXPECT_TRUE(storage.empty());
+        EXPECT_FALSE(storage.contains(0));
+        EXPECT_FALSE(storage.contains(2997));
+
+        storage.insertOrAssign(2997, 1);
+        EXPECT_EQ(*storage.find(2997), 1);
+        EXPECT_EQ(storage.size(), 1u);
+    }
+
+    TEST(ComponentStorage, StaleGenerationFindsNothing)
+    {
+        ComponentStorage<int> storage;
+        const EntityId oldId = makeEntityId(9, 0);
+        const EntityId newId = makeEntityId(9, 1);
+        storage.insertOrAssign(oldId, 1);
+
+        EXPECT_EQ(storage.find(newId), nullptr);
+        EXPECT_FALSE(storage.erase(newId));
+
+        // A newer generation takes over the index.
+        storage.insertOrAssign(newId, 2);
+        EXPECT_EQ(storage.size(), 1u);
+        EXPECT_EQ(storage.find(oldId), nullptr);
+        EXPECT_EQ(*storage.find(newId), 2);
+    }
+
+    TEST(ComponentStorage, HandlesMoveOnlyValues)
+    {
+        ComponentStorage<std::unique_ptr<int>> storage;
+        storage.insertOrAssign(1, std::make_unique<int>(1));
+        storage.insertOrAssign(2, std::make_unique<int>(2));
+        storage.erase(1);
+
+        ASSERT_NE(storage.find(2), nullptr);
+        EXPECT_EQ(**storage.find(2), 2);
+    }
+
+    TEST(ComponentStorage, RandomInsertsAndErasesStayConsistent)
+    {
+        ComponentStorage<EntityId> storage;
+        std::set<EntityId> expected;
+
+        uint32_t seed = 12345;
+        for (int step = 0; step < 20000; ++step)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const EntityId id = (seed >> 8) % 5000;
+            if (seed & 1u)
+            {
+                storage.insertOrAssign(id, id);
+                expected.insert(id);
+            }
+            else
+            {
+                EXPECT_EQ(storage.erase(id), expected.erase(id) == 1);
+            }
+        }
+
+        ASSERT_EQ(storage.size(), expected.size());
+        for (const EntityId id : expected)
+        {
+            ASSERT_NE(storage.find(id), nullptr);
+            EXPECT_EQ(*storage.find(id), id);
+        }
+    }
+}
@@ -50,6 +50,48 @@ namespace parus
         EXPECT_EQ(entityManager->getEntity(id)->mobility, Mobility::Movable);
     }
 
+    TEST(ConsoleReflection, AddressBySlotFollowsRecycledIds)
+    {
+        auto entityManager = makeWorldWithConsole();
+        auto console = Services::get<Console>();
+        ConsoleReflection reflection(console, entityManager);
+
+        const EntityId staleId = entityManager->spawn("Door");
+        entityManager->destroy(staleId);
+        const EntityId id = entityManager->spawn("Window");
+        ASSERT_EQ(getEntityIndex(id), getEntityIndex(staleId));
+
+        const std::string slot = std::to_string(getEntityIndex(id));
+        EXPECT_NE(console->submitCommand("list").find("Window (#" + slot + ")"), std::string::npos);
+
+        console->submitCommand("set #" + slot + ".mobility movable");
+        EXPECT_EQ(entityManager->getEntity(id)->mobility, Mobility::Movable);
+
+        EXPECT_EQ(reflection.resolveEntityId("#" + std::to_string(id)), id);
+        EXPECT_EQ(reflection.resolveEntityId("#" + std::to_string(staleId)), id);
+        EXPECT_FALSE(reflection.resolveEntityId("#" + std::to_string(makeEntityId(getEntityIndex(id), 7))).has_value());
+    }
+
+    TEST(ConsoleReflection, ParentCommandSetsAndClearsTheParent)
+    {
+        auto entityManager = makeWorldWithConsole();
+        auto console = Services::get<Console>();
+        ConsoleReflection reflection(console, entityManager);
+
+        const EntityId tableId = entityManager->spawn("Table");
+        const EntityId lampId = entityManager->spawn("Lamp");
+
+        console->submitCommand("parent Lamp Table");
+        EXPECT_EQ(entityManager->getEntity(lampId)->parent, tableId);
+        EXPECT_NE(console->submitCommand("parent Lamp").find("Table"), std::string::npos);
+
+        EXPECT_NE(console->submitCommand("parent Table Lamp").find("cycle"), std::string::npos);
+        EXPECT_EQ(entityManager->getEntity(tableId)->parent, 0u);
+
+        console->submitCommand("parent Lamp none");
+        EXPECT_EQ(entityManager->getEntity(lampId)->parent, 0u);
+    }
+
     TEST(ConsoleReflection, SetPointLightFieldRoundTrips)
     {
         auto entityManager = makeWorldWithConsole();
@@ -99,6 +141,21 @@ namespace parus
         EXPECT_EQ(hint, "set Door");
     }
 
+    TEST(ConsoleReflection, CompletionNamesRefreshAfterObserversDispatch)
+    {
+        auto entityManager = makeWorldWithConsole();
+        auto console = Services::get<Console>();
+        ConsoleReflection reflection(console, entityManager);
+        entityManager->spawn("Door");
+        EXPECT_EQ(console->hintNext("set Do"), "set Door");
+
+        // The cached names only change once the spawn has been dispatched.
+        entityManager->spawn("Dock");
+        EXPECT_EQ(console->hintNext("set Do"), "set Door");
+        entityManager->dispatchObservers();
+        EXPECT_EQ(console->hintNext("set Do"), "set Dock");
+    }
+
     TEST(ConsoleReflection, StaticTrieCompletionStillWorksAlongsideReflection)
     {
         auto entityManager = makeWorldWithConsole();
@@ -211,4 +268,53 @@ namespace parus
             + std::to_string(initialForward.y) + " " + std::to_string(initialForward.z);
         EXPECT_NE(forwardAfter, initialForwardText);
     }
+
+    TEST(ConsoleReflection, UndoAndRedoEntitySets)
+    {
+        auto entityManager = makeWorldWithConsole();
+        auto console = Services::get<Console>();
+        ConsoleReflection reflection(console, entityManager);
+
+        const EntityId id = entityManager->spawn("Lamp");
+        entityManager->addPointLightComponent(id, PointLightComponent{ .intensity = 1.0f });
+        console->submitCommand("set Lamp.position 1 2 3");
+        console->submitCommand("set Lamp.PointLight.intensity 4");
+        console->submitCommand("set Lamp.name Torch");
+
+        console->submitCommand("undo");
+        EXPECT_EQ(entityManager->getEntity(id)->name, "Lamp");
+        console->submitCommand("undo");
+        EXPECT_FLOAT_EQ(entityManager->getPointLightComponent(id)->intensity, 1.0f);
+        console->submitCommand("undo");
+        EXPECT_FLOAT_EQ(entityManager->getEntity(id)->transform.position.x, 0.0f);
+        EXPECT_NE(console->submitCommand("undo").find("Nothing to undo"), std::string::npos);
+
+        console->submitCommand("redo");
+        EXPECT_FLOAT_EQ(entityManager->getEntity(id)->transform.position.x, 1.0f);
+
+        // A new set forgets what could be redone, and undo never brings back a removed component.
+        console->submitCommand("set Lamp.PointLight.intensity 8");
+        EXPECT_NE(console->submitCommand("redo").find("Nothing to redo"), std::string::npos);
+        entityManager->removePointLightComponent(id);
+        EXPECT_NE(console->submitCommand("undo").find("Cannot undo"), std::string::npos);
+        EXPECT_EQ(entityManager->getPointLightComponent(id), nullptr);
+    }
+
+    TEST(ConsoleReflection, UndoOfRenameWaitsForTheNameToBeFree)
+    {
+        auto entityManager = makeWorldWithConsole();
+        auto console = Services::get<Console>();
+        ConsoleReflection reflection(console, entityManager);
+
+        const EntityId id = entityManager->spawn("Lamp");
+        console->submitCommand("set Lamp.name Torch");
+        const EntityId otherId = entityManager->spawn("Lamp");
+
+        EXPECT_NE(console->submitCommand("undo").find("already taken"), std::string::npos);
+        EXPECT_EQ(entityManager->getEntity(id)->name, "Torch");
+
+        ASSERT_TRUE(entityManager->renameEntity(otherId, "Candle"));
+        console->submitCommand("undo");
+        EXPECT_EQ(entityManager->getEntity(id)->name, "Lamp");
+    }
 }
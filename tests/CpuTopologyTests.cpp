@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "services/threading/CpuTopology.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    namespace
+    {
+        /** A throwaway /sys/devices/system/cpu lookalike. */
+        class FakeSysfs
+        {
+        public:
+            FakeSysfs()
+                : root(std::filesystem::temp_directory_path() / ("parus_cpu_topology_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed())
+                    + "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name()))
+            {
+                std::filesystem::remove_all(root);
+                std::filesystem::create_directories(root);
+            }
+
+            ~FakeSysfs()
+            {
+                std::filesystem::remove_all(root);
+            }
+
+            void addCpu(const unsigned int cpu, const std::string& siblings, const char* siblingsFile = "thread_siblings_list")
+            {
+                const std::filesystem::path topology = root / ("cpu" + std::to_string(cpu)) / "topology";
+                std::filesystem::create_directories(topology);
+                std::ofstream(topology / siblingsFile) << siblings << "\n";
+            }
+
+            void setOnline(const unsigned int cpu, const bool isOnline)
+            {
+                std::ofstream(root / ("cpu" + std::to_string(cpu)) / "online") << (isOnline ? "1" : "0") << "\n";
+            }
+
+            const std::filesystem::path root;
+        };
+    }
+
+    TEST(CpuTopology, ParsesKernelCpuLists)
+    {
+        EXPECT_EQ(CpuTopology::parseCpuList("0-3,8,10-11"), (std::vector<unsigned int> { 0, 1, 2, 3, 8, 10, 11 }));
+        EXPECT_EQ(CpuTopology::parseCpuList("4,0"), (std::vector<unsigned int> { 0, 4 }));
+        EXPECT_EQ(CpuTopology::parseCpuList("2,x,5-3"), (std::vector<unsigned int> { 2 }));
+        EXPECT_TRUE(CpuTopology::parseCpuList("").empty());
+    }
+
+    TEST(CpuTopology, GroupsSmtSiblingsFromSysfs)
+    {
+        // Two cores with two hyper-threads each, numbered the way most x86 machines do it.
+        FakeSysfs sysfs;
+        sysfs.addCpu(0, "0,2");
+        sysfs.addCpu(1, "1,3");
+        sysfs.addCpu(2, "0,2", "core_cpus_list");
+        sysfs.addCpu(3, "1,3");
+        std::filesystem::create_directories(sysfs.root / "cpufreq");
+
+        const CpuTopology topology = CpuTopology::fromSysfs(sysfs.root);
+
+        EXPECT_EQ(topology.physicalCores, (std::vector<std::vector<unsigned int>> { { 0, 2 }, { 1, 3 } }));
+        EXPECT_EQ(topology.getPhysicalCoreCount(), 2u);
+        EXPECT_EQ(topology.getLogicalCpuCount(), 4u);
+        EXPECT_TRUE(topology.hasSmt());
+    }
+
+    TEST(CpuTopology, SkipsOfflineCpus)
+    {
+        FakeSysfs sysfs;
+        sysfs.addCpu(0, "0");
+        sysfs.addCpu(1, "1");
+        sysfs.setOnline(1, false);
+
+        EXPECT_EQ(CpuTopology::fromSysfs(sysfs.root).physicalCores, (std::vector<std::vector<unsigned int>> { { 0 } }));
+    }
+
+    TEST(CpuTopology, MissingSysfsGivesAnEmptyTopology)
+    {
+        EXPECT_TRUE(CpuTopology::fromSysfs(std::filesystem::temp_directory_path() / "parus_no_such_cpu_dir").physicalCores.empty());
+    }
+
+    TEST(CpuTopology, DefaultWorkerCountLeavesACoreToTheMainThread)
+    {
+        CpuTopology topology;
+        topology.physicalCores = { { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+        EXPECT_EQ(topology.getDefaultWorkerCount(false), 3u);
+        EXPECT_EQ(topology.getDefaultWorkerCount(true), 7u);
+
+        topology.physicalCores = { { 0 } };
+        EXPECT_EQ(topology.getDefaultWorkerCount(false), 1u);
+    }
+
+    TEST(CpuTopology, WorkersFillFreeCoresBeforeSmtSiblings)
+    {
+        CpuTopology topology;
+        topology.physicalCores = { { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+        // Core 0 (CPUs 0 and 4) stays free for the main thread.
+        EXPECT_EQ(topology.getWorkerCpuOrder(), (std::vector<unsigned int> { 1, 2, 3, 5, 6, 7 }));
+
+        topology.physicalCores = { { 0, 1 } };
+        EXPECT_EQ(topology.getWorkerCpuOrder(), (std::vector<unsigned int> { 0, 1 }));
+    }
+
+    TEST(CpuTopology, DetectFindsAtLeastOneCore)
+    {
+        const CpuTopology topology = CpuTopology::detect();
+        ASSERT_FALSE(topology.physicalCores.empty());
+        EXPECT_GE(topology.getLogicalCpuCount(), topology.getPhysicalCoreCount());
+    }
+
+    TEST(CpuTopology, PinnedWorkersStillRunEveryTask)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 3;
+        settings.pinWorkers = true;
+
+        ThreadPool pool;
+        pool.init(settings);
+
+        std::atomic<int> counter { 0 };
+        for (int i = 0; i < 200; ++i)
+        {
+            pool.post([&counter] { counter.fetch_add(1); });
+        }
+        pool.waitUntilDone();
+
+        EXPECT_EQ(counter.load(), 200);
+    }
+}
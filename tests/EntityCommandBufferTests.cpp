@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "services/threading/CancellationToken.h"
+#include "services/world/entity/EntityCommandBuffer.h"
+#include "services/world/entity/EntityCommandQueue.h"
+#include "services/world/entity/EntityManager.h"
+
+namespace parus
+{
+    TEST(EntityCommandBuffer, PlaybackAppliesCommandsInOrder)
+    {
+        EntityManager entityManager;
+        const EntityId existingId = entityManager.spawn("Existing");
+
+        EntityCommandBuffer commands;
+        const EntityCommandBuffer::Target lamp = commands.spawn("Lamp");
+        commands.addPointLightComponent(lamp, PointLightComponent{ .intensity = 2.0f });
+        commands.setMobility(lamp, Mobility::Movable);
+        commands.setParent(lamp, existingId);
+        const EntityCommandBuffer::Target cube = commands.spawn("Cube");
+        commands.addMeshComponent(cube, MeshComponent{ std::make_shared<Mesh>() });
+        commands.removeMeshComponent(cube);
+        commands.destroy(existingId);
+        EXPECT_EQ(commands.size(), 8u);
+
+        // Nothing happens until playback.
+        EXPECT_EQ(entityManager.view<>().size(), 1u);
+
+        const std::span<const EntityId> spawnedIds = commands.playback(entityManager);
+        ASSERT_EQ(spawnedIds.size(), 2u);
+        EXPECT_TRUE(commands.empty());
+
+        const Entity* lampEntity = entityManager.getEntity(spawnedIds[0]);
+        ASSERT_NE(lampEntity, nullptr);
+        EXPECT_EQ(lampEntity->name, "Lamp");
+        EXPECT_EQ(lampEntity->mobility, Mobility::Movable);
+        // Destroying the parent made the lamp a root again.
+        EXPECT_EQ(lampEntity->parent, 0u);
+        EXPECT_EQ(entityManager.getPointLightComponent(spawnedIds[0])->intensity, 2.0f);
+
+        EXPECT_EQ(entityManager.getEntity(spawnedIds[1])->name, "Cube");
+        EXPECT_EQ(entityManager.getMeshComponent(spawnedIds[1]), nullptr);
+        EXPECT_EQ(entityManager.getEntity(existingId), nullptr);
+    }
+
+    TEST(EntityCommandBuffer, SpawnsGetUniqueNamesLikeDirectSpawns)
+    {
+        EntityManager entityManager;
+        entityManager.spawn("Tree");
+
+        EntityCommandBuffer commands;
+        commands.spawn("Tree");
+        commands.spawn("Tree");
+        const std::span<const EntityId> spawnedIds = commands.playback(entityManager);
+
+        ASSERT_EQ(spawnedIds.size(), 2u);
+        EXPECT_EQ(entityManager.getEntity(spawnedIds[0])->name, "Tree1");
+        EXPECT_EQ(entityManager.getEntity(spawnedIds[1])->name, "Tree2");
+    }
+
+    TEST(EntityCommandBuffer, CancelledBufferAppliesNothing)
+    {
+        EntityManager entityManager;
+        CancellationSource source;
+
+        EntityCommandBuffer commands(source.getToken());
+        commands.spawn("Cube");
+        source.cancel();
+
+        EXPECT_TRUE(commands.playback(entityManager).empty());
+        EXPECT_TRUE(commands.empty());
+        EXPECT_EQ(entityManager.view<>().size(), 0u);
+    }
+
+    TEST(EntityCommandBuffer, RejectsSpawnTargetsItDoesNotOwn)
+    {
+        EntityCommandBuffer first;
+        EntityCommandBuffer second;
+        const EntityCommandBuffer::Target lamp = first.spawn("Lamp");
+        second.spawn("Cube");
+
+        // Same spawn index in the other buffer, which would otherwise resolve to its Cube.
+        EXPECT_THROW(second.destroy(lamp), std::runtime_error);
+        EXPECT_THROW(second.setParent(EntityCommandBuffer::Target(0), lamp), std::runtime_error);
+
+        // A cleared buffer's old spawns are gone too.
+        first.clear();
+        first.spawn("Cube");
+        EXPECT_THROW(first.destroy(lamp), std::runtime_error);
+        EXPECT_EQ(first.size(), 1u);
+        EXPECT_EQ(second.size(), 1u);
+    }
+
+    TEST(EntityCommandBuffer, MovedFromBufferRejectsItsEarlierSpawns)
+    {
+        EntityManager entityManager;
+        EntityCommandQueue queue;
+        EntityCommandBuffer commands;
+        const EntityCommandBuffer::Target lamp = commands.spawn("Lamp");
+        queue.submit(std::move(commands));
+
+        // The thread keeps recording into its buffer; the Lamp now belongs to the submitted one.
+        EXPECT_TRUE(commands.empty());
+        EXPECT_THROW(commands.destroy(lamp), std::runtime_error);
+        EXPECT_THROW(commands.setParent(EntityCommandBuffer::Target(0), lamp), std::runtime_error);
+
+        commands.spawn("Cube");
+        EXPECT_EQ(queue.playback(entityManager), 1u);
+        EXPECT_EQ(commands.playback(entityManager).size(), 1u);
+        EXPECT_EQ(entityManager.view<>().size(), 2u);
+    }
+
+    TEST(EntityCommandQueue, PlaysBackBuffersFromManyThreads)
+    {
+        constexpr int THREAD_COUNT = 8;
+        constexpr int BUFFERS_PER_THREAD = 50;
+        constexpr int SPAWNS_PER_BUFFER = 4;
+
+        EntityManager entityManager;
+        EntityCommandQueue queue;
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < THREAD_COUNT; ++thread)
+        {
+            threads.emplace_back([&queue, thread]
+            {
+                for (int buffer = 0; buffer < BUFFERS_PER_THREAD; ++buffer)
+                {
+                    EntityCommandBuffer commands;
+                    for (int spawn = 0; spawn < SPAWNS_PER_BUFFER; ++spawn)
+                    {
+                        const EntityCommandBuffer::Target entity = commands.spawn("Entity_" + std::to_string(thread));
+                        commands.addPointLightComponent(entity, PointLightComponent{});
+                    }
+                    queue.submit(std::move(commands));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        EXPECT_EQ(queue.getPendingCount(), static_cast<size_t>(THREAD_COUNT * BUFFERS_PER_THREAD));
+        EXPECT_EQ(queue.playback(entityManager), static_cast<size_t>(THREAD_COUNT * BUFFERS_PER_THREAD * SPAWNS_PER_BUFFER * 2));
+        EXPECT_EQ(queue.getPendingCount(), 0u);
+        EXPECT_EQ(entityManager.view<PointLightComponent>().size(), static_cast<size_t>(THREAD_COUNT * BUFFERS_PER_THREAD * SPAWNS_PER_BUFFER));
+
+        EXPECT_EQ(queue.playback(entityManager), 0u);
+    }
+
+    TEST(EntityCommandQueue, PlaysBackInSubmissionOrder)
+    {
+        EntityManager entityManager;
+        EntityCommandQueue queue;
+
+        EntityCommandBuffer spawnCommands;
+        spawnCommands.spawn("First");
+        queue.submit(std::move(spawnCommands));
+        queue.playback(entityManager);
+        const EntityId firstId = entityManager.getEntityByName("First")->id;
+
+        EntityCommandBuffer destroyCommands;
+        destroyCommands.destroy(firstId);
+        queue.submit(std::move(destroyCommands));
+        EntityCommandBuffer respawnCommands;
+        respawnCommands.spawn("First");
+        queue.submit(std::move(respawnCommands));
+        queue.playback(entityManager);
+
+        // Destroyed before the respawn, so the name was free again.
+        const Entity* respawned = entityManager.getEntityByName("First");
+        ASSERT_NE(respawned, nullptr);
+        EXPECT_NE(respawned->id, firstId);
+        EXPECT_EQ(entityManager.view<>().size(), 1u);
+    }
+}
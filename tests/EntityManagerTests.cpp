@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <memory>
+#include <set>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "services/threading/ThreadPool.h"
 #include "services/world/entity/EntityManager.h"
 #include "services/world/entity/Components.h"
 
@@ -65,6 +73,46 @@ namespace parus
         EXPECT_EQ(entityManager.getEntity(thirdId)->name, "Cube2");
     }
 
+    TEST(EntityManager, FreedSuffixIsReused)
+    {
+        EntityManager entityManager;
+        std::vector<EntityId> ids;
+        for (int i = 0; i < 4; ++i)
+        {
+            ids.push_back(entityManager.spawn("Cube"));
+        }
+
+        entityManager.destroy(ids[2]);
+        EXPECT_EQ(entityManager.getEntity(entityManager.spawn("Cube"))->name, "Cube2");
+        EXPECT_EQ(entityManager.getEntity(entityManager.spawn("Cube"))->name, "Cube4");
+
+        // Renaming away from a suffixed name frees it too.
+        entityManager.renameEntity(ids[1], "Box");
+        EXPECT_EQ(entityManager.getEntity(entityManager.spawn("Cube"))->name, "Cube1");
+    }
+
+    TEST(EntityManager, SuffixSkipsNamesTakenByOtherEntities)
+    {
+        EntityManager entityManager;
+        entityManager.spawn("Cube");
+        entityManager.spawn("Cube1");
+
+        EXPECT_EQ(entityManager.getEntity(entityManager.spawn("Cube"))->name, "Cube2");
+    }
+
+    TEST(EntityManager, ManySameNamedSpawnsStayUnique)
+    {
+        EntityManager entityManager;
+        for (int i = 0; i < 5000; ++i)
+        {
+            entityManager.spawn("Crate");
+        }
+
+        EXPECT_NE(entityManager.getEntityByName("Crate"), nullptr);
+        EXPECT_NE(entityManager.getEntityByName("Crate4999"), nullptr);
+        EXPECT_EQ(entityManager.getEntityByName("Crate5000"), nullptr);
+    }
+
     TEST(EntityManager, DestroyRemovesEntity)
     {
         EntityManager entityManager;
@@ -118,6 +166,51 @@ namespace parus
         EXPECT_NE(first, second);
     }
 
+    TEST(EntityManager, DestroyedIndicesAreRecycledWithANewGeneration)
+    {
+        EntityManager entityManager;
+
+        const EntityId first = entityManager.spawn("Cube");
+        entityManager.addMeshComponent(first, MeshComponent{ std::make_shared<Mesh>() });
+        entityManager.destroy(first);
+        const EntityId second = entityManager.spawn("Sphere");
+
+        EXPECT_EQ(getEntityIndex(second), getEntityIndex(first));
+        EXPECT_EQ(getEntityGeneration(second), getEntityGeneration(first) + 1);
+
+        // The stale handle resolves to nothing, not to the entity now living in its slot.
+        EXPECT_EQ(entityManager.getEntity(first), nullptr);
+        EXPECT_EQ(entityManager.getMeshComponent(first), nullptr);
+        EXPECT_FALSE(entityManager.destroy(first));
+        entityManager.setMobility(first, Mobility::Movable);
+        EXPECT_EQ(entityManager.getEntity(second)->mobility, Mobility::Static);
+        EXPECT_EQ(entityManager.getEntityByIndex(getEntityIndex(first))->id, second);
+    }
+
+    TEST(EntityManager, ClearSceneEntitiesInvalidatesIdsAndReusesIndices)
+    {
+        EntityManager entityManager;
+
+        std::set<uint32_t> indices;
+        std::vector<EntityId> oldIds;
+        for (int i = 0; i < 10; ++i)
+        {
+            oldIds.push_back(entityManager.spawn("Cube"));
+            indices.insert(getEntityIndex(oldIds.back()));
+        }
+
+        entityManager.clearSceneEntities();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            EXPECT_TRUE(indices.contains(getEntityIndex(entityManager.spawn("Sphere"))));
+        }
+        for (const EntityId id : oldIds)
+        {
+            EXPECT_EQ(entityManager.getEntity(id), nullptr);
+        }
+    }
+
     TEST(EntityManager, SetTransformUpdatesEntity)
     {
         EntityManager entityManager;
@@ -345,4 +438,749 @@ namespace parus
         EXPECT_EQ(entityManager.getDirectionalLightEntity(), nullptr);
         EXPECT_EQ(entityManager.getSkyboxEntity(), nullptr);
     }
+
+    TEST(EntityManager, AddComponentIgnoresUnknownEntity)
+    {
+        EntityManager entityManager;
+
+        const EntityId unknownId = makeEntityId(42, 0);
+        entityManager.addMeshComponent(unknownId, MeshComponent{ std::make_shared<Mesh>() });
+        entityManager.addPointLightComponent(unknownId, PointLightComponent{});
+
+        EXPECT_EQ(entityManager.getMeshComponent(unknownId), nullptr);
+        EXPECT_EQ(entityManager.getPointLightComponent(unknownId), nullptr);
+        EXPECT_TRUE(entityManager.view<MeshComponent>().empty());
+    }
+
+    TEST(EntityManager, SpawnManyReturnsIdsInNameOrder)
+    {
+        EntityManager entityManager;
+        entityManager.spawn("Crate");
+
+        const std::vector<std::string> names { "Crate", "Lamp", "Crate" };
+        const std::vector<EntityId> ids = entityManager.spawnMany(names);
+
+        ASSERT_EQ(ids.size(), 3u);
+        EXPECT_EQ(entityManager.getEntity(ids[0])->name, "Crate1");
+        EXPECT_EQ(entityManager.getEntity(ids[1])->name, "Lamp");
+        EXPECT_EQ(entityManager.getEntity(ids[2])->name, "Crate2");
+        EXPECT_EQ(entityManager.view<>().size(), 4u);
+        EXPECT_EQ(entityManager.getChanges().spawned.size(), 4u);
+    }
+
+    TEST(EntityManager, DestroyManyCountsOnlyLiveEntities)
+    {
+        EntityManager entityManager;
+        const EntityId first = entityManager.spawn("First");
+        const EntityId second = entityManager.spawn("Second");
+        const EntityId kept = entityManager.spawn("Kept");
+        entityManager.destroy(second);
+
+        const std::vector<EntityId> ids { first, second, first, 12345 };
+        EXPECT_EQ(entityManager.destroyMany(ids), 1u);
+        EXPECT_EQ(entityManager.getEntity(first), nullptr);
+        EXPECT_NE(entityManager.getEntity(kept), nullptr);
+        EXPECT_EQ(entityManager.view<>().size(), 1u);
+    }
+
+    TEST(EntityManager, ReservedSpawnsDoNotMoveEntities)
+    {
+        EntityManager entityManager;
+        entityManager.reserve(1000);
+
+        const EntityId firstId = entityManager.spawn("Entity0");
+        const Entity* first = entityManager.getEntity(firstId);
+        for (int i = 1; i < 1000; ++i)
+        {
+            entityManager.spawn("Entity" + std::to_string(i));
+        }
+
+        EXPECT_EQ(entityManager.getEntity(firstId), first);
+    }
+
+    TEST(EntityManager, ViewVisitsOnlyEntitiesWithEveryComponent)
+    {
+        EntityManager entityManager;
+
+        const EntityId cubeId = entityManager.spawn("Cube");
+        entityManager.addMeshComponent(cubeId, MeshComponent{ std::make_shared<Mesh>() });
+        const EntityId lampId = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(lampId, PointLightComponent{});
+        const EntityId glowingCubeId = entityManager.spawn("GlowingCube");
+        entityManager.addMeshComponent(glowingCubeId, MeshComponent{ std::make_shared<Mesh>() });
+        entityManager.addPointLightComponent(glowingCubeId, PointLightComponent{ .intensity = 3.0f });
+
+        EXPECT_EQ(entityManager.view<>().size(), 3u);
+        EXPECT_EQ(entityManager.view<MeshComponent>().size(), 2u);
+        EXPECT_EQ(entityManager.view<PointLightComponent>().size(), 2u);
+
+        const auto both = entityManager.view<PointLightComponent, MeshComponent>();
+        EXPECT_EQ(both.size(), 1u);
+
+        std::set<EntityId> visited;
+        both.each([&](const Entity& entity, const PointLightComponent& light, const MeshComponent& mesh)
+        {
+            visited.insert(entity.id);
+            EXPECT_EQ(light.intensity, 3.0f);
+            EXPECT_EQ(&mesh, entityManager.getMeshComponent(entity.id));
+        });
+        EXPECT_EQ(visited, (std::set<EntityId> { glowingCubeId }));
+    }
+
+    TEST(EntityManager, ViewMatchesVectorQueries)
+    {
+        EntityManager entityManager;
+        for (int i = 0; i < 100; ++i)
+        {
+            const EntityId id = entityManager.spawn("Entity");
+            if (i % 3 == 0)
+            {
+                entityManager.addMeshComponent(id, MeshComponent{ std::make_shared<Mesh>() });
+            }
+        }
+        entityManager.destroy(makeEntityId(4, 0));
+
+        const auto meshEntities = entityManager.getMeshEntities();
+        size_t index = 0;
+        entityManager.view<MeshComponent>().each([&](const Entity& entity, const MeshComponent& mesh)
+        {
+            ASSERT_LT(index, meshEntities.size());
+            EXPECT_EQ(meshEntities[index].first, &entity);
+            EXPECT_EQ(meshEntities[index].second, &mesh);
+            ++index;
+        });
+        EXPECT_EQ(index, meshEntities.size());
+        EXPECT_EQ(entityManager.view<MeshComponent>().size(), meshEntities.size());
+    }
+
+    TEST(EntityManager, ParallelViewVisitsEveryMatchOnce)
+    {
+        EntityManager entityManager;
+        for (int i = 0; i < 5000; ++i)
+        {
+            const EntityId id = entityManager.spawn("Lamp");
+            entityManager.addPointLightComponent(id, PointLightComponent{ .intensity = static_cast<float>(i % 7) });
+        }
+
+        ThreadPool pool;
+        pool.init(4);
+
+        std::atomic<size_t> visits { 0 };
+        std::atomic<uint64_t> idSum { 0 };
+        entityManager.view<PointLightComponent>().parallelEach(pool, [&](const Entity& entity, const PointLightComponent&)
+        {
+            visits.fetch_add(1, std::memory_order_relaxed);
+            idSum.fetch_add(entity.id, std::memory_order_relaxed);
+        }, 64);
+
+        EXPECT_EQ(visits.load(), 5000u);
+        EXPECT_EQ(idSum.load(), 5000ull * 5001ull / 2); // Fresh manager: ids are indices 1..5000, generation 0.
+    }
+
+    TEST(EntityManager, MutableViewChangesComponentsInPlace)
+    {
+        EntityManager entityManager;
+        const EntityId glowingCubeId = entityManager.spawn("GlowingCube");
+        entityManager.addMeshComponent(glowingCubeId, MeshComponent{ std::make_shared<Mesh>() });
+        entityManager.addPointLightComponent(glowingCubeId, PointLightComponent{ .intensity = 1.0f });
+        const EntityId lampId = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(lampId, PointLightComponent{ .intensity = 1.0f });
+
+        entityManager.mutableView<PointLightComponent, const MeshComponent>().each([](const Entity&, PointLightComponent& light, const MeshComponent&)
+        {
+            light.intensity = 2.0f;
+        });
+
+        EXPECT_EQ(entityManager.getPointLightComponent(glowingCubeId)->intensity, 2.0f);
+        EXPECT_EQ(entityManager.getPointLightComponent(lampId)->intensity, 1.0f);
+        EXPECT_EQ(entityManager.getChanges().componentsAdded.size(), 3u);
+    }
+
+    namespace
+    {
+        math::Transform makeTranslation(const float x, const float y, const float z)
+        {
+            math::Transform transform;
+            transform.position = math::Vector3(x, y, z);
+            return transform;
+        }
+
+        math::Vector3 getWorldPosition(const EntityManager& entityManager, const EntityId id)
+        {
+            return entityManager.getWorldMatrix(id)->transformPoint({});
+        }
+    }
+
+    TEST(EntityManager, ChildWorldMatrixComposesWithParent)
+    {
+        EntityManager entityManager;
+
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        entityManager.setTransform(parentId, makeTranslation(10.0f, 0.0f, 0.0f));
+        entityManager.setTransform(childId, makeTranslation(0.0f, 2.0f, 0.0f));
+        ASSERT_TRUE(entityManager.setParent(childId, parentId));
+
+        EXPECT_TRUE(entityManager.hasDirtyTransforms());
+        entityManager.updateWorldTransforms();
+        EXPECT_FALSE(entityManager.hasDirtyTransforms());
+
+        EXPECT_EQ(entityManager.getEntity(childId)->parent, parentId);
+        ASSERT_EQ(entityManager.getChildren(parentId).size(), 1u);
+        EXPECT_EQ(entityManager.getChildren(parentId)[0], childId);
+        EXPECT_EQ(getWorldPosition(entityManager, childId), math::Vector3(10.0f, 2.0f, 0.0f));
+
+        // Moving the parent moves the child on the next update, without touching the child itself.
+        entityManager.setTransform(parentId, makeTranslation(-5.0f, 0.0f, 0.0f));
+        EXPECT_EQ(getWorldPosition(entityManager, childId), math::Vector3(10.0f, 2.0f, 0.0f));
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(getWorldPosition(entityManager, childId), math::Vector3(-5.0f, 2.0f, 0.0f));
+
+        ASSERT_TRUE(entityManager.setParent(childId, 0));
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(getWorldPosition(entityManager, childId), math::Vector3(0.0f, 2.0f, 0.0f));
+        EXPECT_TRUE(entityManager.getChildren(parentId).empty());
+    }
+
+    TEST(EntityManager, SetParentRejectsCycles)
+    {
+        EntityManager entityManager;
+
+        const EntityId grandparentId = entityManager.spawn("Grandparent");
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        ASSERT_TRUE(entityManager.setParent(parentId, grandparentId));
+        ASSERT_TRUE(entityManager.setParent(childId, parentId));
+
+        EXPECT_FALSE(entityManager.setParent(grandparentId, childId));
+        EXPECT_FALSE(entityManager.setParent(parentId, parentId));
+        EXPECT_FALSE(entityManager.setParent(childId, makeEntityId(99, 0)));
+        EXPECT_EQ(entityManager.getEntity(grandparentId)->parent, 0u);
+    }
+
+    TEST(EntityManager, DestroyingAParentDetachesItsChildren)
+    {
+        EntityManager entityManager;
+
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        entityManager.setTransform(parentId, makeTranslation(10.0f, 0.0f, 0.0f));
+        entityManager.setTransform(childId, makeTranslation(1.0f, 0.0f, 0.0f));
+        entityManager.setParent(childId, parentId);
+        entityManager.updateWorldTransforms();
+
+        entityManager.destroy(parentId);
+        entityManager.updateWorldTransforms();
+
+        EXPECT_EQ(entityManager.getEntity(childId)->parent, 0u);
+        EXPECT_EQ(getWorldPosition(entityManager, childId), math::Vector3(1.0f, 0.0f, 0.0f));
+    }
+
+    TEST(EntityManager, UpdateOnlyRecomputesChangedSubtrees)
+    {
+        EntityManager entityManager;
+
+        const EntityId movedId = entityManager.spawn("Moved");
+        const EntityId untouchedId = entityManager.spawn("Untouched");
+        entityManager.setTransform(untouchedId, makeTranslation(3.0f, 0.0f, 0.0f));
+        entityManager.updateWorldTransforms();
+
+        // Overwrite the untouched entity's transform behind the cache's back: without a setTransform()
+        // its cached matrix must not be recomputed when an unrelated entity moves.
+        const_cast<Entity*>(entityManager.getEntity(untouchedId))->transform = makeTranslation(100.0f, 0.0f, 0.0f);
+        entityManager.setTransform(movedId, makeTranslation(1.0f, 0.0f, 0.0f));
+        entityManager.updateWorldTransforms();
+
+        EXPECT_EQ(getWorldPosition(entityManager, movedId), math::Vector3(1.0f, 0.0f, 0.0f));
+        EXPECT_EQ(getWorldPosition(entityManager, untouchedId), math::Vector3(3.0f, 0.0f, 0.0f));
+    }
+
+    TEST(EntityManager, ParallelTransformUpdateMatchesSerial)
+    {
+        EntityManager serialManager;
+        EntityManager parallelManager;
+
+        // Chains of depth 6 under 500 roots: every level is wide enough to be split across the pool.
+        std::vector<EntityId> ids;
+        for (EntityManager* entityManager : { &serialManager, &parallelManager })
+        {
+            ids.clear();
+            for (int root = 0; root < 500; ++root)
+            {
+                EntityId parentId = 0;
+                for (int depth = 0; depth < 6; ++depth)
+                {
+                    const EntityId id = entityManager->spawn("Node" + std::to_string(root) + "_" + std::to_string(depth));
+                    math::Transform transform = makeTranslation(static_cast<float>(root), 1.0f, 0.0f);
+                    transform.rotationEuler = math::Vector3(0.0f, 15.0f * static_cast<float>(depth), 0.0f);
+                    entityManager->setTransform(id, transform);
+                    entityManager->setParent(id, parentId);
+                    parentId = id;
+                    ids.push_back(id);
+                }
+            }
+        }
+
+        ThreadPool pool;
+        pool.init(4);
+
+        serialManager.updateWorldTransforms();
+        parallelManager.updateWorldTransforms(pool);
+
+        for (const EntityId id : ids)
+        {
+            EXPECT_EQ(*parallelManager.getWorldMatrix(id), *serialManager.getWorldMatrix(id));
+        }
+    }
+
+    TEST(EntityManager, RecordsSpawnsComponentsAndDestroys)
+    {
+        EntityManager entityManager;
+        const EntityId id = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(id, PointLightComponent{});
+        entityManager.removeMeshComponent(id);
+        entityManager.removePointLightComponent(id);
+        entityManager.destroy(id);
+
+        const EntityChangeSet& changes = entityManager.getChanges();
+        EXPECT_EQ(changes.spawned, std::vector<EntityId>{ id });
+        EXPECT_EQ(changes.destroyed, std::vector<EntityId>{ id });
+        ASSERT_EQ(changes.componentsAdded.size(), 1u);
+        EXPECT_EQ(changes.componentsAdded[0].type, ComponentType::PointLight);
+
+        // Removing a component the entity never had is not a change.
+        ASSERT_EQ(changes.componentsRemoved.size(), 1u);
+        EXPECT_EQ(changes.componentsRemoved[0].type, ComponentType::PointLight);
+    }
+
+    TEST(EntityManager, TransformChangesIncludeDescendants)
+    {
+        EntityManager entityManager;
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        const EntityId otherId = entityManager.spawn("Other");
+        entityManager.setParent(childId, parentId);
+        entityManager.updateWorldTransforms();
+
+        EntityChangeSet changes;
+        entityManager.takeChanges(changes);
+        EXPECT_TRUE(entityManager.getChanges().empty());
+
+        entityManager.setTransform(parentId, makeTranslation(1.0f, 0.0f, 0.0f));
+        entityManager.updateWorldTransforms();
+        entityManager.takeChanges(changes);
+
+        const std::set<EntityId> transformChanged(changes.transformChanged.begin(), changes.transformChanged.end());
+        EXPECT_EQ(transformChanged, (std::set<EntityId>{ parentId, childId }));
+        EXPECT_FALSE(transformChanged.contains(otherId));
+        EXPECT_TRUE(changes.spawned.empty());
+    }
+
+    TEST(EntityManager, ClearSceneEntitiesReplacesPendingChanges)
+    {
+        EntityManager entityManager;
+        entityManager.spawn("Before");
+        entityManager.clearSceneEntities();
+        const EntityId afterId = entityManager.spawn("After");
+
+        const EntityChangeSet& changes = entityManager.getChanges();
+        EXPECT_TRUE(changes.wasCleared);
+        EXPECT_EQ(changes.spawned, std::vector<EntityId>{ afterId });
+    }
+
+    TEST(EntityManager, SpatialIndexFollowsTransformsAndDestroys)
+    {
+        EntityManager entityManager;
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        const EntityId otherId = entityManager.spawn("Other");
+        entityManager.setParent(childId, parentId);
+        entityManager.setTransform(childId, makeTranslation(0.0f, 5.0f, 0.0f));
+        entityManager.setTransform(otherId, makeTranslation(100.0f, 0.0f, 0.0f));
+        entityManager.updateWorldTransforms();
+
+        const auto queryNear = [&entityManager](const math::Vector3& center)
+        {
+            std::set<EntityId> result;
+            entityManager.getSpatialIndex().querySphere({ center, 1.0f }, [&result](const EntityId id) { result.insert(id); });
+            return result;
+        };
+
+        EXPECT_EQ(entityManager.getSpatialIndex().size(), 3u);
+        EXPECT_EQ(queryNear({ 0.0f, 0.0f, 0.0f }), std::set<EntityId>{ parentId });
+        EXPECT_EQ(queryNear({ 0.0f, 5.0f, 0.0f }), std::set<EntityId>{ childId });
+
+        // Moving the parent moves the child's bounds with it.
+        entityManager.setMobility(parentId, Mobility::Movable);
+        entityManager.setTransform(parentId, makeTranslation(0.0f, 0.0f, 20.0f));
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(queryNear({ 0.0f, 0.0f, 20.0f }), std::set<EntityId>{ parentId });
+        EXPECT_EQ(queryNear({ 0.0f, 5.0f, 20.0f }), std::set<EntityId>{ childId });
+        EXPECT_TRUE(queryNear({ 0.0f, 5.0f, 0.0f }).empty());
+
+        entityManager.destroy(otherId);
+        EXPECT_TRUE(queryNear({ 100.0f, 0.0f, 0.0f }).empty());
+        EXPECT_EQ(entityManager.getSpatialIndex().size(), 2u);
+    }
+
+    TEST(EntityManager, SpatialBoundsCoverPointLightRadius)
+    {
+        EntityManager entityManager;
+        const EntityId lampId = entityManager.spawn("Lamp");
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(*entityManager.getSpatialIndex().getBounds(lampId), math::Aabb::fromPoint({ 0.0f, 0.0f, 0.0f }));
+
+        PointLightComponent light;
+        light.radius = 10.0f;
+        entityManager.addPointLightComponent(lampId, light);
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(*entityManager.getSpatialIndex().getBounds(lampId), math::Aabb::fromCenterExtents({ 0.0f, 0.0f, 0.0f }, { 10.0f, 10.0f, 10.0f }));
+
+        entityManager.removePointLightComponent(lampId);
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(*entityManager.getSpatialIndex().getBounds(lampId), math::Aabb::fromPoint({ 0.0f, 0.0f, 0.0f }));
+    }
+
+    TEST(EntityManager, MarkChangedReachesChangeSetAndBounds)
+    {
+        EntityManager entityManager;
+        const EntityId lampId = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(lampId, PointLightComponent{ .radius = 1.0f });
+        entityManager.updateWorldTransforms();
+        EntityChangeSet changes;
+        entityManager.takeChanges(changes);
+
+        entityManager.mutableView<PointLightComponent>().each([](const Entity&, PointLightComponent& light)
+        {
+            light.radius = 10.0f;
+        });
+        entityManager.markChanged<PointLightComponent>(lampId);
+
+        ASSERT_EQ(entityManager.getChanges().componentsAdded.size(), 1u);
+        EXPECT_EQ(entityManager.getChanges().componentsAdded[0].id, lampId);
+        EXPECT_EQ(entityManager.getChanges().componentsAdded[0].type, ComponentType::PointLight);
+
+        entityManager.updateWorldTransforms();
+        EXPECT_EQ(*entityManager.getSpatialIndex().getBounds(lampId), math::Aabb::fromCenterExtents({ 0.0f, 0.0f, 0.0f }, { 10.0f, 10.0f, 10.0f }));
+    }
+
+    TEST(EntityManager, ObserversReceiveBatchesOnDispatch)
+    {
+        EntityManager entityManager;
+        std::vector<EntityId> addedLights;
+        std::vector<EntityId> removedLights;
+        std::vector<EntityId> changedLights;
+        entityManager.onAdd<PointLightComponent>([&addedLights](std::span<const EntityId> ids) { addedLights.assign(ids.begin(), ids.end()); });
+        entityManager.onRemove<PointLightComponent>([&removedLights](std::span<const EntityId> ids) { removedLights.assign(ids.begin(), ids.end()); });
+        entityManager.onChange<PointLightComponent>([&changedLights](std::span<const EntityId> ids) { changedLights.assign(ids.begin(), ids.end()); });
+
+        const EntityId firstId = entityManager.spawn("Lamp");
+        const EntityId secondId = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(firstId, PointLightComponent{});
+        entityManager.addPointLightComponent(secondId, PointLightComponent{});
+        entityManager.addPointLightComponent(firstId, PointLightComponent{ .intensity = 2.0f });
+        entityManager.markChanged<PointLightComponent>(secondId);
+        entityManager.markChanged<MeshComponent>(secondId);
+
+        // Nothing is delivered until the dispatch.
+        EXPECT_TRUE(addedLights.empty());
+        entityManager.dispatchObservers();
+        EXPECT_EQ(addedLights, (std::vector<EntityId> { firstId, secondId }));
+        EXPECT_EQ(changedLights, (std::vector<EntityId> { firstId, secondId }));
+        EXPECT_TRUE(removedLights.empty());
+
+        addedLights.clear();
+        changedLights.clear();
+        entityManager.removePointLightComponent(firstId);
+        entityManager.destroy(secondId);
+        entityManager.dispatchObservers();
+        EXPECT_EQ(removedLights, (std::vector<EntityId> { firstId, secondId }));
+        EXPECT_TRUE(addedLights.empty());
+        EXPECT_TRUE(changedLights.empty());
+    }
+
+    TEST(EntityManager, EntityAndTransformObservers)
+    {
+        EntityManager entityManager;
+        std::vector<EntityId> spawned;
+        std::vector<EntityId> destroyed;
+        std::vector<EntityId> changed;
+        std::vector<EntityId> moved;
+        entityManager.onAdd<Entity>([&spawned](std::span<const EntityId> ids) { spawned.insert(spawned.end(), ids.begin(), ids.end()); });
+        entityManager.onRemove<Entity>([&destroyed](std::span<const EntityId> ids) { destroyed.insert(destroyed.end(), ids.begin(), ids.end()); });
+        entityManager.onChange<Entity>([&changed](std::span<const EntityId> ids) { changed.insert(changed.end(), ids.begin(), ids.end()); });
+        entityManager.onChange<math::Transform>([&moved](std::span<const EntityId> ids) { moved.insert(moved.end(), ids.begin(), ids.end()); });
+
+        const EntityId parentId = entityManager.spawn("Parent");
+        const EntityId childId = entityManager.spawn("Child");
+        entityManager.updateWorldTransforms();
+        entityManager.dispatchObservers();
+        EXPECT_EQ(spawned, (std::vector<EntityId> { parentId, childId }));
+        EXPECT_EQ(moved.size(), 2u);
+
+        moved.clear();
+        entityManager.renameEntity(childId, "Renamed");
+        entityManager.setParent(childId, parentId);
+        entityManager.setTransform(parentId, math::Transform{});
+        entityManager.updateWorldTransforms();
+        entityManager.dispatchObservers();
+        EXPECT_EQ(changed, (std::vector<EntityId> { childId, childId }));
+        EXPECT_EQ(std::set<EntityId>(moved.begin(), moved.end()), (std::set<EntityId> { parentId, childId }));
+
+        entityManager.clearSceneEntities();
+        entityManager.dispatchObservers();
+        EXPECT_EQ(std::set<EntityId>(destroyed.begin(), destroyed.end()), (std::set<EntityId> { parentId, childId }));
+    }
+
+    TEST(EntityManager, ObserversOnlySeeEventsAfterRegistration)
+    {
+        EntityManager entityManager;
+        const EntityId earlyId = entityManager.spawn("Early");
+
+        std::vector<EntityId> spawned;
+        entityManager.onAdd<Entity>([&spawned](std::span<const EntityId> ids) { spawned.assign(ids.begin(), ids.end()); });
+        const EntityId lateId = entityManager.spawn("Late");
+        entityManager.dispatchObservers();
+
+        EXPECT_NE(earlyId, lateId);
+        EXPECT_EQ(spawned, std::vector<EntityId> { lateId });
+    }
+
+    TEST(EntityManager, ObserversCanChangeTheManagerAndRemoveThemselves)
+    {
+        EntityManager entityManager;
+        int lightObserverCalls = 0;
+
+        // Events caused while dispatching wait for the next dispatch.
+        entityManager.onAdd<Entity>([&entityManager](std::span<const EntityId> ids)
+        {
+            for (const EntityId id : ids)
+            {
+                entityManager.addPointLightComponent(id, PointLightComponent{});
+            }
+        });
+        EntityManager::ObserverId lightObserverId = 0;
+        lightObserverId = entityManager.onAdd<PointLightComponent>([&](std::span<const EntityId>)
+        {
+            ++lightObserverCalls;
+            EXPECT_TRUE(entityManager.removeObserver(lightObserverId));
+        });
+
+        entityManager.spawn("Lamp");
+        entityManager.dispatchObservers();
+        EXPECT_EQ(lightObserverCalls, 0);
+        entityManager.dispatchObservers();
+        EXPECT_EQ(lightObserverCalls, 1);
+
+        entityManager.spawn("Lamp");
+        entityManager.dispatchObservers();
+        entityManager.dispatchObservers();
+        EXPECT_EQ(lightObserverCalls, 1);
+        EXPECT_FALSE(entityManager.removeObserver(lightObserverId));
+    }
+
+    TEST(EntityManager, SnapshotKeepsTheStateItWasTakenWith)
+    {
+        EntityManager entityManager;
+        const EntityId lamp = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(lamp, PointLightComponent{ .intensity = 2.0f });
+        entityManager.setTransform(lamp, math::Transform{ .position = { 1.0f, 0.0f, 0.0f } });
+
+        const EntitySnapshot snapshot = entityManager.snapshot();
+        entityManager.setTransform(lamp, math::Transform{ .position = { 5.0f, 0.0f, 0.0f } });
+        entityManager.addPointLightComponent(lamp, PointLightComponent{ .intensity = 3.0f });
+        entityManager.renameEntity(lamp, "Torch");
+        entityManager.spawn("Door");
+
+        ASSERT_NE(snapshot.getEntity(lamp), nullptr);
+        EXPECT_EQ(snapshot.getEntity(lamp)->name, "Lamp");
+        EXPECT_FLOAT_EQ(snapshot.getEntity(lamp)->transform.position.x, 1.0f);
+        EXPECT_FLOAT_EQ(snapshot.getPointLightComponent(lamp)->intensity, 2.0f);
+        size_t snapshotCount = 0;
+        snapshot.view<>().each([&snapshotCount](const Entity&) { ++snapshotCount; });
+        EXPECT_EQ(snapshotCount, 1u);
+
+        EXPECT_EQ(entityManager.getEntity(lamp)->name, "Torch");
+        EXPECT_FLOAT_EQ(entityManager.getPointLightComponent(lamp)->intensity, 3.0f);
+    }
+
+    TEST(EntityManager, SnapshotOutlivesClearedScene)
+    {
+        EntityManager entityManager;
+        const EntityId lamp = entityManager.spawn("Lamp");
+        entityManager.addPointLightComponent(lamp, PointLightComponent{});
+        entityManager.addSkyboxComponent(lamp, SkyboxComponent{});
+
+        const EntitySnapshot snapshot = entityManager.snapshot();
+        entityManager.clearSceneEntities();
+        entityManager.spawn("Overwrites the old name storage");
+
+        EXPECT_EQ(entityManager.getEntity(lamp), nullptr);
+        ASSERT_NE(snapshot.getEntity(lamp), nullptr);
+        EXPECT_EQ(snapshot.getEntity(lamp)->name, "Lamp");
+        EXPECT_NE(snapshot.getPointLightComponent(lamp), nullptr);
+        ASSERT_NE(snapshot.getSkyboxEntity(), nullptr);
+        EXPECT_EQ(snapshot.getSkyboxEntity()->id, lamp);
+    }
+
+    TEST(EntityManager, SnapshotCanBeReadWhileTheWorldChanges)
+    {
+        EntityManager entityManager;
+        std::vector<EntityId> ids;
+        for (int i = 0; i < 2000; ++i)
+        {
+            ids.push_back(entityManager.spawn("Crate"));
+        }
+
+        const EntitySnapshot snapshot = entityManager.snapshot();
+        std::atomic<size_t> movedCount = 0;
+        std::thread reader([&snapshot, &movedCount]
+        {
+            snapshot.view<>().each([&movedCount](const Entity& entity)
+            {
+                if (entity.transform.position.y != 0.0f)
+                {
+                    ++movedCount;
+                }
+            });
+        });
+        for (const EntityId id : ids)
+        {
+            entityManager.setTransform(id, math::Transform{ .position = { 0.0f, 1.0f, 0.0f } });
+        }
+        reader.join();
+
+        EXPECT_EQ(movedCount, 0u);
+    }
+
+    TEST(EntityManager, PublishedSnapshotsAreReadableFromOtherThreads)
+    {
+        EntityManager entityManager;
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->getEpoch(), 0u);
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->view<>().size(), 0u);
+
+        // Each epoch adds one lamp and moves every lamp before it, so a torn read shows up as a
+        // lamp count that doesn't match the epoch or lamps that don't agree on their position.
+        std::atomic<bool> isDone { false };
+        std::atomic<size_t> brokenReads { 0 };
+        std::thread reader([&]
+        {
+            while (!isDone.load(std::memory_order_acquire))
+            {
+                const std::shared_ptr<const EntitySnapshot> snapshot = entityManager.getPublishedSnapshot();
+                const float expectedY = static_cast<float>(snapshot->getEpoch());
+                size_t lampCount = 0;
+                snapshot->view<PointLightComponent>().each([&](const Entity& entity, const PointLightComponent&)
+                {
+                    ++lampCount;
+                    if (entity.transform.position.y != expectedY)
+                    {
+                        brokenReads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+                if (lampCount != snapshot->getEpoch())
+                {
+                    brokenReads.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        std::vector<EntityId> lamps;
+        for (int epoch = 1; epoch <= 500; ++epoch)
+        {
+            lamps.push_back(entityManager.spawn("Lamp"));
+            entityManager.addPointLightComponent(lamps.back(), PointLightComponent{});
+            for (const EntityId lamp : lamps)
+            {
+                entityManager.setTransform(lamp, math::Transform{ .position = { 0.0f, static_cast<float>(epoch), 0.0f } });
+            }
+            // Asks for every epoch, so none is skipped even when the reader thread falls behind.
+            (void)entityManager.getPublishedSnapshot();
+            EXPECT_TRUE(entityManager.publishSnapshotIfRead());
+        }
+        isDone.store(true, std::memory_order_release);
+        reader.join();
+
+        EXPECT_EQ(brokenReads.load(), 0u);
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->getEpoch(), 500u);
+    }
+
+    TEST(EntityManager, PublishSnapshotIfReadSkipsEpochsNobodyRead)
+    {
+        EntityManager entityManager;
+        const EntityId lamp = entityManager.spawn("Lamp");
+
+        EXPECT_FALSE(entityManager.publishSnapshotIfRead());
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->getEpoch(), 0u);
+
+        // The read above asks for the next boundary to publish; after that, unread epochs are skipped.
+        EXPECT_TRUE(entityManager.publishSnapshotIfRead());
+        EXPECT_FALSE(entityManager.publishSnapshotIfRead());
+
+        entityManager.setTransform(lamp, math::Transform{ .position = { 0.0f, 2.0f, 0.0f } });
+        const std::shared_ptr<const EntitySnapshot> published = entityManager.getPublishedSnapshot();
+        EXPECT_EQ(published->getEpoch(), 1u);
+        EXPECT_EQ(published->getEntity(lamp)->transform.position.y, 0.0f);
+
+        EXPECT_TRUE(entityManager.publishSnapshotIfRead());
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->getEntity(lamp)->transform.position.y, 2.0f);
+
+        // An unconditional publish, as at loop start, is current for a first-time reader.
+        entityManager.spawn("Cube");
+        entityManager.publishSnapshot();
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->view<>().size(), 2u);
+    }
+
+    TEST(EntityManager, ClearSceneEntitiesReleasesThePublishedSnapshot)
+    {
+        EntityManager entityManager;
+        auto mesh = std::make_shared<Mesh>();
+        const std::weak_ptr<Mesh> weakMesh = mesh;
+        const EntityId cubeId = entityManager.spawn("Cube");
+        entityManager.addMeshComponent(cubeId, MeshComponent{ std::move(mesh) });
+        entityManager.publishSnapshot();
+        EXPECT_FALSE(weakMesh.expired());
+
+        entityManager.clearSceneEntities();
+
+        EXPECT_TRUE(weakMesh.expired());
+        EXPECT_EQ(entityManager.getPublishedSnapshot()->view<>().size(), 0u);
+    }
+
+    TEST(EntityManager, InstantiateCopiesThePrefabAndLinksBack)
+    {
+        EntityManager entityManager;
+        auto prefab = std::make_shared<Prefab>();
+        prefab->name = "Tree";
+        prefab->mobility = Mobility::Movable;
+        prefab->pointLight = PointLightComponent{ .radius = 5.0f };
+
+        const std::vector<math::Transform> transforms = {
+            math::Transform{ .position = { 1.0f, 0.0f, 0.0f } },
+            math::Transform{ .position = { 2.0f, 0.0f, 0.0f } }
+        };
+        const std::vector<EntityId> trees = entityManager.instantiateMany(prefab, transforms);
+
+        ASSERT_EQ(trees.size(), 2u);
+        EXPECT_EQ(entityManager.getEntity(trees[0])->name, "Tree");
+        EXPECT_NE(entityManager.getEntity(trees[1])->name, "Tree");
+        EXPECT_FLOAT_EQ(entityManager.getEntity(trees[1])->transform.position.x, 2.0f);
+        EXPECT_EQ(entityManager.getEntity(trees[1])->mobility, Mobility::Movable);
+        EXPECT_FLOAT_EQ(entityManager.getPointLightComponent(trees[1])->radius, 5.0f);
+        EXPECT_EQ(entityManager.getMeshComponent(trees[1]), nullptr);
+        EXPECT_EQ(entityManager.getPrefabComponent(trees[1])->prefab, prefab);
+        EXPECT_EQ(entityManager.view<PrefabComponent>().size(), 2u);
+
+        // Overriding one instance leaves the prefab and the other instances alone.
+        entityManager.addPointLightComponent(trees[0], PointLightComponent{ .radius = 9.0f });
+        EXPECT_FLOAT_EQ(prefab->pointLight->radius, 5.0f);
+        EXPECT_FLOAT_EQ(entityManager.getPointLightComponent(trees[1])->radius, 5.0f);
+
+        const EntitySnapshot snapshot = entityManager.snapshot();
+        entityManager.destroy(trees[0]);
+        entityManager.removePrefabComponent(trees[1]);
+        EXPECT_EQ(entityManager.view<PrefabComponent>().size(), 0u);
+        EXPECT_NE(entityManager.getPointLightComponent(trees[1]), nullptr);
+        EXPECT_EQ(snapshot.getPrefabComponent(trees[0])->prefab, prefab);
+    }
 }
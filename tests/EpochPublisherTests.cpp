@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "services/threading/EpochPublisher.h"
+
+namespace parus
+{
+    namespace
+    {
+        struct Value
+        {
+            uint64_t epoch = 0;
+            /** Always twice epoch in a complete value. */
+            uint64_t check = 0;
+        };
+
+        std::shared_ptr<const Value> makeValue(const uint64_t epoch)
+        {
+            return std::make_shared<const Value>(Value{ epoch, epoch * 2 });
+        }
+    }
+
+    TEST(EpochPublisher, StartsAtEpochZeroWithADefaultValue)
+    {
+        const EpochPublisher<Value> publisher;
+
+        EXPECT_EQ(publisher.getEpoch(), 0u);
+        ASSERT_NE(publisher.acquire(), nullptr);
+        EXPECT_EQ(publisher.acquire()->epoch, 0u);
+    }
+
+    TEST(EpochPublisher, PublishMakesTheValueCurrent)
+    {
+        EpochPublisher<Value> publisher;
+
+        for (uint64_t epoch = 1; epoch <= 10; ++epoch)
+        {
+            EXPECT_EQ(publisher.publish(makeValue(epoch)), epoch);
+            EXPECT_EQ(publisher.getEpoch(), epoch);
+            EXPECT_EQ(publisher.acquire()->epoch, epoch);
+        }
+    }
+
+    TEST(EpochPublisher, HeldValuesOutliveLaterEpochsAndOthersAreReleased)
+    {
+        EpochPublisher<Value> publisher;
+        publisher.publish(makeValue(1));
+        const std::shared_ptr<const Value> held = publisher.acquire();
+        publisher.publish(makeValue(2));
+
+        const std::weak_ptr<const Value> second = publisher.acquire();
+        for (uint64_t epoch = 3; epoch <= 6; ++epoch)
+        {
+            publisher.publish(makeValue(epoch));
+        }
+
+        EXPECT_EQ(held->epoch, 1u);
+        EXPECT_TRUE(second.expired());
+        EXPECT_EQ(publisher.acquire()->epoch, 6u);
+    }
+
+    TEST(EpochPublisher, ConcurrentReadersOnlySeeCompleteValuesInOrder)
+    {
+        constexpr uint64_t PUBLISH_COUNT = 20000;
+        EpochPublisher<Value> publisher;
+        std::atomic<bool> isDone { false };
+        std::atomic<uint64_t> brokenReads { 0 };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.emplace_back([&]
+            {
+                uint64_t lastEpoch = 0;
+                while (!isDone.load(std::memory_order_acquire))
+                {
+                    const std::shared_ptr<const Value> value = publisher.acquire();
+                    if (value->check != value->epoch * 2 || value->epoch < lastEpoch)
+                    {
+                        brokenReads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    lastEpoch = value->epoch;
+                }
+            });
+        }
+
+        for (uint64_t epoch = 1; epoch <= PUBLISH_COUNT; ++epoch)
+        {
+            publisher.publish(makeValue(epoch));
+        }
+        isDone.store(true, std::memory_order_release);
+        for (std::thread& reader : readers)
+        {
+            reader.join();
+        }
+
+        EXPECT_EQ(brokenReads.load(), 0u);
+        EXPECT_EQ(publisher.acquire()->epoch, PUBLISH_COUNT);
+    }
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "services/threading/ThreadPool.h"
+#include "services/world/entity/EntityManager.h"
+#include "services/world/lod/LodSelector.h"
+
+namespace parus
+{
+    namespace
+    {
+        /** Thresholds 0.5 and 0.1, so three levels. */
+        LodComponent makeChain()
+        {
+            return LodComponent{ { { std::make_shared<Mesh>(), 0.5f }, { std::make_shared<Mesh>(), 0.1f }, { std::make_shared<Mesh>(), 0.0f } } };
+        }
+
+        /** A unit cube mesh, so the bounding sphere radius is sqrt(3). */
+        EntityId spawnAt(EntityManager& entityManager, const float z)
+        {
+            const auto mesh = std::make_shared<Mesh>();
+            mesh->bounds = math::Aabb::fromCenterExtents({}, { 1.0f, 1.0f, 1.0f });
+
+            const EntityId id = entityManager.spawn("Rock");
+            entityManager.setTransform(id, math::Transform{ .position = { 0.0f, 0.0f, z } });
+            entityManager.addMeshComponent(id, MeshComponent{ mesh });
+            entityManager.addLodComponent(id, makeChain());
+            return id;
+        }
+
+        /** A 90 degree field of view, so the screen size is just radius / distance. */
+        LodSettings makeSettings()
+        {
+            return LodSettings{ .verticalFieldOfView = math::radians(90.0f) };
+        }
+    }
+
+    TEST(LodSelector, SelectLevelPicksTheFirstLevelWhoseThresholdIsMet)
+    {
+        const LodComponent chain = makeChain();
+
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 1.0f, std::nullopt, 0.1f), 0u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.5f, std::nullopt, 0.1f), 0u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.3f, std::nullopt, 0.1f), 1u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.01f, std::nullopt, 0.1f), 2u);
+        EXPECT_EQ(LodSelector::selectLevel({}, 0.01f, std::nullopt, 0.1f), 0u);
+    }
+
+    TEST(LodSelector, HysteresisKeepsTheCurrentLevelNearAThreshold)
+    {
+        const LodComponent chain = makeChain();
+
+        // The band around 0.5 is [0.45, 0.55).
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.48f, 0u, 0.1f), 0u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.44f, 0u, 0.1f), 1u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.52f, 1u, 0.1f), 1u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.56f, 1u, 0.1f), 0u);
+
+        // Far jumps cross several levels at once, and a level past a shortened chain is clamped.
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.01f, 0u, 0.1f), 2u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 1.0f, 2u, 0.1f), 0u);
+        EXPECT_EQ(LodSelector::selectLevel(chain.levels, 0.01f, 7u, 0.1f), 2u);
+    }
+
+    TEST(LodSelector, UpdateSelectsByDistanceAndReportsOnlyChanges)
+    {
+        EntityManager entityManager;
+        const EntityId near = spawnAt(entityManager, -2.0f);
+        const EntityId middle = spawnAt(entityManager, -10.0f);
+        const EntityId far = spawnAt(entityManager, -100.0f);
+        const EntityId plain = entityManager.spawn("Plain");
+        entityManager.updateWorldTransforms();
+
+        ThreadPool pool;
+        pool.init(2);
+        LodSelector selector;
+        selector.update(entityManager, {}, makeSettings(), pool);
+
+        ASSERT_NE(selector.find(near), nullptr);
+        EXPECT_EQ(selector.find(near)->level, 0u);
+        EXPECT_EQ(selector.find(middle)->level, 1u);
+        EXPECT_EQ(selector.find(far)->level, 2u);
+        EXPECT_EQ(selector.find(plain), nullptr);
+        EXPECT_EQ(selector.getChanged().size(), 3u);
+
+        selector.update(entityManager, {}, makeSettings(), pool);
+        EXPECT_TRUE(selector.getChanged().empty());
+
+        // Walking up to the far entity refines it and coarsens the near one.
+        selector.update(entityManager, { 0.0f, 0.0f, -98.0f }, makeSettings(), pool);
+        EXPECT_EQ(selector.find(near)->level, 2u);
+        EXPECT_EQ(selector.find(far)->level, 0u);
+        const std::vector<EntityId> changed(selector.getChanged().begin(), selector.getChanged().end());
+        EXPECT_NE(std::ranges::find(changed, near), changed.end());
+        EXPECT_NE(std::ranges::find(changed, far), changed.end());
+    }
+
+    TEST(LodSelector, ShadowLevelUsesItsOwnDistanceScale)
+    {
+        EntityManager entityManager;
+        const EntityId near = spawnAt(entityManager, -2.0f);
+        const EntityId middle = spawnAt(entityManager, -10.0f);
+        entityManager.updateWorldTransforms();
+
+        ThreadPool pool;
+        pool.init(2);
+        LodSelector selector;
+        selector.update(entityManager, {}, makeSettings(), pool);
+
+        EXPECT_EQ(selector.find(near)->level, 0u);
+        EXPECT_EQ(selector.find(near)->shadowLevel, 1u);
+        EXPECT_EQ(selector.find(middle)->level, 1u);
+        EXPECT_EQ(selector.find(middle)->shadowLevel, 2u);
+    }
+
+    TEST(LodSelector, ForgetsEntitiesThatLoseTheirChain)
+    {
+        EntityManager entityManager;
+        const EntityId kept = spawnAt(entityManager, -2.0f);
+        const EntityId unlinked = spawnAt(entityManager, -2.0f);
+        const EntityId destroyed = spawnAt(entityManager, -2.0f);
+        entityManager.updateWorldTransforms();
+
+        ThreadPool pool;
+        pool.init(2);
+        LodSelector selector;
+        selector.update(entityManager, {}, makeSettings(), pool);
+
+        entityManager.removeLodComponent(unlinked);
+        entityManager.destroy(destroyed);
+        selector.update(entityManager, {}, makeSettings(), pool);
+
+        EXPECT_NE(selector.find(kept), nullptr);
+        EXPECT_EQ(selector.find(unlinked), nullptr);
+        EXPECT_EQ(selector.find(destroyed), nullptr);
+        EXPECT_TRUE(selector.getChanged().empty());
+
+        selector.clear();
+        EXPECT_EQ(selector.find(kept), nullptr);
+    }
+
+    TEST(LodSelector, ParallelUpdateMatchesSelectLevel)
+    {
+        EntityManager entityManager;
+        std::vector<EntityId> ids;
+        for (int i = 0; i < 3000; ++i)
+        {
+            ids.push_back(spawnAt(entityManager, -2.0f - static_cast<float>(i) * 0.05f));
+        }
+        entityManager.updateWorldTransforms();
+
+        ThreadPool pool;
+        pool.init(4);
+        LodSelector selector;
+        selector.update(entityManager, {}, makeSettings(), pool);
+
+        const LodComponent chain = makeChain();
+        EXPECT_EQ(selector.getChanged().size(), ids.size());
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            const float screenSize = std::sqrt(3.0f) / (2.0f + static_cast<float>(i) * 0.05f);
+            ASSERT_EQ(selector.find(ids[i])->level, LodSelector::selectLevel(chain.levels, screenSize, std::nullopt, 0.1f)) << i;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "services/threading/MainThreadQueue.h"
+
+namespace parus
+{
+    TEST(MainThreadQueue, RunsCallbacksInSubmissionOrder)
+    {
+        MainThreadQueue queue;
+        std::vector<int> order;
+        for (int i = 0; i < 5; ++i)
+        {
+            queue.post([&order, i] { order.push_back(i); });
+        }
+
+        EXPECT_EQ(queue.getPendingCount(), 5u);
+        EXPECT_EQ(queue.drain(), 5u);
+        EXPECT_EQ(order, (std::vector { 0, 1, 2, 3, 4 }));
+        EXPECT_EQ(queue.getPendingCount(), 0u);
+        EXPECT_EQ(queue.drain(), 0u);
+    }
+
+    TEST(MainThreadQueue, DrainIsBoundedAndKeepsOrderAcrossCalls)
+    {
+        MainThreadQueue queue;
+        std::vector<int> order;
+        for (int i = 0; i < 3; ++i)
+        {
+            queue.post([&order, i] { order.push_back(i); });
+        }
+
+        EXPECT_EQ(queue.drain(2), 2u);
+        queue.post([&order] { order.push_back(3); });
+        EXPECT_EQ(queue.drain(2), 2u);
+
+        EXPECT_EQ(order, (std::vector { 0, 1, 2, 3 }));
+    }
+
+    TEST(MainThreadQueue, CallbacksPostedWhileDrainingWaitForTheNextDrain)
+    {
+        MainThreadQueue queue;
+        int runs = 0;
+        std::function<void()> repost = [&]
+        {
+            ++runs;
+            queue.post(repost);
+        };
+        queue.post(repost);
+
+        EXPECT_EQ(queue.drain(), 1u);
+        EXPECT_EQ(queue.drain(), 1u);
+        EXPECT_EQ(runs, 2);
+    }
+
+    TEST(MainThreadQueue, ManyProducersDeliverEveryCallbackOnce)
+    {
+        MainThreadQueue queue;
+        constexpr int PRODUCER_COUNT = 4;
+        constexpr int CALLBACKS_PER_PRODUCER = 5000;
+
+        std::vector<int> lastSeen(PRODUCER_COUNT, -1);
+        bool isOrdered = true;
+        int delivered = 0;
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < PRODUCER_COUNT; ++producer)
+        {
+            producers.emplace_back([&, producer]
+            {
+                for (int i = 0; i < CALLBACKS_PER_PRODUCER; ++i)
+                {
+                    // Runs on the draining thread only, so no synchronization is needed inside.
+                    queue.post([&, producer, i]
+                    {
+                        isOrdered = isOrdered && lastSeen[producer] == i - 1;
+                        lastSeen[producer] = i;
+                        ++delivered;
+                    });
+                }
+            });
+        }
+
+        while (delivered < PRODUCER_COUNT * CALLBACKS_PER_PRODUCER)
+        {
+            queue.drain(64);
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        EXPECT_EQ(delivered, PRODUCER_COUNT * CALLBACKS_PER_PRODUCER);
+        EXPECT_TRUE(isOrdered);
+        EXPECT_EQ(queue.drain(), 0u);
+    }
+
+    TEST(MainThreadQueue, FailingCallbackDoesNotStopTheDrain)
+    {
+        MainThreadQueue queue;
+        int runs = 0;
+        queue.post([] { throw std::runtime_error("boom"); });
+        queue.post([&runs] { ++runs; });
+
+        EXPECT_EQ(queue.drain(), 2u);
+        EXPECT_EQ(runs, 1);
+    }
+
+    TEST(MainThreadQueue, DestructorReleasesPendingCallbacks)
+    {
+        const auto payload = std::make_shared<int>(0);
+        {
+            MainThreadQueue queue;
+            queue.post([payload] { ++*payload; });
+            EXPECT_EQ(payload.use_count(), 2);
+        }
+
+        EXPECT_EQ(payload.use_count(), 1);
+        EXPECT_EQ(*payload, 0);
+    }
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+
+#include "engine/utils/math/Bounds.h"
 #include "engine/utils/math/Math.h"
 
 namespace parus
@@ -79,4 +82,80 @@ namespace parus::math
         EXPECT_NEAR(result.y, 7.0f, 1e-4f);
         EXPECT_NEAR(result.z, 8.0f, 1e-4f);
     }
+
+    TEST(AabbTransform, TranslationAndScaleMoveTheCorners)
+    {
+        const math::Aabb box { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+        const math::Matrix4x4 matrix = math::Matrix4x4::scale(2.0f, 3.0f, 4.0f) * math::Matrix4x4::translation(10.0f, 0.0f, 0.0f);
+        const math::Aabb result = box.transform(matrix);
+
+        EXPECT_NEAR(result.min.x, 8.0f, 1e-4f);
+        EXPECT_NEAR(result.max.x, 12.0f, 1e-4f);
+        EXPECT_NEAR(result.min.y, -3.0f, 1e-4f);
+        EXPECT_NEAR(result.max.y, 3.0f, 1e-4f);
+        EXPECT_NEAR(result.min.z, -4.0f, 1e-4f);
+        EXPECT_NEAR(result.max.z, 4.0f, 1e-4f);
+    }
+
+    TEST(AabbTransform, RotationGrowsTheBoxToFitTheCorners)
+    {
+        const math::Aabb box { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+        const math::Aabb result = box.transform(math::Matrix4x4::rotation(0.0f, 45.0f, 0.0f));
+
+        EXPECT_NEAR(result.max.x, std::sqrt(2.0f), 1e-4f);
+        EXPECT_NEAR(result.max.z, std::sqrt(2.0f), 1e-4f);
+        EXPECT_NEAR(result.max.y, 1.0f, 1e-4f);
+    }
+
+    TEST(AabbMerge, EmptyBoxIsIgnored)
+    {
+        const math::Aabb box { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+
+        EXPECT_TRUE(math::Aabb {}.isEmpty());
+        EXPECT_EQ(math::Aabb {}.merge(box), box);
+        EXPECT_FALSE(math::Aabb {}.intersects(box));
+    }
+
+    TEST(RayIntersect, ReturnsEntryDistanceAndRespectsMaxDistance)
+    {
+        const math::Aabb box { { 4.0f, -1.0f, -1.0f }, { 6.0f, 1.0f, 1.0f } };
+        const math::Ray ray { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } };
+
+        ASSERT_TRUE(ray.intersect(box, 100.0f).has_value());
+        EXPECT_NEAR(*ray.intersect(box, 100.0f), 4.0f, 1e-4f);
+        EXPECT_FALSE(ray.intersect(box, 3.0f).has_value());
+        EXPECT_FALSE((math::Ray { { 0.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f } }).intersect(box, 100.0f).has_value());
+        EXPECT_FALSE((math::Ray { { 0.0f, 2.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } }).intersect(box, 100.0f).has_value());
+    }
+
+    TEST(RayIntersect, OriginInsideTheBoxIsAtZero)
+    {
+        const math::Aabb box { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+        const math::Ray ray { { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+
+        EXPECT_EQ(ray.intersect(box, 10.0f), 0.0f);
+    }
+
+    TEST(SphereIntersect, UsesTheClosestPointOfTheBox)
+    {
+        const math::Aabb box { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+
+        EXPECT_TRUE((math::Sphere { { 2.0f, 0.5f, 0.5f }, 1.0f }).intersects(box));
+        // Near the corner, the per-axis distances are each below the radius but their length is not.
+        EXPECT_FALSE((math::Sphere { { 1.8f, 1.8f, 1.8f }, 1.0f }).intersects(box));
+    }
+
+    TEST(FrustumIntersect, PerspectiveCameraSeesOnlyWhatIsInFront)
+    {
+        const math::Matrix4x4 viewProjection = math::Matrix4x4::lookAt({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f })
+            * math::Matrix4x4::perspective(static_cast<float>(math::MATH_PI) / 2.0f, 1.0f, 0.1f, 100.0f);
+        const math::Frustum frustum = math::Frustum::fromViewProjection(viewProjection);
+        const math::Vector3 extents(1.0f, 1.0f, 1.0f);
+
+        EXPECT_TRUE(frustum.intersects(math::Aabb::fromCenterExtents({ 0.0f, 0.0f, -10.0f }, extents)));
+        EXPECT_TRUE(frustum.intersects(math::Aabb::fromCenterExtents({ 10.5f, 0.0f, -10.0f }, extents)));
+        EXPECT_FALSE(frustum.intersects(math::Aabb::fromCenterExtents({ 0.0f, 0.0f, 10.0f }, extents)));
+        EXPECT_FALSE(frustum.intersects(math::Aabb::fromCenterExtents({ 20.0f, 0.0f, -10.0f }, extents)));
+        EXPECT_FALSE(frustum.intersects(math::Aabb::fromCenterExtents({ 0.0f, 0.0f, -200.0f }, extents)));
+    }
 }
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "services/world/entity/NameTable.h"
+
+namespace parus
+{
+    TEST(NameTable, InterningTheSameTextReturnsTheSameId)
+    {
+        NameTable names;
+        const NameId cube = names.intern("Cube");
+        const NameId lamp = names.intern("Lamp");
+
+        EXPECT_NE(cube, lamp);
+        EXPECT_EQ(names.intern(std::string("Cube")), cube);
+        EXPECT_EQ(names.get(cube), "Cube");
+        EXPECT_EQ(names.size(), 2u);
+    }
+
+    TEST(NameTable, FindDoesNotIntern)
+    {
+        NameTable names;
+        names.intern("Cube");
+
+        EXPECT_EQ(names.find("Cube"), std::optional<NameId>(0));
+        EXPECT_EQ(names.find("Lamp"), std::nullopt);
+        EXPECT_EQ(names.size(), 1u);
+    }
+
+    TEST(NameTable, ViewsStayValidAcrossChunks)
+    {
+        NameTable names;
+        const std::string_view first = names.get(names.intern("First"));
+
+        // Enough text to fill several arena chunks, plus one string larger than a chunk.
+        for (int i = 0; i < 5000; ++i)
+        {
+            names.intern("Entity" + std::to_string(i));
+        }
+        const std::string longName(40000, 'x');
+        const NameId longId = names.intern(longName);
+
+        EXPECT_EQ(first, "First");
+        EXPECT_EQ(names.get(longId), longName);
+        EXPECT_EQ(names.get(*names.find("Entity4999")), "Entity4999");
+    }
+
+    TEST(NameTable, ClearForgetsNamesAndReusesTheArena)
+    {
+        NameTable names;
+        names.intern("Cube");
+        names.intern("");
+        names.clear();
+
+        EXPECT_EQ(names.find("Cube"), std::nullopt);
+        EXPECT_EQ(names.size(), 0u);
+
+        const NameId lamp = names.intern("Lamp");
+        EXPECT_EQ(lamp, 0u);
+        EXPECT_EQ(names.get(lamp), "Lamp");
+    }
+}
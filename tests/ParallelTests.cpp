@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "services/threading/Parallel.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    TEST(ParallelFor, VisitsEveryIndexExactlyOnce)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::vector<std::atomic<int>> visits(10000);
+        parallelFor(pool, 0, visits.size(), [&](const size_t i) { visits[i].fetch_add(1); }, 16);
+
+        for (size_t i = 0; i < visits.size(); ++i)
+        {
+            EXPECT_EQ(visits[i].load(), 1) << "index " << i;
+        }
+    }
+
+    TEST(ParallelFor, SmallRangeRunsInlineOnTheCaller)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> ranElsewhere = false;
+        parallelFor(pool, 0, 10, [&](size_t)
+        {
+            if (std::this_thread::get_id() != caller)
+            {
+                ranElsewhere = true;
+            }
+        });
+
+        EXPECT_FALSE(ranElsewhere.load());
+        EXPECT_FALSE(pool.isBusy());
+    }
+
+    TEST(ParallelFor, EmptyRangeDoesNothing)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        int calls = 0;
+        parallelFor(pool, 5, 5, [&](size_t) { ++calls; });
+
+        EXPECT_EQ(calls, 0);
+    }
+
+    TEST(ParallelFor, RethrowsExceptionFromABody)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        EXPECT_THROW(parallelFor(pool, 0, 1000, [](const size_t i)
+        {
+            if (i == 500)
+            {
+                throw std::runtime_error("bad element");
+            }
+        }, 1), std::runtime_error);
+    }
+
+    TEST(ParallelFor, NestedLoopsFromWorkersComplete)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<int> counter = 0;
+        parallelFor(pool, 0, 8, [&](size_t)
+        {
+            parallelFor(pool, 0, 100, [&](size_t) { counter.fetch_add(1); }, 1);
+        }, 1);
+
+        EXPECT_EQ(counter.load(), 800);
+    }
+
+    TEST(ParallelForRange, ChunksCoverTheRangeWithoutOverlap)
+    {
+        ThreadPool pool;
+        pool.init(3);
+
+        std::vector<std::atomic<int>> visits(5000);
+        parallelForRange(pool, 0, visits.size(), [&](const size_t begin, const size_t end)
+        {
+            EXPECT_LT(begin, end);
+            for (size_t i = begin; i < end; ++i)
+            {
+                visits[i].fetch_add(1);
+            }
+        }, 100);
+
+        for (const auto& visit : visits)
+        {
+            EXPECT_EQ(visit.load(), 1);
+        }
+    }
+
+    TEST(ParallelReduce, SumsARange)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        const uint64_t sum = parallelReduce<uint64_t>(pool, 0, 100000, 0,
+            [](const size_t i) { return static_cast<uint64_t>(i); },
+            [](const uint64_t a, const uint64_t b) { return a + b; }, 64);
+
+        EXPECT_EQ(sum, 100000ull * 99999ull / 2ull);
+    }
+
+    TEST(ParallelReduce, CombinesChunksInIndexOrder)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        // String concatenation is not commutative, so any reordering would show up.
+        const std::string joined = parallelReduce<std::string>(pool, 0, 26, "",
+            [](const size_t i) { return std::string(1, static_cast<char>('a' + i)); },
+            [](const std::string& a, const std::string& b) { return a + b; }, 1);
+
+        EXPECT_EQ(joined, "abcdefghijklmnopqrstuvwxyz");
+    }
+
+    TEST(ParallelTransform, WritesEveryOutputElement)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::vector<int> input(4096);
+        std::iota(input.begin(), input.end(), 0);
+        std::vector<int> output(input.size());
+
+        const auto end = parallelTransform(pool, input.begin(), input.end(), output.begin(), [](const int value) { return value * 2; }, 32);
+
+        EXPECT_EQ(end, output.end());
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            EXPECT_EQ(output[i], input[i] * 2);
+        }
+    }
+}
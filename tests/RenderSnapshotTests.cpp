@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "services/world/RenderSnapshot.h"
+
+namespace parus
+{
+    TEST(RenderSnapshotBuffer, PublishHandsTheWrittenSnapshotToTheReader)
+    {
+        RenderSnapshotBuffer buffer;
+
+        buffer.getWriteSnapshot().tick = 1;
+        EXPECT_EQ(buffer.getReadSnapshot().tick, 0u);
+
+        buffer.publish();
+        EXPECT_EQ(buffer.getReadSnapshot().tick, 1u);
+
+        // The writer now fills the other slot; the reader keeps seeing tick 1 until the next publish.
+        buffer.getWriteSnapshot().tick = 2;
+        EXPECT_EQ(buffer.getReadSnapshot().tick, 1u);
+        EXPECT_NE(&buffer.getWriteSnapshot(), &buffer.getReadSnapshot());
+
+        buffer.publish();
+        EXPECT_EQ(buffer.getReadSnapshot().tick, 2u);
+    }
+
+    TEST(RenderSnapshotBuffer, SlotsKeepTheirCapacityAcrossFrames)
+    {
+        RenderSnapshotBuffer buffer;
+        buffer.getWriteSnapshot().pointLights.resize(16);
+        const RenderSnapshot* firstSlot = &buffer.getWriteSnapshot();
+
+        buffer.publish();
+        buffer.publish();
+
+        ASSERT_EQ(&buffer.getWriteSnapshot(), firstSlot);
+        buffer.getWriteSnapshot().pointLights.clear();
+        EXPECT_GE(buffer.getWriteSnapshot().pointLights.capacity(), 16u);
+    }
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "services/world/spatial/AabbTree.h"
+#include "services/world/spatial/SpatialIndex.h"
+
+namespace parus
+{
+    namespace
+    {
+        struct Item
+        {
+            EntityId id;
+            math::Aabb bounds;
+        };
+
+        std::vector<Item> makeRandomItems(const size_t count, const uint32_t seed)
+        {
+            std::mt19937 random(seed);
+            std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+            std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+            std::vector<Item> items;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const math::Vector3 center(position(random), position(random), position(random));
+                items.push_back({ static_cast<EntityId>(i + 1), math::Aabb::fromCenterExtents(center, { size(random), size(random), size(random) }) });
+            }
+            return items;
+        }
+
+        std::set<EntityId> queryAabb(const SpatialIndex& index, const math::Aabb& bounds)
+        {
+            std::set<EntityId> result;
+            index.queryAabb(bounds, [&result](const EntityId id) { EXPECT_TRUE(result.insert(id).second); });
+            return result;
+        }
+
+        std::set<EntityId> bruteForceAabb(const std::vector<Item>& items, const math::Aabb& bounds)
+        {
+            std::set<EntityId> result;
+            for (const Item& item : items)
+            {
+                if (item.bounds.intersects(bounds))
+                {
+                    result.insert(item.id);
+                }
+            }
+            return result;
+        }
+
+        void fill(SpatialIndex& index, const std::vector<Item>& items, const Mobility mobility)
+        {
+            for (const Item& item : items)
+            {
+                index.update(item.id, item.bounds, mobility);
+            }
+            index.commit();
+        }
+    }
+
+    TEST(AabbTree, IncrementalInsertsStayBalanced)
+    {
+        AabbTree tree;
+        for (const Item& item : makeRandomItems(1024, 1))
+        {
+            tree.insert(item.id, item.bounds);
+        }
+
+        EXPECT_EQ(tree.size(), 1024u);
+        // A perfectly balanced tree over 1024 leaves has height 10; AVL rotations keep it within a small factor.
+        EXPECT_LE(tree.getHeight(), 20);
+    }
+
+    TEST(SpatialIndex, QueriesMatchBruteForce)
+    {
+        const std::vector<Item> items = makeRandomItems(500, 2);
+        for (const Mobility mobility : { Mobility::Static, Mobility::Movable })
+        {
+            SpatialIndex index;
+            fill(index, items, mobility);
+            ASSERT_EQ(index.size(), items.size());
+
+            const math::Aabb region { { -20.0f, -30.0f, -10.0f }, { 25.0f, 10.0f, 40.0f } };
+            EXPECT_EQ(queryAabb(index, region), bruteForceAabb(items, region));
+
+            const math::Sphere sphere { { 10.0f, 0.0f, -5.0f }, 30.0f };
+            std::set<EntityId> sphereHits;
+            index.querySphere(sphere, [&sphereHits](const EntityId id) { sphereHits.insert(id); });
+            std::set<EntityId> expectedSphereHits;
+            for (const Item& item : items)
+            {
+                if (sphere.intersects(item.bounds))
+                {
+                    expectedSphereHits.insert(item.id);
+                }
+            }
+            EXPECT_EQ(sphereHits, expectedSphereHits);
+        }
+    }
+
+    TEST(SpatialIndex, RaycastReturnsTheClosestBox)
+    {
+        const std::vector<Item> items = makeRandomItems(500, 3);
+        SpatialIndex index;
+        fill(index, items, Mobility::Static);
+
+        const math::Ray ray { { -150.0f, 1.0f, 2.0f }, math::Vector3(1.0f, 0.05f, 0.02f).normalize() };
+
+        std::set<EntityId> rayHits;
+        index.queryRay(ray, 400.0f, [&rayHits](const EntityId id, float) { rayHits.insert(id); });
+
+        std::set<EntityId> expectedRayHits;
+        std::optional<RayHit> expectedClosest;
+        for (const Item& item : items)
+        {
+            if (const std::optional<float> distance = ray.intersect(item.bounds, 400.0f))
+            {
+                expectedRayHits.insert(item.id);
+                if (!expectedClosest || *distance < expectedClosest->distance)
+                {
+                    expectedClosest = RayHit { item.id, *distance };
+                }
+            }
+        }
+        EXPECT_EQ(rayHits, expectedRayHits);
+
+        const std::optional<RayHit> closest = index.raycast(ray, 400.0f);
+        ASSERT_EQ(closest.has_value(), expectedClosest.has_value());
+        if (closest)
+        {
+            EXPECT_EQ(closest->id, expectedClosest->id);
+            EXPECT_FLOAT_EQ(closest->distance, expectedClosest->distance);
+        }
+    }
+
+    TEST(SpatialIndex, MovedEntitiesAreFoundAtTheirNewBounds)
+    {
+        std::vector<Item> items = makeRandomItems(200, 4);
+        SpatialIndex index;
+        fill(index, items, Mobility::Movable);
+
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            for (Item& item : items)
+            {
+                const math::Vector3 offset(step(random), step(random), step(random));
+                item.bounds = { item.bounds.min + offset, item.bounds.max + offset };
+                index.update(item.id, item.bounds, Mobility::Movable);
+            }
+            index.commit();
+        }
+
+        const math::Aabb region { { -50.0f, -50.0f, -50.0f }, { 10.0f, 20.0f, 30.0f } };
+        EXPECT_EQ(queryAabb(index, region), bruteForceAabb(items, region));
+        EXPECT_EQ(*index.getBounds(items[0].id), items[0].bounds);
+    }
+
+    TEST(SpatialIndex, MobilityChangesMoveEntitiesBetweenTrees)
+    {
+        SpatialIndex index;
+        const math::Aabb bounds { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+        index.update(1, bounds, Mobility::Static);
+        index.update(2, bounds, Mobility::Movable);
+        index.commit();
+
+        index.update(1, bounds, Mobility::Movable);
+        index.update(2, bounds, Mobility::Static);
+        index.commit();
+
+        EXPECT_EQ(queryAabb(index, bounds), (std::set<EntityId>{ 1, 2 }));
+    }
+
+    TEST(SpatialIndex, StaticRemovalsApplyBeforeCommit)
+    {
+        SpatialIndex index;
+        const math::Aabb bounds { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+        index.update(1, bounds, Mobility::Static);
+        index.update(2, bounds, Mobility::Static);
+        index.commit();
+
+        EXPECT_TRUE(index.remove(1));
+        EXPECT_FALSE(index.remove(1));
+        EXPECT_EQ(queryAabb(index, bounds), std::set<EntityId>{ 2 });
+
+        // A static entry that became movable must not be reported twice, nor at its old bounds.
+        const math::Aabb farBounds { { 50.0f, 50.0f, 50.0f }, { 51.0f, 51.0f, 51.0f } };
+        index.update(2, farBounds, Mobility::Movable);
+        EXPECT_TRUE(queryAabb(index, bounds).empty());
+        EXPECT_EQ(queryAabb(index, farBounds), std::set<EntityId>{ 2 });
+    }
+
+    TEST(SpatialIndex, ClearEmptiesBothTrees)
+    {
+        SpatialIndex index;
+        fill(index, makeRandomItems(50, 6), Mobility::Static);
+        index.update(100, { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } }, Mobility::Movable);
+
+        index.clear();
+
+        EXPECT_EQ(index.size(), 0u);
+        EXPECT_TRUE(queryAabb(index, { { -200.0f, -200.0f, -200.0f }, { 200.0f, 200.0f, 200.0f } }).empty());
+    }
+}
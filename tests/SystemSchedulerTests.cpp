@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "services/threading/ThreadPool.h"
+#include "services/world/system/SystemScheduler.h"
+
+namespace parus
+{
+    TEST(SystemAccess, OnlyWritesConflict)
+    {
+        const SystemAccess readsLights = SystemAccess().read<PointLightComponent>();
+        const SystemAccess readsLightsAndMeshes = SystemAccess().read<PointLightComponent, MeshComponent>();
+        const SystemAccess writesLights = SystemAccess().write<PointLightComponent>();
+        const SystemAccess writesTransforms = SystemAccess().read<MeshComponent>().write<math::Transform>();
+
+        EXPECT_FALSE(readsLights.conflictsWith(readsLightsAndMeshes));
+        EXPECT_TRUE(readsLights.conflictsWith(writesLights));
+        EXPECT_TRUE(writesLights.conflictsWith(readsLights));
+        EXPECT_TRUE(writesLights.conflictsWith(writesLights));
+        EXPECT_FALSE(writesLights.conflictsWith(writesTransforms));
+
+        const SystemAccess fromView = SystemAccess::fromView<const MeshComponent, PointLightComponent>();
+        EXPECT_EQ(fromView.reads, componentMask<MeshComponent>());
+        EXPECT_EQ(fromView.writes, componentMask<PointLightComponent>());
+    }
+
+    TEST(SystemScheduler, ConflictingSystemsRunInRegistrationOrder)
+    {
+        ThreadPool pool;
+        pool.init(4);
+        EntityManager entityManager;
+        EntityCommandQueue commands;
+
+        std::mutex orderMutex;
+        std::vector<int> order;
+        auto record = [&](const int system)
+        {
+            return [&, system](const SystemContext&)
+            {
+                std::scoped_lock lock(orderMutex);
+                order.push_back(system);
+            };
+        };
+
+        SystemScheduler scheduler;
+        scheduler.add(SystemAccess().write<math::Transform>(), record(0));
+        scheduler.add(SystemAccess().read<math::Transform>().write<PointLightComponent>(), record(1));
+        scheduler.add(SystemAccess().read<PointLightComponent>(), record(2));
+
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            order.clear();
+            scheduler.update(entityManager, commands, pool, 0.016f);
+            EXPECT_EQ(order, (std::vector<int> { 0, 1, 2 }));
+        }
+    }
+
+    TEST(SystemScheduler, IndependentSystemsRunConcurrently)
+    {
+        ThreadPool pool;
+        pool.init(4);
+        EntityManager entityManager;
+        EntityCommandQueue commands;
+
+        // Each reader waits for the other to start, which only happens if they overlap.
+        std::atomic<int> started { 0 };
+        std::atomic<int> overlapped { 0 };
+        auto reader = [&](const SystemContext&)
+        {
+            started.fetch_add(1);
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (started.load() < 2 && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+            if (started.load() >= 2)
+            {
+                overlapped.fetch_add(1);
+            }
+        };
+
+        SystemScheduler scheduler;
+        scheduler.add(SystemAccess().read<MeshComponent, math::Transform>(), reader);
+        scheduler.add(SystemAccess().read<MeshComponent>(), reader);
+        scheduler.update(entityManager, commands, pool, 0.016f);
+
+        EXPECT_EQ(overlapped.load(), 2);
+    }
+
+    TEST(SystemScheduler, ForEachSystemsSeeEarlierWrites)
+    {
+        ThreadPool pool;
+        pool.init(4);
+        EntityManager entityManager;
+        EntityCommandQueue commands;
+        for (int i = 0; i < 3000; ++i)
+        {
+            const EntityId id = entityManager.spawn("Lamp");
+            entityManager.addPointLightComponent(id, PointLightComponent{ .intensity = 1.0f });
+        }
+
+        SystemScheduler scheduler;
+        scheduler.addForEach<PointLightComponent>([](const SystemContext& context, const Entity&, PointLightComponent& light)
+        {
+            light.intensity += context.deltaTime;
+        }, 64);
+        std::atomic<int> brightLights { 0 };
+        scheduler.addForEach<const PointLightComponent>([&brightLights](const SystemContext&, const Entity&, const PointLightComponent& light)
+        {
+            if (light.intensity == 1.5f)
+            {
+                brightLights.fetch_add(1, std::memory_order_relaxed);
+            }
+        }, 64);
+
+        scheduler.update(entityManager, commands, pool, 0.5f);
+
+        EXPECT_EQ(brightLights.load(), 3000);
+    }
+
+    TEST(SystemScheduler, ParallelChunksCanMarkChanges)
+    {
+        ThreadPool pool;
+        pool.init(4);
+        EntityManager entityManager;
+        EntityCommandQueue commands;
+        constexpr int LIGHT_COUNT = 4096;
+        for (int i = 0; i < LIGHT_COUNT; ++i)
+        {
+            const EntityId id = entityManager.spawn("Lamp");
+            entityManager.addPointLightComponent(id, PointLightComponent{ .intensity = 1.0f });
+        }
+
+        std::set<EntityId> changed;
+        size_t changeCount = 0;
+        entityManager.onChange<PointLightComponent>([&](const std::span<const EntityId> ids)
+        {
+            changed.insert(ids.begin(), ids.end());
+            changeCount += ids.size();
+        });
+
+        SystemScheduler scheduler;
+        scheduler.addForEach<PointLightComponent>([](const SystemContext& context, const Entity& entity, PointLightComponent& light)
+        {
+            light.intensity += context.deltaTime;
+            context.entityManager.markChanged<PointLightComponent>(entity.id);
+        }, 64);
+        EntityChangeSet changes;
+        entityManager.takeChanges(changes);
+        scheduler.update(entityManager, commands, pool, 0.5f);
+        entityManager.dispatchObservers();
+
+        EXPECT_EQ(changeCount, static_cast<size_t>(LIGHT_COUNT));
+        EXPECT_EQ(changed.size(), static_cast<size_t>(LIGHT_COUNT));
+        // The change set gets them too, merged once the systems are done.
+        EXPECT_EQ(entityManager.getChanges().componentsAdded.size(), static_cast<size_t>(LIGHT_COUNT));
+
+        // Marks outside update() go straight to the channel again.
+        entityManager.markChanged<PointLightComponent>(*changed.begin());
+        entityManager.dispatchObservers();
+        EXPECT_EQ(changeCount, static_cast<size_t>(LIGHT_COUNT) + 1);
+    }
+
+    TEST(SystemScheduler, UpdateRethrowsSystemExceptions)
+    {
+        ThreadPool pool;
+        pool.init(2);
+        EntityManager entityManager;
+        EntityCommandQueue commands;
+
+        std::atomic<bool> hasDependentRun { false };
+        SystemScheduler scheduler;
+        scheduler.add(SystemAccess().write<MeshComponent>(), [](const SystemContext&) { throw std::runtime_error("system failed"); });
+        scheduler.add(SystemAccess().read<MeshComponent>(), [&hasDependentRun](const SystemContext&) { hasDependentRun = true; });
+
+        EXPECT_THROW(scheduler.update(entityManager, commands, pool, 0.016f), std::runtime_error);
+        EXPECT_FALSE(hasDependentRun.load());
+    }
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "services/threading/TaskGraph.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    TEST(TaskGraph, RunsNodesAfterTheirDependencies)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::mutex orderMutex;
+        std::vector<char> order;
+        auto record = [&](const char name)
+        {
+            return [&, name]
+            {
+                std::scoped_lock lock(orderMutex);
+                order.push_back(name);
+            };
+        };
+
+        // Diamond: a -> (b, c) -> d
+        TaskGraph graph;
+        const auto a = graph.add(record('a'));
+        const auto b = graph.add(record('b'), { a });
+        const auto c = graph.add(record('c'), { a });
+        graph.add(record('d'), { b, c });
+
+        graph.run(pool).get();
+
+        ASSERT_EQ(order.size(), 4u);
+        EXPECT_EQ(order.front(), 'a');
+        EXPECT_EQ(order.back(), 'd');
+    }
+
+    TEST(TaskGraph, IndependentNodesAllRun)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::atomic<int> counter = 0;
+        TaskGraph graph;
+        std::vector<TaskGraph::NodeId> leaves;
+        for (int i = 0; i < 100; ++i)
+        {
+            leaves.push_back(graph.add([&counter] { counter.fetch_add(1); }));
+        }
+
+        std::atomic<int> observedAtJoin = 0;
+        graph.add([&] { observedAtJoin = counter.load(); }, leaves);
+
+        graph.run(pool).get();
+
+        EXPECT_EQ(counter.load(), 100);
+        EXPECT_EQ(observedAtJoin.load(), 100);
+    }
+
+    TEST(TaskGraph, RunLeavesTheBuilderEmpty)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        TaskGraph graph;
+        graph.add([] {});
+        EXPECT_EQ(graph.size(), 1u);
+
+        graph.run(pool).wait();
+
+        EXPECT_TRUE(graph.empty());
+    }
+
+    TEST(TaskGraph, EmptyGraphCompletesImmediately)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        TaskGraph graph;
+        const TaskHandle<void> handle = graph.run(pool);
+
+        EXPECT_TRUE(handle.isReady());
+    }
+
+    TEST(TaskGraph, FailureSkipsDependentsAndIsRethrown)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<bool> dependentRan = false;
+        TaskGraph graph;
+        const auto failing = graph.add([] { throw std::runtime_error("decode failed"); });
+        graph.add([&] { dependentRan = true; }, { failing });
+
+        EXPECT_THROW(graph.run(pool).get(), std::runtime_error);
+        EXPECT_FALSE(dependentRan.load());
+    }
+
+    TEST(TaskGraph, CycleIsRejected)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        TaskGraph graph;
+        const auto a = graph.add([] {});
+        const auto b = graph.add([] {}, { a });
+        graph.precede(b, a);
+
+        EXPECT_THROW(graph.run(pool), std::runtime_error);
+    }
+
+    TEST(TaskGraph, RunFromAWorkerCanBeWaitedOn)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        const auto outer = pool.enqueue([&pool]
+        {
+            std::atomic<int> sum = 0;
+            TaskGraph graph;
+            const auto first = graph.add([&sum] { sum += 1; });
+            graph.add([&sum] { sum += 2; }, { first });
+            graph.run(pool).get();
+            return sum.load();
+        });
+
+        EXPECT_EQ(outer.get(), 3);
+    }
+}
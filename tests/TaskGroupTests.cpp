@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "services/threading/TaskGroup.h"
+#include "services/threading/ThreadPool.h"
+
+namespace parus
+{
+    TEST(TaskGroup, WaitsForEveryTaskInTheGroup)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::atomic<int> counter { 0 };
+        TaskGroup group(pool);
+        for (int i = 0; i < 500; ++i)
+        {
+            group.run([&counter] { counter.fetch_add(1); });
+        }
+
+        group.wait();
+        EXPECT_EQ(counter.load(), 500);
+        EXPECT_TRUE(group.isDone());
+    }
+
+    TEST(TaskGroup, DoesNotWaitForUnrelatedTasks)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        // Occupies the only worker until the group is done.
+        std::atomic<bool> started { false };
+        std::atomic<bool> release { false };
+        pool.post([&] { started = true; started.notify_all(); release.wait(false); });
+        started.wait(false);
+
+        std::atomic<int> counter { 0 };
+        TaskGroup group(pool);
+        group.run([&counter] { counter.fetch_add(1); });
+        group.wait();
+
+        EXPECT_EQ(counter.load(), 1);
+        EXPECT_TRUE(pool.isBusy());
+
+        release = true;
+        release.notify_all();
+        pool.waitUntilDone();
+    }
+
+    TEST(TaskGroup, ExternalWaiterHelpsExecuteTasks)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> started { false };
+        std::atomic<bool> release { false };
+        pool.post([&] { started = true; started.notify_all(); release.wait(false); });
+        started.wait(false);
+
+        const std::thread::id waiterId = std::this_thread::get_id();
+        std::atomic<int> ranOnWaiter { 0 };
+        TaskGroup group(pool);
+        for (int i = 0; i < 8; ++i)
+        {
+            group.run([&ranOnWaiter, waiterId]
+            {
+                if (std::this_thread::get_id() == waiterId)
+                {
+                    ranOnWaiter.fetch_add(1);
+                }
+            });
+        }
+        group.wait();
+
+        // The worker was blocked the whole time, so the waiter ran everything itself.
+        EXPECT_EQ(ranOnWaiter.load(), 8);
+
+        release = true;
+        release.notify_all();
+    }
+
+    TEST(TaskGroup, WorkerWaiterOnlyRunsItsOwnTasks)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> unrelatedRan { false };
+        std::atomic<bool> unrelatedRanDuringWait { true };
+        std::atomic<int> counter { 0 };
+        pool.post([&]
+        {
+            // Queued ahead of the group's pool tasks on the only worker, which is this one.
+            pool.post([&unrelatedRan] { unrelatedRan = true; });
+
+            TaskGroup group(pool);
+            for (int i = 0; i < 8; ++i)
+            {
+                group.run([&counter] { counter.fetch_add(1); });
+            }
+            group.wait();
+            unrelatedRanDuringWait = unrelatedRan.load();
+        });
+        pool.waitUntilDone();
+
+        EXPECT_EQ(counter.load(), 8);
+        EXPECT_FALSE(unrelatedRanDuringWait.load());
+        EXPECT_TRUE(unrelatedRan.load());
+    }
+
+    TEST(TaskGroup, TasksCanAddMoreTasksToTheirGroup)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<int> counter { 0 };
+        TaskGroup group(pool);
+        for (int i = 0; i < 10; ++i)
+        {
+            group.run([&group, &counter]
+            {
+                for (int j = 0; j < 10; ++j)
+                {
+                    group.run([&counter] { counter.fetch_add(1); });
+                }
+            });
+        }
+
+        group.wait();
+        EXPECT_EQ(counter.load(), 100);
+    }
+
+    TEST(TaskGroup, KeepsTheFirstFailureAndFinishesTheRest)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<int> counter { 0 };
+        TaskGroup group(pool);
+        group.run([] { throw std::runtime_error("boom"); });
+        for (int i = 0; i < 10; ++i)
+        {
+            group.run([&counter] { counter.fetch_add(1); });
+        }
+
+        group.wait();
+        EXPECT_EQ(counter.load(), 10);
+        ASSERT_TRUE(group.getFirstException());
+        EXPECT_THROW(std::rethrow_exception(group.getFirstException()), std::runtime_error);
+    }
+
+    TEST(TaskGroup, DestructorWaits)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<int> counter { 0 };
+        {
+            TaskGroup group(pool);
+            for (int i = 0; i < 50; ++i)
+            {
+                group.run([&counter] { counter.fetch_add(1); });
+            }
+        }
+
+        EXPECT_EQ(counter.load(), 50);
+    }
+
+    TEST(TaskGroup, CancelledGroupDropsTasksThatHaveNotStarted)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> started { false };
+        std::atomic<bool> release { false };
+        pool.post([&] { started = true; started.notify_all(); release.wait(false); });
+        started.wait(false);
+
+        CancellationSource cancellation;
+        std::atomic<int> counter { 0 };
+        TaskGroup group(pool, cancellation.getToken());
+        for (int i = 0; i < 10; ++i)
+        {
+            group.run([&counter] { counter.fetch_add(1); });
+        }
+
+        cancellation.cancel();
+        group.wait();
+
+        EXPECT_EQ(counter.load(), 0);
+        EXPECT_TRUE(group.isDone());
+        EXPECT_TRUE(group.getToken().isCancelled());
+
+        release = true;
+        release.notify_all();
+        pool.waitUntilDone();
+    }
+
+    TEST(TaskGroup, RunningTasksStopAtTheirNextCheck)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        CancellationSource cancellation;
+        std::atomic<bool> started { false };
+        TaskGroup group(pool, cancellation.getToken());
+        group.run([&started, token = cancellation.getToken()]
+        {
+            started = true;
+            started.notify_all();
+            while (!token.isCancelled())
+            {
+                std::this_thread::yield();
+            }
+        });
+
+        started.wait(false);
+        cancellation.cancel();
+        group.wait();
+
+        EXPECT_TRUE(group.isDone());
+        EXPECT_FALSE(group.getFirstException());
+    }
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "services/threading/Task.h"
+#include "services/threading/TaskSlotPool.h"
+#include "services/threading/ThreadPool.h"
+
+namespace
+{
+    std::atomic<size_t> allocationCount { 0 };
+}
+
+// Counts every heap allocation in the test binary; tests compare the count before and after.
+void* operator new(const size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace parus
+{
+    namespace
+    {
+        struct LifetimeCounter
+        {
+            explicit LifetimeCounter(int& destroyed) : destroyed(&destroyed) {}
+            LifetimeCounter(LifetimeCounter&& other) noexcept : destroyed(std::exchange(other.destroyed, nullptr)) {}
+            LifetimeCounter(const LifetimeCounter&) = delete;
+            ~LifetimeCounter()
+            {
+                if (destroyed)
+                {
+                    ++*destroyed;
+                }
+            }
+
+            int* destroyed;
+        };
+    }
+
+    TEST(Task, SmallCallableIsStoredInline)
+    {
+        int calls = 0;
+        const size_t before = allocationCount.load();
+
+        Task task([&calls] { ++calls; });
+        task();
+        task();
+
+        EXPECT_EQ(allocationCount.load(), before);
+        EXPECT_EQ(calls, 2);
+        EXPECT_TRUE(task);
+    }
+
+    TEST(Task, LargeCallableFallsBackToHeap)
+    {
+        std::array<char, Task::INLINE_CAPACITY + 1> payload {};
+        payload[0] = 7;
+        int result = 0;
+        auto function = [payload, &result] { result = payload[0]; };
+        static_assert(!Task::storesInline<decltype(function)>);
+
+        const size_t before = allocationCount.load();
+        Task task(std::move(function));
+        EXPECT_EQ(allocationCount.load(), before + 1);
+
+        Task moved = std::move(task);
+        EXPECT_EQ(allocationCount.load(), before + 1);
+        EXPECT_FALSE(task);
+
+        moved();
+        EXPECT_EQ(result, 7);
+    }
+
+    TEST(Task, AcceptsMoveOnlyCallables)
+    {
+        auto value = std::make_unique<int>(42);
+        int result = 0;
+
+        Task task([value = std::move(value), &result] { result = *value; });
+        Task moved = std::move(task);
+        moved();
+
+        EXPECT_EQ(result, 42);
+    }
+
+    TEST(Task, DestroysCaptureExactlyOnce)
+    {
+        int destroyed = 0;
+        {
+            Task task([counter = LifetimeCounter(destroyed)] {});
+            Task moved = std::move(task);
+            Task assigned;
+            assigned = std::move(moved);
+            EXPECT_EQ(destroyed, 0);
+        }
+        EXPECT_EQ(destroyed, 1);
+
+        destroyed = 0;
+        Task task([counter = LifetimeCounter(destroyed)] {});
+        task.reset();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_FALSE(task);
+    }
+
+    TEST(TaskSlotPool, ReusesReleasedSlots)
+    {
+        TaskSlotPool pool;
+
+        TaskSlot* first = pool.acquire();
+        const uint32_t capacity = pool.getCapacity();
+        pool.release(first);
+
+        std::vector<TaskSlot*> slots;
+        for (uint32_t i = 0; i < capacity; ++i)
+        {
+            slots.push_back(pool.acquire());
+        }
+        EXPECT_EQ(pool.getCapacity(), capacity);
+
+        for (TaskSlot* slot : slots)
+        {
+            pool.release(slot);
+        }
+    }
+
+    TEST(TaskSlotPool, ConcurrentAcquireReleaseHandsOutEachSlotOnce)
+    {
+        TaskSlotPool pool;
+        std::atomic<int> owners[4096] {};
+        std::atomic<bool> failed { false };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]
+            {
+                for (int i = 0; i < 20000; ++i)
+                {
+                    TaskSlot* slot = pool.acquire();
+                    // Four threads never need more than the first chunk.
+                    const uint32_t index = slot->index % 4096;
+                    if (owners[index].fetch_add(1) != 0)
+                    {
+                        failed = true;
+                    }
+                    owners[index].fetch_sub(1);
+                    pool.release(slot);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        EXPECT_FALSE(failed.load());
+    }
+
+    TEST(ThreadPool, PostDoesNotAllocateOnceWarmedUp)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        constexpr int TASK_COUNT = 1000;
+        std::atomic<int> counter { 0 };
+        const auto submitAll = [&]
+        {
+            for (int i = 0; i < TASK_COUNT; ++i)
+            {
+                pool.post([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.waitUntilDone();
+        };
+
+        submitAll();
+        const size_t before = allocationCount.load();
+        submitAll();
+
+        EXPECT_EQ(allocationCount.load(), before);
+        EXPECT_EQ(counter.load(), 2 * TASK_COUNT);
+    }
+}
@@ -0,0 +1,571 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "services/threading/MpmcQueue.h"
+#include "services/threading/ThreadPool.h"
+#include "services/threading/WorkStealingQueue.h"
+
+namespace parus
+{
+    TEST(WorkStealingQueue, OwnerPopsInLifoOrder)
+    {
+        WorkStealingQueue<int> queue(8);
+        int values[3] = { 1, 2, 3 };
+
+        for (int& value : values)
+        {
+            ASSERT_TRUE(queue.push(&value));
+        }
+
+        EXPECT_EQ(*queue.pop(), 3);
+        EXPECT_EQ(*queue.pop(), 2);
+        EXPECT_EQ(*queue.pop(), 1);
+        EXPECT_EQ(queue.pop(), nullptr);
+    }
+
+    TEST(WorkStealingQueue, ThiefStealsInFifoOrder)
+    {
+        WorkStealingQueue<int> queue(8);
+        int values[3] = { 1, 2, 3 };
+
+        for (int& value : values)
+        {
+            ASSERT_TRUE(queue.push(&value));
+        }
+
+        EXPECT_EQ(*queue.steal(), 1);
+        EXPECT_EQ(*queue.steal(), 2);
+        EXPECT_EQ(*queue.pop(), 3);
+        EXPECT_EQ(queue.steal(), nullptr);
+    }
+
+    TEST(WorkStealingQueue, PushFailsWhenFull)
+    {
+        WorkStealingQueue<int> queue(2);
+        int value = 0;
+
+        EXPECT_TRUE(queue.push(&value));
+        EXPECT_TRUE(queue.push(&value));
+        EXPECT_FALSE(queue.push(&value));
+    }
+
+    TEST(WorkStealingQueue, ConcurrentThievesTakeEveryItemExactlyOnce)
+    {
+        constexpr int itemCount = 20000;
+        WorkStealingQueue<int> queue(32768);
+        std::vector<int> items(itemCount);
+        std::vector<std::atomic<int>> taken(itemCount);
+
+        for (int i = 0; i < itemCount; ++i)
+        {
+            items[i] = i;
+            ASSERT_TRUE(queue.push(&items[i]));
+        }
+
+        std::atomic<int> takenCount = 0;
+        auto thief = [&]
+        {
+            while (takenCount.load() < itemCount)
+            {
+                if (const int* item = queue.steal())
+                {
+                    taken[*item].fetch_add(1);
+                    takenCount.fetch_add(1);
+                }
+            }
+        };
+
+        std::vector<std::thread> thieves;
+        for (int i = 0; i < 3; ++i)
+        {
+            thieves.emplace_back(thief);
+        }
+
+        while (takenCount.load() < itemCount)
+        {
+            if (const int* item = queue.pop())
+            {
+                taken[*item].fetch_add(1);
+                takenCount.fetch_add(1);
+            }
+        }
+
+        for (auto& thread : thieves)
+        {
+            thread.join();
+        }
+
+        for (int i = 0; i < itemCount; ++i)
+        {
+            EXPECT_EQ(taken[i].load(), 1) << "item " << i;
+        }
+    }
+
+    TEST(MpmcQueue, PreservesFifoOrderAndReportsEmpty)
+    {
+        MpmcQueue<int> queue(4);
+        int values[2] = { 1, 2 };
+
+        EXPECT_EQ(queue.pop(), nullptr);
+        ASSERT_TRUE(queue.push(&values[0]));
+        ASSERT_TRUE(queue.push(&values[1]));
+
+        EXPECT_EQ(*queue.pop(), 1);
+        EXPECT_EQ(*queue.pop(), 2);
+        EXPECT_EQ(queue.pop(), nullptr);
+    }
+
+    TEST(MpmcQueue, PushFailsWhenFull)
+    {
+        MpmcQueue<int> queue(2);
+        int value = 0;
+
+        EXPECT_TRUE(queue.push(&value));
+        EXPECT_TRUE(queue.push(&value));
+        EXPECT_FALSE(queue.push(&value));
+        EXPECT_NE(queue.pop(), nullptr);
+        EXPECT_TRUE(queue.push(&value));
+    }
+
+    TEST(ThreadPool, RunsEveryEnqueuedTask)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::atomic<int> counter = 0;
+        for (int i = 0; i < 10000; ++i)
+        {
+            pool.enqueue([&counter] { counter.fetch_add(1); });
+        }
+        pool.waitUntilDone();
+
+        EXPECT_EQ(counter.load(), 10000);
+        EXPECT_FALSE(pool.isBusy());
+    }
+
+    TEST(ThreadPool, WaitUntilDoneIncludesTasksEnqueuedByWorkers)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::atomic<int> counter = 0;
+        for (int i = 0; i < 100; ++i)
+        {
+            pool.enqueue([&pool, &counter]
+            {
+                for (int j = 0; j < 100; ++j)
+                {
+                    pool.enqueue([&counter] { counter.fetch_add(1); });
+                }
+            });
+        }
+        pool.waitUntilDone();
+
+        EXPECT_EQ(counter.load(), 100 * 100);
+    }
+
+    TEST(ThreadPool, ManyProducersDoNotLoseTasks)
+    {
+        ThreadPool pool;
+        pool.init(3);
+
+        std::atomic<int> counter = 0;
+        std::vector<std::thread> producers;
+        for (int i = 0; i < 4; ++i)
+        {
+            producers.emplace_back([&pool, &counter]
+            {
+                for (int j = 0; j < 5000; ++j)
+                {
+                    pool.enqueue([&counter] { counter.fetch_add(1); });
+                }
+            });
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        pool.waitUntilDone();
+
+        EXPECT_EQ(counter.load(), 4 * 5000);
+    }
+
+    TEST(ThreadPool, IdleWorkersStealFromABusyWorker)
+    {
+        ThreadPool pool;
+        pool.init(4);
+
+        std::mutex threadIdsMutex;
+        std::set<std::thread::id> threadIds;
+        pool.enqueue([&]
+        {
+            // Every child lands in this worker's deque; only stealing can spread them.
+            for (int i = 0; i < 64; ++i)
+            {
+                pool.enqueue([&]
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    std::scoped_lock lock(threadIdsMutex);
+                    threadIds.insert(std::this_thread::get_id());
+                });
+            }
+        });
+        pool.waitUntilDone();
+
+        EXPECT_GT(threadIds.size(), 1u);
+    }
+
+    TEST(ThreadPool, TasksRunOnWorkerThreads)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<bool> ranOnWorker = false;
+        pool.enqueue([&] { ranOnWorker = pool.isWorkerThread(); });
+        pool.waitUntilDone();
+
+        EXPECT_TRUE(ranOnWorker.load());
+        EXPECT_FALSE(pool.isWorkerThread());
+    }
+
+    TEST(ThreadPool, IsBusyWhileATaskIsRunning)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> release = false;
+        pool.enqueue([&] { while (!release.load()) { std::this_thread::yield(); } });
+
+        EXPECT_TRUE(pool.isBusy());
+        release = true;
+        pool.waitUntilDone();
+        EXPECT_FALSE(pool.isBusy());
+    }
+
+    TEST(ThreadPool, DestructorRunsQueuedTasks)
+    {
+        std::atomic<int> counter = 0;
+        {
+            ThreadPool pool;
+            pool.init(2);
+            for (int i = 0; i < 1000; ++i)
+            {
+                pool.enqueue([&counter] { counter.fetch_add(1); });
+            }
+        }
+
+        EXPECT_EQ(counter.load(), 1000);
+    }
+
+    TEST(TaskHandle, GetReturnsTheTaskResult)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        const TaskHandle<int> handle = pool.enqueue([] { return 42; });
+
+        EXPECT_EQ(handle.get(), 42);
+        EXPECT_TRUE(handle.isReady());
+    }
+
+    TEST(TaskHandle, GetRethrowsTheTaskException)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        const TaskHandle<void> handle = pool.enqueue([] { throw std::runtime_error("boom"); });
+
+        EXPECT_THROW(handle.get(), std::runtime_error);
+    }
+
+    TEST(TaskHandle, WaitDoesNotWaitForUnrelatedTasks)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        std::atomic<bool> release = false;
+        pool.enqueue([&] { while (!release.load()) { std::this_thread::yield(); } });
+        const TaskHandle<int> quick = pool.enqueue([] { return 1; });
+
+        EXPECT_EQ(quick.get(), 1);
+        EXPECT_TRUE(pool.isBusy());
+
+        release = true;
+        pool.waitUntilDone();
+    }
+
+    TEST(TaskHandle, ThenChainsContinuationsWithResults)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        const auto handle = pool.enqueue([] { return 20; })
+            .then([](const int value) { return value + 1; })
+            .then([](const int value) { return std::to_string(value * 2); });
+
+        EXPECT_EQ(handle.get(), "42");
+    }
+
+    TEST(TaskHandle, ThenOnFinishedTaskStillRuns)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        const TaskHandle<int> first = pool.enqueue([] { return 7; });
+        first.wait();
+
+        EXPECT_EQ(first.then([](const int value) { return value * 3; }).get(), 21);
+    }
+
+    TEST(TaskHandle, ThenSkipsContinuationAfterFailure)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> continuationRan = false;
+        const auto handle = pool.enqueue([]() -> int { throw std::runtime_error("boom"); })
+            .then([&](const int) { continuationRan = true; });
+
+        EXPECT_THROW(handle.get(), std::runtime_error);
+        EXPECT_FALSE(continuationRan.load());
+    }
+
+    TEST(TaskHandle, WaitingFromAWorkerHelpsInsteadOfDeadlocking)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        // With a single worker, the inner task can only run if the outer one executes it while waiting.
+        const auto outer = pool.enqueue([&pool]
+        {
+            return pool.enqueue([] { return 5; }).get() + 1;
+        });
+
+        EXPECT_EQ(outer.get(), 6);
+    }
+
+    TEST(TaskHandle, FrameCriticalWaitDoesNotHelpWithBackgroundTasks)
+    {
+        ThreadPool pool;
+        pool.init(1);
+
+        std::atomic<bool> backgroundRan { false };
+        const auto outer = pool.enqueue(TaskPriority::FRAME_CRITICAL, [&]
+        {
+            // Queued on the only worker, which is this one, before the task we wait on.
+            pool.post(TaskPriority::BACKGROUND, [&backgroundRan] { backgroundRan = true; });
+            const int inner = pool.enqueue([] { return 5; }).get();
+            return !backgroundRan.load() && inner == 5;
+        });
+
+        EXPECT_TRUE(outer.get());
+        pool.waitUntilDone();
+        EXPECT_TRUE(backgroundRan.load());
+    }
+
+    namespace
+    {
+        /** Occupies a single-worker pool until release(), so tests can queue tasks deterministically. */
+        class WorkerBlocker
+        {
+        public:
+            explicit WorkerBlocker(ThreadPool& pool)
+            {
+                pool.post(TaskPriority::FRAME_CRITICAL, [this]
+                {
+                    started = true;
+                    started.notify_all();
+                    released.wait(false);
+                });
+                started.wait(false);
+            }
+
+            ~WorkerBlocker() { release(); }
+
+            void release()
+            {
+                released = true;
+                released.notify_all();
+            }
+
+        private:
+            std::atomic<bool> started { false };
+            std::atomic<bool> released { false };
+        };
+
+        template <typename Predicate>
+        bool waitFor(Predicate predicate)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!predicate())
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        }
+    }
+
+    TEST(ThreadPoolPriority, HigherLanesRunFirst)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 1;
+        settings.starvationInterval = 1000;
+        ThreadPool pool;
+        pool.init(settings);
+
+        std::mutex orderMutex;
+        std::vector<TaskPriority> order;
+        WorkerBlocker blocker(pool);
+        for (const TaskPriority priority : { TaskPriority::BACKGROUND, TaskPriority::NORMAL, TaskPriority::FRAME_CRITICAL })
+        {
+            pool.post(priority, [&, priority]
+            {
+                std::scoped_lock lock(orderMutex);
+                order.push_back(priority);
+            });
+        }
+
+        EXPECT_EQ(pool.getQueueDepth(TaskPriority::FRAME_CRITICAL), 1u);
+        EXPECT_EQ(pool.getQueueDepth(TaskPriority::NORMAL), 1u);
+        EXPECT_EQ(pool.getQueueDepth(TaskPriority::BACKGROUND), 1u);
+
+        blocker.release();
+        pool.waitUntilDone();
+
+        const std::vector expected = { TaskPriority::FRAME_CRITICAL, TaskPriority::NORMAL, TaskPriority::BACKGROUND };
+        EXPECT_EQ(order, expected);
+    }
+
+    TEST(ThreadPoolPriority, BackgroundLaneIsNotStarved)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 1;
+        settings.starvationInterval = 4;
+        ThreadPool pool;
+        pool.init(settings);
+
+        std::atomic<int> criticalRun { 0 };
+        std::atomic<int> criticalRunBeforeBackground { -1 };
+        WorkerBlocker blocker(pool);
+        pool.post(TaskPriority::BACKGROUND, [&] { criticalRunBeforeBackground = criticalRun.load(); });
+        for (int i = 0; i < 100; ++i)
+        {
+            pool.post(TaskPriority::FRAME_CRITICAL, [&] { criticalRun.fetch_add(1); });
+        }
+
+        blocker.release();
+        pool.waitUntilDone();
+
+        EXPECT_GE(criticalRunBeforeBackground.load(), 0);
+        EXPECT_LT(criticalRunBeforeBackground.load(), 100);
+    }
+
+    TEST(ThreadPoolPriority, SubmittedTasksInheritTheirParentsLane)
+    {
+        ThreadPool pool;
+        pool.init(2);
+
+        const TaskPriority childPriority = pool.enqueue(TaskPriority::BACKGROUND, [&pool]
+        {
+            return pool.enqueue(getCurrentTaskPriority).get();
+        }).get();
+
+        EXPECT_EQ(childPriority, TaskPriority::BACKGROUND);
+        EXPECT_EQ(getCurrentTaskPriority(), TaskPriority::NORMAL);
+        {
+            const ScopedTaskPriority scope(TaskPriority::FRAME_CRITICAL);
+            EXPECT_EQ(pool.enqueue(getCurrentTaskPriority).get(), TaskPriority::FRAME_CRITICAL);
+        }
+    }
+
+    TEST(ThreadPoolPriority, BackgroundWorkIsCappedPerFrame)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 2;
+        settings.backgroundTasksPerFrame = 2;
+        settings.stalledFrameMilliseconds = 60000;
+        ThreadPool pool;
+        pool.init(settings);
+
+        pool.beginFrame();
+        std::atomic<int> backgroundRun { 0 };
+        for (int i = 0; i < 5; ++i)
+        {
+            pool.post(TaskPriority::BACKGROUND, [&] { backgroundRun.fetch_add(1); });
+        }
+
+        ASSERT_TRUE(waitFor([&] { return backgroundRun.load() == 2; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_EQ(backgroundRun.load(), 2);
+        EXPECT_EQ(pool.getQueueDepth(TaskPriority::BACKGROUND), 3u);
+
+        // Other lanes are not affected by the cap.
+        EXPECT_EQ(pool.enqueue(TaskPriority::NORMAL, [] { return 1; }).get(), 1);
+
+        pool.beginFrame();
+        ASSERT_TRUE(waitFor([&] { return backgroundRun.load() == 4; }));
+        pool.beginFrame();
+        pool.waitUntilDone();
+        EXPECT_EQ(backgroundRun.load(), 5);
+    }
+
+    TEST(ThreadPoolPriority, ThrottledWorkerStillWakesForOtherLanes)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 1;
+        settings.backgroundTasksPerFrame = 1;
+        settings.stalledFrameMilliseconds = 60000;
+        ThreadPool pool;
+        pool.init(settings);
+
+        pool.beginFrame();
+        std::atomic<int> backgroundRun { 0 };
+        for (int i = 0; i < 2; ++i)
+        {
+            pool.post(TaskPriority::BACKGROUND, [&] { backgroundRun.fetch_add(1); });
+        }
+        ASSERT_TRUE(waitFor([&] { return backgroundRun.load() == 1; }));
+
+        // The only worker now waits for the next frame; a normal task must not wait with it.
+        const auto handle = pool.enqueue(TaskPriority::NORMAL, [] { return 1; });
+        EXPECT_TRUE(waitFor([&] { return handle.isReady(); }));
+
+        pool.beginFrame();
+        pool.waitUntilDone();
+        EXPECT_EQ(backgroundRun.load(), 2);
+    }
+
+    TEST(ThreadPoolPriority, StalledFrameLiftsTheBackgroundCap)
+    {
+        ThreadPoolSettings settings;
+        settings.threadCount = 1;
+        settings.backgroundTasksPerFrame = 1;
+        settings.stalledFrameMilliseconds = 10;
+        ThreadPool pool;
+        pool.init(settings);
+
+        pool.beginFrame();
+        std::atomic<int> backgroundRun { 0 };
+        for (int i = 0; i < 5; ++i)
+        {
+            pool.post(TaskPriority::BACKGROUND, [&] { backgroundRun.fetch_add(1); });
+        }
+
+        // No further beginFrame(): the frame counts as stalled and the rest runs anyway.
+        pool.waitUntilDone();
+        EXPECT_EQ(backgroundRun.load(), 5);
+    }
+}
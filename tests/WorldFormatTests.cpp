@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 #include "services/renderer/vulkan/mesh/Mesh.h"
+#include "services/serialization/BinaryStream.h"
+#include "services/serialization/FormatHeader.h"
 #include "services/serialization/WorldFormat.h"
 #include "services/world/World.h"
 #include "services/world/entity/Components.h"
@@ -117,6 +123,136 @@ namespace parus::serialization
         std::filesystem::remove_all(scenesDir);
     }
 
+    TEST(WorldFormatRoundTrip, PrefabInstancesStoreOnlyTheirOverrides)
+    {
+        const std::filesystem::path scenesDir = std::filesystem::temp_directory_path() / "parus_world_format_prefab_test";
+        std::filesystem::create_directories(scenesDir);
+
+        const auto treeMesh = makeGeometryMesh("tree");
+        auto prefab = std::make_shared<Prefab>();
+        prefab->name = "Tree";
+        prefab->mesh = MeshComponent{ treeMesh };
+        prefab->pointLight = PointLightComponent{ math::Vector3(0.2f, 1.0f, 0.2f), 5.0f, 0.5f };
+
+        constexpr size_t TREE_COUNT = 100;
+        const std::vector<math::Transform> transforms(TREE_COUNT);
+
+        // The same trees twice: once as prefab instances, once as plain entities.
+        World prefabWorld;
+        prefabWorld.getStorage()->addNewMesh("tree", treeMesh);
+        const auto prefabEntities = prefabWorld.getEntityManager();
+        const std::vector<EntityId> trees = prefabEntities->instantiateMany(prefab, transforms);
+        prefabEntities->addPointLightComponent(trees.back(), PointLightComponent{ math::Vector3(1.0f, 0.0f, 0.0f), 9.0f, 2.0f });
+        writeWorld(prefabWorld, "prefab_scene", scenesDir / "prefab_scene.pworld");
+
+        World plainWorld;
+        plainWorld.getStorage()->addNewMesh("tree", treeMesh);
+        const auto plainEntities = plainWorld.getEntityManager();
+        for (size_t i = 0; i < TREE_COUNT; ++i)
+        {
+            const EntityId id = plainEntities->spawn(prefabEntities->getEntity(trees[i])->name);
+            plainEntities->addMeshComponent(id, *prefab->mesh);
+            plainEntities->addPointLightComponent(id, *prefabEntities->getPointLightComponent(trees[i]));
+        }
+        writeWorld(plainWorld, "plain_scene", scenesDir / "plain_scene.pworld");
+
+        EXPECT_LT(std::filesystem::file_size(scenesDir / "prefab_scene.pworld"), std::filesystem::file_size(scenesDir / "plain_scene.pworld"));
+
+        const std::optional<SceneData> loaded = readWorld("prefab_scene", scenesDir);
+        ASSERT_TRUE(loaded.has_value());
+        ASSERT_EQ(loaded->prefabs.size(), 1u);
+        EXPECT_EQ(loaded->prefabs[0].name, "Tree");
+        ASSERT_TRUE(loaded->prefabs[0].meshComponent.has_value());
+        EXPECT_EQ(loaded->meshStems[loaded->prefabs[0].meshComponent->meshIndex], "tree");
+
+        ASSERT_EQ(loaded->entities.size(), TREE_COUNT);
+        for (size_t i = 0; i < TREE_COUNT; ++i)
+        {
+            const EntityEntry& entry = loaded->entities[i];
+            EXPECT_EQ(entry.prefabIndex, std::optional<uint32_t>(0));
+            ASSERT_TRUE(entry.meshComponent.has_value());
+            EXPECT_EQ(entry.meshComponent->meshIndex, loaded->prefabs[0].meshComponent->meshIndex);
+            ASSERT_TRUE(entry.pointLightComponent.has_value());
+        }
+
+        // Inherited components are filled in from the prefab; the override keeps its own values.
+        EXPECT_FLOAT_EQ(loaded->entities.front().pointLightComponent->radius, 5.0f);
+        EXPECT_FLOAT_EQ(loaded->entities.back().pointLightComponent->radius, 9.0f);
+
+        std::filesystem::remove_all(scenesDir);
+    }
+
+    TEST(WorldFormatRoundTrip, ReadsVersion3FilesWithoutPrefabs)
+    {
+        const std::filesystem::path scenesDir = std::filesystem::temp_directory_path() / "parus_world_format_v3_test";
+        std::filesystem::create_directories(scenesDir);
+
+        // Laid out as version 3 wrote it: no prefab table, and rows use 0/1 flags instead of ComponentState.
+        std::ostringstream payload(std::ios::binary);
+        writeVector3(payload, math::Vector3(1.0f, 2.0f, 3.0f));
+        writeFloat(payload, 0.5f);
+        writeFloat(payload, -0.2f);
+        writeString(payload, "");
+        writeVector3(payload, math::Vector3());
+        writeVector3(payload, math::Vector3());
+        writeUInt32(payload, 0);
+        writeVector3(payload, math::Vector3(1.0f, 1.0f, 1.0f));
+        writeVector3(payload, math::Vector3(0.0f, -1.0f, 0.0f));
+        writeUInt32(payload, 1);
+        writeString(payload, "cube");
+        writeUInt32(payload, 2);
+        for (const bool isLamp : { false, true })
+        {
+            writeString(payload, isLamp ? "Lamp" : "Cube");
+            writeUInt8(payload, static_cast<uint8_t>(Mobility::Static));
+            writeVector3(payload, math::Vector3());
+            writeVector3(payload, math::Vector3());
+            writeVector3(payload, math::Vector3(1.0f, 1.0f, 1.0f));
+            writeUInt8(payload, isLamp ? 0 : 1);
+            if (!isLamp)
+            {
+                writeUInt32(payload, 0);
+            }
+            writeUInt8(payload, isLamp ? 1 : 0);
+            if (isLamp)
+            {
+                writeVector3(payload, math::Vector3(1.0f, 0.5f, 0.0f));
+                writeFloat(payload, 12.0f);
+                writeFloat(payload, 2.0f);
+            }
+        }
+
+        const std::string payloadBytes = payload.str();
+        {
+            std::ofstream file(scenesDir / "v3_scene.pworld", std::ios::binary);
+            FormatHeader header;
+            header.magic       = MAGIC_PWORLD;
+            header.version     = 3;
+            header.payloadSize = payloadBytes.size();
+            writeHeader(file, header);
+            file.write(payloadBytes.data(), static_cast<std::streamsize>(payloadBytes.size()));
+        }
+
+        const std::optional<SceneData> loaded = readWorld("v3_scene", scenesDir);
+        ASSERT_TRUE(loaded.has_value());
+        EXPECT_TRUE(loaded->prefabs.empty());
+        ASSERT_EQ(loaded->meshStems.size(), 1u);
+        ASSERT_EQ(loaded->entities.size(), 2u);
+
+        EXPECT_EQ(loaded->entities[0].name, "Cube");
+        EXPECT_FALSE(loaded->entities[0].prefabIndex.has_value());
+        ASSERT_TRUE(loaded->entities[0].meshComponent.has_value());
+        EXPECT_EQ(loaded->entities[0].meshComponent->meshIndex, 0u);
+        EXPECT_FALSE(loaded->entities[0].pointLightComponent.has_value());
+
+        EXPECT_EQ(loaded->entities[1].name, "Lamp");
+        EXPECT_FALSE(loaded->entities[1].meshComponent.has_value());
+        ASSERT_TRUE(loaded->entities[1].pointLightComponent.has_value());
+        EXPECT_FLOAT_EQ(loaded->entities[1].pointLightComponent->radius, 12.0f);
+
+        std::filesystem::remove_all(scenesDir);
+    }
+
     // Regression test: a scene whose skybox has no sourcePath (the built-in sky mesh never sets
     // one) writes an empty mesh stem. Storage::getMeshByPath must not insert a null entry for that
     // (or any other) missing key - doing so previously corrupted Storage::meshes with a null